@@ -45,6 +45,7 @@ enum file_type util_stat_get_type(const os_stat_t *st);
 enum file_type util_fd_get_type(int fd);
 enum file_type util_file_get_type(const char *path);
 int util_ddax_region_find(const char *path, unsigned *region_id);
+int util_stat_numa_node(const os_stat_t *st);
 ssize_t util_file_get_size(const char *path);
 ssize_t util_fd_get_size(int fd);
 size_t util_file_device_dax_alignment(const char *path);
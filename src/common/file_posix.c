@@ -12,6 +12,7 @@
 
 #include <errno.h>
 #include <signal.h>
+#include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <dirent.h>
@@ -145,6 +146,93 @@ util_file_device_dax_alignment(const char *path)
 	return device_dax_alignment(path);
 }
 
+/*
+ * read_numa_node -- (internal) reads the numa node from the given sysfs
+ *	attribute, returns -1 if it cannot be read
+ */
+static int
+read_numa_node(const char *spath)
+{
+	LOG(4, "numa node path \"%s\"", spath);
+
+	int fd = os_open(spath, O_RDONLY);
+	if (fd < 0)
+		return -1;
+
+	char buff[16];
+	ssize_t nread = read(fd, buff, sizeof(buff) - 1);
+	os_close(fd);
+
+	if (nread <= 0)
+		return -1;
+
+	buff[nread] = '\0';
+
+	char *endptr;
+	errno = 0;
+	long node = strtol(buff, &endptr, 10);
+	if (errno || endptr == buff || node < 0 || node > INT_MAX)
+		return -1;
+
+	return (int)node;
+}
+
+/*
+ * util_stat_numa_node -- returns the numa node on which the file is located,
+ *	according to the topology of its backing device in sysfs, or -1 if it
+ *	cannot be determined
+ *
+ * This does not require libndctl, but works only for the devices which
+ * expose their numa node in sysfs - i.e. pmem namespaces and dax devices.
+ */
+int
+util_stat_numa_node(const os_stat_t *st)
+{
+	char spath[PATH_MAX];
+	int ret;
+
+	if (S_ISCHR(st->st_mode)) {
+		ret = util_snprintf(spath, PATH_MAX,
+			"/sys/dev/char/%u:%u/device/numa_node",
+			os_major(st->st_rdev), os_minor(st->st_rdev));
+		if (ret < 0) {
+			/* impossible */
+			ERR("!snprintf");
+			ASSERTinfo(0, "snprintf failed");
+			return -1;
+		}
+
+		return read_numa_node(spath);
+	}
+
+	ret = util_snprintf(spath, PATH_MAX,
+		"/sys/dev/block/%u:%u/device/numa_node",
+		os_major(st->st_dev), os_minor(st->st_dev));
+	if (ret < 0) {
+		/* impossible */
+		ERR("!snprintf");
+		ASSERTinfo(0, "snprintf failed");
+		return -1;
+	}
+
+	int node = read_numa_node(spath);
+	if (node >= 0)
+		return node;
+
+	/* partitions have the device attributes in the parent directory */
+	ret = util_snprintf(spath, PATH_MAX,
+		"/sys/dev/block/%u:%u/../device/numa_node",
+		os_major(st->st_dev), os_minor(st->st_dev));
+	if (ret < 0) {
+		/* impossible */
+		ERR("!snprintf");
+		ASSERTinfo(0, "snprintf failed");
+		return -1;
+	}
+
+	return read_numa_node(spath);
+}
+
 /*
  * util_ddax_region_find -- returns Device DAX region id
  */
@@ -70,6 +70,7 @@
 #include "fs.h"
 #include "os_deep.h"
 #include "set_badblocks.h"
+#include "libpmem2.h"
 
 #define SIZE_AUTODETECT_STR "AUTO"
 
@@ -473,6 +474,48 @@ util_poolset_fdclose(struct pool_set *set)
 #endif
 }
 
+/*
+ * util_part_numa_node -- returns the numa node on which the part file is
+ *	located, or -1 if it cannot be determined
+ *
+ * The node is looked up through libndctl first, with a fallback to the
+ * topology of the backing device exposed in sysfs.
+ */
+int
+util_part_numa_node(struct pool_set_part *part)
+{
+	LOG(3, "part %p", part);
+
+	int fd = part->fd;
+	if (fd == -1) {
+		fd = os_open(part->path, O_RDONLY);
+		if (fd == -1) {
+			LOG(2, "!open %s", part->path);
+			return -1;
+		}
+	}
+
+	int numa_node = -1;
+
+	struct pmem2_source *src;
+	if (pmem2_source_from_fd(&src, fd) == 0) {
+		if (pmem2_source_numa_node(src, &numa_node) != 0)
+			numa_node = -1;
+		pmem2_source_delete(&src);
+	}
+
+	os_stat_t st;
+	if (numa_node < 0 && os_fstat(fd, &st) == 0)
+		numa_node = util_stat_numa_node(&st);
+
+	if (fd != part->fd)
+		os_close(fd);
+
+	LOG(4, "part %s numa node %d", part->path, numa_node);
+
+	return numa_node < 0 ? -1 : numa_node;
+}
+
 /*
  * util_autodetect_size -- (internal) retrieves size of an existing file
  */
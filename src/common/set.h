@@ -323,6 +323,7 @@ void util_poolset_free(struct pool_set *set);
 int util_poolset_chmod(struct pool_set *set, mode_t mode);
 void util_poolset_fdclose(struct pool_set *set);
 void util_poolset_fdclose_always(struct pool_set *set);
+int util_part_numa_node(struct pool_set_part *part);
 int util_is_poolset_file(const char *path);
 int util_poolset_foreach_part_struct(struct pool_set *set,
 	int (*cb)(struct part_file *pf, void *arg), void *arg);
@@ -165,6 +165,13 @@ void os_thread_self(os_thread_t *thread);
 int os_thread_setaffinity_np(os_thread_t *thread, size_t set_size,
 	const os_cpu_set_t *set);
 
+int os_getcpu(unsigned *cpu, unsigned *node);
+
+/* futex-like waiting on a 32-bit word */
+
+int os_futex_wait(uint32_t *addr, uint32_t val);
+void os_futex_wake(uint32_t *addr, int nwaiters);
+
 int os_thread_atfork(void (*prepare)(void), void (*parent)(void),
 	void (*child)(void));
 
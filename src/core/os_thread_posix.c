@@ -13,6 +13,17 @@
 #include <pthread_np.h>
 #endif
 #include <semaphore.h>
+#include <errno.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#endif
+#ifdef __FreeBSD__
+#include <sys/types.h>
+#include <sys/umtx.h>
+#endif
 
 #include "os_thread.h"
 #include "util.h"
@@ -373,6 +384,66 @@ os_thread_setaffinity_np(os_thread_t *thread, size_t set_size,
 		(cpu_set_t *)set);
 }
 
+/*
+ * os_getcpu -- returns the cpu and the numa node the calling thread is
+ *	currently running on, the node may be NULL
+ */
+int
+os_getcpu(unsigned *cpu, unsigned *node)
+{
+#ifdef __linux__
+	if (node == NULL) {
+		/* glibc reads the cpu from the rseq area or the vdso */
+		int ret = sched_getcpu();
+		if (ret >= 0) {
+			*cpu = (unsigned)ret;
+			return 0;
+		}
+	}
+#endif
+#ifdef SYS_getcpu
+	return (int)syscall(SYS_getcpu, cpu, node, NULL);
+#else
+	SUPPRESS_UNUSED(cpu, node);
+	errno = ENOTSUP;
+	return -1;
+#endif
+}
+
+/*
+ * os_futex_wait -- blocks the calling thread as long as the word at addr
+ *	is equal to val, spurious wake ups are possible
+ */
+int
+os_futex_wait(uint32_t *addr, uint32_t val)
+{
+#if defined(__linux__)
+	return (int)syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, val,
+		NULL, NULL, 0);
+#elif defined(__FreeBSD__)
+	return _umtx_op(addr, UMTX_OP_WAIT_UINT_PRIVATE, val, NULL, NULL);
+#else
+	SUPPRESS_UNUSED(addr, val);
+	return sched_yield();
+#endif
+}
+
+/*
+ * os_futex_wake -- wakes up to nwaiters threads blocked on the word at addr
+ */
+void
+os_futex_wake(uint32_t *addr, int nwaiters)
+{
+#if defined(__linux__)
+	(void) syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, nwaiters,
+		NULL, NULL, 0);
+#elif defined(__FreeBSD__)
+	(void) _umtx_op(addr, UMTX_OP_WAKE_PRIVATE, nwaiters, NULL, NULL);
+#else
+	SUPPRESS_UNUSED(addr, nwaiters);
+#endif
+}
+
 /*
  * os_cpu_zero -- CP_ZERO abstraction layer
  */
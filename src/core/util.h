@@ -84,6 +84,7 @@ uint64_t util_checksum_compute(void *addr, size_t len, uint64_t *csump,
 int util_checksum(void *addr, size_t len, uint64_t *csump,
 		int insert, size_t skip_off);
 uint64_t util_checksum_seq(const void *addr, size_t len, uint64_t csum);
+uint32_t util_crc32c(uint32_t crc, const void *addr, size_t len);
 int util_parse_size(const char *str, size_t *sizep);
 char *util_fgets(char *buffer, int max, FILE *stream);
 char *util_getexecname(char *path, size_t pathlen);
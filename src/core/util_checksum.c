@@ -0,0 +1,218 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2014-2026, Intel Corporation */
+
+/*
+ * util_checksum.c -- Fletcher64-like checksum
+ *
+ * The checksum is a pair of 32-bit sums over the 32-bit little endian words
+ * of the data: lo32 is the sum of the words and hi32 is the sum of all
+ * the intermediate values of lo32. Since hi32 is a prefix sum, the data can
+ * be split into a number of interleaved lanes, each summed independently,
+ * and the lane sums merged at the end (see util_checksum_lanes). This is
+ * what the vectorized implementations do, the best one available on the CPU
+ * is selected on first use.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <endian.h>
+
+#include "util.h"
+#include "util_checksum.h"
+#include "os.h"
+#include "out.h"
+
+typedef uint64_t (*checksum_seq_fn)(const void *addr, size_t len,
+		uint64_t csum);
+
+static uint64_t util_checksum_seq_select(const void *addr, size_t len,
+		uint64_t csum);
+
+static checksum_seq_fn Checksum_seq = util_checksum_seq_select;
+
+/*
+ * util_checksum_seq_generic -- compute sequential Fletcher64-like checksum,
+ *	one word at a time
+ */
+uint64_t
+util_checksum_seq_generic(const void *addr, size_t len, uint64_t csum)
+{
+	if (len % 4 != 0)
+		abort();
+	const uint32_t *p32 = addr;
+	const uint32_t *p32end = (const uint32_t *)((const char *)addr + len);
+	uint32_t lo32 = (uint32_t)csum;
+	uint32_t hi32 = (uint32_t)(csum >> 32);
+	while (p32 < p32end) {
+		lo32 += le32toh(*p32);
+		++p32;
+		hi32 += lo32;
+	}
+	return (uint64_t)hi32 << 32 | lo32;
+}
+
+/*
+ * util_checksum_lanes -- merges the checksum with the sums of nwords words
+ *	processed in nlanes interleaved lanes
+ *
+ * For every lane, sum is the sum of its words and psum is the sum of all
+ * the intermediate values of sum, i.e. the word at the position i of the lane
+ * is counted n - i times in psum, where n is the number of words in a lane.
+ */
+uint64_t
+util_checksum_lanes(uint64_t csum, const uint32_t *sum, const uint32_t *psum,
+		unsigned nlanes, size_t nwords)
+{
+	uint32_t lo32 = (uint32_t)csum;
+	uint32_t hi32 = (uint32_t)(csum >> 32);
+
+	/* every word adds the initial lo32 to hi32 */
+	hi32 += (uint32_t)nwords * lo32;
+
+	for (unsigned l = 0; l < nlanes; ++l) {
+		lo32 += sum[l];
+		hi32 += nlanes * psum[l] - l * sum[l];
+	}
+
+	return (uint64_t)hi32 << 32 | lo32;
+}
+
+/*
+ * util_checksum_seq_select -- (internal) selects the implementation of
+ *	the checksum and computes it
+ */
+static uint64_t
+util_checksum_seq_select(const void *addr, size_t len, uint64_t csum)
+{
+	checksum_seq_fn fn = util_checksum_seq_generic;
+
+#if defined(__x86_64__) || defined(__amd64__)
+	fn = util_checksum_seq_sse2;
+	LOG(3, "sse2 checksum");
+
+	__builtin_cpu_init();
+
+	char *e = os_getenv("PMEM_AVX");
+	if (__builtin_cpu_supports("avx2") &&
+			(e == NULL || strcmp(e, "0") != 0)) {
+		fn = util_checksum_seq_avx2;
+		LOG(3, "avx2 checksum");
+	}
+
+#if AVX512F_AVAILABLE
+	e = os_getenv("PMEM_AVX512F");
+	if (__builtin_cpu_supports("avx512f") &&
+			(e == NULL || strcmp(e, "0") != 0)) {
+		fn = util_checksum_seq_avx512f;
+		LOG(3, "avx512f checksum");
+	}
+#endif
+#endif
+
+	util_atomic_store_explicit64(&Checksum_seq, fn, memory_order_relaxed);
+
+	return fn(addr, len, csum);
+}
+
+/*
+ * util_checksum_zeros -- (internal) merges the checksum with n words
+ *	treated as zeros
+ */
+static inline uint64_t
+util_checksum_zeros(uint64_t csum, uint32_t n)
+{
+	uint32_t lo32 = (uint32_t)csum;
+	uint32_t hi32 = (uint32_t)(csum >> 32);
+
+	hi32 += n * lo32;
+
+	return (uint64_t)hi32 << 32 | lo32;
+}
+
+/*
+ * util_checksum_compute -- compute Fletcher64-like checksum
+ *
+ * csump points to where the checksum lives, so that location
+ * is treated as zeros while calculating the checksum. The
+ * checksummed data is assumed to be in little endian order.
+ */
+uint64_t
+util_checksum_compute(void *addr, size_t len, uint64_t *csump, size_t skip_off)
+{
+	if (len % 4 != 0)
+		abort();
+
+	uint32_t *p32 = addr;
+	uint32_t *p32end = (uint32_t *)((char *)addr + len);
+	uint32_t *skip;
+	uint32_t *csum32 = NULL;
+	uint64_t csum = 0;
+
+	/* the first word at or after skip_off starts the skipped part */
+	if (skip_off && skip_off < len)
+		skip = (uint32_t *)((char *)addr +
+			ALIGN_UP(skip_off, sizeof(uint32_t)));
+	else
+		skip = p32end;
+
+	/* a misaligned checksum location is never hit by the word pointer */
+	if (((uintptr_t)csump - (uintptr_t)addr) % 4 == 0)
+		csum32 = (uint32_t *)csump;
+
+	while (p32 < p32end) {
+		if (p32 == csum32 || p32 >= skip) {
+			/* treat both halves of the checksum as zeros */
+			csum = util_checksum_zeros(csum, 2);
+			p32 += 2;
+			continue;
+		}
+
+		uint32_t *next = skip;
+		if (csum32 > p32 && csum32 < next)
+			next = csum32;
+
+		csum = util_checksum_seq(p32,
+			(size_t)((char *)next - (char *)p32), csum);
+		p32 = next;
+	}
+
+	return csum;
+}
+
+/*
+ * util_checksum -- compute Fletcher64-like checksum
+ *
+ * csump points to where the checksum lives, so that location
+ * is treated as zeros while calculating the checksum.
+ * If insert is true, the calculated checksum is inserted into
+ * the range at *csump.  Otherwise the calculated checksum is
+ * checked against *csump and the result returned (true means
+ * the range checksummed correctly).
+ */
+int
+util_checksum(void *addr, size_t len, uint64_t *csump,
+		int insert, size_t skip_off)
+{
+	uint64_t csum = util_checksum_compute(addr, len, csump, skip_off);
+
+	if (insert) {
+		*csump = htole64(csum);
+		return 1;
+	}
+
+	return *csump == htole64(csum);
+}
+
+/*
+ * util_checksum_seq -- compute sequential Fletcher64-like checksum
+ *
+ * Merges checksum from the old buffer with checksum for current buffer.
+ */
+uint64_t
+util_checksum_seq(const void *addr, size_t len, uint64_t csum)
+{
+	checksum_seq_fn fn;
+	util_atomic_load_explicit64(&Checksum_seq, &fn, memory_order_relaxed);
+
+	return fn(addr, len, csum);
+}
@@ -0,0 +1,35 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright 2026, Intel Corporation */
+
+/*
+ * util_checksum.h -- internal definitions for the implementations of
+ *	the Fletcher64-like checksum
+ */
+
+#ifndef PMDK_UTIL_CHECKSUM_H
+#define PMDK_UTIL_CHECKSUM_H 1
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint64_t util_checksum_seq_generic(const void *addr, size_t len,
+		uint64_t csum);
+uint64_t util_checksum_lanes(uint64_t csum, const uint32_t *sum,
+		const uint32_t *psum, unsigned nlanes, size_t nwords);
+
+#if defined(__x86_64__) || defined(__amd64__)
+uint64_t util_checksum_seq_sse2(const void *addr, size_t len, uint64_t csum);
+uint64_t util_checksum_seq_avx2(const void *addr, size_t len, uint64_t csum);
+uint64_t util_checksum_seq_avx512f(const void *addr, size_t len,
+		uint64_t csum);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
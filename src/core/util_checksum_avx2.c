@@ -0,0 +1,59 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2026, Intel Corporation */
+
+/*
+ * util_checksum_avx2.c -- AVX2 implementation of the Fletcher64-like checksum
+ */
+
+#ifdef __AVX2__
+
+#include <immintrin.h>
+
+#include "util_checksum.h"
+
+/* two vectors of eight 32-bit words per iteration */
+#define CHECKSUM_AVX2_LANES 16
+#define CHECKSUM_AVX2_BLOCK (CHECKSUM_AVX2_LANES * sizeof(uint32_t))
+
+/*
+ * util_checksum_seq_avx2 -- compute sequential Fletcher64-like checksum
+ */
+uint64_t
+util_checksum_seq_avx2(const void *addr, size_t len, uint64_t csum)
+{
+	const __m256i *p = addr;
+	size_t nblocks = len / CHECKSUM_AVX2_BLOCK;
+
+	__m256i sum0 = _mm256_setzero_si256();
+	__m256i sum1 = _mm256_setzero_si256();
+	__m256i psum0 = _mm256_setzero_si256();
+	__m256i psum1 = _mm256_setzero_si256();
+
+	for (size_t i = 0; i < nblocks; ++i) {
+		sum0 = _mm256_add_epi32(sum0, _mm256_loadu_si256(p));
+		sum1 = _mm256_add_epi32(sum1, _mm256_loadu_si256(p + 1));
+		psum0 = _mm256_add_epi32(psum0, sum0);
+		psum1 = _mm256_add_epi32(psum1, sum1);
+		p += 2;
+	}
+
+	if (nblocks != 0) {
+		uint32_t sum[CHECKSUM_AVX2_LANES];
+		uint32_t psum[CHECKSUM_AVX2_LANES];
+
+		_mm256_storeu_si256((__m256i *)sum, sum0);
+		_mm256_storeu_si256((__m256i *)sum + 1, sum1);
+		_mm256_storeu_si256((__m256i *)psum, psum0);
+		_mm256_storeu_si256((__m256i *)psum + 1, psum1);
+
+		csum = util_checksum_lanes(csum, sum, psum,
+			CHECKSUM_AVX2_LANES, nblocks * CHECKSUM_AVX2_LANES);
+	}
+
+	/* avoid the penalty of mixing AVX and SSE code in the generic part */
+	_mm256_zeroupper();
+
+	return util_checksum_seq_generic(p, len % CHECKSUM_AVX2_BLOCK, csum);
+}
+
+#endif
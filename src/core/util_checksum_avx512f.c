@@ -0,0 +1,61 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2026, Intel Corporation */
+
+/*
+ * util_checksum_avx512f.c -- AVX512F implementation of the Fletcher64-like
+ *	checksum
+ */
+
+#ifdef __AVX512F__
+
+#include <immintrin.h>
+
+#include "util_checksum.h"
+
+/* two vectors of sixteen 32-bit words per iteration */
+#define CHECKSUM_AVX512F_LANES 32
+#define CHECKSUM_AVX512F_BLOCK (CHECKSUM_AVX512F_LANES * sizeof(uint32_t))
+
+/*
+ * util_checksum_seq_avx512f -- compute sequential Fletcher64-like checksum
+ */
+uint64_t
+util_checksum_seq_avx512f(const void *addr, size_t len, uint64_t csum)
+{
+	const __m512i *p = addr;
+	size_t nblocks = len / CHECKSUM_AVX512F_BLOCK;
+
+	__m512i sum0 = _mm512_setzero_si512();
+	__m512i sum1 = _mm512_setzero_si512();
+	__m512i psum0 = _mm512_setzero_si512();
+	__m512i psum1 = _mm512_setzero_si512();
+
+	for (size_t i = 0; i < nblocks; ++i) {
+		sum0 = _mm512_add_epi32(sum0, _mm512_loadu_si512(p));
+		sum1 = _mm512_add_epi32(sum1, _mm512_loadu_si512(p + 1));
+		psum0 = _mm512_add_epi32(psum0, sum0);
+		psum1 = _mm512_add_epi32(psum1, sum1);
+		p += 2;
+	}
+
+	if (nblocks != 0) {
+		uint32_t sum[CHECKSUM_AVX512F_LANES];
+		uint32_t psum[CHECKSUM_AVX512F_LANES];
+
+		_mm512_storeu_si512(sum, sum0);
+		_mm512_storeu_si512(sum + 16, sum1);
+		_mm512_storeu_si512(psum, psum0);
+		_mm512_storeu_si512(psum + 16, psum1);
+
+		csum = util_checksum_lanes(csum, sum, psum,
+			CHECKSUM_AVX512F_LANES,
+			nblocks * CHECKSUM_AVX512F_LANES);
+	}
+
+	/* avoid the penalty of mixing AVX and SSE code in the generic part */
+	_mm256_zeroupper();
+
+	return util_checksum_seq_generic(p, len % CHECKSUM_AVX512F_BLOCK, csum);
+}
+
+#endif
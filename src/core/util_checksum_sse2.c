@@ -0,0 +1,56 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2026, Intel Corporation */
+
+/*
+ * util_checksum_sse2.c -- SSE2 implementation of the Fletcher64-like checksum
+ */
+
+#ifdef __SSE2__
+
+#include <immintrin.h>
+
+#include "util_checksum.h"
+
+/* two vectors of four 32-bit words per iteration */
+#define CHECKSUM_SSE2_LANES 8
+#define CHECKSUM_SSE2_BLOCK (CHECKSUM_SSE2_LANES * sizeof(uint32_t))
+
+/*
+ * util_checksum_seq_sse2 -- compute sequential Fletcher64-like checksum
+ */
+uint64_t
+util_checksum_seq_sse2(const void *addr, size_t len, uint64_t csum)
+{
+	const __m128i *p = addr;
+	size_t nblocks = len / CHECKSUM_SSE2_BLOCK;
+
+	__m128i sum0 = _mm_setzero_si128();
+	__m128i sum1 = _mm_setzero_si128();
+	__m128i psum0 = _mm_setzero_si128();
+	__m128i psum1 = _mm_setzero_si128();
+
+	for (size_t i = 0; i < nblocks; ++i) {
+		sum0 = _mm_add_epi32(sum0, _mm_loadu_si128(p));
+		sum1 = _mm_add_epi32(sum1, _mm_loadu_si128(p + 1));
+		psum0 = _mm_add_epi32(psum0, sum0);
+		psum1 = _mm_add_epi32(psum1, sum1);
+		p += 2;
+	}
+
+	if (nblocks != 0) {
+		uint32_t sum[CHECKSUM_SSE2_LANES];
+		uint32_t psum[CHECKSUM_SSE2_LANES];
+
+		_mm_storeu_si128((__m128i *)sum, sum0);
+		_mm_storeu_si128((__m128i *)sum + 1, sum1);
+		_mm_storeu_si128((__m128i *)psum, psum0);
+		_mm_storeu_si128((__m128i *)psum + 1, psum1);
+
+		csum = util_checksum_lanes(csum, sum, psum,
+			CHECKSUM_SSE2_LANES, nblocks * CHECKSUM_SSE2_LANES);
+	}
+
+	return util_checksum_seq_generic(p, len % CHECKSUM_SSE2_BLOCK, csum);
+}
+
+#endif
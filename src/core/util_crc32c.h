@@ -0,0 +1,29 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright 2026, Intel Corporation */
+
+/*
+ * util_crc32c.h -- internal definitions for the implementations of
+ *	the CRC32C checksum
+ */
+
+#ifndef PMDK_UTIL_CRC32C_H
+#define PMDK_UTIL_CRC32C_H 1
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint32_t util_crc32c_generic(uint32_t crc, const void *addr, size_t len);
+
+#if defined(__x86_64__) || defined(__amd64__)
+uint32_t util_crc32c_sse42(uint32_t crc, const void *addr, size_t len);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,214 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2026, Intel Corporation */
+
+/*
+ * util_crc32c_sse42.c -- SSE4.2 implementation of the CRC32C checksum
+ *
+ * A single chain of crc32 instructions is limited by their latency, so
+ * the long buffers are split into three blocks whose checksums are
+ * computed at the same time and then merged. Merging shifts the checksum
+ * of a block over the length of the following one, with the help of tables
+ * computed on first use.
+ */
+
+#ifdef __SSE4_2__
+
+#include <nmmintrin.h>
+
+#include "os_thread.h"
+#include "util_crc32c.h"
+
+/* the reflected CRC32C polynomial */
+#define CRC32C_POLY 0x82f63b78U
+
+/* lengths of the blocks processed three at a time, must be powers of two */
+#define CRC32C_LONG 8192
+#define CRC32C_SHORT 256
+
+/* operators which shift the checksum over the zeros of the block length */
+static uint32_t Crc32c_long[4][256];
+static uint32_t Crc32c_short[4][256];
+
+static os_once_t Crc32c_shift_once = OS_ONCE_INIT;
+
+/*
+ * gf2_matrix_times -- (internal) multiply the vector by the matrix over GF(2)
+ */
+static uint32_t
+gf2_matrix_times(const uint32_t *mat, uint32_t vec)
+{
+	uint32_t sum = 0;
+
+	while (vec) {
+		if (vec & 1)
+			sum ^= *mat;
+		vec >>= 1;
+		mat++;
+	}
+
+	return sum;
+}
+
+/*
+ * gf2_matrix_square -- (internal) square the matrix over GF(2)
+ */
+static void
+gf2_matrix_square(uint32_t *square, const uint32_t *mat)
+{
+	for (unsigned n = 0; n < 32; n++)
+		square[n] = gf2_matrix_times(mat, mat[n]);
+}
+
+/*
+ * crc32c_zeros_op -- (internal) construct the operator which applies len
+ *	zero bytes to the checksum, len must be a power of two
+ */
+static void
+crc32c_zeros_op(uint32_t *even, size_t len)
+{
+	uint32_t odd[32];
+
+	/* the operator for a single zero bit */
+	odd[0] = CRC32C_POLY;
+	uint32_t row = 1;
+	for (unsigned n = 1; n < 32; n++) {
+		odd[n] = row;
+		row <<= 1;
+	}
+
+	/* two zero bits */
+	gf2_matrix_square(even, odd);
+	/* four zero bits */
+	gf2_matrix_square(odd, even);
+
+	/* one zero byte, two zero bytes and so on, until len is reached */
+	do {
+		gf2_matrix_square(even, odd);
+		len >>= 1;
+		if (len == 0)
+			return;
+		gf2_matrix_square(odd, even);
+		len >>= 1;
+	} while (len);
+
+	for (unsigned n = 0; n < 32; n++)
+		even[n] = odd[n];
+}
+
+/*
+ * crc32c_zeros -- (internal) build the byte-wise tables of the operator
+ *	which applies len zero bytes to the checksum
+ */
+static void
+crc32c_zeros(uint32_t zeros[4][256], size_t len)
+{
+	uint32_t op[32];
+
+	crc32c_zeros_op(op, len);
+	for (uint32_t n = 0; n < 256; n++) {
+		zeros[0][n] = gf2_matrix_times(op, n);
+		zeros[1][n] = gf2_matrix_times(op, n << 8);
+		zeros[2][n] = gf2_matrix_times(op, n << 16);
+		zeros[3][n] = gf2_matrix_times(op, n << 24);
+	}
+}
+
+/*
+ * crc32c_shift_init -- (internal) build the tables of the shift operators
+ */
+static void
+crc32c_shift_init(void)
+{
+	crc32c_zeros(Crc32c_long, CRC32C_LONG);
+	crc32c_zeros(Crc32c_short, CRC32C_SHORT);
+}
+
+/*
+ * crc32c_shift -- (internal) shift the checksum using the operator tables
+ */
+static inline uint32_t
+crc32c_shift(uint32_t zeros[4][256], uint32_t crc)
+{
+	return zeros[0][crc & 0xff] ^ zeros[1][(crc >> 8) & 0xff] ^
+		zeros[2][(crc >> 16) & 0xff] ^ zeros[3][crc >> 24];
+}
+
+/*
+ * crc32c_blocks -- (internal) update the checksum with as many triples of
+ *	blocks of the given length as there are in the buffer
+ */
+static inline uint32_t
+crc32c_blocks(uint32_t crc, const unsigned char **next, size_t *len,
+		size_t block, uint32_t zeros[4][256])
+{
+	const unsigned char *p = *next;
+	uint64_t crc0 = crc;
+
+	while (*len >= 3 * block) {
+		uint64_t crc1 = 0;
+		uint64_t crc2 = 0;
+		const unsigned char *end = p + block;
+
+		do {
+			crc0 = _mm_crc32_u64(crc0, *(const uint64_t *)p);
+			crc1 = _mm_crc32_u64(crc1,
+				*(const uint64_t *)(p + block));
+			crc2 = _mm_crc32_u64(crc2,
+				*(const uint64_t *)(p + 2 * block));
+			p += 8;
+		} while (p < end);
+
+		crc0 = crc32c_shift(zeros, (uint32_t)crc0) ^ crc1;
+		crc0 = crc32c_shift(zeros, (uint32_t)crc0) ^ crc2;
+
+		p += 2 * block;
+		*len -= 3 * block;
+	}
+
+	*next = p;
+
+	return (uint32_t)crc0;
+}
+
+/*
+ * util_crc32c_sse42 -- update the raw (not inverted) CRC32C value
+ */
+uint32_t
+util_crc32c_sse42(uint32_t crc, const void *addr, size_t len)
+{
+	const unsigned char *next = addr;
+
+	/* bring the pointer to an eight-byte boundary */
+	while (len && ((uintptr_t)next & 7) != 0) {
+		crc = _mm_crc32_u8(crc, *next);
+		next++;
+		len--;
+	}
+
+	if (len >= 3 * CRC32C_SHORT) {
+		os_once(&Crc32c_shift_once, crc32c_shift_init);
+
+		crc = crc32c_blocks(crc, &next, &len, CRC32C_LONG,
+			Crc32c_long);
+		crc = crc32c_blocks(crc, &next, &len, CRC32C_SHORT,
+			Crc32c_short);
+	}
+
+	uint64_t crc64 = crc;
+	while (len >= 8) {
+		crc64 = _mm_crc32_u64(crc64, *(const uint64_t *)next);
+		next += 8;
+		len -= 8;
+	}
+	crc = (uint32_t)crc64;
+
+	while (len) {
+		crc = _mm_crc32_u8(crc, *next);
+		next++;
+		len--;
+	}
+
+	return crc;
+}
+
+#endif
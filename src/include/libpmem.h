@@ -15,6 +15,7 @@
 #define LIBPMEM_H 1
 
 #include <sys/types.h>
+#include <sys/uio.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -66,16 +67,21 @@ void *pmem_memset_nodrain(void *pmemdest, int c, size_t len);
 
 #define PMEM_F_MEM_NOFLUSH	(1U << 5)
 
+#define PMEM_F_MEM_PARALLEL	(1U << 6)
+
 #define PMEM_F_MEM_VALID_FLAGS (PMEM_F_MEM_NODRAIN | \
 				PMEM_F_MEM_NONTEMPORAL | \
 				PMEM_F_MEM_TEMPORAL | \
 				PMEM_F_MEM_WC | \
 				PMEM_F_MEM_WB | \
-				PMEM_F_MEM_NOFLUSH)
+				PMEM_F_MEM_NOFLUSH | \
+				PMEM_F_MEM_PARALLEL)
 
 void *pmem_memmove(void *pmemdest, const void *src, size_t len, unsigned flags);
 void *pmem_memcpy(void *pmemdest, const void *src, size_t len, unsigned flags);
 void *pmem_memset(void *pmemdest, int c, size_t len, unsigned flags);
+void *pmem_memcpyv(void *pmemdest, const struct iovec *iov, int iovcnt,
+	unsigned flags);
 
 /*
  * PMEM_MAJOR_VERSION and PMEM_MINOR_VERSION provide the current version of the
@@ -16,6 +16,7 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include <sys/uio.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -77,6 +78,9 @@ int pmem2_source_delete(struct pmem2_source **src);
 int pmem2_source_pread_mcsafe(struct pmem2_source *src, void *buf, size_t size,
 	size_t offset);
 
+int pmem2_source_pread_mcsafe_crc32c(struct pmem2_source *src, void *buf,
+	size_t size, size_t offset, uint32_t *crc);
+
 int pmem2_source_pwrite_mcsafe(struct pmem2_source *src, void *buf, size_t size,
 	size_t offset);
 
@@ -171,6 +175,10 @@ size_t pmem2_map_get_size(struct pmem2_map *map);
 
 enum pmem2_granularity pmem2_map_get_store_granularity(struct pmem2_map *map);
 
+size_t pmem2_map_get_movnt_threshold(struct pmem2_map *map);
+
+void pmem2_map_set_movnt_threshold(struct pmem2_map *map, size_t threshold);
+
 /* flushing */
 
 typedef void (*pmem2_persist_fn)(const void *ptr, size_t size);
@@ -185,6 +193,18 @@ pmem2_flush_fn pmem2_get_flush_fn(struct pmem2_map *map);
 
 pmem2_drain_fn pmem2_get_drain_fn(struct pmem2_map *map);
 
+struct pmem2_flush_set;
+
+int pmem2_flush_set_new(struct pmem2_flush_set **fs_ptr,
+	struct pmem2_map *map);
+
+int pmem2_flush_set_delete(struct pmem2_flush_set **fs_ptr);
+
+int pmem2_flush_set_add(struct pmem2_flush_set *fs, const void *ptr,
+	size_t size);
+
+void pmem2_flush_set_commit(struct pmem2_flush_set *fs);
+
 #define PMEM2_F_MEM_NODRAIN	(1U << 0)
 
 #define PMEM2_F_MEM_NONTEMPORAL	(1U << 1)
@@ -195,12 +215,15 @@ pmem2_drain_fn pmem2_get_drain_fn(struct pmem2_map *map);
 
 #define PMEM2_F_MEM_NOFLUSH	(1U << 5)
 
+#define PMEM2_F_MEM_PARALLEL	(1U << 6)
+
 #define PMEM2_F_MEM_VALID_FLAGS (PMEM2_F_MEM_NODRAIN | \
 		PMEM2_F_MEM_NONTEMPORAL | \
 		PMEM2_F_MEM_TEMPORAL | \
 		PMEM2_F_MEM_WC | \
 		PMEM2_F_MEM_WB | \
-		PMEM2_F_MEM_NOFLUSH)
+		PMEM2_F_MEM_NOFLUSH | \
+		PMEM2_F_MEM_PARALLEL)
 
 typedef void *(*pmem2_memmove_fn)(void *pmemdest, const void *src, size_t len,
 	unsigned flags);
@@ -211,12 +234,22 @@ typedef void *(*pmem2_memcpy_fn)(void *pmemdest, const void *src, size_t len,
 typedef void *(*pmem2_memset_fn)(void *pmemdest, int c, size_t len,
 	unsigned flags);
 
+typedef void *(*pmem2_memcpyv_fn)(void *pmemdest, const struct iovec *iov,
+	int iovcnt, unsigned flags);
+
+typedef void *(*pmem2_memcpy_crc32c_fn)(void *pmemdest, const void *src,
+	size_t len, unsigned flags, uint32_t *crc);
+
 pmem2_memmove_fn pmem2_get_memmove_fn(struct pmem2_map *map);
 
 pmem2_memcpy_fn pmem2_get_memcpy_fn(struct pmem2_map *map);
 
 pmem2_memset_fn pmem2_get_memset_fn(struct pmem2_map *map);
 
+pmem2_memcpyv_fn pmem2_get_memcpyv_fn(struct pmem2_map *map);
+
+pmem2_memcpy_crc32c_fn pmem2_get_memcpy_crc32c_fn(struct pmem2_map *map);
+
 /* RAS */
 
 int pmem2_deep_flush(struct pmem2_map *map, void *ptr, size_t size);
@@ -49,6 +49,8 @@ struct pobj_action {
 #define POBJ_ACTION_XRESERVE_VALID_FLAGS\
 	(POBJ_XALLOC_CLASS_MASK |\
 	POBJ_XALLOC_ARENA_MASK |\
+	POBJ_XALLOC_HUGE_ALIGN_2M |\
+	POBJ_XALLOC_HUGE_ALIGN_1G |\
 	POBJ_XALLOC_ZERO)
 
 PMEMoid pmemobj_reserve(PMEMobjpool *pop, struct pobj_action *act,
@@ -61,6 +63,8 @@ void pmemobj_defer_free(PMEMobjpool *pop, PMEMoid oid, struct pobj_action *act);
 
 int pmemobj_publish(PMEMobjpool *pop, struct pobj_action *actv,
 	size_t actvcnt);
+int pmemobj_publish_queued(PMEMobjpool *pop, struct pobj_action *actv,
+	size_t actvcnt);
 int pmemobj_tx_publish(struct pobj_action *actv, size_t actvcnt);
 int pmemobj_tx_xpublish(struct pobj_action *actv, size_t actvcnt,
 		uint64_t flags);
@@ -22,6 +22,8 @@ extern "C" {
  */
 
 #define POBJ_XALLOC_VALID_FLAGS	(POBJ_XALLOC_ZERO |\
+	POBJ_XALLOC_HUGE_ALIGN_2M |\
+	POBJ_XALLOC_HUGE_ALIGN_1G |\
 	POBJ_XALLOC_CLASS_MASK)
 
 /*
@@ -40,6 +42,14 @@ int pmemobj_xalloc(PMEMobjpool *pop, PMEMoid *oidp, size_t size,
 	uint64_t type_num, uint64_t flags,
 	pmemobj_constr constructor, void *arg);
 
+/*
+ * Allocates with flags 'count' new objects of the same size and type
+ * from the pool in a single atomic operation.
+ */
+int pmemobj_xalloc_bulk(PMEMobjpool *pop, PMEMoid *oidv, size_t count,
+	size_t size, uint64_t type_num, uint64_t flags,
+	pmemobj_constr constructor, void *arg);
+
 /*
  * Allocates a new zeroed object from the pool.
  */
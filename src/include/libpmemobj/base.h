@@ -34,6 +34,8 @@ typedef struct pmemobjpool PMEMobjpool;
 #define POBJ_FLAG_NO_SNAPSHOT		(((uint64_t)1) << 2)
 #define POBJ_FLAG_ASSUME_INITIALIZED	(((uint64_t)1) << 3)
 #define POBJ_FLAG_TX_NO_ABORT		(((uint64_t)1) << 4)
+#define POBJ_FLAG_HUGE_ALIGN_2M		(((uint64_t)1) << 5)
+#define POBJ_FLAG_HUGE_ALIGN_1G		(((uint64_t)1) << 6)
 
 #define POBJ_CLASS_ID(id)	(((uint64_t)(id)) << 48)
 #define POBJ_ARENA_ID(id)	(((uint64_t)(id)) << 32)
@@ -43,6 +45,8 @@ typedef struct pmemobjpool PMEMobjpool;
 #define POBJ_XALLOC_ZERO	POBJ_FLAG_ZERO
 #define POBJ_XALLOC_NO_FLUSH	POBJ_FLAG_NO_FLUSH
 #define POBJ_XALLOC_NO_ABORT	POBJ_FLAG_TX_NO_ABORT
+#define POBJ_XALLOC_HUGE_ALIGN_2M	POBJ_FLAG_HUGE_ALIGN_2M
+#define POBJ_XALLOC_HUGE_ALIGN_1G	POBJ_FLAG_HUGE_ALIGN_1G
 
 /*
  * pmemobj_mem* flags
@@ -227,6 +231,12 @@ int pmemobj_xflush(PMEMobjpool *pop, const void *addr, size_t len,
  */
 void pmemobj_drain(PMEMobjpool *pop);
 
+/*
+ * Waits until all the data written to the pool is persistent in all of its
+ * replicas. Only needed with the asynchronous replication.
+ */
+int pmemobj_replica_sync(PMEMobjpool *pop);
+
 /*
  * Version checking.
  */
@@ -144,9 +144,100 @@ enum pobj_stats_enabled {
 	POBJ_STATS_DISABLED,
 };
 
+/*
+ * Latencies of a phase of transactions, read from the stats.tx.latency.*
+ * entry points. All the values are in nanoseconds, and the percentiles are
+ * approximated by the upper bounds of the histogram buckets.
+ */
+struct pobj_tx_latency {
+	uint64_t count;
+	uint64_t total;
+	uint64_t min;
+	uint64_t max;
+	uint64_t p50;
+	uint64_t p90;
+	uint64_t p99;
+	uint64_t p999;
+};
+
+/*
+ * Occupancy of an allocation class, read from
+ * the stats.heap.alloc_class.[class_id].occupancy entry point.
+ *
+ * For the classes of runs, a block is a single unit of the class. For
+ * the class of huge allocations (id 0), a block is a single chunk and the free
+ * blocks are the free chunks of the heap.
+ */
+struct pobj_alloc_class_stats {
+	uint64_t runs; /* number of runs of the class */
+	uint64_t used_blocks;
+	uint64_t free_blocks;
+	unsigned fill_pct; /* percentage of the blocks which are used */
+};
+
+#define POBJ_ZONE_STATS_NBUCKETS 16
+
+/*
+ * Free chunks of a zone, read from the stats.heap.zone.[zone_id].occupancy
+ * entry point. The n-th element of the extents histogram is the number of
+ * contiguous free extents of 2^n to 2^(n+1) - 1 chunks.
+ */
+struct pobj_zone_stats {
+	uint64_t chunks; /* number of chunks in the zone */
+	uint64_t free_chunks;
+	uint64_t free_extents;
+	uint64_t extents[POBJ_ZONE_STATS_NBUCKETS];
+};
+
 enum pobj_arenas_assignment_type {
 	POBJ_ARENAS_ASSIGNMENT_THREAD_KEY,
 	POBJ_ARENAS_ASSIGNMENT_GLOBAL,
+	POBJ_ARENAS_ASSIGNMENT_NUMA,
+};
+
+/*
+ * Containers of the free chunks of the heap, selected by the
+ * heap.huge_container entry point.
+ */
+enum pobj_huge_container_type {
+	POBJ_HUGE_CONTAINER_RAVL,
+	POBJ_HUGE_CONTAINER_CRITNIB,
+};
+
+enum pobj_lane_policy {
+	POBJ_LANE_POLICY_ROUND_ROBIN,
+	POBJ_LANE_POLICY_CPU,
+	POBJ_LANE_POLICY_PINNED,
+};
+
+/*
+ * The maximum number of references to a single object which can be reported
+ * to the background defragmentation.
+ */
+#define POBJ_DEFRAG_MAX_REFS 64
+
+/*
+ * Callbacks of the background defragmentation, started by the
+ * heap.defrag.start entry point.
+ *
+ * For every object found in a sparse run, refs is called to fill the array of
+ * nrefs pointers with the locations of all the persistent references to
+ * the object, and returns the number of references. The references must
+ * reside in the pool and must not be modified by the application until moved
+ * is called for the object. Neither can the object itself be written to or
+ * freed in the meantime, its contents are copied to the new location.
+ * An object for which refs returns 0, more than nrefs or an invalid reference
+ * is not moved. The references are updated atomically with the relocation of
+ * the object, after which moved is called with the new PMEMoid of the object.
+ * moved is called for every object passed to refs, with the new PMEMoid equal
+ * to the old one if the object was not relocated.
+ */
+struct pobj_defrag_callbacks {
+	size_t (*refs)(PMEMobjpool *pop, PMEMoid oid, PMEMoid **refs,
+		size_t nrefs, void *arg);
+	void (*moved)(PMEMobjpool *pop, PMEMoid oid, PMEMoid new_oid,
+		void *arg);
+	void *arg;
 };
 
 /* EXPERIMENTAL */
@@ -101,6 +101,8 @@ typedef void (*pmemobj_tx_callback)(PMEMobjpool *pop, enum pobj_tx_stage stage,
 	POBJ_XALLOC_NO_FLUSH |\
 	POBJ_XALLOC_ARENA_MASK |\
 	POBJ_XALLOC_CLASS_MASK |\
+	POBJ_XALLOC_HUGE_ALIGN_2M |\
+	POBJ_XALLOC_HUGE_ALIGN_1G |\
 	POBJ_XALLOC_NO_ABORT)
 
 #define POBJ_XADD_NO_FLUSH		POBJ_FLAG_NO_FLUSH
@@ -262,6 +264,9 @@ PMEMoid pmemobj_tx_alloc(size_t size, uint64_t type_num);
  *  - POBJ_XALLOC_NO_FLUSH - skip flush on commit
  *  - POBJ_XALLOC_NO_ABORT - if the function does not end successfully,
  *  do not abort the transaction and return the error number.
+ *  - POBJ_XALLOC_HUGE_ALIGN_2M, POBJ_XALLOC_HUGE_ALIGN_1G - align the object
+ *  to 2 megabytes (1 gigabyte) in the pool, if there's a free block of chunks
+ *  which allows it
  *
  * This function must be called during TX_STAGE_WORK.
  */
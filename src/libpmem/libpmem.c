@@ -10,6 +10,7 @@
 
 #include "libpmem.h"
 
+#include "memops_parallel.h"
 #include "pmem.h"
 #include "pmemcommon.h"
 
@@ -39,6 +40,7 @@ libpmem_fini(void)
 {
 	LOG(3, NULL);
 
+	memops_parallel_fini();
 	common_fini();
 }
 
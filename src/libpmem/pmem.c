@@ -143,6 +143,8 @@
 #include <fcntl.h>
 
 #include "libpmem.h"
+#include "memops_parallel.h"
+#include "memops_vector.h"
 #include "pmem.h"
 #include "pmem2_arch.h"
 #include "out.h"
@@ -162,6 +164,9 @@ struct pmem_funcs {
 	flush_func deep_flush;
 	flush_func flush;
 	fence_func fence;
+
+	/* length from which pmem_memcpyv streams all the buffers */
+	size_t movnt_threshold;
 };
 
 static struct pmem_funcs Funcs;
@@ -578,8 +583,14 @@ pmem_memmove(void *pmemdest, const void *src, size_t len, unsigned flags)
 		ERR("invalid flags 0x%x", flags);
 #endif
 	PMEM_API_START();
-	Funcs.memmove_nodrain(pmemdest, src, len, flags & ~PMEM_F_MEM_NODRAIN,
-			Funcs.flush, &Funcs.memmove_funcs);
+	if (flags & PMEM_F_MEM_PARALLEL)
+		memmove_nodrain_parallel(pmemdest, src, len,
+			flags & ~PMEM_F_MEM_NODRAIN, Funcs.flush,
+			&Funcs.memmove_funcs, Funcs.memmove_nodrain);
+	else
+		Funcs.memmove_nodrain(pmemdest, src, len,
+			flags & ~PMEM_F_MEM_NODRAIN, Funcs.flush,
+			&Funcs.memmove_funcs);
 
 	if ((flags & (PMEM_F_MEM_NODRAIN | PMEM_F_MEM_NOFLUSH)) == 0)
 		pmem_drain();
@@ -602,8 +613,14 @@ pmem_memcpy(void *pmemdest, const void *src, size_t len, unsigned flags)
 		ERR("invalid flags 0x%x", flags);
 #endif
 	PMEM_API_START();
-	Funcs.memmove_nodrain(pmemdest, src, len, flags & ~PMEM_F_MEM_NODRAIN,
-			Funcs.flush, &Funcs.memmove_funcs);
+	if (flags & PMEM_F_MEM_PARALLEL)
+		memmove_nodrain_parallel(pmemdest, src, len,
+			flags & ~PMEM_F_MEM_NODRAIN, Funcs.flush,
+			&Funcs.memmove_funcs, Funcs.memmove_nodrain);
+	else
+		Funcs.memmove_nodrain(pmemdest, src, len,
+			flags & ~PMEM_F_MEM_NODRAIN, Funcs.flush,
+			&Funcs.memmove_funcs);
 
 	if ((flags & (PMEM_F_MEM_NODRAIN | PMEM_F_MEM_NOFLUSH)) == 0)
 		pmem_drain();
@@ -627,8 +644,50 @@ pmem_memset(void *pmemdest, int c, size_t len, unsigned flags)
 #endif
 
 	PMEM_API_START();
-	Funcs.memset_nodrain(pmemdest, c, len, flags & ~PMEM_F_MEM_NODRAIN,
-			Funcs.flush, &Funcs.memset_funcs);
+	if (flags & PMEM_F_MEM_PARALLEL)
+		memset_nodrain_parallel(pmemdest, c, len,
+			flags & ~PMEM_F_MEM_NODRAIN, Funcs.flush,
+			&Funcs.memset_funcs, Funcs.memset_nodrain);
+	else
+		Funcs.memset_nodrain(pmemdest, c, len,
+			flags & ~PMEM_F_MEM_NODRAIN, Funcs.flush,
+			&Funcs.memset_funcs);
+
+	if ((flags & (PMEM_F_MEM_NODRAIN | PMEM_F_MEM_NOFLUSH)) == 0)
+		pmem_drain();
+
+	PMEM_API_END();
+	return pmemdest;
+}
+
+/*
+ * pmem_memcpyv -- memcpy of many buffers to pmem
+ */
+void *
+pmem_memcpyv(void *pmemdest, const struct iovec *iov, int iovcnt,
+		unsigned flags)
+{
+	LOG(15, "pmemdest %p iov %p iovcnt %d flags 0x%x",
+			pmemdest, iov, iovcnt, flags);
+
+#ifdef DEBUG
+	if (flags & ~PMEM_F_MEM_VALID_FLAGS)
+		ERR("invalid flags 0x%x", flags);
+#endif
+
+	PMEM_API_START();
+	/*
+	 * The joins are shorter than the threshold, so let the total
+	 * length decide whether they are stored with nontemporal stores.
+	 */
+	if (!(flags & (PMEM_F_MEM_NOFLUSH | PMEM_F_MEM_NONTEMPORAL |
+			PMEM_F_MEM_TEMPORAL | PMEM_F_MEM_WC |
+			PMEM_F_MEM_WB)) &&
+			memcpyv_len(iov, iovcnt) >= Funcs.movnt_threshold)
+		flags |= PMEM_F_MEM_NONTEMPORAL;
+
+	memcpyv_nodrain(pmemdest, iov, iovcnt, flags & ~PMEM_F_MEM_NODRAIN,
+		Funcs.flush, &Funcs.memmove_funcs, Funcs.memmove_nodrain);
 
 	if ((flags & (PMEM_F_MEM_NODRAIN | PMEM_F_MEM_NOFLUSH)) == 0)
 		pmem_drain();
@@ -821,6 +880,9 @@ pmem_init(void)
 	info.flush = NULL;
 	info.fence = NULL;
 	info.flush_has_builtin_fence = 0;
+	info.movnt_threshold = 0;
+	info.movnt_tunable = 0;
+	info.movnt_calibrate = 0;
 
 	pmem2_arch_init(&info);
 
@@ -851,11 +913,14 @@ pmem_init(void)
 			Funcs.fence = fence_empty;
 		else
 			Funcs.fence = info.fence;
+		Funcs.movnt_threshold = info.movnt_tunable ?
+			info.movnt_threshold : SIZE_MAX;
 	} else {
 		Funcs.memmove_nodrain = info.memmove_nodrain_eadr;
 		Funcs.memset_nodrain = info.memset_nodrain_eadr;
 		Funcs.flush = flush_empty;
 		Funcs.fence = info.fence;
+		Funcs.movnt_threshold = SIZE_MAX;
 	}
 
 	char *ptr = os_getenv("PMEM_NO_GENERIC_MEMCPY");
@@ -888,6 +953,8 @@ pmem_init(void)
 	else if (Funcs.flush != Funcs.deep_flush)
 		FATAL("invalid flush function address");
 
+	memops_parallel_init(Funcs.fence);
+
 	pmem_os_init(&Is_pmem);
 }
 
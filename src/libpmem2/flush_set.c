@@ -0,0 +1,259 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2026, Intel Corporation */
+
+/*
+ * flush_set.c -- pmem2_flush_set implementation
+ *
+ * A flush set defers the flushing of the ranges added to it until it is
+ * committed. The ranges are rounded to the flush granularity of the mapping
+ * (a cache line, or a page for the mappings flushed with msync), so
+ * the units modified many times are flushed only once, and then they are
+ * sorted and merged, so each contiguous run of units is flushed with a single
+ * call of the flush function of the mapping, followed by a single drain.
+ *
+ * The mappings with the byte granularity do not need flushing, so nothing is
+ * recorded for them and the commit only drains.
+ *
+ * A flush set is not thread-safe, each thread should use its own one.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "alloc.h"
+#include "libpmem2.h"
+#include "map.h"
+#include "out.h"
+#include "pmem2_utils.h"
+#include "util.h"
+
+/* number of ranges the flush set is created with */
+#define FLUSH_SET_MIN_RANGES 256
+/* number of ranges after which the flush set flushes them early */
+#define FLUSH_SET_MAX_RANGES (64 * 1024)
+
+struct flush_range {
+	uintptr_t start;
+	uintptr_t end;
+};
+
+struct pmem2_flush_set {
+	struct pmem2_map *map;
+	uintptr_t unit; /* size of the units the ranges are rounded to */
+
+	struct flush_range *ranges;
+	size_t nranges;
+	size_t capacity;
+};
+
+/*
+ * pmem2_flush_set_new -- creates an empty flush set for the mapping
+ */
+int
+pmem2_flush_set_new(struct pmem2_flush_set **fs_ptr, struct pmem2_map *map)
+{
+	LOG(3, "fs_ptr %p map %p", fs_ptr, map);
+	PMEM2_ERR_CLR();
+
+	*fs_ptr = NULL;
+
+	int ret;
+	struct pmem2_flush_set *fs = pmem2_malloc(sizeof(*fs), &ret);
+	if (ret)
+		return ret;
+
+	fs->map = map;
+	fs->unit = map->effective_granularity == PMEM2_GRANULARITY_PAGE ?
+		(uintptr_t)Pagesize : CACHELINE_SIZE;
+	fs->nranges = 0;
+	fs->capacity = FLUSH_SET_MIN_RANGES;
+	fs->ranges = NULL;
+
+	if (map->effective_granularity != PMEM2_GRANULARITY_BYTE) {
+		fs->ranges = pmem2_malloc(fs->capacity * sizeof(*fs->ranges),
+			&ret);
+		if (ret) {
+			Free(fs);
+			return ret;
+		}
+	}
+
+	*fs_ptr = fs;
+
+	return 0;
+}
+
+/*
+ * pmem2_flush_set_delete -- deletes the flush set, the ranges which were not
+ *	committed are not flushed
+ */
+int
+pmem2_flush_set_delete(struct pmem2_flush_set **fs_ptr)
+{
+	LOG(3, "fs_ptr %p", fs_ptr);
+	/* we do not need to clear err because this function cannot fail */
+
+	struct pmem2_flush_set *fs = *fs_ptr;
+	if (fs == NULL)
+		return 0;
+
+	Free(fs->ranges);
+	Free(fs);
+	*fs_ptr = NULL;
+
+	return 0;
+}
+
+/*
+ * flush_range_cmp -- (internal) compares the starts of the ranges
+ */
+static int
+flush_range_cmp(const void *lhs, const void *rhs)
+{
+	const struct flush_range *l = lhs;
+	const struct flush_range *r = rhs;
+
+	if (l->start < r->start)
+		return -1;
+	if (l->start > r->start)
+		return 1;
+
+	return 0;
+}
+
+/*
+ * flush_set_compact -- (internal) sorts the ranges and merges the ones which
+ *	overlap or are adjacent to each other
+ */
+static void
+flush_set_compact(struct pmem2_flush_set *fs)
+{
+	if (fs->nranges < 2)
+		return;
+
+	qsort(fs->ranges, fs->nranges, sizeof(*fs->ranges), flush_range_cmp);
+
+	size_t n = 0;
+	for (size_t i = 1; i < fs->nranges; ++i) {
+		struct flush_range *last = &fs->ranges[n];
+		const struct flush_range *r = &fs->ranges[i];
+
+		if (r->start <= last->end) {
+			if (r->end > last->end)
+				last->end = r->end;
+		} else {
+			fs->ranges[++n] = *r;
+		}
+	}
+
+	fs->nranges = n + 1;
+}
+
+/*
+ * flush_set_flush -- (internal) flushes all the recorded ranges and
+ *	empties the flush set
+ */
+static void
+flush_set_flush(struct pmem2_flush_set *fs)
+{
+	flush_set_compact(fs);
+
+	for (size_t i = 0; i < fs->nranges; ++i) {
+		const struct flush_range *r = &fs->ranges[i];
+		fs->map->flush_fn((const void *)r->start, r->end - r->start);
+	}
+
+	fs->nranges = 0;
+}
+
+/*
+ * flush_set_make_room -- (internal) makes room for at least one more range
+ *
+ * The flush set grows until it holds FLUSH_SET_MAX_RANGES ranges. If it
+ * cannot grow, the recorded ranges are flushed early: the commit drains
+ * them along with the rest, so adding a range never fails.
+ */
+static void
+flush_set_make_room(struct pmem2_flush_set *fs)
+{
+	flush_set_compact(fs);
+	if (fs->nranges <= fs->capacity / 2)
+		return;
+
+	if (fs->capacity < FLUSH_SET_MAX_RANGES) {
+		size_t capacity = fs->capacity * 2;
+		struct flush_range *ranges = Realloc(fs->ranges,
+			capacity * sizeof(*ranges));
+
+		if (ranges != NULL) {
+			fs->ranges = ranges;
+			fs->capacity = capacity;
+			return;
+		}
+
+		LOG(4, "cannot grow the flush set %p", fs);
+	}
+
+	flush_set_flush(fs);
+}
+
+/*
+ * pmem2_flush_set_add -- records the range to be flushed by the commit
+ */
+int
+pmem2_flush_set_add(struct pmem2_flush_set *fs, const void *ptr, size_t size)
+{
+	LOG(15, "fs %p ptr %p size %zu", fs, ptr, size);
+	PMEM2_ERR_CLR();
+
+	uintptr_t map_addr = (uintptr_t)fs->map->addr;
+	uintptr_t map_end = map_addr + fs->map->content_length;
+	uintptr_t start = (uintptr_t)ptr;
+	uintptr_t end = start + size;
+
+	if (start < map_addr || end > map_end || end < start) {
+		ERR("flush set range ptr %p size %zu exceeds map range %p",
+			ptr, size, fs->map);
+		return PMEM2_E_LENGTH_OUT_OF_RANGE;
+	}
+
+	if (size == 0 || fs->ranges == NULL)
+		return 0;
+
+	start = start & ~(fs->unit - 1);
+	end = (end + fs->unit - 1) & ~(fs->unit - 1);
+
+	/* the ranges are often added in order or repeated */
+	if (fs->nranges > 0) {
+		struct flush_range *last = &fs->ranges[fs->nranges - 1];
+		if (start <= last->end && end >= last->start) {
+			if (start < last->start)
+				last->start = start;
+			if (end > last->end)
+				last->end = end;
+			return 0;
+		}
+	}
+
+	if (fs->nranges == fs->capacity)
+		flush_set_make_room(fs);
+
+	fs->ranges[fs->nranges].start = start;
+	fs->ranges[fs->nranges].end = end;
+	fs->nranges++;
+
+	return 0;
+}
+
+/*
+ * pmem2_flush_set_commit -- flushes all the recorded ranges in the order of
+ *	their addresses and waits for the flushes to complete
+ */
+void
+pmem2_flush_set_commit(struct pmem2_flush_set *fs)
+{
+	LOG(15, "fs %p", fs);
+
+	flush_set_flush(fs);
+	fs->map->drain_fn();
+}
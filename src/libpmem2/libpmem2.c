@@ -8,6 +8,7 @@
 #include "libpmem2.h"
 
 #include "map.h"
+#include "memops_parallel.h"
 #include "out.h"
 #include "persist.h"
 #include "pmem2.h"
@@ -43,6 +44,7 @@ libpmem2_fini(void)
 {
 	LOG(3, NULL);
 
+	memops_parallel_fini();
 	pmem2_map_fini();
 	out_fini();
 }
@@ -220,6 +220,8 @@ pmem2_unregister_mapping(struct pmem2_map *map)
 
 	util_rwlock_unlock(&State.range_map_lock);
 
+	movnt_threshold_maps_changed();
+
 	return ret;
 }
 
@@ -268,6 +270,7 @@ pmem2_map_from_existing(struct pmem2_map **map_ptr,
 	map->effective_granularity = gran;
 	pmem2_set_flush_fns(map);
 	pmem2_set_mem_fns(map);
+	movnt_threshold_map_init(map);
 	map->source = *src;
 
 	/* XXX: there is no way to set custom vdm in this function */
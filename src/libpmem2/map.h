@@ -13,6 +13,7 @@
 #include "os.h"
 #include "source.h"
 #include "libminiasync/vdm.h"
+#include "movnt_threshold.h"
 #include "vm_reservation.h"
 
 #ifdef __cplusplus
@@ -37,6 +38,12 @@ struct pmem2_map {
 	pmem2_memmove_fn memmove_fn;
 	pmem2_memcpy_fn memcpy_fn;
 	pmem2_memset_fn memset_fn;
+	pmem2_memcpyv_fn memcpyv_fn;
+	pmem2_memcpy_crc32c_fn memcpy_crc32c_fn;
+
+	/* length from which the nontemporal stores are used by default */
+	size_t movnt_threshold;
+	struct movnt_calibration movnt_calib;
 
 	struct pmem2_source source;
 	struct pmem2_vm_reservation *reserv;
@@ -9,6 +9,10 @@
 #include "out.h"
 #include "pmem2_utils.h"
 #include "source.h"
+#include "util.h"
+
+/* size of the chunks read at once when the checksum is computed */
+#define MCSAFE_CRC32C_CHUNK (64 * 1024)
 
 enum mcsafe_op_type {
 	MCSAFE_OP_READ,
@@ -22,10 +26,10 @@ enum mcsafe_op_type {
  */
 static int
 mcsafe_op_none(struct pmem2_source *src, void *buf, size_t size,
-		size_t offset)
+		size_t offset, uint32_t *crc)
 {
 	/* suppress unused parameters */
-	SUPPRESS_UNUSED(src, buf, size, offset);
+	SUPPRESS_UNUSED(src, buf, size, offset, crc);
 
 	ASSERT(0);
 
@@ -33,16 +37,11 @@ mcsafe_op_none(struct pmem2_source *src, void *buf, size_t size,
 }
 
 /*
- * mcsafe_op_reg_read -- safe regular read operation
+ * reg_pread -- (internal) read from the file, report the errors
  */
 static int
-mcsafe_op_reg_read(struct pmem2_source *src, void *buf, size_t size,
-		size_t offset)
+reg_pread(int fd, void *buf, size_t size, size_t offset, size_t *nread)
 {
-	int fd;
-	pmem2_source_get_fd(src, &fd);
-	ASSERT(fd >= 0);
-
 	ssize_t retsize = pread(fd, buf, size, (off_t)offset);
 	if (retsize == -1) {
 		if (errno == EIO) {
@@ -55,16 +54,73 @@ mcsafe_op_reg_read(struct pmem2_source *src, void *buf, size_t size,
 		return PMEM2_E_ERRNO;
 	}
 
+	*nread = (size_t)retsize;
+
+	return 0;
+}
+
+/*
+ * reg_pread_crc32c -- (internal) read from the file in chunks and compute
+ *	the checksum of each one while it is still in the cache
+ */
+static int
+reg_pread_crc32c(int fd, void *buf, size_t size, size_t offset,
+		uint32_t *crc)
+{
+	char *dest = buf;
+
+	while (size > 0) {
+		size_t len = size < MCSAFE_CRC32C_CHUNK ?
+			size : MCSAFE_CRC32C_CHUNK;
+		size_t nread;
+
+		int ret = reg_pread(fd, dest, len, offset, &nread);
+		if (ret)
+			return ret;
+
+		if (nread == 0) {
+			ERR("unexpected end of file at offset %zu", offset);
+			return PMEM2_E_IO_FAIL;
+		}
+
+		*crc = util_crc32c(*crc, dest, nread);
+
+		dest += nread;
+		offset += nread;
+		size -= nread;
+	}
+
 	return 0;
 }
 
+/*
+ * mcsafe_op_reg_read -- safe regular read operation
+ */
+static int
+mcsafe_op_reg_read(struct pmem2_source *src, void *buf, size_t size,
+		size_t offset, uint32_t *crc)
+{
+	int fd;
+	pmem2_source_get_fd(src, &fd);
+	ASSERT(fd >= 0);
+
+	if (crc)
+		return reg_pread_crc32c(fd, buf, size, offset, crc);
+
+	size_t nread;
+	return reg_pread(fd, buf, size, offset, &nread);
+}
+
 /*
  * mcsafe_op_reg_write -- safe regular write operation
  */
 static int
 mcsafe_op_reg_write(struct pmem2_source *src, void *buf, size_t size,
-		size_t offset)
+		size_t offset, uint32_t *crc)
 {
+	/* writes do not compute the checksum */
+	SUPPRESS_UNUSED(crc);
+
 	int fd;
 	pmem2_source_get_fd(src, &fd);
 	ASSERT(fd >= 0);
@@ -106,7 +162,7 @@ signal_handler(int sig)
  * mcsafe_op -- machine safe operation definition
  */
 typedef int (*mcsafe_op)(struct pmem2_source *src, void *buf, size_t size,
-			size_t offset);
+			size_t offset, uint32_t *crc);
 
 /*
  * handle_sigbus_execute_mcsafe_op -- execute provided operation and handle
@@ -114,7 +170,7 @@ typedef int (*mcsafe_op)(struct pmem2_source *src, void *buf, size_t size,
  */
 static int
 handle_sigbus_execute_mcsafe_op(struct pmem2_source *src, void *buf,
-		size_t size, size_t offset, mcsafe_op mcsafe_op)
+		size_t size, size_t offset, uint32_t *crc, mcsafe_op mcsafe_op)
 {
 	int ret;
 
@@ -142,7 +198,7 @@ handle_sigbus_execute_mcsafe_op(struct pmem2_source *src, void *buf,
 	/* set the global jmp pointer to the jmp on stack */
 	Mcsafe_jmp = &mcsafe_jmp_buf;
 
-	ret = mcsafe_op(src, buf, size, offset);
+	ret = mcsafe_op(src, buf, size, offset, crc);
 
 clnup_null_global_jmp:
 	Mcsafe_jmp = NULL;
@@ -160,7 +216,8 @@ clnup_null_global_jmp:
  * devdax_read -- devdax read operation
  */
 static int
-devdax_read(struct pmem2_source *src, void *buf, size_t size, size_t offset)
+devdax_read(struct pmem2_source *src, void *buf, size_t size, size_t offset,
+		uint32_t *crc)
 {
 	int ret;
 	int clnup_ret;
@@ -182,9 +239,17 @@ devdax_read(struct pmem2_source *src, void *buf, size_t size, size_t offset)
 	ASSERTne(map, NULL);
 
 	void *addr = pmem2_map_get_address(map);
-	pmem2_memcpy_fn memcpy_fn = pmem2_get_memcpy_fn(map);
 
-	memcpy_fn(buf, ADDR_SUM(addr, offset), size, 0);
+	if (crc) {
+		pmem2_memcpy_crc32c_fn memcpy_crc32c_fn =
+			pmem2_get_memcpy_crc32c_fn(map);
+
+		memcpy_crc32c_fn(buf, ADDR_SUM(addr, offset), size, 0, crc);
+	} else {
+		pmem2_memcpy_fn memcpy_fn = pmem2_get_memcpy_fn(map);
+
+		memcpy_fn(buf, ADDR_SUM(addr, offset), size, 0);
+	}
 
 	clnup_ret = pmem2_map_delete(&map);
 	ASSERTeq(clnup_ret, 0);
@@ -199,8 +264,12 @@ clnup_cfg_delete:
  * devdax_write -- devdax write operation
  */
 static int
-devdax_write(struct pmem2_source *src, void *buf, size_t size, size_t offset)
+devdax_write(struct pmem2_source *src, void *buf, size_t size, size_t offset,
+		uint32_t *crc)
 {
+	/* writes do not compute the checksum */
+	SUPPRESS_UNUSED(crc);
+
 	int ret;
 	int clnup_ret;
 	struct pmem2_config *cfg;
@@ -239,9 +308,9 @@ clnup_cfg_delete:
  */
 static int
 mcsafe_op_devdax_read(struct pmem2_source *src, void *buf, size_t size,
-		size_t offset)
+		size_t offset, uint32_t *crc)
 {
-	return handle_sigbus_execute_mcsafe_op(src, buf, size, offset,
+	return handle_sigbus_execute_mcsafe_op(src, buf, size, offset, crc,
 			devdax_read);
 }
 
@@ -250,9 +319,9 @@ mcsafe_op_devdax_read(struct pmem2_source *src, void *buf, size_t size,
  */
 static int
 mcsafe_op_devdax_write(struct pmem2_source *src, void *buf, size_t size,
-		size_t offset)
+		size_t offset, uint32_t *crc)
 {
-	return handle_sigbus_execute_mcsafe_op(src, buf, size, offset,
+	return handle_sigbus_execute_mcsafe_op(src, buf, size, offset, crc,
 			devdax_write);
 }
 
@@ -330,7 +399,37 @@ pmem2_source_pread_mcsafe(struct pmem2_source *src, void *buf, size_t size,
 	/* source from directory file can't be created in pmem2 */
 	ASSERTne(ftype, PMEM2_FTYPE_DIR);
 
-	return mcsafe_ops[ftype][MCSAFE_OP_READ](src, buf, size, offset);
+	return mcsafe_ops[ftype][MCSAFE_OP_READ](src, buf, size, offset, NULL);
+}
+
+/*
+ * pmem2_source_pread_mcsafe_crc32c -- read from the source in a safe manner
+ *                                     (detect badblocks) and update the
+ *                                     CRC32C checksum of the read data
+ */
+int
+pmem2_source_pread_mcsafe_crc32c(struct pmem2_source *src, void *buf,
+		size_t size, size_t offset, uint32_t *crc)
+{
+	LOG(3, "source %p buf %p size %zu offset %zu crc %p", src, buf, size,
+			offset, crc);
+	PMEM2_ERR_CLR();
+
+	int ret = pmem2_source_type_check_mcsafe_supp(src);
+	if (ret)
+		return ret;
+
+	ret = pmem2_source_check_op_size(src, size, offset);
+	if (ret)
+		return ret;
+
+	enum pmem2_file_type ftype = src->value.ftype;
+	ASSERT(ftype > 0 && ftype < MAX_PMEM2_FILE_TYPE);
+
+	/* source from directory file can't be created in pmem2 */
+	ASSERTne(ftype, PMEM2_FTYPE_DIR);
+
+	return mcsafe_ops[ftype][MCSAFE_OP_READ](src, buf, size, offset, crc);
 }
 
 /*
@@ -358,5 +457,6 @@ pmem2_source_pwrite_mcsafe(struct pmem2_source *src, void *buf, size_t size,
 	/* source from directory file can't be created in pmem2 */
 	ASSERTne(ftype, PMEM2_FTYPE_DIR);
 
-	return mcsafe_ops[ftype][MCSAFE_OP_WRITE](src, buf, size, offset);
+	return mcsafe_ops[ftype][MCSAFE_OP_WRITE](src, buf, size, offset,
+			NULL);
 }
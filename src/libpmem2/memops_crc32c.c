@@ -0,0 +1,74 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2026, Intel Corporation */
+
+/*
+ * memops_crc32c.c -- memcpy to pmem which computes the CRC32C checksum of
+ *	the copied data
+ *
+ * The source is copied in chunks small enough to stay in the L1 cache.
+ * The checksum of each chunk is computed first, which brings the chunk to
+ * the cache, and then the chunk is copied from there with the memmove
+ * function selected for the platform, so the source is read from the memory
+ * only once and the destination is never read back.
+ *
+ * The chunks are aligned to the destination, so no cache line of pmem is
+ * written partially by one chunk and then again by the next one.
+ */
+
+#include "libpmem2.h"
+#include "memops_crc32c.h"
+#include "out.h"
+#include "util.h"
+
+/* size of the chunks copied at once */
+#define MEMCPY_CRC32C_CHUNK 4096
+
+/* the flags which choose the kind of stores */
+#define MEMCPY_CRC32C_STORE_FLAGS (PMEM2_F_MEM_NOFLUSH |\
+	PMEM2_F_MEM_NONTEMPORAL | PMEM2_F_MEM_TEMPORAL |\
+	PMEM2_F_MEM_WC | PMEM2_F_MEM_WB)
+
+/*
+ * memcpy_crc32c_nodrain -- copies len bytes from src to pmemdest and updates
+ *	*crc with the checksum of the copied data
+ *
+ * The kind of stores, if not chosen by the caller, is chosen once for
+ * the whole copy. The copy is never split between many threads, so
+ * PMEM2_F_MEM_PARALLEL is ignored.
+ */
+void *
+memcpy_crc32c_nodrain(void *pmemdest, const void *src, size_t len,
+		unsigned flags, uint32_t *crc, size_t movnt_threshold,
+		flush_func flush, const struct memmove_nodrain *memmove_funcs,
+		memmove_nodrain_func memmove_nodrain)
+{
+	LOG(15, "pmemdest %p src %p len %zu flags 0x%x crc %p", pmemdest, src,
+			len, flags, crc);
+
+	flags &= ~PMEM2_F_MEM_PARALLEL;
+	if (!(flags & MEMCPY_CRC32C_STORE_FLAGS))
+		flags |= len < movnt_threshold ?
+			PMEM2_F_MEM_TEMPORAL : PMEM2_F_MEM_NONTEMPORAL;
+
+	char *dest = pmemdest;
+	const char *s = src;
+	uint32_t c = *crc;
+
+	while (len > 0) {
+		size_t n = MEMCPY_CRC32C_CHUNK -
+			((uintptr_t)dest & (MEMCPY_CRC32C_CHUNK - 1));
+		if (n > len)
+			n = len;
+
+		c = util_crc32c(c, s, n);
+		memmove_nodrain(dest, s, n, flags, flush, memmove_funcs);
+
+		dest += n;
+		s += n;
+		len -= n;
+	}
+
+	*crc = c;
+
+	return pmemdest;
+}
@@ -0,0 +1,29 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright 2026, Intel Corporation */
+
+/*
+ * memops_crc32c.h -- internal definitions for the memcpy which computes
+ *	the CRC32C checksum of the copied data
+ */
+#ifndef PMEM2_MEMOPS_CRC32C_H
+#define PMEM2_MEMOPS_CRC32C_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pmem2_arch.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void *memcpy_crc32c_nodrain(void *pmemdest, const void *src, size_t len,
+		unsigned flags, uint32_t *crc, size_t movnt_threshold,
+		flush_func flush, const struct memmove_nodrain *memmove_funcs,
+		memmove_nodrain_func memmove_nodrain);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,434 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2026, Intel Corporation */
+
+/*
+ * memops_parallel.c -- mem[move|cpy|set] performed by many threads at once
+ *
+ * A single core cannot saturate the write bandwidth of an interleaved
+ * persistent memory namespace. An operation with the PMEM2_F_MEM_PARALLEL
+ * flag and a long enough range is split into cache line aligned stripes,
+ * which are stored at the same time by the calling thread and the threads
+ * of a worker pool. Each thread drains its own stores before the stripe is
+ * reported as done, so the operation is complete once all of its stripes
+ * are done.
+ *
+ * The worker threads are created by the first parallel operation. Only one
+ * parallel operation runs at a time, the operations started while the pool
+ * is busy are performed by their calling threads alone. A child process does
+ * not inherit the workers, it creates its own ones when needed.
+ */
+
+#include <stdlib.h>
+
+#include "alloc.h"
+#include "libpmem2.h"
+#include "memops_parallel.h"
+#include "os.h"
+#include "os_thread.h"
+#include "out.h"
+#include "sys_util.h"
+#include "util.h"
+
+#define PARALLEL_DEFAULT_THREADS 4
+#define PARALLEL_MAX_THREADS 64
+#define PARALLEL_DEFAULT_THRESHOLD (4 << 20)
+
+enum parallel_op_type {
+	PARALLEL_MEMMOVE,
+	PARALLEL_MEMSET,
+};
+
+struct parallel_op {
+	enum parallel_op_type type;
+	char *dest;
+	const char *src;
+	int c;
+	size_t len;
+	unsigned flags;
+	flush_func flush;
+
+	memmove_nodrain_func memmove_nodrain;
+	const struct memmove_nodrain *memmove_funcs;
+	memset_nodrain_func memset_nodrain;
+	const struct memset_nodrain *memset_funcs;
+
+	size_t nstripes;
+};
+
+static struct {
+	os_mutex_t lock;
+	os_cond_t work; /* signaled when a new operation is started */
+	os_cond_t done; /* signaled when the last stripe is done */
+
+	unsigned nthreads; /* threads per operation, incl. the calling one */
+	size_t threshold; /* minimum length of a parallel operation */
+	fence_func fence;
+
+	os_thread_t *workers;
+	unsigned nworkers; /* number of successfully created workers */
+	int started;
+	int stop;
+
+	int busy; /* an operation is in progress */
+	struct parallel_op op;
+	size_t next; /* next stripe of the operation to be stored */
+	size_t ndone; /* number of stripes already stored and drained */
+} Pool;
+
+/*
+ * parallel_stripe_offset -- (internal) returns the offset of the i-th stripe
+ *	of the operation, aligned to the cache line of the destination
+ */
+static size_t
+parallel_stripe_offset(const struct parallel_op *op, size_t i)
+{
+	if (i == 0)
+		return 0;
+	if (i == op->nstripes)
+		return op->len;
+
+	uintptr_t dest = (uintptr_t)op->dest;
+	uintptr_t off = ALIGN_UP(dest + op->len / op->nstripes * i,
+		CACHELINE_SIZE) - dest;
+
+	return MIN((size_t)off, op->len);
+}
+
+/*
+ * parallel_stripe -- (internal) stores and drains the i-th stripe
+ */
+static void
+parallel_stripe(const struct parallel_op *op, size_t i)
+{
+	size_t off = parallel_stripe_offset(op, i);
+	size_t len = parallel_stripe_offset(op, i + 1) - off;
+
+	if (op->type == PARALLEL_MEMMOVE)
+		op->memmove_nodrain(op->dest + off, op->src + off, len,
+			op->flags, op->flush, op->memmove_funcs);
+	else
+		op->memset_nodrain(op->dest + off, op->c, len,
+			op->flags, op->flush, op->memset_funcs);
+
+	/* the stores of this thread are not drained by the calling one */
+	if (!(op->flags & PMEM2_F_MEM_NOFLUSH))
+		Pool.fence();
+}
+
+/*
+ * parallel_take_stripes -- (internal) stores the stripes of the current
+ *	operation until there are none left, must be called with the lock held
+ */
+static void
+parallel_take_stripes(void)
+{
+	while (Pool.next < Pool.op.nstripes) {
+		size_t i = Pool.next++;
+
+		util_mutex_unlock(&Pool.lock);
+		parallel_stripe(&Pool.op, i);
+		util_mutex_lock(&Pool.lock);
+
+		if (++Pool.ndone == Pool.op.nstripes)
+			os_cond_signal(&Pool.done);
+	}
+}
+
+/*
+ * parallel_worker -- (internal) the main loop of a worker thread
+ */
+static void *
+parallel_worker(void *arg)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(arg);
+
+	util_mutex_lock(&Pool.lock);
+
+	while (!Pool.stop) {
+		if (Pool.next < Pool.op.nstripes)
+			parallel_take_stripes();
+		else
+			os_cond_wait(&Pool.work, &Pool.lock);
+	}
+
+	util_mutex_unlock(&Pool.lock);
+
+	return NULL;
+}
+
+/*
+ * parallel_start -- (internal) creates the worker threads, must be called
+ *	with the lock held
+ *
+ * The calling thread stores the stripes which are not taken by the workers,
+ * so the pool works with any number of them.
+ */
+static void
+parallel_start(void)
+{
+	Pool.started = 1;
+
+	Pool.workers = Malloc(sizeof(*Pool.workers) * (Pool.nthreads - 1));
+	if (Pool.workers == NULL) {
+		LOG(2, "!cannot allocate the parallel workers");
+		return;
+	}
+
+	for (unsigned i = 0; i < Pool.nthreads - 1; ++i) {
+		if (os_thread_create(&Pool.workers[i], NULL,
+				parallel_worker, NULL) != 0) {
+			LOG(2, "!cannot create a parallel worker");
+			break;
+		}
+		Pool.nworkers++;
+	}
+}
+
+/*
+ * parallel_run -- (internal) performs the operation using the worker
+ *	threads, returns -1 if the pool is already busy
+ */
+static int
+parallel_run(const struct parallel_op *op)
+{
+	util_mutex_lock(&Pool.lock);
+
+	if (Pool.busy || Pool.stop) {
+		util_mutex_unlock(&Pool.lock);
+		return -1;
+	}
+
+	if (!Pool.started)
+		parallel_start();
+
+	Pool.busy = 1;
+	Pool.op = *op;
+	Pool.next = 0;
+	Pool.ndone = 0;
+
+	os_cond_broadcast(&Pool.work);
+
+	parallel_take_stripes();
+
+	while (Pool.ndone < Pool.op.nstripes)
+		os_cond_wait(&Pool.done, &Pool.lock);
+
+	Pool.busy = 0;
+
+	util_mutex_unlock(&Pool.lock);
+
+	return 0;
+}
+
+/*
+ * parallel_getenv -- (internal) reads a numeric environment variable
+ */
+static void
+parallel_getenv(const char *name, unsigned long long min,
+		unsigned long long max, unsigned long long *val)
+{
+	const char *ptr = os_getenv(name);
+	if (ptr == NULL)
+		return;
+
+	char *end;
+	unsigned long long v = strtoull(ptr, &end, 10);
+	if (*ptr == '\0' || *end != '\0' || v < min || v > max) {
+		LOG(3, "Invalid %s", name);
+		return;
+	}
+
+	LOG(3, "%s set to %llu", name, v);
+	*val = v;
+}
+
+/*
+ * parallel_atfork_prepare -- (internal) keeps the pool consistent across
+ *	fork by holding its lock
+ */
+static void
+parallel_atfork_prepare(void)
+{
+	util_mutex_lock(&Pool.lock);
+}
+
+/*
+ * parallel_atfork_parent -- (internal) releases the lock in the parent
+ */
+static void
+parallel_atfork_parent(void)
+{
+	util_mutex_unlock(&Pool.lock);
+}
+
+/*
+ * parallel_atfork_child -- (internal) forgets the worker threads of
+ *	the parent
+ *
+ * The workers do not exist in the child, so they must not be waited for.
+ * They are created again by the first parallel operation of the child.
+ * The lock is owned by the thread of the parent and the condition variables
+ * may still count the waiters of the parent, so they are initialized again.
+ */
+static void
+parallel_atfork_child(void)
+{
+	Free(Pool.workers);
+	Pool.workers = NULL;
+	Pool.nworkers = 0;
+	Pool.started = 0;
+
+	Pool.busy = 0;
+	Pool.op.nstripes = 0;
+	Pool.next = 0;
+	Pool.ndone = 0;
+
+	util_mutex_init(&Pool.lock);
+	os_cond_init(&Pool.work);
+	os_cond_init(&Pool.done);
+}
+
+/*
+ * memops_parallel_init -- initializes the parallel operations, fence is
+ *	used by the workers to drain their stores
+ */
+void
+memops_parallel_init(fence_func fence)
+{
+	util_mutex_init(&Pool.lock);
+	os_cond_init(&Pool.work);
+	os_cond_init(&Pool.done);
+
+	unsigned long long nthreads = PARALLEL_DEFAULT_THREADS;
+	parallel_getenv("PMEM_PARALLEL_THREADS", 1, PARALLEL_MAX_THREADS,
+		&nthreads);
+
+	unsigned long long threshold = PARALLEL_DEFAULT_THRESHOLD;
+	parallel_getenv("PMEM_PARALLEL_THRESHOLD", 0, SIZE_MAX, &threshold);
+
+	Pool.nthreads = (unsigned)nthreads;
+	Pool.threshold = (size_t)threshold;
+	Pool.fence = fence;
+
+	if (os_thread_atfork(parallel_atfork_prepare, parallel_atfork_parent,
+			parallel_atfork_child))
+		LOG(2, "!cannot register the parallel pool fork handlers");
+}
+
+/*
+ * memops_parallel_fini -- stops the worker threads
+ */
+void
+memops_parallel_fini(void)
+{
+	util_mutex_lock(&Pool.lock);
+	Pool.stop = 1;
+	os_cond_broadcast(&Pool.work);
+	util_mutex_unlock(&Pool.lock);
+
+	for (unsigned i = 0; i < Pool.nworkers; ++i)
+		os_thread_join(&Pool.workers[i], NULL);
+
+	Free(Pool.workers);
+	Pool.workers = NULL;
+	Pool.nworkers = 0;
+
+	os_cond_destroy(&Pool.done);
+	os_cond_destroy(&Pool.work);
+	util_mutex_destroy(&Pool.lock);
+}
+
+/*
+ * parallel_nstripes -- (internal) returns the number of stripes for
+ *	an operation of the given length, 1 if it's not worth splitting
+ */
+static size_t
+parallel_nstripes(size_t len)
+{
+	if (Pool.nthreads < 2 || len < Pool.threshold ||
+			len < (size_t)Pool.nthreads * CACHELINE_SIZE)
+		return 1;
+
+	return Pool.nthreads;
+}
+
+/*
+ * memmove_nodrain_parallel -- memmove to pmem using the worker threads
+ *
+ * Overlapping ranges are moved by the calling thread alone.
+ */
+void *
+memmove_nodrain_parallel(void *pmemdest, const void *src, size_t len,
+		unsigned flags, flush_func flush,
+		const struct memmove_nodrain *memmove_funcs,
+		memmove_nodrain_func memmove_nodrain)
+{
+	LOG(15, "pmemdest %p src %p len %zu flags 0x%x", pmemdest, src, len,
+			flags);
+
+	flags &= ~PMEM2_F_MEM_PARALLEL;
+
+	int overlap = (const char *)pmemdest < (const char *)src + len &&
+		(const char *)src < (const char *)pmemdest + len;
+
+	struct parallel_op op;
+	op.nstripes = parallel_nstripes(len);
+
+	if (op.nstripes > 1 && !overlap) {
+		op.type = PARALLEL_MEMMOVE;
+		op.dest = pmemdest;
+		op.src = src;
+		op.c = 0;
+		op.len = len;
+		op.flags = flags;
+		op.flush = flush;
+		op.memmove_nodrain = memmove_nodrain;
+		op.memmove_funcs = memmove_funcs;
+		op.memset_nodrain = NULL;
+		op.memset_funcs = NULL;
+
+		if (parallel_run(&op) == 0)
+			return pmemdest;
+	}
+
+	return memmove_nodrain(pmemdest, src, len, flags, flush,
+		memmove_funcs);
+}
+
+/*
+ * memset_nodrain_parallel -- memset to pmem using the worker threads
+ */
+void *
+memset_nodrain_parallel(void *pmemdest, int c, size_t len,
+		unsigned flags, flush_func flush,
+		const struct memset_nodrain *memset_funcs,
+		memset_nodrain_func memset_nodrain)
+{
+	LOG(15, "pmemdest %p c 0x%x len %zu flags 0x%x", pmemdest, c, len,
+			flags);
+
+	flags &= ~PMEM2_F_MEM_PARALLEL;
+
+	struct parallel_op op;
+	op.nstripes = parallel_nstripes(len);
+
+	if (op.nstripes > 1) {
+		op.type = PARALLEL_MEMSET;
+		op.dest = pmemdest;
+		op.src = NULL;
+		op.c = c;
+		op.len = len;
+		op.flags = flags;
+		op.flush = flush;
+		op.memmove_nodrain = NULL;
+		op.memmove_funcs = NULL;
+		op.memset_nodrain = memset_nodrain;
+		op.memset_funcs = memset_funcs;
+
+		if (parallel_run(&op) == 0)
+			return pmemdest;
+	}
+
+	return memset_nodrain(pmemdest, c, len, flags, flush, memset_funcs);
+}
@@ -0,0 +1,35 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright 2026, Intel Corporation */
+
+/*
+ * memops_parallel.h -- internal definitions for the mem[move|cpy|set]
+ *	performed by many threads at once
+ */
+#ifndef PMEM2_MEMOPS_PARALLEL_H
+#define PMEM2_MEMOPS_PARALLEL_H
+
+#include <stddef.h>
+
+#include "pmem2_arch.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void memops_parallel_init(fence_func fence);
+void memops_parallel_fini(void);
+
+void *memmove_nodrain_parallel(void *pmemdest, const void *src, size_t len,
+		unsigned flags, flush_func flush,
+		const struct memmove_nodrain *memmove_funcs,
+		memmove_nodrain_func memmove_nodrain);
+void *memset_nodrain_parallel(void *pmemdest, int c, size_t len,
+		unsigned flags, flush_func flush,
+		const struct memset_nodrain *memset_funcs,
+		memset_nodrain_func memset_nodrain);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
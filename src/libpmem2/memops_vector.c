@@ -0,0 +1,125 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2026, Intel Corporation */
+
+/*
+ * memops_vector.c -- memcpy of many buffers to a contiguous range of pmem
+ *
+ * The buffers are copied one after another, each with a single call of
+ * the memmove function, so the long ones are streamed with nontemporal
+ * stores. A cache line of the destination to which more than one buffer is
+ * copied (a join) is first gathered in a temporary buffer and then stored
+ * at once, so no line is written partially by one buffer and then again
+ * by the next one.
+ */
+
+#include <string.h>
+
+#include "libpmem2.h"
+#include "memops_parallel.h"
+#include "memops_vector.h"
+#include "out.h"
+#include "util.h"
+
+/*
+ * memcpyv_len -- returns the total length of the buffers
+ */
+size_t
+memcpyv_len(const struct iovec *iov, int iovcnt)
+{
+	size_t len = 0;
+	for (int i = 0; i < iovcnt; ++i)
+		len += iov[i].iov_len;
+
+	return len;
+}
+
+/*
+ * memcpyv_gather -- (internal) copies up to size bytes of the buffers,
+ *	starting from the offset off of the i-th one, to buf and advances
+ *	the position, returns the number of bytes copied
+ */
+static size_t
+memcpyv_gather(char *buf, size_t size, const struct iovec *iov, int iovcnt,
+		int *i, size_t *off)
+{
+	size_t len = 0;
+
+	while (len < size && *i < iovcnt) {
+		size_t n = MIN(size - len, iov[*i].iov_len - *off);
+		memcpy(buf + len, (const char *)iov[*i].iov_base + *off, n);
+		len += n;
+		*off += n;
+
+		if (*off == iov[*i].iov_len) {
+			(*i)++;
+			*off = 0;
+		}
+	}
+
+	return len;
+}
+
+/*
+ * memcpyv_nodrain -- copies the buffers one after another to pmemdest
+ */
+void *
+memcpyv_nodrain(void *pmemdest, const struct iovec *iov, int iovcnt,
+		unsigned flags, flush_func flush,
+		const struct memmove_nodrain *memmove_funcs,
+		memmove_nodrain_func memmove_nodrain)
+{
+	LOG(15, "pmemdest %p iov %p iovcnt %d flags 0x%x", pmemdest, iov,
+			iovcnt, flags);
+
+	char line[CACHELINE_SIZE];
+	char *dest = pmemdest;
+	int i = 0;
+	size_t off = 0; /* offset in the i-th buffer */
+
+	while (1) {
+		/* skip the copied and the empty buffers */
+		while (i < iovcnt && off == iov[i].iov_len) {
+			++i;
+			off = 0;
+		}
+
+		if (i == iovcnt)
+			break;
+
+		const char *src = (const char *)iov[i].iov_base + off;
+		size_t avail = iov[i].iov_len - off;
+		size_t line_left = CACHELINE_SIZE -
+			((uintptr_t)dest & (CACHELINE_SIZE - 1));
+		size_t len;
+
+		if (avail >= line_left) {
+			/*
+			 * the rest of the current line and all the whole lines
+			 * which follow it come from this buffer
+			 */
+			len = line_left + ALIGN_DOWN(avail - line_left,
+				CACHELINE_SIZE);
+
+			if (flags & PMEM2_F_MEM_PARALLEL)
+				memmove_nodrain_parallel(dest, src, len, flags,
+					flush, memmove_funcs, memmove_nodrain);
+			else
+				memmove_nodrain(dest, src, len, flags, flush,
+					memmove_funcs);
+
+			off += len;
+		} else {
+			/* a join, the line comes from many buffers */
+			len = memcpyv_gather(line, line_left, iov, iovcnt,
+				&i, &off);
+
+			memmove_nodrain(dest, line, len,
+				flags & ~PMEM2_F_MEM_PARALLEL, flush,
+				memmove_funcs);
+		}
+
+		dest += len;
+	}
+
+	return pmemdest;
+}
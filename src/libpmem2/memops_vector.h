@@ -0,0 +1,30 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright 2026, Intel Corporation */
+
+/*
+ * memops_vector.h -- internal definitions for the scatter-gather memcpy
+ */
+#ifndef PMEM2_MEMOPS_VECTOR_H
+#define PMEM2_MEMOPS_VECTOR_H
+
+#include <stddef.h>
+#include <sys/uio.h>
+
+#include "pmem2_arch.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+size_t memcpyv_len(const struct iovec *iov, int iovcnt);
+
+void *memcpyv_nodrain(void *pmemdest, const struct iovec *iov, int iovcnt,
+		unsigned flags, flush_func flush,
+		const struct memmove_nodrain *memmove_funcs,
+		memmove_nodrain_func memmove_nodrain);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
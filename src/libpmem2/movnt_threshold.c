@@ -0,0 +1,410 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2026, Intel Corporation */
+
+/*
+ * movnt_threshold.c -- per mapping choice between temporal and nontemporal
+ *	stores
+ *
+ * Unless the caller forces the kind of stores with a flag, mem[move|cpy|set]
+ * uses the nontemporal ones for operations not shorter than the movnt
+ * threshold of the mapping. The best threshold depends on the platform
+ * (eADR, ADR or DRAM behind the mapping) and on the CPU, so it is calibrated
+ * by the first operations performed on each mapping: they are split by
+ * the kind of operation and into power of two length buckets, and within
+ * each bucket alternately use temporal and nontemporal stores. Once enough
+ * operations are measured, the threshold is set to the shortest length from
+ * which the nontemporal stores are faster for all the measured kinds of
+ * operations. The calibrating operations store the data asked for by
+ * the user, so the only cost of the calibration is a clock read per
+ * operation.
+ *
+ * The functions don't get the mapping they write to, so it is looked up
+ * by the destination address. Each thread caches the last few mappings it
+ * wrote to, along with their thresholds once the calibration is over, so
+ * that the lookup under the lock of the mappings registry is done only when
+ * the thread starts writing to another mapping or when a mapping is deleted
+ * or its threshold is overridden. Writes to the addresses outside of any
+ * mapping miss the cache and take the lock on every call.
+ */
+
+#include <string.h>
+
+#include "libpmem2.h"
+#include "map.h"
+#include "movnt_threshold.h"
+#include "os.h"
+#include "out.h"
+#include "util.h"
+
+/* number of operations measured before the threshold is chosen */
+#define MOVNT_CALIBRATION_SAMPLES 512
+/* buckets with less samples of either kind of stores are not considered */
+#define MOVNT_BUCKET_MIN_SAMPLES 4
+/* number of mappings cached by each thread */
+#define MOVNT_CACHED_MAPS 4
+
+#define MOVNT_FLAGS (PMEM2_F_MEM_NOFLUSH | PMEM2_F_MEM_NONTEMPORAL |\
+	PMEM2_F_MEM_TEMPORAL | PMEM2_F_MEM_WC | PMEM2_F_MEM_WB)
+
+static struct {
+	size_t threshold; /* default threshold of the pmem mappings */
+	int tunable; /* the kind of stores depends on the threshold */
+	int calibrate; /* new mappings calibrate their thresholds */
+	/* changed when a mapping is unregistered or its threshold overridden */
+	uint64_t maps_gen;
+} Movnt;
+
+/*
+ * movnt_cached_map -- a mapping recently written to by the thread
+ *
+ * The address range is copied, so that it can be checked without touching
+ * the mapping, which might have been deleted since it was cached.
+ */
+struct movnt_cached_map {
+	char *addr;
+	size_t len;
+	struct pmem2_map *map;
+	int final; /* the threshold is known, the mapping is not needed */
+	size_t threshold;
+};
+
+/* the mappings recently written to by this thread */
+static __thread struct {
+	uint64_t maps_gen; /* the entries are valid only in this generation */
+	unsigned next; /* the entry to be replaced */
+	struct movnt_cached_map maps[MOVNT_CACHED_MAPS];
+} Map_cache;
+
+/*
+ * movnt_threshold_init -- initializes the per mapping movnt thresholds
+ */
+void
+movnt_threshold_init(const struct pmem2_arch_info *info)
+{
+	Movnt.threshold = info->movnt_threshold;
+	Movnt.tunable = info->movnt_tunable;
+	Movnt.calibrate = info->movnt_calibrate;
+
+	char *ptr = os_getenv("PMEM_MOVNT_CALIBRATE");
+	if (ptr) {
+		if (strcmp(ptr, "1") == 0) {
+			LOG(3, "movnt calibration forced to 1");
+			Movnt.calibrate = Movnt.tunable;
+		} else if (strcmp(ptr, "0") == 0) {
+			LOG(3, "movnt calibration forced to 0");
+			Movnt.calibrate = 0;
+		} else {
+			LOG(3, "incorrect value of PMEM_MOVNT_CALIBRATE (%s)",
+				ptr);
+		}
+	}
+	LOG(3, "movnt calibration = %d", Movnt.calibrate);
+}
+
+/*
+ * movnt_threshold_map_init -- sets the initial movnt threshold of the mapping
+ *
+ * Mappings with the byte granularity don't need to flush the caches, so
+ * they keep using the temporal stores unless calibrated otherwise.
+ */
+void
+movnt_threshold_map_init(struct pmem2_map *map)
+{
+	if (!Movnt.tunable ||
+			map->effective_granularity == PMEM2_GRANULARITY_BYTE)
+		map->movnt_threshold = SIZE_MAX;
+	else
+		map->movnt_threshold = Movnt.threshold;
+
+	memset(&map->movnt_calib, 0, sizeof(map->movnt_calib));
+	map->movnt_calib.state = Movnt.calibrate ?
+		MOVNT_CALIBRATING : MOVNT_CALIBRATED;
+}
+
+/*
+ * movnt_threshold_maps_changed -- invalidates the cached mapping lookups,
+ *	must be called when a mapping is unregistered or its threshold changes
+ */
+void
+movnt_threshold_maps_changed(void)
+{
+	util_fetch_and_add64(&Movnt.maps_gen, 1);
+}
+
+/*
+ * movnt_find_map -- (internal) returns the cache entry of the mapping
+ *	containing pmemdest, or NULL if there is no such mapping
+ */
+static struct movnt_cached_map *
+movnt_find_map(void *pmemdest)
+{
+	/*
+	 * The generation is read before the cached entries are used, so
+	 * an entry of a mapping unregistered before this call is never used.
+	 */
+	uint64_t gen;
+	util_atomic_load_explicit64(&Movnt.maps_gen, &gen,
+		memory_order_acquire);
+
+	if (Map_cache.maps_gen != gen) {
+		memset(&Map_cache, 0, sizeof(Map_cache));
+		Map_cache.maps_gen = gen;
+	}
+
+	char *dest = pmemdest;
+	for (unsigned i = 0; i < MOVNT_CACHED_MAPS; ++i) {
+		struct movnt_cached_map *c = &Map_cache.maps[i];
+		if (dest >= c->addr && dest < c->addr + c->len)
+			return c;
+	}
+
+	struct pmem2_map *map = pmem2_map_find(pmemdest, 1);
+	if (map == NULL || dest < (char *)map->addr)
+		return NULL;
+
+	struct movnt_cached_map *c = &Map_cache.maps[Map_cache.next];
+	Map_cache.next = (Map_cache.next + 1) % MOVNT_CACHED_MAPS;
+
+	c->addr = map->addr;
+	c->len = map->content_length;
+	c->map = map;
+	c->final = 0;
+
+	return c;
+}
+
+/*
+ * movnt_bucket -- (internal) returns the calibration bucket of the length
+ */
+static unsigned
+movnt_bucket(size_t len)
+{
+	unsigned shift = util_mssb_index64(len);
+	if (shift < MOVNT_BUCKET_MIN_SHIFT)
+		shift = MOVNT_BUCKET_MIN_SHIFT;
+	if (shift > MOVNT_BUCKET_MAX_SHIFT)
+		shift = MOVNT_BUCKET_MAX_SHIFT;
+
+	return shift - MOVNT_BUCKET_MIN_SHIFT;
+}
+
+/*
+ * movnt_bucket_min -- (internal) returns the shortest length of the bucket
+ */
+static size_t
+movnt_bucket_min(unsigned bucket)
+{
+	return bucket == 0 ? 0 : 1ULL << (MOVNT_BUCKET_MIN_SHIFT + bucket);
+}
+
+/*
+ * movnt_choose -- returns the flags with the kind of stores chosen for
+ *	the operation, starts the probe if the operation is to be measured
+ */
+unsigned
+movnt_choose(void *pmemdest, size_t len, unsigned flags, enum movnt_op op,
+		struct movnt_probe *probe)
+{
+	probe->map = NULL;
+
+	/* the caller has already chosen */
+	if (!Movnt.tunable || len == 0 || (flags & MOVNT_FLAGS))
+		return flags;
+
+	struct movnt_cached_map *c = movnt_find_map(pmemdest);
+	if (c == NULL)
+		return flags;
+
+	if (c->final)
+		return flags | (len < c->threshold ?
+			PMEM2_F_MEM_TEMPORAL : PMEM2_F_MEM_NONTEMPORAL);
+
+	struct pmem2_map *map = c->map;
+	int state;
+	util_atomic_load_explicit32(&map->movnt_calib.state, &state,
+		memory_order_acquire);
+
+	if (state == MOVNT_CALIBRATING) {
+		unsigned bucket = movnt_bucket(len);
+		struct movnt_bucket *b = &map->movnt_calib.buckets[op][bucket];
+
+		probe->map = map;
+		probe->len = len;
+		probe->op = op;
+		probe->bucket = bucket;
+		probe->nt = (unsigned)(util_fetch_and_add64(&b->calls, 1) & 1);
+		os_clock_gettime(CLOCK_MONOTONIC, &probe->start);
+
+		return flags | (probe->nt ?
+			PMEM2_F_MEM_NONTEMPORAL : PMEM2_F_MEM_TEMPORAL);
+	}
+
+	size_t threshold;
+	util_atomic_load_explicit64(&map->movnt_threshold, &threshold,
+		memory_order_relaxed);
+
+	/* the threshold changes from now on only with the generation */
+	if (state != MOVNT_FINISHING) {
+		c->threshold = threshold;
+		c->final = 1;
+	}
+
+	return flags | (len < threshold ?
+		PMEM2_F_MEM_TEMPORAL : PMEM2_F_MEM_NONTEMPORAL);
+}
+
+/*
+ * movnt_cost_min -- (internal) atomically lowers the cost to val
+ */
+static void
+movnt_cost_min(uint64_t *cost, uint64_t val)
+{
+	uint64_t cur;
+	util_atomic_load64(cost, &cur);
+
+	while ((cur == 0 || val < cur) &&
+			!util_bool_compare_and_swap64(cost, cur, val))
+		util_atomic_load64(cost, &cur);
+}
+
+/*
+ * movnt_calibrated_threshold -- (internal) returns the shortest length from
+ *	which the nontemporal stores were faster in all the measured buckets,
+ *	for all the kinds of operations measured in each of them
+ *
+ * Lengths longer than the measured ones keep the old threshold, unless
+ * the nontemporal stores were faster for the longest measured length.
+ */
+static size_t
+movnt_calibrated_threshold(const struct movnt_calibration *calib,
+		size_t threshold)
+{
+	size_t calibrated = SIZE_MAX;
+	int longest = -1;
+
+	for (int i = MOVNT_NBUCKETS - 1; i >= 0; --i) {
+		int measured = 0;
+		int nt_faster = 1;
+
+		for (unsigned op = 0; op < MAX_MOVNT_OP; ++op) {
+			const struct movnt_bucket *b = &calib->buckets[op][i];
+			if (b->nsamples[0] < MOVNT_BUCKET_MIN_SAMPLES ||
+				b->nsamples[1] < MOVNT_BUCKET_MIN_SAMPLES)
+				continue;
+
+			measured = 1;
+			if (b->cost[1] > b->cost[0])
+				nt_faster = 0;
+		}
+
+		if (!measured)
+			continue;
+
+		if (longest < 0)
+			longest = i;
+
+		if (!nt_faster)
+			break;
+
+		calibrated = movnt_bucket_min((unsigned)i);
+	}
+
+	if (longest < 0)
+		return threshold;
+
+	if (calibrated == SIZE_MAX && longest < MOVNT_NBUCKETS - 1)
+		calibrated = MAX(threshold,
+			movnt_bucket_min((unsigned)longest + 1));
+
+	return calibrated;
+}
+
+/*
+ * movnt_calibration_finish -- (internal) sets the calibrated threshold
+ *	of the mapping, unless it was overridden in the meantime
+ */
+static void
+movnt_calibration_finish(struct pmem2_map *map)
+{
+	struct movnt_calibration *calib = &map->movnt_calib;
+
+	if (!util_bool_compare_and_swap32(&calib->state,
+			MOVNT_CALIBRATING, MOVNT_FINISHING))
+		return;
+
+	size_t threshold = movnt_calibrated_threshold(calib,
+		map->movnt_threshold);
+	LOG(3, "map %p movnt threshold calibrated to %zu", map, threshold);
+
+	util_atomic_store64(&map->movnt_threshold, threshold);
+	util_atomic_store32(&calib->state, MOVNT_CALIBRATED);
+}
+
+/*
+ * movnt_probe_end -- records the time of the measured operation
+ */
+void
+movnt_probe_end(struct movnt_probe *probe)
+{
+	if (probe->map == NULL)
+		return;
+
+	struct timespec end;
+	os_clock_gettime(CLOCK_MONOTONIC, &end);
+
+	uint64_t ns = (uint64_t)(end.tv_sec - probe->start.tv_sec) *
+		1000000000ULL + (uint64_t)end.tv_nsec -
+		(uint64_t)probe->start.tv_nsec;
+	uint64_t cost = MAX(ns * 4096 / probe->len, 1);
+
+	struct movnt_calibration *calib = &probe->map->movnt_calib;
+	struct movnt_bucket *b = &calib->buckets[probe->op][probe->bucket];
+
+	movnt_cost_min(&b->cost[probe->nt], cost);
+	util_fetch_and_add64(&b->nsamples[probe->nt], 1);
+
+	if (util_fetch_and_add64(&calib->nsamples, 1) + 1 ==
+			MOVNT_CALIBRATION_SAMPLES)
+		movnt_calibration_finish(probe->map);
+}
+
+/*
+ * pmem2_map_get_movnt_threshold -- returns the length from which
+ *	the nontemporal stores are used by default
+ */
+size_t
+pmem2_map_get_movnt_threshold(struct pmem2_map *map)
+{
+	LOG(3, "map %p", map);
+
+	/* we do not need to clear err because this function cannot fail */
+	size_t threshold;
+	util_atomic_load64(&map->movnt_threshold, &threshold);
+
+	return threshold;
+}
+
+/*
+ * pmem2_map_set_movnt_threshold -- overrides the length from which
+ *	the nontemporal stores are used by default, stops the calibration
+ */
+void
+pmem2_map_set_movnt_threshold(struct pmem2_map *map, size_t threshold)
+{
+	LOG(3, "map %p threshold %zu", map, threshold);
+
+	/* we do not need to clear err because this function cannot fail */
+	struct movnt_calibration *calib = &map->movnt_calib;
+	int state;
+
+	do {
+		util_atomic_load32(&calib->state, &state);
+	} while (state == MOVNT_FINISHING ||
+		!util_bool_compare_and_swap32(&calib->state, state,
+			MOVNT_OVERRIDDEN));
+
+	util_atomic_store64(&map->movnt_threshold, threshold);
+
+	/* the threads might have cached the previous threshold */
+	movnt_threshold_maps_changed();
+}
@@ -0,0 +1,86 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright 2026, Intel Corporation */
+
+/*
+ * movnt_threshold.h -- internal definitions for the per mapping choice
+ *	between temporal and nontemporal stores
+ */
+#ifndef PMEM2_MOVNT_THRESHOLD_H
+#define PMEM2_MOVNT_THRESHOLD_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "libpmem2.h"
+#include "pmem2_arch.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * lengths are sampled in power of two buckets, the first one holds
+ * everything shorter than 2^(MOVNT_BUCKET_MIN_SHIFT + 1) bytes and
+ * the last one everything longer than 2^(MOVNT_BUCKET_MAX_SHIFT) bytes
+ */
+#define MOVNT_BUCKET_MIN_SHIFT 6
+#define MOVNT_BUCKET_MAX_SHIFT 21
+#define MOVNT_NBUCKETS (MOVNT_BUCKET_MAX_SHIFT - MOVNT_BUCKET_MIN_SHIFT + 1)
+
+/*
+ * kinds of operations, calibrated separately because their costs differ
+ */
+enum movnt_op {
+	MOVNT_OP_MEMMOVE, /* also memcpy */
+	MOVNT_OP_MEMSET,
+	MOVNT_OP_MEMCPYV,
+	MOVNT_OP_MEMCPY_CRC32C,
+
+	MAX_MOVNT_OP
+};
+
+enum movnt_calibration_state {
+	MOVNT_CALIBRATING,
+	MOVNT_FINISHING, /* the threshold is being stored */
+	MOVNT_CALIBRATED,
+	MOVNT_OVERRIDDEN,
+};
+
+struct movnt_bucket {
+	uint64_t calls;
+	uint64_t nsamples[2]; /* temporal, nontemporal */
+	uint64_t cost[2]; /* the lowest time (ns) per 4 KiB, 0 if unknown */
+};
+
+struct movnt_calibration {
+	int state;
+	uint64_t nsamples;
+	struct movnt_bucket buckets[MAX_MOVNT_OP][MOVNT_NBUCKETS];
+};
+
+/*
+ * movnt_probe -- a single operation measured during the calibration
+ */
+struct movnt_probe {
+	struct pmem2_map *map; /* NULL if the operation is not measured */
+	size_t len;
+	unsigned op;
+	unsigned bucket;
+	unsigned nt;
+	struct timespec start;
+};
+
+void movnt_threshold_init(const struct pmem2_arch_info *info);
+void movnt_threshold_map_init(struct pmem2_map *map);
+void movnt_threshold_maps_changed(void);
+
+unsigned movnt_choose(void *pmemdest, size_t len, unsigned flags,
+		enum movnt_op op, struct movnt_probe *probe);
+void movnt_probe_end(struct movnt_probe *probe);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -11,6 +11,10 @@
 #include "libpmem2.h"
 #include "libpmem2/base.h"
 #include "map.h"
+#include "memops_crc32c.h"
+#include "memops_parallel.h"
+#include "memops_vector.h"
+#include "movnt_threshold.h"
 #include "out.h"
 #include "os.h"
 #include "persist.h"
@@ -83,6 +87,9 @@ pmem2_persist_init(void)
 	Info.flush = NULL;
 	Info.fence = NULL;
 	Info.flush_has_builtin_fence = 0;
+	Info.movnt_threshold = 0;
+	Info.movnt_tunable = 0;
+	Info.movnt_calibrate = 0;
 
 	pmem2_arch_init(&Info);
 
@@ -114,6 +121,9 @@ pmem2_persist_init(void)
 			LOG(3, "using generic memset");
 		}
 	}
+
+	memops_parallel_init(Info.fence);
+	movnt_threshold_init(&Info);
 }
 
 /*
@@ -439,9 +449,19 @@ pmem2_memmove_nonpmem(void *pmemdest, const void *src, size_t len,
 		ERR("invalid flags 0x%x", flags);
 #endif
 	PMEM2_API_START("pmem2_memmove");
-	Info.memmove_nodrain(pmemdest, src, len,
-		flags & ~PMEM2_F_MEM_NODRAIN,
-		Info.flush, &Info.memmove_funcs);
+	struct movnt_probe probe;
+	flags = movnt_choose(pmemdest, len, flags,
+		MOVNT_OP_MEMMOVE, &probe);
+
+	if (flags & PMEM2_F_MEM_PARALLEL)
+		memmove_nodrain_parallel(pmemdest, src, len,
+			flags & ~PMEM2_F_MEM_NODRAIN,
+			Info.flush, &Info.memmove_funcs, Info.memmove_nodrain);
+	else
+		Info.memmove_nodrain(pmemdest, src, len,
+			flags & ~PMEM2_F_MEM_NODRAIN,
+			Info.flush, &Info.memmove_funcs);
+	movnt_probe_end(&probe);
 
 	if (!(flags & PMEM2_F_MEM_NOFLUSH))
 		pmem2_persist_pages(pmemdest, len);
@@ -461,9 +481,19 @@ pmem2_memset_nonpmem(void *pmemdest, int c, size_t len, unsigned flags)
 		ERR("invalid flags 0x%x", flags);
 #endif
 	PMEM2_API_START("pmem2_memset");
-	Info.memset_nodrain(pmemdest, c, len,
-		flags & ~PMEM2_F_MEM_NODRAIN,
-		Info.flush, &Info.memset_funcs);
+	struct movnt_probe probe;
+	flags = movnt_choose(pmemdest, len, flags,
+		MOVNT_OP_MEMSET, &probe);
+
+	if (flags & PMEM2_F_MEM_PARALLEL)
+		memset_nodrain_parallel(pmemdest, c, len,
+			flags & ~PMEM2_F_MEM_NODRAIN,
+			Info.flush, &Info.memset_funcs, Info.memset_nodrain);
+	else
+		Info.memset_nodrain(pmemdest, c, len,
+			flags & ~PMEM2_F_MEM_NODRAIN,
+			Info.flush, &Info.memset_funcs);
+	movnt_probe_end(&probe);
 
 	if (!(flags & PMEM2_F_MEM_NOFLUSH))
 		pmem2_persist_pages(pmemdest, len);
@@ -472,6 +502,63 @@ pmem2_memset_nonpmem(void *pmemdest, int c, size_t len, unsigned flags)
 	return pmemdest;
 }
 
+/*
+ * pmem2_memcpyv_nonpmem -- memcpy of many buffers followed by an msync
+ */
+static void *
+pmem2_memcpyv_nonpmem(void *pmemdest, const struct iovec *iov, int iovcnt,
+		unsigned flags)
+{
+#ifdef DEBUG
+	if (flags & ~PMEM2_F_MEM_VALID_FLAGS)
+		ERR("invalid flags 0x%x", flags);
+#endif
+	PMEM2_API_START("pmem2_memcpyv");
+	size_t len = memcpyv_len(iov, iovcnt);
+	struct movnt_probe probe;
+	flags = movnt_choose(pmemdest, len, flags,
+		MOVNT_OP_MEMCPYV, &probe);
+
+	memcpyv_nodrain(pmemdest, iov, iovcnt, flags & ~PMEM2_F_MEM_NODRAIN,
+		Info.flush, &Info.memmove_funcs, Info.memmove_nodrain);
+	movnt_probe_end(&probe);
+
+	if (!(flags & PMEM2_F_MEM_NOFLUSH))
+		pmem2_persist_pages(pmemdest, len);
+
+	PMEM2_API_END("pmem2_memcpyv");
+	return pmemdest;
+}
+
+/*
+ * pmem2_memcpy_crc32c_nonpmem -- memcpy computing the checksum of the copied
+ *	data followed by an msync
+ */
+static void *
+pmem2_memcpy_crc32c_nonpmem(void *pmemdest, const void *src, size_t len,
+		unsigned flags, uint32_t *crc)
+{
+#ifdef DEBUG
+	if (flags & ~PMEM2_F_MEM_VALID_FLAGS)
+		ERR("invalid flags 0x%x", flags);
+#endif
+	PMEM2_API_START("pmem2_memcpy_crc32c");
+	struct movnt_probe probe;
+	flags = movnt_choose(pmemdest, len, flags,
+		MOVNT_OP_MEMCPY_CRC32C, &probe);
+
+	memcpy_crc32c_nodrain(pmemdest, src, len, flags & ~PMEM2_F_MEM_NODRAIN,
+		crc, Info.movnt_threshold, Info.flush, &Info.memmove_funcs,
+		Info.memmove_nodrain);
+	movnt_probe_end(&probe);
+
+	if (!(flags & PMEM2_F_MEM_NOFLUSH))
+		pmem2_persist_pages(pmemdest, len);
+
+	PMEM2_API_END("pmem2_memcpy_crc32c");
+	return pmemdest;
+}
+
 /*
  * pmem2_memmove -- mem[move|cpy] to pmem
  */
@@ -484,10 +571,19 @@ pmem2_memmove(void *pmemdest, const void *src, size_t len,
 		ERR("invalid flags 0x%x", flags);
 #endif
 	PMEM2_API_START("pmem2_memmove");
-	Info.memmove_nodrain(pmemdest, src, len, flags, Info.flush,
+	struct movnt_probe probe;
+	flags = movnt_choose(pmemdest, len, flags,
+		MOVNT_OP_MEMMOVE, &probe);
+
+	if (flags & PMEM2_F_MEM_PARALLEL)
+		memmove_nodrain_parallel(pmemdest, src, len, flags, Info.flush,
+			&Info.memmove_funcs, Info.memmove_nodrain);
+	else
+		Info.memmove_nodrain(pmemdest, src, len, flags, Info.flush,
 			&Info.memmove_funcs);
 	if ((flags & (PMEM2_F_MEM_NODRAIN | PMEM2_F_MEM_NOFLUSH)) == 0)
 		pmem2_drain();
+	movnt_probe_end(&probe);
 
 	PMEM2_API_END("pmem2_memmove");
 	return pmemdest;
@@ -504,15 +600,78 @@ pmem2_memset(void *pmemdest, int c, size_t len, unsigned flags)
 		ERR("invalid flags 0x%x", flags);
 #endif
 	PMEM2_API_START("pmem2_memset");
-	Info.memset_nodrain(pmemdest, c, len, flags, Info.flush,
+	struct movnt_probe probe;
+	flags = movnt_choose(pmemdest, len, flags,
+		MOVNT_OP_MEMSET, &probe);
+
+	if (flags & PMEM2_F_MEM_PARALLEL)
+		memset_nodrain_parallel(pmemdest, c, len, flags, Info.flush,
+			&Info.memset_funcs, Info.memset_nodrain);
+	else
+		Info.memset_nodrain(pmemdest, c, len, flags, Info.flush,
 			&Info.memset_funcs);
 	if ((flags & (PMEM2_F_MEM_NODRAIN | PMEM2_F_MEM_NOFLUSH)) == 0)
 		pmem2_drain();
+	movnt_probe_end(&probe);
 
 	PMEM2_API_END("pmem2_memset");
 	return pmemdest;
 }
 
+/*
+ * pmem2_memcpyv -- memcpy of many buffers to pmem
+ */
+static void *
+pmem2_memcpyv(void *pmemdest, const struct iovec *iov, int iovcnt,
+		unsigned flags)
+{
+#ifdef DEBUG
+	if (flags & ~PMEM2_F_MEM_VALID_FLAGS)
+		ERR("invalid flags 0x%x", flags);
+#endif
+	PMEM2_API_START("pmem2_memcpyv");
+	struct movnt_probe probe;
+	flags = movnt_choose(pmemdest, memcpyv_len(iov, iovcnt), flags,
+		MOVNT_OP_MEMCPYV, &probe);
+
+	memcpyv_nodrain(pmemdest, iov, iovcnt, flags, Info.flush,
+		&Info.memmove_funcs, Info.memmove_nodrain);
+	if ((flags & (PMEM2_F_MEM_NODRAIN | PMEM2_F_MEM_NOFLUSH)) == 0)
+		pmem2_drain();
+	movnt_probe_end(&probe);
+
+	PMEM2_API_END("pmem2_memcpyv");
+	return pmemdest;
+}
+
+/*
+ * pmem2_memcpy_crc32c -- memcpy to pmem computing the checksum of the copied
+ *	data
+ */
+static void *
+pmem2_memcpy_crc32c(void *pmemdest, const void *src, size_t len,
+		unsigned flags, uint32_t *crc)
+{
+#ifdef DEBUG
+	if (flags & ~PMEM2_F_MEM_VALID_FLAGS)
+		ERR("invalid flags 0x%x", flags);
+#endif
+	PMEM2_API_START("pmem2_memcpy_crc32c");
+	struct movnt_probe probe;
+	flags = movnt_choose(pmemdest, len, flags,
+		MOVNT_OP_MEMCPY_CRC32C, &probe);
+
+	memcpy_crc32c_nodrain(pmemdest, src, len, flags, crc,
+		Info.movnt_threshold, Info.flush, &Info.memmove_funcs,
+		Info.memmove_nodrain);
+	if ((flags & (PMEM2_F_MEM_NODRAIN | PMEM2_F_MEM_NOFLUSH)) == 0)
+		pmem2_drain();
+	movnt_probe_end(&probe);
+
+	PMEM2_API_END("pmem2_memcpy_crc32c");
+	return pmemdest;
+}
+
 /*
  * pmem2_memmove_eadr -- mem[move|cpy] to pmem, platform supports eADR
  */
@@ -525,10 +684,19 @@ pmem2_memmove_eadr(void *pmemdest, const void *src, size_t len,
 		ERR("invalid flags 0x%x", flags);
 #endif
 	PMEM2_API_START("pmem2_memmove");
-	Info.memmove_nodrain_eadr(pmemdest, src, len, flags, Info.flush,
-			&Info.memmove_funcs);
+	struct movnt_probe probe;
+	flags = movnt_choose(pmemdest, len, flags,
+		MOVNT_OP_MEMMOVE, &probe);
+
+	if (flags & PMEM2_F_MEM_PARALLEL)
+		memmove_nodrain_parallel(pmemdest, src, len, flags, Info.flush,
+			&Info.memmove_funcs, Info.memmove_nodrain_eadr);
+	else
+		Info.memmove_nodrain_eadr(pmemdest, src, len, flags,
+			Info.flush, &Info.memmove_funcs);
 	if ((flags & (PMEM2_F_MEM_NODRAIN | PMEM2_F_MEM_NOFLUSH)) == 0)
 		pmem2_drain();
+	movnt_probe_end(&probe);
 
 	PMEM2_API_END("pmem2_memmove");
 	return pmemdest;
@@ -545,15 +713,78 @@ pmem2_memset_eadr(void *pmemdest, int c, size_t len, unsigned flags)
 		ERR("invalid flags 0x%x", flags);
 #endif
 	PMEM2_API_START("pmem2_memset");
-	Info.memset_nodrain_eadr(pmemdest, c, len, flags, Info.flush,
+	struct movnt_probe probe;
+	flags = movnt_choose(pmemdest, len, flags,
+		MOVNT_OP_MEMSET, &probe);
+
+	if (flags & PMEM2_F_MEM_PARALLEL)
+		memset_nodrain_parallel(pmemdest, c, len, flags, Info.flush,
+			&Info.memset_funcs, Info.memset_nodrain_eadr);
+	else
+		Info.memset_nodrain_eadr(pmemdest, c, len, flags, Info.flush,
 			&Info.memset_funcs);
 	if ((flags & (PMEM2_F_MEM_NODRAIN | PMEM2_F_MEM_NOFLUSH)) == 0)
 		pmem2_drain();
+	movnt_probe_end(&probe);
 
 	PMEM2_API_END("pmem2_memset");
 	return pmemdest;
 }
 
+/*
+ * pmem2_memcpyv_eadr -- memcpy of many buffers to pmem, platform supports eADR
+ */
+static void *
+pmem2_memcpyv_eadr(void *pmemdest, const struct iovec *iov, int iovcnt,
+		unsigned flags)
+{
+#ifdef DEBUG
+	if (flags & ~PMEM2_F_MEM_VALID_FLAGS)
+		ERR("invalid flags 0x%x", flags);
+#endif
+	PMEM2_API_START("pmem2_memcpyv");
+	struct movnt_probe probe;
+	flags = movnt_choose(pmemdest, memcpyv_len(iov, iovcnt), flags,
+		MOVNT_OP_MEMCPYV, &probe);
+
+	memcpyv_nodrain(pmemdest, iov, iovcnt, flags, Info.flush,
+		&Info.memmove_funcs, Info.memmove_nodrain_eadr);
+	if ((flags & (PMEM2_F_MEM_NODRAIN | PMEM2_F_MEM_NOFLUSH)) == 0)
+		pmem2_drain();
+	movnt_probe_end(&probe);
+
+	PMEM2_API_END("pmem2_memcpyv");
+	return pmemdest;
+}
+
+/*
+ * pmem2_memcpy_crc32c_eadr -- memcpy to pmem computing the checksum of
+ *	the copied data, platform supports eADR
+ */
+static void *
+pmem2_memcpy_crc32c_eadr(void *pmemdest, const void *src, size_t len,
+		unsigned flags, uint32_t *crc)
+{
+#ifdef DEBUG
+	if (flags & ~PMEM2_F_MEM_VALID_FLAGS)
+		ERR("invalid flags 0x%x", flags);
+#endif
+	PMEM2_API_START("pmem2_memcpy_crc32c");
+	struct movnt_probe probe;
+	flags = movnt_choose(pmemdest, len, flags,
+		MOVNT_OP_MEMCPY_CRC32C, &probe);
+
+	memcpy_crc32c_nodrain(pmemdest, src, len, flags, crc,
+		Info.movnt_threshold, Info.flush, &Info.memmove_funcs,
+		Info.memmove_nodrain_eadr);
+	if ((flags & (PMEM2_F_MEM_NODRAIN | PMEM2_F_MEM_NOFLUSH)) == 0)
+		pmem2_drain();
+	movnt_probe_end(&probe);
+
+	PMEM2_API_END("pmem2_memcpy_crc32c");
+	return pmemdest;
+}
+
 /*
  * pmem2_set_mem_fns -- set function pointers related to mem[move|cpy|set]
  */
@@ -565,16 +796,22 @@ pmem2_set_mem_fns(struct pmem2_map *map)
 			map->memmove_fn = pmem2_memmove_nonpmem;
 			map->memcpy_fn = pmem2_memmove_nonpmem;
 			map->memset_fn = pmem2_memset_nonpmem;
+			map->memcpyv_fn = pmem2_memcpyv_nonpmem;
+			map->memcpy_crc32c_fn = pmem2_memcpy_crc32c_nonpmem;
 			break;
 		case PMEM2_GRANULARITY_CACHE_LINE:
 			map->memmove_fn = pmem2_memmove;
 			map->memcpy_fn = pmem2_memmove;
 			map->memset_fn = pmem2_memset;
+			map->memcpyv_fn = pmem2_memcpyv;
+			map->memcpy_crc32c_fn = pmem2_memcpy_crc32c;
 			break;
 		case PMEM2_GRANULARITY_BYTE:
 			map->memmove_fn = pmem2_memmove_eadr;
 			map->memcpy_fn = pmem2_memmove_eadr;
 			map->memset_fn = pmem2_memset_eadr;
+			map->memcpyv_fn = pmem2_memcpyv_eadr;
+			map->memcpy_crc32c_fn = pmem2_memcpy_crc32c_eadr;
 			break;
 		default:
 			abort();
@@ -612,6 +849,26 @@ pmem2_get_memset_fn(struct pmem2_map *map)
 	return map->memset_fn;
 }
 
+/*
+ * pmem2_get_memcpyv_fn - return a pointer to a function
+ */
+pmem2_memcpyv_fn
+pmem2_get_memcpyv_fn(struct pmem2_map *map)
+{
+	/* we do not need to clear err because this function cannot fail */
+	return map->memcpyv_fn;
+}
+
+/*
+ * pmem2_get_memcpy_crc32c_fn - return a pointer to a function
+ */
+pmem2_memcpy_crc32c_fn
+pmem2_get_memcpy_crc32c_fn(struct pmem2_map *map)
+{
+	/* we do not need to clear err because this function cannot fail */
+	return map->memcpy_crc32c_fn;
+}
+
 #if VG_PMEMCHECK_ENABLED
 /*
  * pmem2_emit_log -- logs library and function names to pmemcheck store log
@@ -67,6 +67,13 @@ struct pmem2_arch_info {
 	flush_func flush;
 	fence_func fence;
 	int flush_has_builtin_fence;
+
+	/* length from which the nontemporal stores are used by default */
+	size_t movnt_threshold;
+	/* the kind of stores depends on movnt_threshold */
+	int movnt_tunable;
+	/* movnt_threshold was not forced, so it may be calibrated */
+	int movnt_calibrate;
 };
 
 void pmem2_arch_init(struct pmem2_arch_info *info);
@@ -566,6 +566,7 @@ pmem2_arch_init(struct pmem2_arch_info *info)
 	 * and pmem_memset_*().
 	 * It has no effect if movnt is not supported or disabled.
 	 */
+	int forced = 0;
 	const char *ptr = os_getenv("PMEM_MOVNT_THRESHOLD");
 	if (ptr) {
 		long long val = atoll(ptr);
@@ -575,9 +576,14 @@ pmem2_arch_init(struct pmem2_arch_info *info)
 		} else {
 			LOG(3, "PMEM_MOVNT_THRESHOLD set to %zu", (size_t)val);
 			Movnt_threshold = (size_t)val;
+			forced = 1;
 		}
 	}
 
+	info->movnt_threshold = Movnt_threshold;
+	info->movnt_tunable = impl != MEMCPY_INVALID;
+	info->movnt_calibrate = info->movnt_tunable && !forced;
+
 	if (info->flush == flush_clwb)
 		LOG(3, "using clwb");
 	else if (info->flush == flush_clflushopt)
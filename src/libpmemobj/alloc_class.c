@@ -121,6 +121,9 @@ struct alloc_class_collection {
 
 	int fail_on_missing_class;
 	int autogenerate_on_missing_class;
+
+	/* huge classes with aligned data, selected by allocation flags */
+	struct alloc_class huge_aligned[MAX_HUGE_ALIGNMENTS];
 };
 
 /*
@@ -197,7 +200,9 @@ alloc_class_new(int id, struct alloc_class_collection *ac,
 
 	switch (type) {
 		case CLASS_HUGE:
-			id = DEFAULT_ALLOC_CLASS_ID;
+			c->rdsc.alignment = alignment;
+			if (id < 0)
+				id = DEFAULT_ALLOC_CLASS_ID;
 			break;
 		case CLASS_RUN:
 			c->rdsc.alignment = alignment;
@@ -421,10 +426,24 @@ alloc_class_collection_new()
 
 	memset(ac->class_map_by_alloc_size, 0xFF, maps_size);
 
-	if (alloc_class_new(-1, ac, CLASS_HUGE, HEADER_COMPACT,
-		CHUNKSIZE, 0, 1) == NULL)
+	struct alloc_class *huge = alloc_class_new(-1, ac, CLASS_HUGE,
+		HEADER_COMPACT, CHUNKSIZE, 0, 1);
+	if (huge == NULL)
 		goto error;
 
+	/*
+	 * The huge classes with aligned data are not registered under any id,
+	 * they share the chunks of the default class.
+	 */
+	static const size_t huge_alignments[MAX_HUGE_ALIGNMENTS] = {
+		HUGE_ALIGNMENT_2M, HUGE_ALIGNMENT_1G
+	};
+	for (int i = 0; i < MAX_HUGE_ALIGNMENTS; ++i) {
+		ac->huge_aligned[i] = *huge;
+		ac->huge_aligned[i].flags |= CHUNK_FLAG_ALIGNED;
+		ac->huge_aligned[i].rdsc.alignment = huge_alignments[i];
+	}
+
 	struct alloc_class *predefined_class =
 		alloc_class_new(-1, ac, CLASS_RUN, HEADER_COMPACT,
 			MIN_UNIT_SIZE, 0, 1);
@@ -586,6 +605,21 @@ alloc_class_by_alloc_size(struct alloc_class_collection *ac, size_t size)
 	}
 }
 
+/*
+ * alloc_class_huge_aligned -- returns the huge allocation class with data
+ *	aligned to the given size
+ */
+struct alloc_class *
+alloc_class_huge_aligned(struct alloc_class_collection *ac, size_t alignment)
+{
+	for (int i = 0; i < MAX_HUGE_ALIGNMENTS; ++i) {
+		if (ac->huge_aligned[i].rdsc.alignment == alignment)
+			return &ac->huge_aligned[i];
+	}
+
+	return NULL;
+}
+
 /*
  * alloc_class_by_run -- returns the allocation class that has the given
  *	unit size
@@ -22,6 +22,11 @@ extern "C" {
 #define DEFAULT_ALLOC_CLASS_ID (0)
 #define RUN_UNIT_MAX RUN_BITS_PER_VALUE
 
+/* alignments of the huge classes that can be selected by allocation flags */
+#define HUGE_ALIGNMENT_2M ((size_t)1 << 21)
+#define HUGE_ALIGNMENT_1G ((size_t)1 << 30)
+#define MAX_HUGE_ALIGNMENTS 2
+
 struct alloc_class_collection;
 
 enum alloc_class_type {
@@ -41,7 +46,7 @@ struct alloc_class {
 	enum header_type header_type;
 	enum alloc_class_type type;
 
-	/* run-specific data */
+	/* run-specific data, only alignment is used by huge classes */
 	struct run_descriptor rdsc;
 };
 
@@ -55,6 +60,8 @@ struct alloc_class *alloc_class_by_alloc_size(
 	struct alloc_class_collection *ac, size_t size);
 struct alloc_class *alloc_class_by_id(
 	struct alloc_class_collection *ac, uint8_t id);
+struct alloc_class *alloc_class_huge_aligned(
+	struct alloc_class_collection *ac, size_t alignment);
 
 int alloc_class_reserve(struct alloc_class_collection *ac, uint8_t id);
 int alloc_class_find_first_free_slot(struct alloc_class_collection *ac,
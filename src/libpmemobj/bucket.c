@@ -39,6 +39,15 @@ struct bucket_locked {
 	os_mutex_t lock;
 };
 
+/*
+ * bucket_is_huge -- (internal) checks whether the bucket holds free chunks
+ */
+static inline int
+bucket_is_huge(struct bucket *b)
+{
+	return b->aclass != NULL && b->aclass->type == CLASS_HUGE;
+}
+
 /*
  * bucket_init -- initializes the bucket's runtime state
  */
@@ -168,7 +177,11 @@ bucket_insert_block(struct bucket *b, const struct memory_block *m)
 		VALGRIND_ANNOTATE_NEW_MEMORY(data, size);
 	}
 #endif
-	return b->c_ops->insert(b->container, m);
+	int ret = b->c_ops->insert(b->container, m);
+	if (ret == 0 && bucket_is_huge(b))
+		heap_free_chunks_update(b->container->heap, m, 1);
+
+	return ret;
 }
 
 /*
@@ -177,7 +190,11 @@ bucket_insert_block(struct bucket *b, const struct memory_block *m)
 int
 bucket_remove_block(struct bucket *b, const struct memory_block *m)
 {
-	return b->c_ops->get_rm_exact(b->container, m);
+	int ret = b->c_ops->get_rm_exact(b->container, m);
+	if (ret == 0 && bucket_is_huge(b))
+		heap_free_chunks_update(b->container->heap, m, 0);
+
+	return ret;
 }
 
 /*
@@ -186,7 +203,11 @@ bucket_remove_block(struct bucket *b, const struct memory_block *m)
 int
 bucket_alloc_block(struct bucket *b, struct memory_block *m_out)
 {
-	return b->c_ops->get_rm_bestfit(b->container, m_out);
+	int ret = b->c_ops->get_rm_bestfit(b->container, m_out);
+	if (ret == 0 && bucket_is_huge(b))
+		heap_free_chunks_update(b->container->heap, m_out, 0);
+
+	return ret;
 }
 
 /*
@@ -0,0 +1,398 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2026, Intel Corporation */
+
+/*
+ * container_critnib.c -- implementation of size-segregated block container
+ *	indexed by critnib trees
+ *
+ * Free blocks of the same size are kept on a circular, doubly-linked list.
+ * The lists of the small sizes are directly indexed by the size and a bitmap
+ * stores the information whether a given list is empty or not. The lists of
+ * the bigger sizes are found in a critnib keyed by the inverted size, so that
+ * the best-fit list is a single less-or-equal lookup. A second critnib maps
+ * the position of every block to its list entry, for the exact removals.
+ *
+ * The list entries are allocated in batches and recycled by the container,
+ * which means that once the container is warmed up, neither insert nor remove
+ * call the system allocator.
+ */
+
+#include "container_critnib.h"
+#include "critnib.h"
+#include "out.h"
+#include "sys_util.h"
+#include "util.h"
+#include "vec.h"
+
+#define CONTAINER_CRITNIB_SMALL_SIZES 64U
+#define CONTAINER_CRITNIB_BATCH 64U /* number of entries allocated at once */
+
+/* inverted, so that the next bigger size is found by critnib_find_le */
+#define SIZE_KEY(size_idx) (UINT64_MAX - (size_idx))
+#define BLOCK_KEY(m) ((uint64_t)(m)->zone_id << 32 |\
+	(uint64_t)(m)->chunk_id << 16 | (m)->block_off)
+
+enum container_critnib_entry_type {
+	ENTRY_FREE,
+	ENTRY_BLOCK, /* free memory block stored in the container */
+	ENTRY_LIST, /* head of the list of blocks of a single size */
+};
+
+struct container_critnib_entry {
+	struct memory_block m;
+	struct container_critnib_entry *prev;
+	struct container_critnib_entry *next;
+	enum container_critnib_entry_type type;
+};
+
+struct block_container_critnib {
+	struct block_container super;
+
+	/* heads of the lists of blocks up to CONTAINER_CRITNIB_SMALL_SIZES */
+	struct container_critnib_entry small[CONTAINER_CRITNIB_SMALL_SIZES];
+	uint64_t nonempty_small;
+
+	struct critnib *sizes; /* heads of the lists of the bigger blocks */
+	struct critnib *blocks; /* entries of the blocks by their position */
+
+	struct container_critnib_entry *free_entries;
+	VEC(, struct container_critnib_entry *) batches;
+
+	size_t nblocks;
+};
+
+/*
+ * container_critnib_list_init -- (internal) initializes an empty list
+ */
+static void
+container_critnib_list_init(struct container_critnib_entry *l,
+	uint32_t size_idx)
+{
+	l->m.size_idx = size_idx;
+	l->type = ENTRY_LIST;
+	l->prev = l;
+	l->next = l;
+}
+
+/*
+ * container_critnib_entry_get -- (internal) takes an entry from the free
+ *	entries, allocating a new batch if there are none
+ */
+static struct container_critnib_entry *
+container_critnib_entry_get(struct block_container_critnib *c)
+{
+	if (c->free_entries == NULL) {
+		struct container_critnib_entry *batch =
+			Malloc(sizeof(*batch) * CONTAINER_CRITNIB_BATCH);
+		if (batch == NULL)
+			return NULL;
+
+		if (VEC_PUSH_BACK(&c->batches, batch) != 0) {
+			Free(batch);
+			return NULL;
+		}
+
+		for (unsigned i = 0; i < CONTAINER_CRITNIB_BATCH; ++i) {
+			batch[i].type = ENTRY_FREE;
+			batch[i].next = c->free_entries;
+			c->free_entries = &batch[i];
+		}
+	}
+
+	struct container_critnib_entry *e = c->free_entries;
+	c->free_entries = e->next;
+
+	return e;
+}
+
+/*
+ * container_critnib_entry_put -- (internal) returns an entry to the free
+ *	entries
+ */
+static void
+container_critnib_entry_put(struct block_container_critnib *c,
+	struct container_critnib_entry *e)
+{
+	e->type = ENTRY_FREE;
+	e->next = c->free_entries;
+	c->free_entries = e;
+}
+
+/*
+ * container_critnib_insert_block -- (internal) inserts a new memory block
+ *	into the container
+ */
+static int
+container_critnib_insert_block(struct block_container *bc,
+	const struct memory_block *m)
+{
+	ASSERTne(m->size_idx, 0);
+
+	struct block_container_critnib *c =
+		(struct block_container_critnib *)bc;
+
+	struct container_critnib_entry *e = container_critnib_entry_get(c);
+	if (e == NULL)
+		goto error_entry_get;
+
+	e->m = *m;
+	e->type = ENTRY_BLOCK;
+
+	int ret = critnib_insert(c->blocks, BLOCK_KEY(m), e);
+	if (ret != 0) {
+		errno = ret;
+		goto error_block_insert;
+	}
+
+	struct container_critnib_entry *l;
+	if (m->size_idx <= CONTAINER_CRITNIB_SMALL_SIZES) {
+		l = &c->small[m->size_idx - 1];
+		c->nonempty_small |= 1ULL << (m->size_idx - 1);
+	} else if ((l = critnib_get(c->sizes, SIZE_KEY(m->size_idx))) ==
+			NULL) {
+		l = container_critnib_entry_get(c);
+		if (l == NULL)
+			goto error_list_get;
+
+		container_critnib_list_init(l, m->size_idx);
+
+		ret = critnib_insert(c->sizes, SIZE_KEY(m->size_idx), l);
+		if (ret != 0) {
+			errno = ret;
+			container_critnib_entry_put(c, l);
+			goto error_list_get;
+		}
+	}
+
+	e->prev = l;
+	e->next = l->next;
+	l->next->prev = e;
+	l->next = e;
+
+	c->nblocks++;
+
+	return 0;
+
+error_list_get:
+	critnib_remove(c->blocks, BLOCK_KEY(m));
+error_block_insert:
+	container_critnib_entry_put(c, e);
+error_entry_get:
+	return -1;
+}
+
+/*
+ * container_critnib_rm_entry -- (internal) removes the entry of a block
+ *	from its list, and the list itself if it becomes empty
+ */
+static void
+container_critnib_rm_entry(struct block_container_critnib *c,
+	struct container_critnib_entry *e)
+{
+	ASSERTeq(e->type, ENTRY_BLOCK);
+
+	struct container_critnib_entry *prev = e->prev;
+	struct container_critnib_entry *next = e->next;
+	prev->next = next;
+	next->prev = prev;
+
+	critnib_remove(c->blocks, BLOCK_KEY(&e->m));
+	container_critnib_entry_put(c, e);
+	c->nblocks--;
+
+	/* the only remaining entry of an empty list is its head */
+	if (prev != next)
+		return;
+
+	struct container_critnib_entry *l = prev;
+	ASSERTeq(l->type, ENTRY_LIST);
+
+	if (l->m.size_idx <= CONTAINER_CRITNIB_SMALL_SIZES) {
+		c->nonempty_small &= ~(1ULL << (l->m.size_idx - 1));
+	} else {
+		critnib_remove(c->sizes, SIZE_KEY(l->m.size_idx));
+		container_critnib_entry_put(c, l);
+	}
+}
+
+/*
+ * container_critnib_get_rm_block_bestfit -- (internal) removes and returns
+ *	the best-fit memory block for size
+ */
+static int
+container_critnib_get_rm_block_bestfit(struct block_container *bc,
+	struct memory_block *m)
+{
+	ASSERTne(m->size_idx, 0);
+
+	struct block_container_critnib *c =
+		(struct block_container_critnib *)bc;
+
+	struct container_critnib_entry *l = NULL;
+	if (m->size_idx <= CONTAINER_CRITNIB_SMALL_SIZES) {
+		uint64_t fits = c->nonempty_small &
+			~((1ULL << (m->size_idx - 1)) - 1);
+		if (fits != 0)
+			l = &c->small[util_lssb_index64(fits)];
+	}
+
+	if (l == NULL)
+		l = critnib_find_le(c->sizes, SIZE_KEY(m->size_idx));
+
+	if (l == NULL)
+		return ENOMEM;
+
+	/* the most recently inserted block of the size is reused first */
+	struct container_critnib_entry *e = l->next;
+	ASSERTne(e, l);
+
+	*m = e->m;
+	container_critnib_rm_entry(c, e);
+
+	return 0;
+}
+
+/*
+ * container_critnib_get_rm_block_exact --
+ *	(internal) removes exact match memory block
+ */
+static int
+container_critnib_get_rm_block_exact(struct block_container *bc,
+	const struct memory_block *m)
+{
+	struct block_container_critnib *c =
+		(struct block_container_critnib *)bc;
+
+	struct container_critnib_entry *e =
+		critnib_get(c->blocks, BLOCK_KEY(m));
+	if (e == NULL || e->m.size_idx != m->size_idx)
+		return ENOMEM;
+
+	container_critnib_rm_entry(c, e);
+
+	return 0;
+}
+
+/*
+ * container_critnib_is_empty -- (internal) checks whether the container is
+ *	empty
+ */
+static int
+container_critnib_is_empty(struct block_container *bc)
+{
+	struct block_container_critnib *c =
+		(struct block_container_critnib *)bc;
+
+	return c->nblocks == 0;
+}
+
+/*
+ * container_critnib_rm_all -- (internal) removes all elements from
+ *	the container
+ */
+static void
+container_critnib_rm_all(struct block_container *bc)
+{
+	struct block_container_critnib *c =
+		(struct block_container_critnib *)bc;
+
+	struct container_critnib_entry *batch;
+	VEC_FOREACH(batch, &c->batches) {
+		for (unsigned i = 0; i < CONTAINER_CRITNIB_BATCH; ++i) {
+			struct container_critnib_entry *e = &batch[i];
+			if (e->type == ENTRY_BLOCK) {
+				critnib_remove(c->blocks, BLOCK_KEY(&e->m));
+				container_critnib_entry_put(c, e);
+			} else if (e->type == ENTRY_LIST) {
+				critnib_remove(c->sizes,
+					SIZE_KEY(e->m.size_idx));
+				container_critnib_entry_put(c, e);
+			}
+		}
+	}
+
+	for (unsigned i = 0; i < CONTAINER_CRITNIB_SMALL_SIZES; ++i)
+		container_critnib_list_init(&c->small[i], i + 1);
+
+	c->nonempty_small = 0;
+	c->nblocks = 0;
+}
+
+/*
+ * container_critnib_destroy -- (internal) deletes the container
+ */
+static void
+container_critnib_destroy(struct block_container *bc)
+{
+	struct block_container_critnib *c =
+		(struct block_container_critnib *)bc;
+
+	critnib_delete(c->blocks);
+	critnib_delete(c->sizes);
+
+	struct container_critnib_entry *batch;
+	VEC_FOREACH(batch, &c->batches) {
+		Free(batch);
+	}
+	VEC_DELETE(&c->batches);
+
+	Free(bc);
+}
+
+/*
+ * Size-segregated block container used to provide best-fit functionality to
+ * the bucket. Both the best-fit and the exact removals are O(k) where k is
+ * the length of the key, and unlike in the ravl-based container, the memory
+ * of the free blocks is never accessed.
+ *
+ * Among the blocks of the best-fit size, the most recently inserted one is
+ * provided, not the one with the lowest address.
+ */
+static const struct block_container_ops container_critnib_ops = {
+	.insert = container_critnib_insert_block,
+	.get_rm_exact = container_critnib_get_rm_block_exact,
+	.get_rm_bestfit = container_critnib_get_rm_block_bestfit,
+	.is_empty = container_critnib_is_empty,
+	.rm_all = container_critnib_rm_all,
+	.destroy = container_critnib_destroy,
+};
+
+/*
+ * container_new_critnib -- allocates and initializes a critnib container
+ */
+struct block_container *
+container_new_critnib(struct palloc_heap *heap)
+{
+	struct block_container_critnib *bc = Malloc(sizeof(*bc));
+	if (bc == NULL)
+		goto error_container_malloc;
+
+	bc->super.heap = heap;
+	bc->super.c_ops = &container_critnib_ops;
+
+	bc->sizes = critnib_new();
+	if (bc->sizes == NULL)
+		goto error_sizes_new;
+
+	bc->blocks = critnib_new();
+	if (bc->blocks == NULL)
+		goto error_blocks_new;
+
+	for (unsigned i = 0; i < CONTAINER_CRITNIB_SMALL_SIZES; ++i)
+		container_critnib_list_init(&bc->small[i], i + 1);
+
+	bc->nonempty_small = 0;
+	bc->free_entries = NULL;
+	VEC_INIT(&bc->batches);
+	bc->nblocks = 0;
+
+	return (struct block_container *)&bc->super;
+
+error_blocks_new:
+	critnib_delete(bc->sizes);
+error_sizes_new:
+	Free(bc);
+
+error_container_malloc:
+	return NULL;
+}
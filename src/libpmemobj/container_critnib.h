@@ -0,0 +1,24 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright 2026, Intel Corporation */
+
+/*
+ * container_critnib.h -- internal definitions for size-segregated,
+ *	critnib-indexed block container
+ */
+
+#ifndef LIBPMEMOBJ_CONTAINER_CRITNIB_H
+#define LIBPMEMOBJ_CONTAINER_CRITNIB_H 1
+
+#include "container.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct block_container *container_new_critnib(struct palloc_heap *heap);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LIBPMEMOBJ_CONTAINER_CRITNIB_H */
@@ -0,0 +1,205 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2026, Intel Corporation */
+
+/*
+ * container_numa.c -- implementation of numa-aware block container
+ */
+
+#include "container_numa.h"
+#include "heap.h"
+#include "out.h"
+#include "sys_util.h"
+
+#define CONTAINER_NUMA_MAX_NODES 64
+
+struct block_container_numa {
+	struct block_container super;
+
+	/* constructor of the per-node containers */
+	struct block_container *(*container_new)(struct palloc_heap *heap);
+
+	/*
+	 * One container per numa node, created on first use. The first
+	 * slot holds blocks from zones whose numa node is unknown.
+	 */
+	struct block_container *nodes[CONTAINER_NUMA_MAX_NODES + 1];
+};
+
+/*
+ * container_numa_node_idx -- (internal) returns the slot for the node
+ */
+static unsigned
+container_numa_node_idx(int node)
+{
+	if (node < 0)
+		return 0;
+
+	return (unsigned)node % CONTAINER_NUMA_MAX_NODES + 1;
+}
+
+/*
+ * container_numa_block_node -- (internal) returns the container of the
+ *	node on which the memory block is located
+ */
+static struct block_container **
+container_numa_block_node(struct block_container_numa *c,
+	const struct memory_block *m)
+{
+	int node = heap_zone_numa_node(c->super.heap, m->zone_id);
+
+	return &c->nodes[container_numa_node_idx(node)];
+}
+
+/*
+ * container_numa_insert_block -- (internal) inserts a new memory block
+ *	into the container of the node on which it is located
+ */
+static int
+container_numa_insert_block(struct block_container *bc,
+	const struct memory_block *m)
+{
+	struct block_container_numa *c =
+		(struct block_container_numa *)bc;
+
+	struct block_container **n = container_numa_block_node(c, m);
+	if (*n == NULL && (*n = c->container_new(c->super.heap)) == NULL)
+		return -1;
+
+	return (*n)->c_ops->insert(*n, m);
+}
+
+/*
+ * container_numa_get_rm_block_bestfit -- (internal) removes and returns the
+ *	best-fit memory block for size, preferring the blocks local to the
+ *	calling thread
+ */
+static int
+container_numa_get_rm_block_bestfit(struct block_container *bc,
+	struct memory_block *m)
+{
+	struct block_container_numa *c =
+		(struct block_container_numa *)bc;
+
+	unsigned local = container_numa_node_idx(heap_thread_numa_node());
+
+	struct block_container *n = c->nodes[local];
+	if (n != NULL && n->c_ops->get_rm_bestfit(n, m) == 0)
+		return 0;
+
+	for (unsigned i = 0; i <= CONTAINER_NUMA_MAX_NODES; ++i) {
+		n = c->nodes[i];
+		if (i == local || n == NULL)
+			continue;
+
+		if (n->c_ops->get_rm_bestfit(n, m) == 0)
+			return 0;
+	}
+
+	return ENOMEM;
+}
+
+/*
+ * container_numa_get_rm_block_exact --
+ *	(internal) removes exact match memory block
+ */
+static int
+container_numa_get_rm_block_exact(struct block_container *bc,
+	const struct memory_block *m)
+{
+	struct block_container_numa *c =
+		(struct block_container_numa *)bc;
+
+	struct block_container *n = *container_numa_block_node(c, m);
+	if (n == NULL)
+		return ENOMEM;
+
+	return n->c_ops->get_rm_exact(n, m);
+}
+
+/*
+ * container_numa_is_empty -- (internal) checks whether the container is empty
+ */
+static int
+container_numa_is_empty(struct block_container *bc)
+{
+	struct block_container_numa *c =
+		(struct block_container_numa *)bc;
+
+	for (unsigned i = 0; i <= CONTAINER_NUMA_MAX_NODES; ++i) {
+		struct block_container *n = c->nodes[i];
+		if (n != NULL && !n->c_ops->is_empty(n))
+			return 0;
+	}
+
+	return 1;
+}
+
+/*
+ * container_numa_rm_all -- (internal) removes all elements from the container
+ */
+static void
+container_numa_rm_all(struct block_container *bc)
+{
+	struct block_container_numa *c =
+		(struct block_container_numa *)bc;
+
+	for (unsigned i = 0; i <= CONTAINER_NUMA_MAX_NODES; ++i) {
+		struct block_container *n = c->nodes[i];
+		if (n != NULL)
+			n->c_ops->rm_all(n);
+	}
+}
+
+/*
+ * container_numa_destroy -- (internal) deletes the container
+ */
+static void
+container_numa_destroy(struct block_container *bc)
+{
+	struct block_container_numa *c =
+		(struct block_container_numa *)bc;
+
+	for (unsigned i = 0; i <= CONTAINER_NUMA_MAX_NODES; ++i) {
+		struct block_container *n = c->nodes[i];
+		if (n != NULL)
+			n->c_ops->destroy(n);
+	}
+
+	Free(bc);
+}
+
+/*
+ * Composite block container which keeps the memory blocks in separate
+ * per-node containers, based on the numa node of the pool part backing the
+ * zone of each block. Best-fit requests are served from the node of the
+ * calling thread first, and only then from the remaining nodes, while the
+ * exact match requests (e.g., coalescing) are routed directly to the node of
+ * the block.
+ */
+static const struct block_container_ops container_numa_ops = {
+	.insert = container_numa_insert_block,
+	.get_rm_exact = container_numa_get_rm_block_exact,
+	.get_rm_bestfit = container_numa_get_rm_block_bestfit,
+	.is_empty = container_numa_is_empty,
+	.rm_all = container_numa_rm_all,
+	.destroy = container_numa_destroy,
+};
+
+/*
+ * container_new_numa -- allocates and initializes a numa-aware container
+ *	which uses the provided constructor for the per-node containers
+ */
+struct block_container *
+container_new_numa(struct palloc_heap *heap,
+	struct block_container *(*container_new)(struct palloc_heap *heap))
+{
+	struct block_container_numa *bc = Zalloc(sizeof(*bc));
+	if (bc == NULL)
+		return NULL;
+
+	bc->super.heap = heap;
+	bc->super.c_ops = &container_numa_ops;
+	bc->container_new = container_new;
+
+	return (struct block_container *)&bc->super;
+}
@@ -0,0 +1,24 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright 2026, Intel Corporation */
+
+/*
+ * container_numa.h -- internal definitions for numa-aware block container
+ */
+
+#ifndef LIBPMEMOBJ_CONTAINER_NUMA_H
+#define LIBPMEMOBJ_CONTAINER_NUMA_H 1
+
+#include "container.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct block_container *container_new_numa(struct palloc_heap *heap,
+	struct block_container *(*container_new)(struct palloc_heap *heap));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LIBPMEMOBJ_CONTAINER_NUMA_H */
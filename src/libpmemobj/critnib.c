@@ -547,15 +547,18 @@ static void *
 find_successor(struct critnib_node *__restrict n)
 {
 	while (1) {
+		struct critnib_node *m = NULL;
 		int nib;
-		for (nib = NIB; nib >= 0; nib--)
-			if (n->child[nib])
+		for (nib = NIB; nib >= 0; nib--) {
+			load(&n->child[nib], &m);
+			if (m)
 				break;
+		}
 
 		if (nib < 0)
 			return NULL;
 
-		n = n->child[nib];
+		n = m;
 		if (is_leaf(n))
 			return to_leaf(n)->value;
 	}
@@ -0,0 +1,464 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2026, Intel Corporation */
+
+/*
+ * defrag_daemon.c -- background defragmentation of the heap
+ *
+ * The defragmentation thread repeatedly takes the sparsest run out of
+ * the recyclers, so that nothing new is allocated from it, and relocates all
+ * of its objects with palloc_defrag. The application reports, through
+ * a callback, where the persistent references to every object are, and those
+ * are updated atomically with the relocation. A run which has been emptied
+ * this way becomes a free chunk, usable by the allocations of any size.
+ *
+ * The number of relocated bytes per second is limited by the bandwidth
+ * budget, so that the defragmentation does not starve the application of
+ * the persistent memory bandwidth.
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <time.h>
+
+#include "defrag_daemon.h"
+#include "heap.h"
+#include "obj.h"
+#include "os.h"
+#include "os_thread.h"
+#include "out.h"
+#include "palloc.h"
+#include "pmalloc.h"
+#include "sys_util.h"
+#include "vec.h"
+
+#define NSEC_IN_SEC 1000000000ULL
+#define NSEC_IN_MSEC 1000000ULL
+
+struct defrag_object {
+	uint64_t off;
+	size_t size;
+	PMEMoid *ref; /* one of the references to the object */
+	int queried; /* the references were retrieved from the application */
+};
+
+VEC(defrag_object_vec, struct defrag_object);
+VEC(defrag_offset_vec, uint64_t *);
+
+struct defrag_daemon {
+	PMEMobjpool *pop;
+
+	os_mutex_t lock;
+	os_cond_t cond; /* signaled when the thread is asked to stop */
+
+	unsigned fill_threshold; /* percent of used units */
+	uint64_t bandwidth; /* bytes per second, 0 means unlimited */
+	uint64_t interval; /* milliseconds */
+
+	struct pobj_defrag_callbacks cb;
+	int running;
+	int stop;
+	os_thread_t thread;
+};
+
+/*
+ * defrag_daemon_now -- (internal) returns the current time in nanoseconds
+ */
+static uint64_t
+defrag_daemon_now(void)
+{
+	struct timespec t;
+	os_clock_gettime(CLOCK_REALTIME, &t);
+
+	return (uint64_t)t.tv_sec * NSEC_IN_SEC + (uint64_t)t.tv_nsec;
+}
+
+/*
+ * defrag_daemon_sleep_until -- (internal) waits until the given time or until
+ *	the thread is asked to stop, must be called with the lock held
+ */
+static void
+defrag_daemon_sleep_until(struct defrag_daemon *d, uint64_t time)
+{
+	struct timespec deadline;
+	deadline.tv_sec = (time_t)(time / NSEC_IN_SEC);
+	deadline.tv_nsec = (long)(time % NSEC_IN_SEC);
+
+	while (!d->stop) {
+		if (os_cond_timedwait(&d->cond, &d->lock,
+				&deadline) == ETIMEDOUT)
+			break;
+	}
+}
+
+/*
+ * defrag_daemon_collect -- (internal) records an object of the run
+ */
+static int
+defrag_daemon_collect(const struct memory_block *m, void *arg)
+{
+	struct defrag_object_vec *objects = arg;
+
+	if (m->m_ops->get_flags(m) & OBJ_INTERNAL_OBJECT_MASK)
+		return 0;
+
+	struct defrag_object obj = {
+		HEAP_PTR_TO_OFF(m->heap, m->m_ops->get_user_data(m)),
+		m->m_ops->get_user_size(m),
+		NULL,
+		0,
+	};
+
+	return VEC_PUSH_BACK(objects, obj);
+}
+
+/*
+ * defrag_daemon_refs -- (internal) retrieves the references to the object
+ *	from the application, returns 0 if the object cannot be moved
+ */
+static size_t
+defrag_daemon_refs(struct defrag_daemon *d, struct defrag_object *obj,
+	PMEMoid **refs)
+{
+	PMEMobjpool *pop = d->pop;
+	PMEMoid oid = {pop->uuid_lo, obj->off};
+
+	size_t nrefs = d->cb.refs(pop, oid, refs, POBJ_DEFRAG_MAX_REFS,
+		d->cb.arg);
+	if (nrefs > POBJ_DEFRAG_MAX_REFS) {
+		ERR("too many references to the object at %" PRIu64,
+			obj->off);
+		return 0;
+	}
+
+	for (size_t i = 0; i < nrefs; ++i) {
+		if (!OBJ_PTR_IS_VALID(pop, refs[i]) ||
+				!OID_EQUALS(*refs[i], oid)) {
+			ERR("invalid reference to the object at %" PRIu64,
+				obj->off);
+			return 0;
+		}
+	}
+
+	return nrefs;
+}
+
+/*
+ * defrag_daemon_relocate -- (internal) moves the objects out of the run,
+ *	returns the number of relocated bytes
+ */
+static uint64_t
+defrag_daemon_relocate(struct defrag_daemon *d, struct memory_block *m,
+	struct defrag_object_vec *objects, struct defrag_offset_vec *objv)
+{
+	PMEMobjpool *pop = d->pop;
+	PMEMoid *refs[POBJ_DEFRAG_MAX_REFS];
+
+	os_mutex_t *lock = m->m_ops->get_lock(m);
+	util_mutex_lock(lock);
+	int ret = m->m_ops->iterate_used(m, defrag_daemon_collect, objects);
+	util_mutex_unlock(lock);
+
+	if (ret != 0) {
+		ERR("!failed to collect the objects of a run");
+		return 0;
+	}
+
+	struct defrag_object *obj;
+	VEC_FOREACH_BY_PTR(obj, objects) {
+		obj->queried = 1;
+		size_t nrefs = defrag_daemon_refs(d, obj, refs);
+		if (nrefs == 0)
+			continue;
+
+		obj->ref = refs[0];
+		for (size_t i = 0; i < nrefs; ++i) {
+			if (VEC_PUSH_BACK(objv, &refs[i]->off) != 0) {
+				/* the references to obj are partially added */
+				ERR("!failed to relocate the objects of a run");
+				VEC_CLEAR(objv);
+				goto out;
+			}
+		}
+	}
+
+	if (VEC_SIZE(objv) != 0) {
+		struct operation_context *ctx = pmalloc_operation_hold(pop);
+		if (palloc_defrag(&pop->heap, VEC_ARR(objv), VEC_SIZE(objv),
+				ctx, NULL) != 0)
+			ERR("!palloc_defrag");
+		pmalloc_operation_release(pop);
+	}
+
+out:;
+	/*
+	 * The application is told about every object passed to refs, also
+	 * those which were not relocated, so that it can release their
+	 * references.
+	 */
+	uint64_t nbytes = 0;
+	VEC_FOREACH_BY_PTR(obj, objects) {
+		if (!obj->queried)
+			continue;
+
+		PMEMoid oid = {pop->uuid_lo, obj->off};
+		PMEMoid new_oid = obj->ref != NULL ? *obj->ref : oid;
+
+		if (!OID_EQUALS(oid, new_oid)) {
+			STATS_INC(pop->stats, transient, heap_defrag_objects,
+				1);
+			STATS_INC(pop->stats, transient, heap_defrag_bytes,
+				obj->size);
+			nbytes += obj->size;
+		}
+
+		if (d->cb.moved != NULL)
+			d->cb.moved(pop, oid, new_oid, d->cb.arg);
+	}
+
+	return nbytes;
+}
+
+/*
+ * defrag_daemon_worker -- (internal) the background defragmentation thread
+ */
+static void *
+defrag_daemon_worker(void *arg)
+{
+	struct defrag_daemon *d = arg;
+	struct palloc_heap *heap = &d->pop->heap;
+
+	struct defrag_object_vec objects = VEC_INITIALIZER;
+	struct defrag_offset_vec objv = VEC_INITIALIZER;
+
+	unsigned class_id = 0;
+
+	/* the time from which the relocated bytes are paid for */
+	uint64_t budget_start = defrag_daemon_now();
+
+	util_mutex_lock(&d->lock);
+	while (!d->stop) {
+		unsigned fill_threshold = d->fill_threshold;
+		util_mutex_unlock(&d->lock);
+
+		uint64_t nbytes = 0;
+		int freed = 0;
+
+		struct memory_block m;
+		if (heap_get_sparse_run(heap, fill_threshold,
+				&class_id, &m) == 0) {
+			nbytes = defrag_daemon_relocate(d, &m, &objects,
+				&objv);
+
+			freed = heap_discard_run(heap, &m);
+			if (freed)
+				STATS_INC(d->pop->stats, transient,
+					heap_defrag_runs, 1);
+
+			VEC_CLEAR(&objects);
+			VEC_CLEAR(&objv);
+		}
+
+		util_mutex_lock(&d->lock);
+
+		if (nbytes == 0 && !freed) {
+			/* nothing to do, or the objects can't be moved now */
+			defrag_daemon_sleep_until(d, defrag_daemon_now() +
+				d->interval * NSEC_IN_MSEC);
+			budget_start = defrag_daemon_now();
+		} else if (d->bandwidth == 0) {
+			budget_start = defrag_daemon_now();
+		} else {
+			budget_start += nbytes * NSEC_IN_SEC / d->bandwidth;
+			defrag_daemon_sleep_until(d, budget_start);
+		}
+	}
+	util_mutex_unlock(&d->lock);
+
+	VEC_DELETE(&objects);
+	VEC_DELETE(&objv);
+
+	return NULL;
+}
+
+/*
+ * defrag_daemon_new -- creates a new, stopped, defragmentation instance
+ */
+struct defrag_daemon *
+defrag_daemon_new(PMEMobjpool *pop)
+{
+	struct defrag_daemon *d = Zalloc(sizeof(*d));
+	if (d == NULL) {
+		ERR("!Zalloc");
+		return NULL;
+	}
+
+	d->pop = pop;
+	d->fill_threshold = DEFRAG_DEFAULT_FILL_THRESHOLD;
+	d->bandwidth = 0;
+	d->interval = DEFRAG_DEFAULT_INTERVAL;
+
+	util_mutex_init(&d->lock);
+	os_cond_init(&d->cond);
+
+	return d;
+}
+
+/*
+ * defrag_daemon_delete -- stops the defragmentation thread and deletes
+ *	the instance
+ */
+void
+defrag_daemon_delete(struct defrag_daemon *d)
+{
+	defrag_daemon_stop(d);
+
+	os_cond_destroy(&d->cond);
+	util_mutex_destroy(&d->lock);
+	Free(d);
+}
+
+/*
+ * defrag_daemon_start -- starts the defragmentation thread
+ */
+int
+defrag_daemon_start(struct defrag_daemon *d,
+	const struct pobj_defrag_callbacks *cb)
+{
+	if (cb == NULL || cb->refs == NULL) {
+		ERR("the references callback is required");
+		errno = EINVAL;
+		return -1;
+	}
+
+	util_mutex_lock(&d->lock);
+
+	if (d->running) {
+		util_mutex_unlock(&d->lock);
+		ERR("the defragmentation is already running");
+		errno = EBUSY;
+		return -1;
+	}
+
+	d->cb = *cb;
+	d->stop = 0;
+
+	int ret = os_thread_create(&d->thread, NULL, defrag_daemon_worker, d);
+	if (ret != 0) {
+		util_mutex_unlock(&d->lock);
+		errno = ret;
+		ERR("!os_thread_create");
+		return -1;
+	}
+
+	d->running = 1;
+
+	util_mutex_unlock(&d->lock);
+
+	return 0;
+}
+
+/*
+ * defrag_daemon_stop -- stops the defragmentation thread, if running, and
+ *	waits for the relocation of the current run to finish
+ */
+void
+defrag_daemon_stop(struct defrag_daemon *d)
+{
+	util_mutex_lock(&d->lock);
+
+	if (!d->running) {
+		util_mutex_unlock(&d->lock);
+		return;
+	}
+
+	d->stop = 1;
+	os_cond_signal(&d->cond);
+	util_mutex_unlock(&d->lock);
+
+	os_thread_join(&d->thread, NULL);
+
+	util_mutex_lock(&d->lock);
+	d->running = 0;
+	util_mutex_unlock(&d->lock);
+}
+
+/*
+ * defrag_daemon_get_fill_threshold -- returns the percentage of used units
+ *	below which the runs are defragmented
+ */
+unsigned
+defrag_daemon_get_fill_threshold(struct defrag_daemon *d)
+{
+	util_mutex_lock(&d->lock);
+	unsigned fill_threshold = d->fill_threshold;
+	util_mutex_unlock(&d->lock);
+
+	return fill_threshold;
+}
+
+/*
+ * defrag_daemon_set_fill_threshold -- sets the percentage of used units
+ *	below which the runs are defragmented
+ */
+void
+defrag_daemon_set_fill_threshold(struct defrag_daemon *d,
+	unsigned fill_threshold)
+{
+	ASSERT(fill_threshold <= DEFRAG_MAX_FILL_THRESHOLD);
+
+	util_mutex_lock(&d->lock);
+	d->fill_threshold = fill_threshold;
+	util_mutex_unlock(&d->lock);
+}
+
+/*
+ * defrag_daemon_get_bandwidth -- returns the maximum number of bytes
+ *	relocated per second
+ */
+uint64_t
+defrag_daemon_get_bandwidth(struct defrag_daemon *d)
+{
+	util_mutex_lock(&d->lock);
+	uint64_t bandwidth = d->bandwidth;
+	util_mutex_unlock(&d->lock);
+
+	return bandwidth;
+}
+
+/*
+ * defrag_daemon_set_bandwidth -- sets the maximum number of bytes relocated
+ *	per second, 0 removes the limit
+ */
+void
+defrag_daemon_set_bandwidth(struct defrag_daemon *d, uint64_t bandwidth)
+{
+	util_mutex_lock(&d->lock);
+	d->bandwidth = bandwidth;
+	util_mutex_unlock(&d->lock);
+}
+
+/*
+ * defrag_daemon_get_interval -- returns the time, in milliseconds, between
+ *	the searches for sparse runs when none was found
+ */
+uint64_t
+defrag_daemon_get_interval(struct defrag_daemon *d)
+{
+	util_mutex_lock(&d->lock);
+	uint64_t interval = d->interval;
+	util_mutex_unlock(&d->lock);
+
+	return interval;
+}
+
+/*
+ * defrag_daemon_set_interval -- sets the time, in milliseconds, between
+ *	the searches for sparse runs when none was found
+ */
+void
+defrag_daemon_set_interval(struct defrag_daemon *d, uint64_t interval)
+{
+	util_mutex_lock(&d->lock);
+	d->interval = interval;
+	util_mutex_unlock(&d->lock);
+}
@@ -0,0 +1,48 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright 2026, Intel Corporation */
+
+/*
+ * defrag_daemon.h -- internal definitions for the background defragmentation
+ */
+
+#ifndef LIBPMEMOBJ_DEFRAG_DAEMON_H
+#define LIBPMEMOBJ_DEFRAG_DAEMON_H 1
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "libpmemobj/ctl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DEFRAG_DEFAULT_FILL_THRESHOLD 25 /* percent */
+#define DEFRAG_MAX_FILL_THRESHOLD 50 /* percent */
+#define DEFRAG_DEFAULT_INTERVAL 1000 /* milliseconds */
+
+struct pmemobjpool;
+struct defrag_daemon;
+
+struct defrag_daemon *defrag_daemon_new(struct pmemobjpool *pop);
+void defrag_daemon_delete(struct defrag_daemon *d);
+
+int defrag_daemon_start(struct defrag_daemon *d,
+	const struct pobj_defrag_callbacks *cb);
+void defrag_daemon_stop(struct defrag_daemon *d);
+
+unsigned defrag_daemon_get_fill_threshold(struct defrag_daemon *d);
+void defrag_daemon_set_fill_threshold(struct defrag_daemon *d,
+	unsigned fill_threshold);
+
+uint64_t defrag_daemon_get_bandwidth(struct defrag_daemon *d);
+void defrag_daemon_set_bandwidth(struct defrag_daemon *d, uint64_t bandwidth);
+
+uint64_t defrag_daemon_get_interval(struct defrag_daemon *d);
+void defrag_daemon_set_interval(struct defrag_daemon *d, uint64_t interval);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
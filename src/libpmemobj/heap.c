@@ -21,6 +21,8 @@
 #include "sys_util.h"
 #include "valgrind_internal.h"
 #include "recycler.h"
+#include "container_critnib.h"
+#include "container_numa.h"
 #include "container_ravl.h"
 #include "container_seglists.h"
 #include "alloc_class.h"
@@ -35,12 +37,20 @@
  */
 #define HEAP_DEFAULT_GROW_SIZE (1 << 27) /* 128 megabytes */
 #define MAX_DEFAULT_ARENAS (1 << 10) /* 1024 arenas */
+#define HEAP_NUMA_NODE_REFRESH 1024 /* calls between the node lookups */
 
 enum pobj_arenas_assignment_type Default_arenas_assignment_type =
 	POBJ_ARENAS_ASSIGNMENT_THREAD_KEY;
 
 size_t Default_arenas_max = 0;
 
+unsigned Default_parallel_reclaim = 0;
+
+enum pobj_huge_container_type Default_huge_container =
+	POBJ_HUGE_CONTAINER_RAVL;
+
+int Default_huge_align = 0;
+
 struct arenas_thread_assignment {
 	enum pobj_arenas_assignment_type type;
 	union {
@@ -79,6 +89,76 @@ struct arena {
 	int automatic;
 	size_t nthreads;
 	struct arenas *arenas;
+
+	/* numa node the arena is bound to, -1 if none */
+	int numa_node;
+
+	/*
+	 * Units allocated (or freed, the counters wrap around) by the threads
+	 * of the arena, per allocation class. Kept per arena so that the
+	 * threads don't share a single counter on every allocation, summed
+	 * up with the global ones on read.
+	 */
+	uint64_t class_used[MAX_ALLOCATION_CLASSES];
+};
+
+/*
+ * A single reserved run block kept in the thread cache, along with the
+ * reservation of the run it was carved out of.
+ */
+struct heap_thread_cache_entry {
+	struct memory_block m;
+	struct memory_block_reserved *mresv;
+};
+
+struct heap_thread_cache_bin {
+	unsigned nentries;
+	struct heap_thread_cache_entry entries[HEAP_THREAD_CACHE_BIN_SIZE_MAX];
+};
+
+/*
+ * Thread caches are per-thread magazines of blocks that were reserved
+ * in batches from the buckets of the thread's arena. Allocations of small
+ * sizes are served from the magazine without taking any locks.
+ */
+struct heap_thread_cache {
+	struct palloc_heap *heap;
+	PMDK_LIST_ENTRY(heap_thread_cache) entry;
+
+	/* one bin per allocation class, allocated on first use */
+	struct heap_thread_cache_bin *bins[MAX_ALLOCATION_CLASSES];
+};
+
+struct heap_thread_caches {
+	int enabled;
+	unsigned bin_size;
+	size_t max_size;
+
+	/* created when the thread caches are enabled for the first time */
+	int key_created;
+	os_tls_key_t key;
+
+	/* protects the list of caches and the creation of the key */
+	os_mutex_t lock;
+	PMDK_LIST_HEAD(heap_thread_cache_list, heap_thread_cache) caches;
+};
+
+/*
+ * Runs of an allocation class and the units used in them, or, for the class
+ * of huge allocations, the chunks used by the allocations.
+ */
+struct heap_class_occupancy {
+	uint64_t runs;
+	uint64_t used;
+};
+
+/*
+ * Free chunks of a zone which are available to the allocator, i.e. inserted
+ * into a bucket of the huge allocation class.
+ */
+struct heap_zone_occupancy {
+	uint64_t free_chunks;
+	uint64_t extents[POBJ_ZONE_STATS_NBUCKETS];
 };
 
 struct heap_rt {
@@ -95,6 +175,18 @@ struct heap_rt {
 
 	unsigned nzones;
 	int *zone_reclaimed_map;
+
+	/* numa nodes of the zones, only for numa arenas assignment */
+	int *zone_numa_map;
+	unsigned nnuma_nodes; /* number of distinct nodes in the map */
+	int *part_numa_map; /* numa nodes of the parts of the first replica */
+	unsigned npart_numa_map;
+
+	struct heap_thread_caches tcaches;
+
+	/* incrementally updated occupancy of the classes and the zones */
+	struct heap_class_occupancy class_occupancy[MAX_ALLOCATION_CLASSES];
+	struct heap_zone_occupancy *zone_occupancy;
 };
 
 /*
@@ -190,6 +282,7 @@ heap_arena_new(struct palloc_heap *heap, int automatic)
 	arena->nthreads = 0;
 	arena->automatic = automatic;
 	arena->arenas = &heap->rt->arenas;
+	arena->numa_node = -1;
 
 	COMPILE_ERROR_ON(MAX_ALLOCATION_CLASSES > UINT8_MAX);
 	for (uint8_t i = 0; i < MAX_ALLOCATION_CLASSES; ++i) {
@@ -251,7 +344,8 @@ heap_arena_thread_attach(struct palloc_heap *heap, struct arena *a)
 	struct heap_rt *h = heap->rt;
 
 	struct arenas_thread_assignment *assignment = &h->arenas.assignment;
-	ASSERTeq(assignment->type, POBJ_ARENAS_ASSIGNMENT_THREAD_KEY);
+	ASSERT(assignment->type == POBJ_ARENAS_ASSIGNMENT_THREAD_KEY ||
+		assignment->type == POBJ_ARENAS_ASSIGNMENT_NUMA);
 
 	struct arena *thread_arena = os_tls_get(assignment->thread);
 	if (thread_arena)
@@ -296,6 +390,7 @@ arena_thread_assignment_init(struct arenas_thread_assignment *assignment,
 
 	switch (type) {
 		case POBJ_ARENAS_ASSIGNMENT_THREAD_KEY:
+		case POBJ_ARENAS_ASSIGNMENT_NUMA:
 			ret = os_tls_key_create(&assignment->thread,
 				heap_thread_arena_destructor);
 			break;
@@ -319,6 +414,7 @@ arena_thread_assignment_fini(struct arenas_thread_assignment *assignment)
 {
 	switch (assignment->type) {
 		case POBJ_ARENAS_ASSIGNMENT_THREAD_KEY:
+		case POBJ_ARENAS_ASSIGNMENT_NUMA:
 			os_tls_key_delete(assignment->thread);
 			break;
 		case POBJ_ARENAS_ASSIGNMENT_GLOBAL:
@@ -406,6 +502,159 @@ heap_thread_arena_assign(struct palloc_heap *heap)
 	return least_used;
 }
 
+/*
+ * heap_thread_numa_node -- returns the numa node of the calling thread,
+ *	or -1 if unknown
+ *
+ * The node is cached per thread and refreshed every HEAP_NUMA_NODE_REFRESH
+ * calls, so that a thread migrated to another node eventually follows, but
+ * the allocations don't pay for a system call each.
+ */
+int
+heap_thread_numa_node(void)
+{
+	static __thread int node = -1;
+	static __thread unsigned ncalls;
+
+	if (ncalls++ % HEAP_NUMA_NODE_REFRESH == 0) {
+		unsigned cpu;
+		unsigned n;
+		node = os_getcpu(&cpu, &n) == 0 ? (int)n : -1;
+	}
+
+	return node;
+}
+
+/*
+ * heap_zone_numa_node -- returns the numa node of the pool part backing
+ *	the zone, or -1 if unknown
+ */
+int
+heap_zone_numa_node(struct palloc_heap *heap, uint32_t zone_id)
+{
+	int *map = heap->rt->zone_numa_map;
+
+	return map == NULL ? -1 : map[zone_id];
+}
+
+/*
+ * heap_part_numa_node -- (internal) returns the numa node of the part of
+ *	the first replica, looking up the nodes of the parts not seen before
+ */
+static int
+heap_part_numa_node(struct palloc_heap *heap, unsigned p)
+{
+	struct heap_rt *h = heap->rt;
+	struct pool_replica *rep = heap->set->replica[0];
+
+	if (p >= h->npart_numa_map) {
+		/* the replica grows by whole parts */
+		int *map = Realloc(h->part_numa_map,
+			sizeof(int) * rep->nparts);
+		if (map == NULL)
+			return util_part_numa_node(&rep->part[p]);
+
+		for (unsigned i = h->npart_numa_map; i < rep->nparts; ++i)
+			map[i] = util_part_numa_node(&rep->part[i]);
+
+		h->part_numa_map = map;
+		h->npart_numa_map = rep->nparts;
+	}
+
+	return h->part_numa_map[p];
+}
+
+/*
+ * heap_zone_numa_lookup -- (internal) finds the numa node of the pool part
+ *	which contains the beginning of the zone
+ */
+static int
+heap_zone_numa_lookup(struct palloc_heap *heap, uint32_t zone_id)
+{
+	if (heap->set == NULL)
+		return -1;
+
+	uintptr_t zaddr = (uintptr_t)ZID_TO_ZONE(heap->layout, zone_id);
+
+	struct pool_replica *rep = heap->set->replica[0];
+	for (unsigned p = 0; p < rep->nparts; ++p) {
+		struct pool_set_part *part = &rep->part[p];
+		uintptr_t addr = (uintptr_t)part->addr;
+		if (zaddr >= addr && zaddr < addr + part->size)
+			return heap_part_numa_node(heap, p);
+	}
+
+	return -1;
+}
+
+/*
+ * heap_numa_arena_assign -- (internal) assigns the least used arena bound to
+ *	the numa node of the current thread
+ *
+ * Automatic arenas are bound to nodes lazily - until the node of the calling
+ * thread has its fair share of the arenas, the least used unbound arena gets
+ * bound to it whenever all of the node's arenas are already in use.
+ * If all the arenas are already bound to other nodes, this falls back to the
+ * least used arena overall.
+ */
+static struct arena *
+heap_numa_arena_assign(struct palloc_heap *heap)
+{
+	int node = heap_thread_numa_node();
+
+	util_mutex_lock(&heap->rt->arenas.lock);
+
+	struct arena *local = NULL;
+	struct arena *unbound = NULL;
+	struct arena *least_used = NULL;
+	unsigned nlocal = 0;
+	unsigned nauto = 0;
+
+	ASSERTne(VEC_SIZE(&heap->rt->arenas.vec), 0);
+
+	struct arena *a;
+	VEC_FOREACH(a, &heap->rt->arenas.vec) {
+		if (!a->automatic)
+			continue;
+		nauto++;
+		if (least_used == NULL ||
+			a->nthreads < least_used->nthreads)
+			least_used = a;
+		if (a->numa_node == node)
+			nlocal++;
+		if (a->numa_node == node && (local == NULL ||
+			a->nthreads < local->nthreads))
+			local = a;
+		if (a->numa_node == -1 && (unbound == NULL ||
+			a->nthreads < unbound->nthreads))
+			unbound = a;
+	}
+
+	/* at least one automatic arena must exist */
+	ASSERTne(least_used, NULL);
+
+	unsigned fair_share = nauto / heap->rt->nnuma_nodes;
+
+	/* prefer binding a new arena over sharing a busy local one */
+	if (local == NULL || (local->nthreads != 0 && unbound != NULL &&
+	    nlocal < fair_share)) {
+		if (unbound != NULL) {
+			unbound->numa_node = node;
+			local = unbound;
+		} else {
+			local = least_used;
+		}
+	}
+
+	LOG(4, "assigning %p arena (node %d) to current thread", local, node);
+
+	heap_arena_thread_attach(heap, local);
+
+	util_mutex_unlock(&heap->rt->arenas.lock);
+
+	return local;
+}
+
 /*
  * heap_thread_arena -- (internal) returns the arena assigned to the current
  *	thread
@@ -426,6 +675,10 @@ heap_thread_arena(struct palloc_heap *heap)
 			if ((arena = assignment->global) == NULL)
 				arena = heap_global_arena_assign(heap);
 			break;
+		case POBJ_ARENAS_ASSIGNMENT_NUMA:
+			if ((arena = os_tls_get(assignment->thread)) == NULL)
+				arena = heap_numa_arena_assign(heap);
+			break;
 		default: {
 			ASSERT(0); /* unreachable */
 		}
@@ -699,6 +952,7 @@ heap_run_into_free_chunk(struct palloc_heap *heap,
 	struct memory_block *m)
 {
 	struct chunk_header *hdr = heap_get_chunk_hdr(heap, m);
+	struct chunk_run *run = heap_get_chunk_run(heap, m);
 
 	m->block_off = 0;
 	m->size_idx = hdr->size_idx;
@@ -706,6 +960,12 @@ heap_run_into_free_chunk(struct palloc_heap *heap,
 	STATS_SUB(heap->stats, transient, heap_run_active,
 		m->size_idx * CHUNKSIZE);
 
+	struct alloc_class *c = alloc_class_by_run(
+		heap->rt->alloc_classes,
+		run->hdr.block_size, hdr->flags, m->size_idx);
+	if (c != NULL)
+		util_fetch_and_sub64(&heap->rt->class_occupancy[c->id].runs, 1);
+
 	/*
 	 * The only thing this could race with is heap_memblock_on_free()
 	 * because that function is called after processing the operation,
@@ -750,6 +1010,15 @@ heap_reclaim_run(struct palloc_heap *heap, struct memory_block *m, int startup)
 		return e.free_space == b.nbits;
 	}
 
+	/* empty runs are counted as well, they are removed as free chunks */
+	if (startup) {
+		struct heap_class_occupancy *o =
+			&heap->rt->class_occupancy[c->id];
+		util_fetch_and_add64(&o->runs, 1);
+		util_fetch_and_add64(&o->used,
+			c->rdsc.nallocs - e.free_space);
+	}
+
 	if (e.free_space == c->rdsc.nallocs)
 		return 1;
 
@@ -776,6 +1045,8 @@ heap_reclaim_zone_garbage(struct palloc_heap *heap, struct bucket *bucket,
 	uint32_t zone_id)
 {
 	struct zone *z = ZID_TO_ZONE(heap->layout, zone_id);
+	struct heap_class_occupancy *huge =
+		&heap->rt->class_occupancy[DEFAULT_ALLOC_CLASS_ID];
 
 	for (uint32_t i = 0; i < z->header.size_idx; ) {
 		struct chunk_header *hdr = &z->chunk_headers[i];
@@ -799,6 +1070,7 @@ heap_reclaim_zone_garbage(struct palloc_heap *heap, struct bucket *bucket,
 				heap_free_chunk_reuse(heap, bucket, &m);
 				break;
 			case CHUNK_TYPE_USED:
+				util_fetch_and_add64(&huge->used, m.size_idx);
 				break;
 			default:
 				ASSERT(0);
@@ -857,6 +1129,18 @@ heap_populate_bucket(struct palloc_heap *heap, struct bucket *bucket)
 			break;
 	}
 
+	/* prefer the zones local to the calling thread, if known */
+	if (h->zone_numa_map != NULL && zone_id != h->nzones) {
+		int node = heap_thread_numa_node();
+		for (unsigned z = zone_id; z < h->nzones; ++z) {
+			if (h->zone_reclaimed_map[z] == 0 &&
+			    h->zone_numa_map[z] == node) {
+				zone_id = z;
+				break;
+			}
+		}
+	}
+
 	/* at this point we are sure that there's no more memory in the heap */
 	if (zone_id == h->nzones)
 		return ENOMEM;
@@ -883,6 +1167,164 @@ heap_populate_bucket(struct palloc_heap *heap, struct bucket *bucket)
 	return 0;
 }
 
+/*
+ * A worker of the parallel zone reclaim, owns a contiguous range of zones
+ * and collects the free chunks found there in its own private bucket.
+ */
+struct heap_reclaim_worker {
+	struct palloc_heap *heap;
+	uint32_t zone_start;
+	uint32_t zone_end;
+	struct bucket_locked *bucket;
+	os_thread_t thread;
+	int running;
+};
+
+/*
+ * heap_reclaim_worker_run -- (internal) reclaims all the initialized zones
+ *	in the range owned by the worker
+ */
+static void *
+heap_reclaim_worker_run(void *arg)
+{
+	struct heap_reclaim_worker *w = arg;
+	struct palloc_heap *heap = w->heap;
+
+	struct bucket *b = bucket_acquire(w->bucket);
+
+	for (uint32_t zone_id = w->zone_start; zone_id < w->zone_end;
+			++zone_id) {
+		struct zone *z = ZID_TO_ZONE(heap->layout, zone_id);
+
+		/* uninitialized zones are left for heap_populate_bucket */
+		if (z->header.magic != ZONE_HEADER_MAGIC)
+			continue;
+
+		util_atomic_store_explicit32(
+			&heap->rt->zone_reclaimed_map[zone_id], 1,
+			memory_order_release);
+
+		/* ignore zone and chunk headers */
+		VALGRIND_ADD_TO_GLOBAL_TX_IGNORE(z, sizeof(z->header) +
+			sizeof(z->chunk_headers));
+
+		heap_reclaim_zone_garbage(heap, b, zone_id);
+	}
+
+	bucket_release(b);
+
+	return NULL;
+}
+
+/*
+ * heap_huge_container_new -- (internal) creates a container of the free
+ *	chunks of the type selected by the heap.huge_container entry point
+ */
+static struct block_container *
+heap_huge_container_new(struct palloc_heap *heap)
+{
+	switch (Default_huge_container) {
+	case POBJ_HUGE_CONTAINER_CRITNIB:
+		return container_new_critnib(heap);
+	default:
+		return container_new_ravl(heap);
+	}
+}
+
+/*
+ * heap_reclaim_zones_parallel -- (internal) reclaims all the initialized
+ *	zones of the heap using the given number of threads
+ *
+ * Each worker gathers the free chunks of its zones into a private bucket,
+ * which are then moved to the default bucket once all the workers are done.
+ * The runs are inserted directly into the recyclers, which are thread-safe.
+ * This is only an optimization of the lazy reclaim done on the allocation
+ * path, and so any failure here simply leaves the zones for later.
+ */
+static void
+heap_reclaim_zones_parallel(struct palloc_heap *heap, unsigned nthreads)
+{
+	struct heap_rt *h = heap->rt;
+
+	unsigned nworkers = MIN(nthreads, h->nzones);
+	if (nworkers == 0)
+		return;
+
+	struct heap_reclaim_worker *workers =
+		Zalloc(sizeof(*workers) * nworkers);
+	if (workers == NULL) {
+		LOG(2, "!failed to allocate parallel reclaim workers");
+		return;
+	}
+
+	struct alloc_class *c = alloc_class_by_id(h->alloc_classes,
+		DEFAULT_ALLOC_CLASS_ID);
+
+	uint32_t zones_per_worker = h->nzones / nworkers;
+	uint32_t zones_extra = h->nzones % nworkers;
+	uint32_t zone_id = 0;
+
+	unsigned i;
+	for (i = 0; i < nworkers; ++i) {
+		struct heap_reclaim_worker *w = &workers[i];
+		w->heap = heap;
+		w->zone_start = zone_id;
+		zone_id += zones_per_worker + (i < zones_extra ? 1 : 0);
+		w->zone_end = zone_id;
+
+		struct block_container *bc = heap_huge_container_new(heap);
+		if (bc == NULL)
+			goto error_bucket_create;
+
+		w->bucket = bucket_locked_new(bc, c);
+		if (w->bucket == NULL) {
+			bc->c_ops->destroy(bc);
+			goto error_bucket_create;
+		}
+	}
+	ASSERTeq(zone_id, h->nzones);
+
+	for (i = 1; i < nworkers; ++i) {
+		struct heap_reclaim_worker *w = &workers[i];
+		if (os_thread_create(&w->thread, NULL,
+				heap_reclaim_worker_run, w) == 0)
+			w->running = 1;
+		else
+			heap_reclaim_worker_run(w);
+	}
+
+	heap_reclaim_worker_run(&workers[0]);
+
+	for (i = 1; i < nworkers; ++i) {
+		if (workers[i].running)
+			os_thread_join(&workers[i].thread, NULL);
+	}
+
+	struct bucket *defb = bucket_acquire(h->default_bucket);
+	for (i = 0; i < nworkers; ++i) {
+		struct bucket *b = bucket_acquire(workers[i].bucket);
+
+		struct memory_block m = MEMORY_BLOCK_NONE;
+		m.size_idx = 1;
+		while (bucket_alloc_block(b, &m) == 0) {
+			bucket_insert_block(defb, &m);
+			m = MEMORY_BLOCK_NONE;
+			m.size_idx = 1;
+		}
+
+		bucket_release(b);
+	}
+	bucket_release(defb);
+
+	i = nworkers;
+
+error_bucket_create:
+	while (i-- > 0)
+		bucket_locked_delete(workers[i].bucket);
+
+	Free(workers);
+}
+
 /*
  * heap_recycle_unused -- recalculate scores in the recycler and turn any
  *	empty runs into free chunks
@@ -969,8 +1411,10 @@ heap_ensure_huge_bucket_filled(struct palloc_heap *heap,
 
 /*
  * heap_discard_run -- puts the memory block back into the global heap.
+ *
+ * Returns 1 if the run was empty and turned into a free chunk, 0 otherwise.
  */
-void
+int
 heap_discard_run(struct palloc_heap *heap, struct memory_block *m)
 {
 	if (heap_reclaim_run(heap, m, 0)) {
@@ -981,7 +1425,49 @@ heap_discard_run(struct palloc_heap *heap, struct memory_block *m)
 		heap_run_into_free_chunk(heap, b, m);
 
 		heap_bucket_release(b);
+
+		return 1;
+	}
+
+	return 0;
+}
+
+/*
+ * heap_get_sparse_run -- retrieves from the recyclers a run in which no more
+ *	than fill_pct percent of units are used, the classes are visited in
+ *	a round-robin fashion starting from the one at *class_id
+ *
+ * The run is no longer available for allocations, it has to be put back
+ * into the heap with heap_discard_run.
+ */
+int
+heap_get_sparse_run(struct palloc_heap *heap, unsigned fill_pct,
+	unsigned *class_id, struct memory_block *m)
+{
+	for (unsigned i = 0; i < MAX_ALLOCATION_CLASSES; ++i) {
+		unsigned id = (*class_id + i) % MAX_ALLOCATION_CLASSES;
+
+		struct recycler *r;
+		util_atomic_load_explicit64(&heap->rt->recyclers[id], &r,
+			memory_order_acquire);
+		if (r == NULL)
+			continue;
+
+		struct alloc_class *c = alloc_class_by_id(
+			heap->rt->alloc_classes, (uint8_t)id);
+		if (c == NULL || c->type != CLASS_RUN)
+			continue;
+
+		uint32_t max_used = c->rdsc.nallocs * fill_pct / 100;
+
+		*m = MEMORY_BLOCK_NONE;
+		if (recycler_get_sparse(r, max_used, m) == 0) {
+			*class_id = (id + 1) % MAX_ALLOCATION_CLASSES;
+			return 0;
+		}
 	}
+
+	return ENOMEM;
 }
 
 /*
@@ -1072,6 +1558,7 @@ heap_run_create(struct palloc_heap *heap, struct bucket *b,
 
 	STATS_INC(heap->stats, transient, heap_run_active,
 		m->size_idx * CHUNKSIZE);
+	util_fetch_and_add64(&heap->rt->class_occupancy[aclass->id].runs, 1);
 
 	return 0;
 }
@@ -1133,6 +1620,36 @@ out:
 	return ret;
 }
 
+/*
+ * heap_class_used_update -- (internal) accounts the units of the class which
+ *	were allocated or freed by the current thread
+ */
+static void
+heap_class_used_update(struct palloc_heap *heap, uint8_t class_id,
+	uint64_t units, int allocated)
+{
+	struct arenas_thread_assignment *assignment =
+		&heap->rt->arenas.assignment;
+	struct arena *arena;
+
+	/*
+	 * The arena is not assigned here, that would require the arenas lock,
+	 * the threads which never allocated use the global counters instead.
+	 */
+	if (assignment->type == POBJ_ARENAS_ASSIGNMENT_GLOBAL)
+		arena = assignment->global;
+	else
+		arena = os_tls_get(assignment->thread);
+
+	uint64_t *used = arena != NULL ? &arena->class_used[class_id] :
+		&heap->rt->class_occupancy[class_id].used;
+
+	if (allocated)
+		util_fetch_and_add64(used, units);
+	else
+		util_fetch_and_sub64(used, units);
+}
+
 /*
  * heap_memblock_on_free -- bookkeeping actions executed at every free of a
  *	block
@@ -1140,8 +1657,11 @@ out:
 void
 heap_memblock_on_free(struct palloc_heap *heap, const struct memory_block *m)
 {
-	if (m->type != MEMORY_BLOCK_RUN)
+	if (m->type != MEMORY_BLOCK_RUN) {
+		heap_class_used_update(heap, DEFAULT_ALLOC_CLASS_ID,
+			m->size_idx, 0);
 		return;
+	}
 
 	struct chunk_header *hdr = heap_get_chunk_hdr(heap, m);
 	struct chunk_run *run = heap_get_chunk_run(heap, m);
@@ -1155,6 +1675,8 @@ heap_memblock_on_free(struct palloc_heap *heap, const struct memory_block *m)
 	if (c == NULL)
 		return;
 
+	heap_class_used_update(heap, c->id, m->size_idx, 0);
+
 	struct recycler *recycler = heap_get_recycler(heap, c->id,
 		c->rdsc.nallocs);
 	if (recycler == NULL) {
@@ -1166,47 +1688,213 @@ heap_memblock_on_free(struct palloc_heap *heap, const struct memory_block *m)
 }
 
 /*
- * heap_split_block -- (internal) splits unused part of the memory block
+ * heap_free_chunks_update -- accounts the free chunks inserted into or
+ *	removed from a bucket of the huge allocation class
  */
-static void
-heap_split_block(struct palloc_heap *heap, struct bucket *b,
-		struct memory_block *m, uint32_t units)
+void
+heap_free_chunks_update(struct palloc_heap *heap,
+	const struct memory_block *m, int inserted)
 {
-	struct alloc_class *aclass = bucket_alloc_class(b);
-	ASSERT(units <= UINT16_MAX);
-	ASSERT(units > 0);
+	struct heap_zone_occupancy *o = &heap->rt->zone_occupancy[m->zone_id];
+	unsigned bucket = MIN(util_mssb_index(m->size_idx),
+		POBJ_ZONE_STATS_NBUCKETS - 1);
 
-	if (aclass->type == CLASS_RUN) {
-		ASSERT((uint64_t)m->block_off + (uint64_t)units <= UINT32_MAX);
-		struct memory_block r = {m->chunk_id, m->zone_id,
-			m->size_idx - units, (uint32_t)(m->block_off + units),
-			NULL, NULL, 0, 0, NULL};
-		memblock_rebuild_state(heap, &r);
-		if (bucket_insert_block(b, &r) != 0)
-			LOG(2,
-				"failed to allocate memory block runtime tracking info");
+	if (inserted) {
+		util_fetch_and_add64(&o->free_chunks, m->size_idx);
+		util_fetch_and_add64(&o->extents[bucket], 1);
 	} else {
-		uint32_t new_chunk_id = m->chunk_id + units;
-		uint32_t new_size_idx = m->size_idx - units;
-
-		struct memory_block n = memblock_huge_init(heap,
-			new_chunk_id, m->zone_id, new_size_idx);
-
-		*m = memblock_huge_init(heap, m->chunk_id, m->zone_id, units);
-
-		if (bucket_insert_block(b, &n) != 0)
-			LOG(2,
-				"failed to allocate memory block runtime tracking info");
+		util_fetch_and_sub64(&o->free_chunks, m->size_idx);
+		util_fetch_and_sub64(&o->extents[bucket], 1);
 	}
-
-	m->size_idx = units;
 }
 
 /*
- * heap_get_bestfit_block --
- *	extracts a memory block of equal size index
+ * heap_class_occupancy_update -- accounts the memory block which was
+ *	allocated
  */
-int
+void
+heap_class_occupancy_update(struct palloc_heap *heap,
+	const struct memory_block *m)
+{
+	if (m->type == MEMORY_BLOCK_HUGE) {
+		heap_class_used_update(heap, DEFAULT_ALLOC_CLASS_ID,
+			m->size_idx, 1);
+		return;
+	}
+
+	struct chunk_header *hdr = heap_get_chunk_hdr(heap, m);
+	struct chunk_run *run = heap_get_chunk_run(heap, m);
+
+	struct alloc_class *c = alloc_class_by_run(
+		heap->rt->alloc_classes,
+		run->hdr.block_size, hdr->flags, hdr->size_idx);
+	if (c != NULL)
+		heap_class_used_update(heap, c->id, m->size_idx, 1);
+}
+
+/*
+ * heap_get_class_occupancy -- reads the occupancy of the allocation class
+ *
+ * Only the runs and the chunks of the zones which were already reclaimed
+ * are accounted.
+ */
+int
+heap_get_class_occupancy(struct palloc_heap *heap, unsigned class_id,
+	struct pobj_alloc_class_stats *out)
+{
+	struct alloc_class *c = alloc_class_by_id(heap->rt->alloc_classes,
+		(uint8_t)class_id);
+	if (c == NULL)
+		return -1;
+
+	/* all the huge classes share the chunks of the heap */
+	uint8_t id = c->type == CLASS_HUGE ? DEFAULT_ALLOC_CLASS_ID : c->id;
+	struct heap_class_occupancy *o = &heap->rt->class_occupancy[id];
+	uint64_t used;
+	util_atomic_load_explicit64(&o->used, &used, memory_order_relaxed);
+
+	/* the counters of the arenas wrap around, only their sum is valid */
+	util_mutex_lock(&heap->rt->arenas.lock);
+	struct arena *arena;
+	VEC_FOREACH(arena, &heap->rt->arenas.vec) {
+		uint64_t n;
+		util_atomic_load_explicit64(&arena->class_used[id], &n,
+			memory_order_relaxed);
+		used += n;
+	}
+	util_mutex_unlock(&heap->rt->arenas.lock);
+
+	uint64_t free = 0;
+	if (c->type == CLASS_HUGE) {
+		out->runs = 0;
+		for (unsigned z = 0; z < heap->rt->nzones; ++z) {
+			uint64_t n;
+			util_atomic_load_explicit64(
+				&heap->rt->zone_occupancy[z].free_chunks, &n,
+				memory_order_relaxed);
+			free += n;
+		}
+	} else {
+		util_atomic_load_explicit64(&o->runs, &out->runs,
+			memory_order_relaxed);
+		uint64_t total = out->runs * c->rdsc.nallocs;
+
+		/* the counters are not read atomically as a whole */
+		free = total > used ? total - used : 0;
+	}
+
+	out->used_blocks = used;
+	out->free_blocks = free;
+	out->fill_pct = used + free == 0 ? 0 :
+		(unsigned)(used * 100 / (used + free));
+
+	return 0;
+}
+
+/*
+ * heap_get_zone_occupancy -- reads the free chunks of the zone, reclaiming
+ *	the zone if it wasn't used yet
+ */
+int
+heap_get_zone_occupancy(struct palloc_heap *heap, unsigned zone_id,
+	struct pobj_zone_stats *out)
+{
+	if (zone_id >= heap->rt->nzones)
+		return -1;
+
+	heap_ensure_zone_reclaimed(heap, zone_id);
+
+	struct zone *z = ZID_TO_ZONE(heap->layout, zone_id);
+	struct heap_zone_occupancy *o = &heap->rt->zone_occupancy[zone_id];
+
+	out->chunks = z->header.size_idx;
+	util_atomic_load_explicit64(&o->free_chunks, &out->free_chunks,
+		memory_order_relaxed);
+
+	out->free_extents = 0;
+	for (unsigned i = 0; i < POBJ_ZONE_STATS_NBUCKETS; ++i) {
+		util_atomic_load_explicit64(&o->extents[i], &out->extents[i],
+			memory_order_relaxed);
+		out->free_extents += out->extents[i];
+	}
+
+	return 0;
+}
+
+/*
+ * heap_get_nzones -- returns the number of zones of the heap
+ */
+unsigned
+heap_get_nzones(struct palloc_heap *heap)
+{
+	return heap->rt->nzones;
+}
+
+/*
+ * heap_split_block -- (internal) splits unused part of the memory block
+ */
+static void
+heap_split_block(struct palloc_heap *heap, struct bucket *b,
+		struct memory_block *m, uint32_t units)
+{
+	struct alloc_class *aclass = bucket_alloc_class(b);
+	ASSERT(units <= UINT16_MAX);
+	ASSERT(units > 0);
+
+	if (aclass->type == CLASS_RUN) {
+		ASSERT((uint64_t)m->block_off + (uint64_t)units <= UINT32_MAX);
+		struct memory_block r = {m->chunk_id, m->zone_id,
+			m->size_idx - units, (uint32_t)(m->block_off + units),
+			NULL, NULL, 0, 0, NULL};
+		memblock_rebuild_state(heap, &r);
+		if (bucket_insert_block(b, &r) != 0)
+			LOG(2,
+				"failed to allocate memory block runtime tracking info");
+	} else {
+		uint32_t new_chunk_id = m->chunk_id + units;
+		uint32_t new_size_idx = m->size_idx - units;
+
+		struct memory_block n = memblock_huge_init(heap,
+			new_chunk_id, m->zone_id, new_size_idx);
+
+		*m = memblock_huge_init(heap, m->chunk_id, m->zone_id, units);
+
+		if (bucket_insert_block(b, &n) != 0)
+			LOG(2,
+				"failed to allocate memory block runtime tracking info");
+	}
+
+	m->size_idx = units;
+}
+
+/*
+ * heap_prep_bestfit_block -- (internal) trims the block extracted from the
+ *	bucket to the requested size and sets its header type
+ */
+static void
+heap_prep_bestfit_block(struct palloc_heap *heap, struct bucket *b,
+	struct memory_block *m, uint32_t units)
+{
+	struct alloc_class *aclass = bucket_alloc_class(b);
+
+	ASSERT(m->size_idx >= units);
+
+	if (units != m->size_idx)
+		heap_split_block(heap, b, m, units);
+
+	/* the chunk might have been used by a block with aligned data */
+	if (aclass->type == CLASS_HUGE)
+		memblock_huge_set_aligned(m, 0);
+
+	m->m_ops->ensure_header_type(m, aclass->header_type);
+	m->header_type = aclass->header_type;
+}
+
+/*
+ * heap_get_bestfit_block --
+ *	extracts a memory block of equal size index
+ */
+int
 heap_get_bestfit_block(struct palloc_heap *heap, struct bucket *b,
 	struct memory_block *m)
 {
@@ -1223,15 +1911,505 @@ heap_get_bestfit_block(struct palloc_heap *heap, struct bucket *b,
 		}
 	}
 
-	ASSERT(m->size_idx >= units);
+	heap_prep_bestfit_block(heap, b, m, units);
 
-	if (units != m->size_idx)
-		heap_split_block(heap, b, m, units);
+	return 0;
+}
+
+/*
+ * heap_huge_align_padding -- (internal) returns the padding of huge blocks
+ *	with aligned data, or SIZE_MAX if their data cannot be aligned in
+ *	the current mapping of the heap
+ *
+ * The padding is the same for all the chunks of the heap, because both the
+ * zones and the chunks are multiples of the chunk size.
+ */
+static size_t
+heap_huge_align_padding(struct palloc_heap *heap, enum header_type t)
+{
+	struct memory_block m = MEMORY_BLOCK_NONE;
+	m.heap = heap;
+	m.header_type = t;
+
+	size_t hsize = header_type_to_size[t];
+	size_t padding = memblock_huge_padding(&m);
+
+	/* the user data must begin in the first chunk of the block... */
+	if (padding + hsize >= CHUNKSIZE)
+		return SIZE_MAX;
+
+	/* ... and be aligned to the chunk size also in the address space */
+	uintptr_t data = (uintptr_t)heap_get_chunk(heap, &m)->data +
+		padding + hsize;
+	if (data % CHUNKSIZE != 0)
+		return SIZE_MAX;
+
+	return padding;
+}
+
+/*
+ * heap_get_aligned_huge_block -- extracts a huge memory block whose user data
+ *	is aligned to the given multiple of the chunk size, falls back to
+ *	the best-fit block if there's no free block which could be aligned
+ *
+ * A free block which is big enough to satisfy the request regardless of its
+ * placement is taken from the bucket, and the chunks before and after
+ * the aligned part of the block are put back.
+ */
+int
+heap_get_aligned_huge_block(struct palloc_heap *heap, struct bucket *b,
+	struct memory_block *m, size_t alignment)
+{
+	struct alloc_class *aclass = bucket_alloc_class(b);
+	ASSERTeq(aclass->type, CLASS_HUGE);
+	ASSERTeq(alignment % CHUNKSIZE, 0);
+
+	uint32_t units = m->size_idx;
+
+	/* the older versions would misplace the data of aligned blocks */
+	if (!heap->huge_align)
+		goto fallback;
+
+	size_t padding = heap_huge_align_padding(heap, aclass->header_type);
+	if (padding == SIZE_MAX)
+		goto fallback;
+
+	/* the padding might not fit in the slack of the last chunk */
+	uint32_t aligned_units = units + (padding != 0);
+	uint64_t slack = alignment / CHUNKSIZE - 1;
+	if (aligned_units + slack > MAX_CHUNK)
+		goto fallback;
 
+	m->size_idx = (uint32_t)(aligned_units + slack);
+	while (bucket_alloc_block(b, m) != 0) {
+		if (heap_ensure_huge_bucket_filled(heap, b) != 0)
+			goto fallback;
+	}
+
+	size_t hsize = header_type_to_size[aclass->header_type];
+	uintptr_t data = (uintptr_t)heap_get_chunk(heap, m)->data +
+		padding + hsize;
+	uint32_t skip = (uint32_t)((ALIGN_UP(data, alignment) - data) /
+		CHUNKSIZE);
+	ASSERT(skip <= slack);
+
+	uint32_t chunk_id = m->chunk_id;
+	uint32_t zone_id = m->zone_id;
+	uint32_t rest = m->size_idx - skip - aligned_units;
+
+	struct memory_block n;
+	if (skip != 0) {
+		n = memblock_huge_init(heap, chunk_id, zone_id, skip);
+		if (bucket_insert_block(b, &n) != 0)
+			LOG(2,
+				"failed to allocate memory block runtime tracking info");
+	}
+
+	if (rest != 0) {
+		n = memblock_huge_init(heap, chunk_id + skip + aligned_units,
+			zone_id, rest);
+		if (bucket_insert_block(b, &n) != 0)
+			LOG(2,
+				"failed to allocate memory block runtime tracking info");
+	}
+
+	*m = memblock_huge_init(heap, chunk_id + skip, zone_id, aligned_units);
 	m->m_ops->ensure_header_type(m, aclass->header_type);
 	m->header_type = aclass->header_type;
+	memblock_huge_set_aligned(m, 1);
 
 	return 0;
+
+fallback:
+	STATS_INC(heap->stats, transient, heap_huge_align_fallbacks, 1);
+
+	*m = MEMORY_BLOCK_NONE;
+	m->size_idx = units;
+
+	return heap_get_bestfit_block(heap, b, m);
+}
+
+/*
+ * heap_thread_cache_bin_refill -- (internal) reserves a batch of single-unit
+ *	blocks from the thread's arena bucket of the given class
+ *
+ * Only the first block is allowed to refill the bucket, the rest of the batch
+ * is carved out of whatever is left in the bucket. This way the cache never
+ * forces the active run to be detached just to fill up the magazine.
+ */
+static int
+heap_thread_cache_bin_refill(struct palloc_heap *heap,
+	struct alloc_class *c, struct heap_thread_cache_bin *bin)
+{
+	unsigned batch = heap->rt->tcaches.bin_size;
+	ASSERT(batch <= HEAP_THREAD_CACHE_BIN_SIZE_MAX);
+	ASSERTeq(bin->nentries, 0);
+
+	struct bucket *b = heap_bucket_acquire(heap, c->id,
+		HEAP_ARENA_PER_THREAD);
+
+	unsigned n;
+	for (n = 0; n < batch; ++n) {
+		struct heap_thread_cache_entry *e = &bin->entries[n];
+		e->m = MEMORY_BLOCK_NONE;
+		e->m.size_idx = 1;
+
+		if (n == 0) {
+			if (heap_get_bestfit_block(heap, b, &e->m) != 0)
+				break;
+		} else {
+			if (bucket_alloc_block(b, &e->m) != 0)
+				break;
+			heap_prep_bestfit_block(heap, b, &e->m, 1);
+		}
+
+		if ((e->mresv = bucket_active_block(b)) != NULL)
+			util_fetch_and_add64(&e->mresv->nresv, 1);
+	}
+
+	heap_bucket_release(b);
+
+	/*
+	 * Blocks are handed out from the top of the bin, reverse the batch so
+	 * that consecutive allocations are served in address order.
+	 */
+	for (unsigned i = 0; i < n / 2; ++i) {
+		struct heap_thread_cache_entry tmp = bin->entries[i];
+		bin->entries[i] = bin->entries[n - i - 1];
+		bin->entries[n - i - 1] = tmp;
+	}
+	bin->nentries = n;
+
+	return n == 0 ? ENOMEM : 0;
+}
+
+/*
+ * heap_thread_cache_bin_drain -- (internal) gives the cached blocks back to
+ *	their buckets and drops the associated run reservations
+ *
+ * If reclaim is not set, the runtime state of the heap is about to be
+ * destroyed and only the transient tracking information is released.
+ */
+static void
+heap_thread_cache_bin_drain(struct palloc_heap *heap,
+	struct heap_thread_cache_bin *bin, int reclaim)
+{
+	struct heap_thread_cache_entry *e;
+
+	if (reclaim) {
+		struct bucket_locked *locked = NULL;
+		struct bucket *b = NULL;
+		for (unsigned i = 0; i < bin->nentries; ++i) {
+			e = &bin->entries[i];
+			if (e->mresv == NULL)
+				continue;
+
+			if (locked != e->mresv->bucket) {
+				if (b != NULL)
+					bucket_release(b);
+				locked = e->mresv->bucket;
+				b = bucket_acquire(locked);
+			}
+			bucket_try_insert_attached_block(b, &e->m);
+		}
+		if (b != NULL)
+			bucket_release(b);
+	}
+
+	for (unsigned i = 0; i < bin->nentries; ++i) {
+		e = &bin->entries[i];
+		if (e->mresv == NULL)
+			continue;
+
+		struct memory_block_reserved *mresv = e->mresv;
+		if (util_fetch_and_sub64(&mresv->nresv, 1) == 1) {
+			VALGRIND_ANNOTATE_HAPPENS_AFTER(&mresv->nresv);
+			if (reclaim)
+				heap_discard_run(heap, &mresv->m);
+			Free(mresv);
+		} else {
+			VALGRIND_ANNOTATE_HAPPENS_BEFORE(&mresv->nresv);
+		}
+	}
+
+	bin->nentries = 0;
+}
+
+/*
+ * heap_thread_cache_drain -- (internal) empties all bins of the thread cache
+ */
+static void
+heap_thread_cache_drain(struct heap_thread_cache *cache, int reclaim)
+{
+	for (int i = 0; i < MAX_ALLOCATION_CLASSES; ++i) {
+		if (cache->bins[i] != NULL)
+			heap_thread_cache_bin_drain(cache->heap,
+				cache->bins[i], reclaim);
+	}
+}
+
+/*
+ * heap_thread_cache_delete -- (internal) drains and deallocates the cache
+ *
+ * Must be called with thread caches lock taken.
+ */
+static void
+heap_thread_cache_delete(struct heap_thread_cache *cache, int reclaim)
+{
+	heap_thread_cache_drain(cache, reclaim);
+
+	PMDK_LIST_REMOVE(cache, entry);
+
+	for (int i = 0; i < MAX_ALLOCATION_CLASSES; ++i)
+		Free(cache->bins[i]);
+	Free(cache);
+}
+
+/*
+ * heap_thread_cache_destructor -- (internal) returns the cached blocks back
+ *	to the heap when the thread exits
+ */
+static void
+heap_thread_cache_destructor(void *arg)
+{
+	struct heap_thread_cache *cache = arg;
+	struct heap_thread_caches *tcaches = &cache->heap->rt->tcaches;
+
+	util_mutex_lock(&tcaches->lock);
+	heap_thread_cache_delete(cache, 1 /* reclaim */);
+	util_mutex_unlock(&tcaches->lock);
+}
+
+/*
+ * heap_thread_cache_new -- (internal) creates the cache of the current thread
+ */
+static struct heap_thread_cache *
+heap_thread_cache_new(struct palloc_heap *heap)
+{
+	struct heap_thread_caches *tcaches = &heap->rt->tcaches;
+
+	struct heap_thread_cache *cache = Zalloc(sizeof(*cache));
+	if (cache == NULL)
+		return NULL;
+
+	cache->heap = heap;
+
+	util_mutex_lock(&tcaches->lock);
+	PMDK_LIST_INSERT_HEAD(&tcaches->caches, cache, entry);
+	util_mutex_unlock(&tcaches->lock);
+
+	os_tls_set(tcaches->key, cache);
+
+	return cache;
+}
+
+/*
+ * heap_thread_cache_get -- takes a single-unit block of the given class out
+ *	of the calling thread's cache, refilling the cache from the arena if
+ *	needed
+ *
+ * Returns 0 on success. Non-zero means that the allocation needs to be
+ * served directly from the buckets.
+ */
+int
+heap_thread_cache_get(struct palloc_heap *heap, struct alloc_class *c,
+	struct memory_block *m, struct memory_block_reserved **mresv)
+{
+	struct heap_thread_caches *tcaches = &heap->rt->tcaches;
+
+	int enabled;
+	util_atomic_load_explicit32(&tcaches->enabled, &enabled,
+		memory_order_acquire);
+	if (!enabled || c->type != CLASS_RUN ||
+	    c->unit_size > tcaches->max_size)
+		return -1;
+
+	struct heap_thread_cache *cache = os_tls_get(tcaches->key);
+	if (cache == NULL && (cache = heap_thread_cache_new(heap)) == NULL)
+		return -1;
+
+	struct heap_thread_cache_bin *bin = cache->bins[c->id];
+	if (bin == NULL) {
+		if ((bin = Malloc(sizeof(*bin))) == NULL)
+			return -1;
+		bin->nentries = 0;
+		cache->bins[c->id] = bin;
+	}
+
+	if (bin->nentries == 0 &&
+	    heap_thread_cache_bin_refill(heap, c, bin) != 0)
+		return -1;
+
+	struct heap_thread_cache_entry *e = &bin->entries[--bin->nentries];
+	*m = e->m;
+	*mresv = e->mresv;
+
+	return 0;
+}
+
+/*
+ * heap_thread_cache_put -- returns a block obtained from
+ *	heap_thread_cache_get back to the calling thread's cache
+ */
+void
+heap_thread_cache_put(struct palloc_heap *heap, struct alloc_class *c,
+	const struct memory_block *m, struct memory_block_reserved *mresv)
+{
+	struct heap_thread_cache *cache =
+		os_tls_get(heap->rt->tcaches.key);
+	ASSERTne(cache, NULL);
+
+	struct heap_thread_cache_bin *bin = cache->bins[c->id];
+	ASSERTne(bin, NULL);
+	ASSERT(bin->nentries < HEAP_THREAD_CACHE_BIN_SIZE_MAX);
+
+	struct heap_thread_cache_entry *e = &bin->entries[bin->nentries++];
+	e->m = *m;
+	e->mresv = mresv;
+}
+
+/*
+ * heap_thread_cache_flush -- returns all blocks cached by the calling thread
+ *	back to the heap
+ */
+void
+heap_thread_cache_flush(struct palloc_heap *heap)
+{
+	struct heap_thread_caches *tcaches = &heap->rt->tcaches;
+
+	util_mutex_lock(&tcaches->lock);
+	if (tcaches->key_created) {
+		struct heap_thread_cache *cache = os_tls_get(tcaches->key);
+		if (cache != NULL)
+			heap_thread_cache_drain(cache, 1 /* reclaim */);
+	}
+	util_mutex_unlock(&tcaches->lock);
+}
+
+/*
+ * heap_get_thread_cache_enabled -- returns whether the thread caches are used
+ */
+int
+heap_get_thread_cache_enabled(struct palloc_heap *heap)
+{
+	return heap->rt->tcaches.enabled;
+}
+
+/*
+ * heap_set_thread_cache_enabled -- enables or disables the thread caches
+ *
+ * Disabling the caches does not release the blocks that are already cached,
+ * those are given back when the owning thread exits, flushes its cache or
+ * when the pool is closed.
+ */
+int
+heap_set_thread_cache_enabled(struct palloc_heap *heap, int enabled)
+{
+	struct heap_thread_caches *tcaches = &heap->rt->tcaches;
+	int ret = 0;
+
+	util_mutex_lock(&tcaches->lock);
+	if (enabled && !tcaches->key_created) {
+		if ((ret = os_tls_key_create(&tcaches->key,
+				heap_thread_cache_destructor)) != 0) {
+			errno = ret;
+			ERR("!os_tls_key_create");
+			ret = -1;
+			goto out;
+		}
+		tcaches->key_created = 1;
+	}
+
+	util_atomic_store_explicit32(&tcaches->enabled, enabled,
+		memory_order_release);
+
+out:
+	util_mutex_unlock(&tcaches->lock);
+	return ret;
+}
+
+/*
+ * heap_get_thread_cache_bin_size -- returns the number of blocks reserved
+ *	per allocation class in a single thread cache refill
+ */
+unsigned
+heap_get_thread_cache_bin_size(struct palloc_heap *heap)
+{
+	return heap->rt->tcaches.bin_size;
+}
+
+/*
+ * heap_set_thread_cache_bin_size -- changes the number of blocks reserved
+ *	per allocation class in a single thread cache refill
+ */
+int
+heap_set_thread_cache_bin_size(struct palloc_heap *heap, unsigned bin_size)
+{
+	if (bin_size == 0 || bin_size > HEAP_THREAD_CACHE_BIN_SIZE_MAX) {
+		ERR("thread cache bin size must be in range <1,%u>",
+			HEAP_THREAD_CACHE_BIN_SIZE_MAX);
+		errno = EINVAL;
+		return -1;
+	}
+
+	heap->rt->tcaches.bin_size = bin_size;
+
+	return 0;
+}
+
+/*
+ * heap_get_thread_cache_max_size -- returns the largest unit size of
+ *	an allocation class that can be served from the thread caches
+ */
+size_t
+heap_get_thread_cache_max_size(struct palloc_heap *heap)
+{
+	return heap->rt->tcaches.max_size;
+}
+
+/*
+ * heap_set_thread_cache_max_size -- changes the largest unit size of
+ *	an allocation class that can be served from the thread caches
+ */
+void
+heap_set_thread_cache_max_size(struct palloc_heap *heap, size_t max_size)
+{
+	heap->rt->tcaches.max_size = max_size;
+}
+
+/*
+ * heap_thread_caches_init -- (internal) initializes the thread caches state
+ */
+static void
+heap_thread_caches_init(struct heap_thread_caches *tcaches)
+{
+	tcaches->enabled = 0;
+	tcaches->bin_size = HEAP_THREAD_CACHE_DEFAULT_BIN_SIZE;
+	tcaches->max_size = HEAP_THREAD_CACHE_DEFAULT_MAX_SIZE;
+	tcaches->key_created = 0;
+	util_mutex_init(&tcaches->lock);
+	PMDK_LIST_INIT(&tcaches->caches);
+}
+
+/*
+ * heap_thread_caches_fini -- (internal) releases all the thread caches
+ *
+ * The caches of all threads are released here because, once the heap is
+ * gone, the thread destructors are no longer able to do it.
+ */
+static void
+heap_thread_caches_fini(struct heap_thread_caches *tcaches)
+{
+	util_mutex_lock(&tcaches->lock);
+	while (!PMDK_LIST_EMPTY(&tcaches->caches))
+		heap_thread_cache_delete(PMDK_LIST_FIRST(&tcaches->caches),
+			0 /* reclaim */);
+	util_mutex_unlock(&tcaches->lock);
+
+	if (tcaches->key_created)
+		os_tls_key_delete(tcaches->key);
+
+	util_mutex_destroy(&tcaches->lock);
 }
 
 /*
@@ -1380,6 +2558,20 @@ heap_get_arena_auto(struct palloc_heap *heap, unsigned arena_id)
 	return a->automatic;
 }
 
+/*
+ * heap_get_arena_numa_node -- returns the numa node the arena is bound to
+ */
+int
+heap_get_arena_numa_node(struct palloc_heap *heap, unsigned arena_id)
+{
+	util_mutex_lock(&heap->rt->arenas.lock);
+	struct arena *a = heap_get_arena_by_id(heap, arena_id);
+	int numa_node = a->numa_node;
+	util_mutex_unlock(&heap->rt->arenas.lock);
+
+	return numa_node;
+}
+
 /*
  * heap_set_arena_auto -- sets arena automatic value
  */
@@ -1486,12 +2678,19 @@ heap_buckets_init(struct palloc_heap *heap)
 		}
 	}
 
-	h->default_bucket = bucket_locked_new(container_new_ravl(heap),
+	struct block_container *bc = h->zone_numa_map != NULL ?
+		container_new_numa(heap, heap_huge_container_new) :
+		heap_huge_container_new(heap);
+
+	h->default_bucket = bucket_locked_new(bc,
 		alloc_class_by_id(h->alloc_classes, DEFAULT_ALLOC_CLASS_ID));
 
 	if (h->default_bucket == NULL)
 		goto error_bucket_create;
 
+	if (Default_parallel_reclaim != 0)
+		heap_reclaim_zones_parallel(heap, Default_parallel_reclaim);
+
 	return 0;
 
 error_bucket_create: {
@@ -1532,6 +2731,10 @@ heap_extend(struct palloc_heap *heap, struct bucket *b, size_t size)
 	uint32_t chunk_id = heap->rt->nzones == nzones ? z->header.size_idx : 0;
 	heap_zone_init(heap, zone_id, chunk_id);
 
+	if (heap->rt->zone_numa_map != NULL)
+		heap->rt->zone_numa_map[zone_id] =
+			heap_zone_numa_lookup(heap, zone_id);
+
 	if (heap->rt->nzones != nzones) {
 		heap->rt->nzones = nzones;
 		return 0;
@@ -1613,6 +2816,25 @@ heap_boot(struct palloc_heap *heap, void *heap_start, uint64_t heap_size,
 		goto err_reclaimed_map_malloc;
 	}
 
+	memset(h->class_occupancy, 0, sizeof(h->class_occupancy));
+	h->zone_occupancy = Zalloc(sizeof(struct heap_zone_occupancy) *
+		h->nzones);
+	if (h->zone_occupancy == NULL) {
+		err = ENOMEM;
+		goto err_zone_occupancy_malloc;
+	}
+
+	h->zone_numa_map = NULL;
+	h->part_numa_map = NULL;
+	h->npart_numa_map = 0;
+	if (Default_arenas_assignment_type == POBJ_ARENAS_ASSIGNMENT_NUMA) {
+		h->zone_numa_map = Malloc(sizeof(int) * h->nzones);
+		if (h->zone_numa_map == NULL) {
+			err = ENOMEM;
+			goto err_numa_map_malloc;
+		}
+	}
+
 	if ((err = arena_thread_assignment_init(&h->arenas.assignment,
 		Default_arenas_assignment_type)) != 0) {
 		goto error_assignment_init;
@@ -1647,6 +2869,26 @@ heap_boot(struct palloc_heap *heap, void *heap_start, uint64_t heap_size,
 	heap->alloc_pattern = PALLOC_CTL_DEBUG_NO_PATTERN;
 	VALGRIND_DO_CREATE_MEMPOOL(heap->layout, 0, 0);
 
+	h->nnuma_nodes = 1;
+	if (h->zone_numa_map != NULL) {
+		unsigned nnodes = 0;
+		for (uint32_t i = 0; i < h->nzones; ++i) {
+			int node = heap_zone_numa_lookup(heap, i);
+			h->zone_numa_map[i] = node;
+
+			/* count the distinct nodes */
+			uint32_t j;
+			for (j = 0; j < i; ++j) {
+				if (h->zone_numa_map[j] == node)
+					break;
+			}
+			if (node >= 0 && j == i)
+				nnodes++;
+		}
+		if (nnodes > 1)
+			h->nnuma_nodes = nnodes;
+	}
+
 	for (unsigned i = 0; i < narenas_default; ++i) {
 		if (VEC_PUSH_BACK(&h->arenas.vec, heap_arena_new(heap, 1))) {
 			err = errno;
@@ -1657,6 +2899,8 @@ heap_boot(struct palloc_heap *heap, void *heap_start, uint64_t heap_size,
 	for (unsigned i = 0; i < MAX_ALLOCATION_CLASSES; ++i)
 		h->recyclers[i] = NULL;
 
+	heap_thread_caches_init(&h->tcaches);
+
 	heap_zone_update_if_needed(heap);
 
 	return 0;
@@ -1668,6 +2912,11 @@ error_arenas_malloc:
 error_alloc_classes_new:
 	arena_thread_assignment_fini(&h->arenas.assignment);
 error_assignment_init:
+	Free(h->part_numa_map);
+	Free(h->zone_numa_map);
+err_numa_map_malloc:
+	Free(h->zone_occupancy);
+err_zone_occupancy_malloc:
 	Free(h->zone_reclaimed_map);
 err_reclaimed_map_malloc:
 	Free(h);
@@ -1742,6 +2991,8 @@ heap_cleanup(struct palloc_heap *heap)
 {
 	struct heap_rt *rt = heap->rt;
 
+	heap_thread_caches_fini(&rt->tcaches);
+
 	alloc_class_collection_delete(rt->alloc_classes);
 
 	arena_thread_assignment_fini(&rt->arenas.assignment);
@@ -1765,6 +3016,9 @@ heap_cleanup(struct palloc_heap *heap)
 
 	VALGRIND_DO_DESTROY_MEMPOOL(heap->layout);
 
+	Free(rt->part_numa_map);
+	Free(rt->zone_numa_map);
+	Free(rt->zone_occupancy);
 	Free(rt->zone_reclaimed_map);
 	Free(rt);
 	heap->rt = NULL;
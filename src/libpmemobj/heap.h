@@ -23,6 +23,9 @@ extern "C" {
 
 extern enum pobj_arenas_assignment_type Default_arenas_assignment_type;
 extern size_t Default_arenas_max;
+extern unsigned Default_parallel_reclaim;
+extern enum pobj_huge_container_type Default_huge_container;
+extern int Default_huge_align;
 
 #define HEAP_OFF_TO_PTR(heap, off) ((void *)((char *)((heap)->base) + (off)))
 #define HEAP_PTR_TO_OFF(heap, ptr)\
@@ -31,6 +34,10 @@ extern size_t Default_arenas_max;
 #define BIT_IS_CLR(a, i)	(!((a) & (1ULL << (i))))
 #define HEAP_ARENA_PER_THREAD (0)
 
+#define HEAP_THREAD_CACHE_BIN_SIZE_MAX 64
+#define HEAP_THREAD_CACHE_DEFAULT_BIN_SIZE 16
+#define HEAP_THREAD_CACHE_DEFAULT_MAX_SIZE 1024
+
 int heap_boot(struct palloc_heap *heap, void *heap_start, uint64_t heap_size,
 		uint64_t *sizep,
 		void *base, struct pmem_ops *p_ops,
@@ -59,21 +66,42 @@ heap_bucket_release(struct bucket *b);
 
 int heap_get_bestfit_block(struct palloc_heap *heap, struct bucket *b,
 	struct memory_block *m);
+int heap_get_aligned_huge_block(struct palloc_heap *heap, struct bucket *b,
+	struct memory_block *m, size_t alignment);
 os_mutex_t *heap_get_run_lock(struct palloc_heap *heap,
 		uint32_t chunk_id);
 
 void
 heap_force_recycle(struct palloc_heap *heap);
 
-void
+int
 heap_discard_run(struct palloc_heap *heap, struct memory_block *m);
 
+int heap_get_sparse_run(struct palloc_heap *heap, unsigned fill_pct,
+	unsigned *class_id, struct memory_block *m);
+
 void
 heap_memblock_on_free(struct palloc_heap *heap, const struct memory_block *m);
 
 void
 heap_ensure_zone_reclaimed(struct palloc_heap *heap, uint32_t zone_id);
 
+struct pobj_alloc_class_stats;
+struct pobj_zone_stats;
+
+void heap_free_chunks_update(struct palloc_heap *heap,
+	const struct memory_block *m, int inserted);
+void heap_class_occupancy_update(struct palloc_heap *heap,
+	const struct memory_block *m);
+int heap_get_class_occupancy(struct palloc_heap *heap, unsigned class_id,
+	struct pobj_alloc_class_stats *out);
+int heap_get_zone_occupancy(struct palloc_heap *heap, unsigned zone_id,
+	struct pobj_zone_stats *out);
+unsigned heap_get_nzones(struct palloc_heap *heap);
+
+int heap_thread_numa_node(void);
+int heap_zone_numa_node(struct palloc_heap *heap, uint32_t zone_id);
+
 int
 heap_free_chunk_reuse(struct palloc_heap *heap,
 	struct bucket *bucket, struct memory_block *m);
@@ -101,6 +129,7 @@ struct bucket_locked **
 heap_get_arena_buckets(struct palloc_heap *heap, unsigned arena_id);
 
 int heap_get_arena_auto(struct palloc_heap *heap, unsigned arena_id);
+int heap_get_arena_numa_node(struct palloc_heap *heap, unsigned arena_id);
 
 int heap_set_arena_auto(struct palloc_heap *heap, unsigned arena_id,
 		int automatic);
@@ -109,6 +138,28 @@ void heap_set_arena_thread(struct palloc_heap *heap, unsigned arena_id);
 
 unsigned heap_get_procs(void);
 
+int heap_thread_cache_get(struct palloc_heap *heap, struct alloc_class *c,
+	struct memory_block *m, struct memory_block_reserved **mresv);
+
+void heap_thread_cache_put(struct palloc_heap *heap, struct alloc_class *c,
+	const struct memory_block *m, struct memory_block_reserved *mresv);
+
+void heap_thread_cache_flush(struct palloc_heap *heap);
+
+int heap_get_thread_cache_enabled(struct palloc_heap *heap);
+
+int heap_set_thread_cache_enabled(struct palloc_heap *heap, int enabled);
+
+unsigned heap_get_thread_cache_bin_size(struct palloc_heap *heap);
+
+int heap_set_thread_cache_bin_size(struct palloc_heap *heap,
+	unsigned bin_size);
+
+size_t heap_get_thread_cache_max_size(struct palloc_heap *heap);
+
+void heap_set_thread_cache_max_size(struct palloc_heap *heap,
+	size_t max_size);
+
 void heap_vg_open(struct palloc_heap *heap, object_callback cb,
 		void *arg, int objects);
 
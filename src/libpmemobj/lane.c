@@ -12,22 +12,31 @@
 #include <inttypes.h>
 #include <errno.h>
 #include <limits.h>
-#include <sched.h>
+#include <string.h>
 
 #include "libpmemobj.h"
 #include "critnib.h"
+#include "ctl.h"
 #include "lane.h"
 #include "out.h"
 #include "util.h"
 #include "obj.h"
+#include "os.h"
 #include "os_thread.h"
 #include "valgrind_internal.h"
 #include "memops.h"
 #include "palloc.h"
 #include "tx.h"
+#include "stats.h"
 
 static os_tls_key_t Lane_info_key;
 
+/* number of threads recovering the lanes at pool open, 0 means serial */
+static unsigned Lane_recovery_nthreads;
+
+/* the way the threads select their lanes */
+static enum pobj_lane_policy Lane_policy = POBJ_LANE_POLICY_ROUND_ROBIN;
+
 static __thread struct critnib *Lane_info_ht;
 static __thread struct lane_info *Lane_info_records;
 static __thread struct lane_info *Lane_info_cache;
@@ -207,6 +216,7 @@ lane_init(PMEMobjpool *pop, struct lane *lane, struct lane_layout *layout)
 	ASSERTne(lane, NULL);
 
 	lane->layout = layout;
+	VEC_INIT(&lane->rep_dirty);
 
 	lane->internal = operation_new((struct ulog *)&layout->internal,
 		LANE_REDO_INTERNAL_SIZE,
@@ -248,6 +258,7 @@ lane_destroy(PMEMobjpool *pop, struct lane *lane)
 	/* suppress unused-parameter errors */
 	SUPPRESS_UNUSED(pop);
 
+	VEC_DELETE(&lane->rep_dirty);
 	operation_delete(lane->undo);
 	operation_delete(lane->internal);
 	operation_delete(lane->external);
@@ -277,6 +288,15 @@ lane_boot(PMEMobjpool *pop)
 		goto error_locks_malloc;
 	}
 
+	pop->lanes_desc.lane_waiters =
+		Zalloc(sizeof(*pop->lanes_desc.lane_waiters) * pop->nlanes);
+	if (pop->lanes_desc.lane_waiters == NULL) {
+		ERR("!Malloc for lane waiters");
+		goto error_waiters_malloc;
+	}
+	pop->lanes_desc.any_waiters.seq = 0;
+	pop->lanes_desc.any_waiters.nwaiters = 0;
+
 	/* add lanes to pmemcheck ignored list */
 	VALGRIND_ADD_TO_GLOBAL_TX_IGNORE((char *)pop + pop->lanes_offset,
 		(sizeof(struct lane_layout) * pop->nlanes));
@@ -296,6 +316,9 @@ lane_boot(PMEMobjpool *pop)
 error_lane_init:
 	for (; i >= 1; --i)
 		lane_destroy(pop, &pop->lanes_desc.lane[i - 1]);
+	Free(pop->lanes_desc.lane_waiters);
+	pop->lanes_desc.lane_waiters = NULL;
+error_waiters_malloc:
 	Free(pop->lanes_desc.lane_locks);
 	pop->lanes_desc.lane_locks = NULL;
 error_locks_malloc:
@@ -341,10 +364,169 @@ lane_cleanup(PMEMobjpool *pop)
 	pop->lanes_desc.lane = NULL;
 	Free(pop->lanes_desc.lane_locks);
 	pop->lanes_desc.lane_locks = NULL;
+	Free(pop->lanes_desc.lane_waiters);
+	pop->lanes_desc.lane_waiters = NULL;
 
 	lane_info_cleanup(pop);
 }
 
+/*
+ * lane_time_ns -- (internal) returns the current monotonic time in ns
+ */
+static uint64_t
+lane_time_ns(void)
+{
+	struct timespec t;
+	os_clock_gettime(CLOCK_MONOTONIC, &t);
+
+	return (uint64_t)t.tv_sec * 1000000000ULL + (uint64_t)t.tv_nsec;
+}
+
+/*
+ * lane_recover_redo -- (internal) recovers the internal and external redo
+ *	logs of a single lane, without draining the cleared log headers
+ */
+static int
+lane_recover_redo(PMEMobjpool *pop, uint64_t idx)
+{
+	struct lane_layout *layout = lane_get_layout(pop, idx);
+	struct lane *lane = &pop->lanes_desc.lane[idx];
+
+	uint64_t start = lane_time_ns();
+
+	int recovered = ulog_recover((struct ulog *)&layout->internal,
+		OBJ_OFF_IS_VALID_FROM_CTX, &pop->p_ops);
+	recovered |= ulog_recover((struct ulog *)&layout->external,
+		OBJ_OFF_IS_VALID_FROM_CTX, &pop->p_ops);
+
+	lane->recovery_time = lane_time_ns() - start;
+
+	return recovered;
+}
+
+/*
+ * lane_recover_undo -- (internal) recovers the undo log of a single lane
+ */
+static int
+lane_recover_undo(PMEMobjpool *pop, uint64_t idx)
+{
+	struct lane_layout *layout = lane_get_layout(pop, idx);
+	struct lane *lane = &pop->lanes_desc.lane[idx];
+
+	uint64_t start = lane_time_ns();
+
+	int recovered = ulog_recovery_needed((struct ulog *)&layout->undo, 0);
+
+	struct operation_context *ctx = lane->undo;
+	operation_resume(ctx);
+	operation_process(ctx);
+	operation_finish(ctx, ULOG_INC_FIRST_GEN_NUM |
+			ULOG_FREE_AFTER_FIRST);
+
+	lane->recovery_time += lane_time_ns() - start;
+
+	return recovered;
+}
+
+typedef int (*lane_recover_fn)(PMEMobjpool *pop, uint64_t idx);
+
+/*
+ * A worker of the parallel lane recovery, owns a contiguous range of lanes.
+ */
+struct lane_recovery_worker {
+	PMEMobjpool *pop;
+	lane_recover_fn recover;
+	uint64_t lane_start;
+	uint64_t lane_end;
+	uint64_t nrecovered;
+	os_thread_t thread;
+	int running;
+};
+
+/*
+ * lane_recovery_worker_run -- (internal) recovers the lanes owned by
+ *	the worker
+ */
+static void *
+lane_recovery_worker_run(void *arg)
+{
+	struct lane_recovery_worker *w = arg;
+
+	for (uint64_t i = w->lane_start; i < w->lane_end; ++i) {
+		if (w->recover(w->pop, i))
+			w->nrecovered++;
+	}
+
+	return NULL;
+}
+
+/*
+ * lane_recover_all -- (internal) recovers all the lanes using the configured
+ *	number of threads, returns the number of lanes that had to be recovered
+ *
+ * The lanes are independent of each other, so each worker simply
+ * takes a range of them. If a thread cannot be created, its range
+ * is recovered by the calling thread instead.
+ */
+static uint64_t
+lane_recover_all(PMEMobjpool *pop, lane_recover_fn recover)
+{
+	unsigned nworkers = Lane_recovery_nthreads;
+	if (nworkers > pop->nlanes)
+		nworkers = (unsigned)pop->nlanes;
+
+	struct lane_recovery_worker serial;
+	struct lane_recovery_worker *workers = NULL;
+	if (nworkers > 1)
+		workers = Zalloc(sizeof(*workers) * nworkers);
+
+	if (workers == NULL) {
+		nworkers = 1;
+		memset(&serial, 0, sizeof(serial));
+		workers = &serial;
+	}
+
+	uint64_t lanes_per_worker = pop->nlanes / nworkers;
+	uint64_t lanes_extra = pop->nlanes % nworkers;
+	uint64_t lane_idx = 0;
+
+	unsigned i;
+	for (i = 0; i < nworkers; ++i) {
+		struct lane_recovery_worker *w = &workers[i];
+		w->pop = pop;
+		w->recover = recover;
+		w->lane_start = lane_idx;
+		lane_idx += lanes_per_worker + (i < lanes_extra ? 1 : 0);
+		w->lane_end = lane_idx;
+	}
+	ASSERTeq(lane_idx, pop->nlanes);
+
+	for (i = 1; i < nworkers; ++i) {
+		struct lane_recovery_worker *w = &workers[i];
+		if (os_thread_create(&w->thread, NULL,
+				lane_recovery_worker_run, w) == 0)
+			w->running = 1;
+	}
+
+	lane_recovery_worker_run(&workers[0]);
+
+	uint64_t nrecovered = workers[0].nrecovered;
+	for (i = 1; i < nworkers; ++i) {
+		struct lane_recovery_worker *w = &workers[i];
+		if (w->running)
+			os_thread_join(&w->thread, NULL);
+		else
+			lane_recovery_worker_run(w);
+
+		nrecovered += w->nrecovered;
+	}
+
+	if (workers != &serial)
+		Free(workers);
+
+	return nrecovered;
+}
+
 /*
  * lane_recover_and_section_boot -- performs initialization and recovery of all
  * lanes
@@ -357,21 +539,16 @@ lane_recover_and_section_boot(PMEMobjpool *pop)
 		SIZEOF_ULOG(LANE_REDO_INTERNAL_SIZE) != LANE_TOTAL_SIZE);
 
 	int err = 0;
-	uint64_t i; /* lane index */
-	struct lane_layout *layout;
+	uint64_t start = lane_time_ns();
 
 	/*
 	 * First we need to recover the internal/external redo logs so that the
 	 * allocator state is consistent before we boot it.
 	 */
-	for (i = 0; i < pop->nlanes; ++i) {
-		layout = lane_get_layout(pop, i);
+	uint64_t nrecovered = lane_recover_all(pop, lane_recover_redo);
 
-		ulog_recover((struct ulog *)&layout->internal,
-			OBJ_OFF_IS_VALID_FROM_CTX, &pop->p_ops);
-		ulog_recover((struct ulog *)&layout->external,
-			OBJ_OFF_IS_VALID_FROM_CTX, &pop->p_ops);
-	}
+	/* a single drain for all of the cleared redo logs */
+	pmemops_drain(&pop->p_ops);
 
 	if ((err = pmalloc_boot(pop)) != 0)
 		return err;
@@ -380,13 +557,11 @@ lane_recover_and_section_boot(PMEMobjpool *pop)
 	 * Undo logs must be processed after the heap is initialized since
 	 * a undo recovery might require deallocation of the next ulogs.
 	 */
-	for (i = 0; i < pop->nlanes; ++i) {
-		struct operation_context *ctx = pop->lanes_desc.lane[i].undo;
-		operation_resume(ctx);
-		operation_process(ctx);
-		operation_finish(ctx, ULOG_INC_FIRST_GEN_NUM |
-				ULOG_FREE_AFTER_FIRST);
-	}
+	nrecovered += lane_recover_all(pop, lane_recover_undo);
+
+	STATS_SET(pop->stats, transient, lanes_recovered, nrecovered);
+	STATS_SET(pop->stats, transient, lanes_recovery_time,
+		lane_time_ns() - start);
 
 	return 0;
 }
@@ -424,40 +599,165 @@ lane_check(PMEMobjpool *pop)
 }
 
 /*
- * get_lane -- (internal) get free lane index
+ * lane_try_any -- (internal) looks for a free lane, starting with the primary
+ *	lane of the thread
  */
-static inline void
-get_lane(uint64_t *locks, struct lane_info *info, uint64_t nlocks)
+static inline int
+lane_try_any(uint64_t *locks, struct lane_info *info, uint64_t nlocks)
 {
 	info->lane_idx = info->primary;
-	while (1) {
-		do {
-			info->lane_idx %= nlocks;
-			if (likely(util_bool_compare_and_swap64(
-					&locks[info->lane_idx], 0, 1))) {
-				if (info->lane_idx == info->primary) {
-					info->primary_attempts =
-						LANE_PRIMARY_ATTEMPTS;
-				} else if (info->primary_attempts == 0) {
-					info->primary = info->lane_idx;
-					info->primary_attempts =
-						LANE_PRIMARY_ATTEMPTS;
-				}
-				return;
+	do {
+		info->lane_idx %= nlocks;
+		if (likely(util_bool_compare_and_swap64(
+				&locks[info->lane_idx], 0, 1))) {
+			if (info->lane_idx == info->primary) {
+				info->primary_attempts =
+					LANE_PRIMARY_ATTEMPTS;
+			} else if (info->primary_attempts == 0) {
+				info->primary = info->lane_idx;
+				info->primary_attempts =
+					LANE_PRIMARY_ATTEMPTS;
 			}
+			return 1;
+		}
 
-			if (info->lane_idx == info->primary &&
-					info->primary_attempts > 0) {
-				info->primary_attempts--;
-			}
+		if (info->lane_idx == info->primary &&
+				info->primary_attempts > 0) {
+			info->primary_attempts--;
+		}
+
+		++info->lane_idx;
+	} while (info->lane_idx < nlocks);
+
+	return 0;
+}
 
-			++info->lane_idx;
-		} while (info->lane_idx < nlocks);
+/*
+ * lane_try_pinned -- (internal) tries to grab the primary lane of the thread
+ */
+static inline int
+lane_try_pinned(uint64_t *locks, struct lane_info *info, uint64_t nlocks)
+{
+	info->lane_idx = info->primary %= nlocks;
 
-		sched_yield();
+	return util_bool_compare_and_swap64(&locks[info->lane_idx], 0, 1);
+}
+
+/*
+ * lane_cpu_primary -- (internal) returns the lane assigned to the cpu
+ *	the thread is running on
+ *
+ * Consecutive cpus are assigned lanes in different cache lines of the lock
+ * array, in the same way the round-robin assignment does it.
+ */
+static inline uint64_t
+lane_cpu_primary(struct lane_info *info, uint64_t nlocks)
+{
+	unsigned cpu;
+	if (os_getcpu(&cpu, NULL) != 0)
+		return info->primary;
+
+	uint64_t idx = (uint64_t)cpu * LANE_JUMP;
+
+	return (idx + idx / nlocks) % nlocks;
+}
+
+/*
+ * get_lane -- (internal) get free lane index
+ *
+ * If no lane is found after a couple of sweeps, the thread is parked until
+ * a lane is released, instead of burning the cpu time the lane holders
+ * might need to make progress. In the pinned mode the thread waits for its
+ * primary lane only.
+ */
+static inline void
+get_lane(PMEMobjpool *pop, struct lane_info *info)
+{
+	struct lane_descriptor *desc = &pop->lanes_desc;
+	uint64_t *locks = desc->lane_locks;
+	uint64_t nlocks = desc->runtime_nlanes;
+
+	enum pobj_lane_policy policy;
+	util_atomic_load_explicit32(&Lane_policy, &policy,
+		memory_order_relaxed);
+
+	if (policy == POBJ_LANE_POLICY_CPU)
+		info->primary = lane_cpu_primary(info, nlocks);
+
+	int pinned = policy == POBJ_LANE_POLICY_PINNED;
+
+	for (unsigned sweeps = 1; 1; ++sweeps) {
+		if (pinned ? lane_try_pinned(locks, info, nlocks) :
+				lane_try_any(locks, info, nlocks))
+			return;
+
+		STATS_INC(pop->stats, transient, lanes_spins, 1);
+		if (sweeps < LANE_SPIN_SWEEPS)
+			continue;
+
+		struct lane_waiters *w = pinned ?
+			&desc->lane_waiters[info->primary] :
+			&desc->any_waiters;
+
+		/*
+		 * The lane might have been released before the thread was
+		 * added to the queue, so it has to look again before parking.
+		 */
+		util_fetch_and_add32(&w->nwaiters, 1);
+		uint32_t seq;
+		util_atomic_load_explicit32(&w->seq, &seq,
+			memory_order_acquire);
+
+		int acquired = pinned ? lane_try_pinned(locks, info, nlocks) :
+			lane_try_any(locks, info, nlocks);
+		if (!acquired) {
+			uint64_t start = lane_time_ns();
+			os_futex_wait(&w->seq, seq);
+
+			STATS_INC(pop->stats, transient, lanes_waits, 1);
+			STATS_INC(pop->stats, transient, lanes_wait_time,
+				lane_time_ns() - start);
+		}
+
+		util_fetch_and_sub32(&w->nwaiters, 1);
+
+		if (acquired)
+			return;
+
+		sweeps = 0;
 	}
 }
 
+/*
+ * put_lane -- (internal) releases the lane and wakes up a thread waiting for
+ *	it, or for any lane if there is none
+ */
+static inline void
+put_lane(PMEMobjpool *pop, uint64_t lane_idx)
+{
+	struct lane_descriptor *desc = &pop->lanes_desc;
+
+	if (unlikely(!util_bool_compare_and_swap64(
+			&desc->lane_locks[lane_idx], 1, 0))) {
+		FATAL("util_bool_compare_and_swap64");
+	}
+
+	struct lane_waiters *w = &desc->lane_waiters[lane_idx];
+	uint32_t nwaiters;
+	util_atomic_load_explicit32(&w->nwaiters, &nwaiters,
+		memory_order_acquire);
+	if (likely(nwaiters == 0)) {
+		w = &desc->any_waiters;
+		util_atomic_load_explicit32(&w->nwaiters, &nwaiters,
+			memory_order_acquire);
+		if (likely(nwaiters == 0))
+			return;
+	}
+
+	util_fetch_and_add32(&w->seq, 1);
+	os_futex_wake(&w->seq, 1);
+}
+
 /*
  * get_lane_info_record -- (internal) get lane record attached to memory pool
  *	or first free
@@ -516,10 +816,9 @@ lane_hold(PMEMobjpool *pop, struct lane **lanep)
 			&pop->lanes_desc.next_lane_idx, LANE_JUMP);
 	} /* handles wraparound */
 
-	uint64_t *llocks = pop->lanes_desc.lane_locks;
 	/* grab next free lane from lanes available at runtime */
 	if (!lane->nest_count++) {
-		get_lane(llocks, lane, pop->lanes_desc.runtime_nlanes);
+		get_lane(pop, lane);
 	}
 
 	struct lane *l = &pop->lanes_desc.lane[lane->lane_idx];
@@ -553,10 +852,164 @@ lane_release(PMEMobjpool *pop)
 	if (unlikely(lane->nest_count == 0)) {
 		FATAL("lane_release");
 	} else if (--(lane->nest_count) == 0) {
-		if (unlikely(!util_bool_compare_and_swap64(
-				&pop->lanes_desc.lane_locks[lane->lane_idx],
-				1, 0))) {
-			FATAL("util_bool_compare_and_swap64");
-		}
+		put_lane(pop, lane->lane_idx);
+	}
+}
+
+/*
+ * lane_get_held -- returns the lane currently held by the calling thread or
+ *	NULL if the thread does not hold any lane of the pool
+ */
+struct lane *
+lane_get_held(PMEMobjpool *pop)
+{
+	struct lane_info *info = Lane_info_cache;
+
+	if (info == NULL || info->pop_uuid_lo != pop->uuid_lo) {
+		if (Lane_info_ht == NULL)
+			return NULL;
+
+		info = critnib_get(Lane_info_ht, pop->uuid_lo);
+		if (info == NULL)
+			return NULL;
 	}
+
+	if (info->nest_count == 0 || pop->lanes_desc.lane == NULL)
+		return NULL;
+
+	return &pop->lanes_desc.lane[info->lane_idx];
+}
+
+/*
+ * CTL_READ_HANDLER(nthreads) -- reads the number of threads used to recover
+ *	the lanes at pool open
+ */
+static int
+CTL_READ_HANDLER(nthreads)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(ctx, source, indexes);
+
+	unsigned *nthreads = arg;
+
+	*nthreads = Lane_recovery_nthreads;
+
+	return 0;
+}
+
+/*
+ * CTL_WRITE_HANDLER(nthreads) -- writes the number of threads used to recover
+ *	the lanes at pool open
+ */
+static int
+CTL_WRITE_HANDLER(nthreads)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(ctx, source, indexes);
+
+	Lane_recovery_nthreads = *(unsigned *)arg;
+
+	return 0;
+}
+
+static const struct ctl_argument CTL_ARG(nthreads) = CTL_ARG_LONG_LONG;
+
+static const struct ctl_node CTL_NODE(recovery)[] = {
+	CTL_LEAF_RW(nthreads),
+
+	CTL_NODE_END
+};
+
+/*
+ * CTL_READ_HANDLER(policy) -- reads the lane selection policy
+ */
+static int
+CTL_READ_HANDLER(policy)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(ctx, source, indexes);
+
+	enum pobj_lane_policy *dest = arg;
+
+	util_atomic_load_explicit32(&Lane_policy, dest, memory_order_relaxed);
+
+	return 0;
+}
+
+/*
+ * CTL_WRITE_HANDLER(policy) -- sets the lane selection policy
+ */
+static int
+CTL_WRITE_HANDLER(policy)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(ctx, source, indexes);
+
+	enum pobj_lane_policy policy = *(enum pobj_lane_policy *)arg;
+	if (policy != POBJ_LANE_POLICY_ROUND_ROBIN &&
+			policy != POBJ_LANE_POLICY_CPU &&
+			policy != POBJ_LANE_POLICY_PINNED) {
+		ERR("invalid lane policy");
+		errno = EINVAL;
+		return -1;
+	}
+
+	util_atomic_store_explicit32(&Lane_policy, policy,
+		memory_order_relaxed);
+
+	return 0;
+}
+
+/*
+ * lane_policy_parser -- parses the lane policy enum
+ */
+static int
+lane_policy_parser(const void *arg, void *dest, size_t dest_size)
+{
+	const char *vstr = arg;
+	enum pobj_lane_policy *policy = dest;
+	ASSERTeq(dest_size, sizeof(enum pobj_lane_policy));
+
+	if (strcmp(vstr, "round_robin") == 0) {
+		*policy = POBJ_LANE_POLICY_ROUND_ROBIN;
+	} else if (strcmp(vstr, "cpu") == 0) {
+		*policy = POBJ_LANE_POLICY_CPU;
+	} else if (strcmp(vstr, "pinned") == 0) {
+		*policy = POBJ_LANE_POLICY_PINNED;
+	} else {
+		ERR("invalid lane policy");
+		errno = EINVAL;
+		return -1;
+	}
+
+	return 0;
+}
+
+static const struct ctl_argument CTL_ARG(policy) = {
+	.dest_size = sizeof(enum pobj_lane_policy),
+	.parsers = {
+		CTL_ARG_PARSER(enum pobj_lane_policy, lane_policy_parser),
+		CTL_ARG_PARSER_END
+	}
+};
+
+static const struct ctl_node CTL_NODE(lane_global)[] = {
+	CTL_CHILD(recovery),
+	CTL_LEAF_RW(policy),
+
+	CTL_NODE_END
+};
+
+/*
+ * lane_global_ctl_register -- registers global ctl entries of the lanes
+ */
+void
+lane_global_ctl_register(void)
+{
+	ctl_register_module_node(NULL, "lane",
+		(struct ctl_node *)CTL_NODE(lane_global));
 }
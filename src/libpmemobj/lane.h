@@ -11,6 +11,7 @@
 #include <stdint.h>
 #include "ulog.h"
 #include "libpmemobj.h"
+#include "vec.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -30,6 +31,9 @@ extern "C" {
  */
 #define LANE_PRIMARY_ATTEMPTS 128
 
+/* number of sweeps over all the lanes before a thread is parked */
+#define LANE_SPIN_SWEEPS 4
+
 #define RLANE_DEFAULT 0
 
 #define LANE_TOTAL_SIZE 3072 /* 3 * 1024 (sum of 3 old lane sections) */
@@ -80,11 +84,32 @@ struct lane_layout {
 	struct ULOG(LANE_UNDO_SIZE) undo;
 };
 
+/*
+ * Range of the pool, relative to its beginning, which was flushed but not yet
+ * copied to the replicas.
+ */
+struct lane_range {
+	uintptr_t off;
+	uintptr_t end;
+};
+
 struct lane {
 	struct lane_layout *layout; /* pointer to persistent layout */
 	struct operation_context *internal; /* context for internal ulog */
 	struct operation_context *external; /* context for external ulog */
 	struct operation_context *undo; /* context for undo ulog */
+	uint64_t recovery_time; /* time spent recovering the lane in ns */
+	VEC(, struct lane_range) rep_dirty; /* pending replica ranges */
+};
+
+/*
+ * Queue of the threads parked until a lane is released. The threads wait on
+ * the seq word, which is incremented by the releasing thread before waking
+ * one of them up.
+ */
+struct lane_waiters {
+	uint32_t seq;
+	uint32_t nwaiters;
 };
 
 struct lane_descriptor {
@@ -96,6 +121,8 @@ struct lane_descriptor {
 	unsigned runtime_nlanes;
 	unsigned next_lane_idx;
 	uint64_t *lane_locks;
+	struct lane_waiters *lane_waiters; /* threads waiting for the lane */
+	struct lane_waiters any_waiters; /* threads waiting for any lane */
 	struct lane *lane;
 };
 
@@ -139,8 +166,11 @@ int lane_recover_and_section_boot(PMEMobjpool *pop);
 int lane_section_cleanup(PMEMobjpool *pop);
 int lane_check(PMEMobjpool *pop);
 
+void lane_global_ctl_register(void);
+
 unsigned lane_hold(PMEMobjpool *pop, struct lane **lane);
 void lane_release(PMEMobjpool *pop);
+struct lane *lane_get_held(PMEMobjpool *pop);
 
 #ifdef __cplusplus
 }
@@ -527,13 +527,44 @@ run_block_size(const struct memory_block *m)
 	return run->hdr.block_size;
 }
 
+/*
+ * memblock_huge_padding -- returns the number of bytes between the beginning
+ *	of the first chunk and the header of a huge block with aligned data
+ *
+ * The user data of such blocks starts at the first offset in the pool which is
+ * a multiple of the chunk size and leaves enough room for the header. The
+ * padding is computed from the offset rather than from the address, so that it
+ * does not depend on the address at which the pool is mapped.
+ */
+size_t
+memblock_huge_padding(const struct memory_block *m)
+{
+	uintptr_t hsize = header_type_to_size[m->header_type];
+	uintptr_t off = (uintptr_t)heap_get_chunk(m->heap, m)->data -
+		(uintptr_t)m->heap->base;
+
+	return ALIGN_UP(off + hsize, CHUNKSIZE) - off - hsize;
+}
+
+/*
+ * huge_get_padding -- (internal) returns the padding of a huge block, which
+ *	is zero unless the block has aligned data
+ */
+static size_t
+huge_get_padding(const struct memory_block *m)
+{
+	struct chunk_header *hdr = heap_get_chunk_hdr(m->heap, m);
+
+	return hdr->flags & CHUNK_FLAG_ALIGNED ? memblock_huge_padding(m) : 0;
+}
+
 /*
  * huge_get_real_data -- returns pointer to the beginning data of a huge block
  */
 static void *
 huge_get_real_data(const struct memory_block *m)
 {
-	return heap_get_chunk(m->heap, m)->data;
+	return heap_get_chunk(m->heap, m)->data + huge_get_padding(m);
 }
 
 /*
@@ -817,6 +848,30 @@ huge_ensure_header_type(const struct memory_block *m,
 	}
 }
 
+/*
+ * memblock_huge_set_aligned -- sets or clears the flag of a free chunk which
+ *	places the user data of the huge block at an aligned offset. This is
+ *	fail-safe atomic.
+ */
+void
+memblock_huge_set_aligned(const struct memory_block *m, int aligned)
+{
+	struct chunk_header *hdr = heap_get_chunk_hdr(m->heap, m);
+	ASSERTeq(hdr->type, CHUNK_TYPE_FREE);
+
+	uint16_t f = aligned ? (uint16_t)(hdr->flags | CHUNK_FLAG_ALIGNED) :
+		(uint16_t)(hdr->flags & ~CHUNK_FLAG_ALIGNED);
+	if (f == hdr->flags)
+		return;
+
+	VALGRIND_ADD_TO_TX(hdr, sizeof(*hdr));
+	uint64_t nhdr = chunk_get_chunk_hdr_value(hdr->type, f, hdr->size_idx);
+	util_atomic_store_explicit64((uint64_t *)hdr,
+		nhdr, memory_order_relaxed);
+	pmemops_persist(&m->heap->p_ops, hdr, sizeof(*hdr));
+	VALGRIND_REMOVE_FROM_TX(hdr, sizeof(*hdr));
+}
+
 /*
  * run_ensure_header_type -- runs must be created with appropriate header type.
  */
@@ -854,6 +909,19 @@ block_get_real_size(const struct memory_block *m)
 	}
 }
 
+/*
+ * huge_get_real_size -- returns the size of a huge memory block that includes
+ *	all of the overhead (headers), without the padding of aligned blocks
+ */
+static size_t
+huge_get_real_size(const struct memory_block *m)
+{
+	if (m->size_idx == 0)
+		return block_get_real_size(m);
+
+	return block_get_real_size(m) - huge_get_padding(m);
+}
+
 /*
  * block_get_user_size -- returns the size of a memory block without overheads,
  *	this is the size of a data block that can be used.
@@ -861,7 +929,8 @@ block_get_real_size(const struct memory_block *m)
 static size_t
 block_get_user_size(const struct memory_block *m)
 {
-	return block_get_real_size(m) - header_type_to_size[m->header_type];
+	return m->m_ops->get_real_size(m) -
+		header_type_to_size[m->header_type];
 }
 
 /*
@@ -872,7 +941,7 @@ block_write_header(const struct memory_block *m,
 	uint64_t extra_field, uint16_t flags)
 {
 	memblock_header_ops[m->header_type].write(m,
-		block_get_real_size(m), extra_field, flags);
+		m->m_ops->get_real_size(m), extra_field, flags);
 }
 
 /*
@@ -1282,7 +1351,7 @@ static const struct memory_block_ops mb_ops[MAX_MEMORY_BLOCK] = {
 		.get_user_data = block_get_user_data,
 		.get_real_data = huge_get_real_data,
 		.get_user_size = block_get_user_size,
-		.get_real_size = block_get_real_size,
+		.get_real_size = huge_get_real_size,
 		.write_header = block_write_header,
 		.invalidate = block_invalidate,
 		.ensure_header_type = huge_ensure_header_type,
@@ -1495,18 +1564,19 @@ memblock_from_offset_opt(struct palloc_heap *heap, uint64_t off, int size)
 
 	off -= header_type_to_size[m.header_type];
 
-	m.type = off != 0 ? MEMORY_BLOCK_RUN : MEMORY_BLOCK_HUGE;
-	ASSERTeq(memblock_detect_type(heap, &m), m.type);
-
+	m.type = memblock_detect_type(heap, &m);
 	m.m_ops = &mb_ops[m.type];
 
 	uint64_t unit_size = m.m_ops->block_size(&m);
 
-	if (off != 0) { /* run */
+	if (m.type == MEMORY_BLOCK_RUN) {
+		ASSERTne(off, 0);
 		off -= run_get_data_offset(&m);
 		off -= RUN_BASE_METADATA_SIZE;
 		m.block_off = (uint16_t)(off / unit_size);
 		off -= m.block_off * unit_size;
+	} else {
+		off -= huge_get_padding(&m);
 	}
 
 	struct alloc_class_collection *acc = heap_alloc_classes(heap);
@@ -291,6 +291,8 @@ void memblock_rebuild_state(struct palloc_heap *heap, struct memory_block *m);
 
 struct memory_block memblock_huge_init(struct palloc_heap *heap,
 	uint32_t chunk_id, uint32_t zone_id, uint32_t size_idx);
+size_t memblock_huge_padding(const struct memory_block *m);
+void memblock_huge_set_aligned(const struct memory_block *m, int aligned);
 
 struct memory_block memblock_run_init(struct palloc_heap *heap,
 	uint32_t chunk_id, uint32_t zone_id, struct run_descriptor *rdsc);
@@ -20,11 +20,15 @@
 #include "ravl.h"
 #include "ulog.h"
 #include "valgrind_internal.h"
-#include "vecq.h"
 #include "sys_util.h"
 
 #define ULOG_BASE_SIZE 1024
-#define OP_MERGE_SEARCH 64
+#define OP_MERGE_INIT_CAPACITY 64
+
+/* number of recent operations the ulog retention is based on */
+#define OP_RETAIN_WINDOW 128
+/* how often, in operations, the retained capacity is recalculated */
+#define OP_RETAIN_INTERVAL 16
 
 enum operation_state {
 	OPERATION_IDLE,
@@ -38,6 +42,16 @@ struct operation_log {
 	struct ulog *ulog; /* DRAM allocated log of modifications */
 };
 
+/*
+ * operation_merge_slot -- the last entry of the shadow log which modifies
+ *	the given offset
+ */
+struct operation_merge_slot {
+	uint64_t offset; /* offset modified by the entry */
+	uint64_t gen; /* operation in which the slot was filled */
+	size_t entry; /* offset of the entry in the shadow log */
+};
+
 /*
  * operation_context -- context of an ongoing palloc operation
  */
@@ -65,13 +79,24 @@ struct operation_context {
 
 	struct ulog_next next; /* vector of 'next' fields of persistent ulog */
 
+	size_t retain_max; /* max capacity of retained ulogs, 0 if disabled */
+	unsigned retain_percentile; /* percentile of the logged bytes */
+	size_t retain_capacity; /* capacity of the ulogs retained on finish */
+	size_t *retain_samples; /* logged bytes of the recent operations */
+	size_t retain_nsamples; /* total number of recorded samples */
+	size_t nretained; /* ulogs kept beyond the second one by retention */
+	size_t nreused; /* retained ulogs used instead of new extensions */
+
 	enum operation_state state; /* operation sanity check */
 
 	struct operation_log pshadow_ops; /* shadow copy of persistent ulog */
 	struct operation_log transient_ops; /* log of transient changes */
 
-	/* collection used to look for potential merge candidates */
-	VECQ(, struct ulog_entry_val *) merge_entries;
+	/* open addressing hash table used to look for merge candidates */
+	struct operation_merge_slot *merge_slots;
+	size_t merge_capacity; /* always a power of two */
+	size_t merge_nslots; /* slots filled in the current operation */
+	uint64_t merge_gen; /* slots of other operations are empty */
 };
 
 /*
@@ -205,7 +230,14 @@ operation_new(struct ulog *ulog, size_t ulog_base_nbytes,
 	ctx->s_ops.memcpy = operation_transient_memcpy;
 	ctx->s_ops.drain = operation_transient_drain;
 
-	VECQ_INIT(&ctx->merge_entries);
+	ctx->merge_slots = Zalloc(sizeof(*ctx->merge_slots) *
+		OP_MERGE_INIT_CAPACITY);
+	if (ctx->merge_slots == NULL) {
+		ERR("!Zalloc");
+		goto error_ulog_alloc;
+	}
+	ctx->merge_capacity = OP_MERGE_INIT_CAPACITY;
+	ctx->merge_gen = 1;
 
 	if (operation_log_transient_init(&ctx->transient_ops) != 0)
 		goto error_ulog_alloc;
@@ -228,8 +260,9 @@ error_ctx_alloc:
 void
 operation_delete(struct operation_context *ctx)
 {
-	VECQ_DELETE(&ctx->merge_entries);
+	Free(ctx->merge_slots);
 	VEC_DELETE(&ctx->next);
+	Free(ctx->retain_samples);
 	Free(ctx->pshadow_ops.ulog);
 	Free(ctx->transient_ops.ulog);
 	Free(ctx);
@@ -305,52 +338,132 @@ operation_merge(struct ulog_entry_base *entry, uint64_t value,
 	}
 }
 
+/*
+ * operation_merge_slot_first -- (internal) returns the first slot to probe
+ *	for the offset
+ */
+static inline size_t
+operation_merge_slot_first(uint64_t offset, size_t capacity)
+{
+	uint64_t h = (offset >> 3) * 0x9E3779B97F4A7C15ULL;
+	h ^= h >> 32;
+
+	return (size_t)h & (capacity - 1);
+}
+
+/*
+ * operation_merge_slot_find -- (internal) returns the slot of the offset,
+ *	or the empty slot in which it should be stored
+ */
+static struct operation_merge_slot *
+operation_merge_slot_find(struct operation_context *ctx, uint64_t offset)
+{
+	size_t mask = ctx->merge_capacity - 1;
+
+	for (size_t i = operation_merge_slot_first(offset,
+			ctx->merge_capacity); 1; i = (i + 1) & mask) {
+		struct operation_merge_slot *slot = &ctx->merge_slots[i];
+		if (slot->gen != ctx->merge_gen || slot->offset == offset)
+			return slot;
+	}
+}
+
+/*
+ * operation_merge_grow -- (internal) doubles the capacity of the merge
+ *	hash table, keeping only the slots of the current operation
+ */
+static int
+operation_merge_grow(struct operation_context *ctx)
+{
+	size_t capacity = ctx->merge_capacity * 2;
+	struct operation_merge_slot *slots = Zalloc(sizeof(*slots) * capacity);
+	if (slots == NULL)
+		return -1;
+
+	struct operation_merge_slot *old = ctx->merge_slots;
+	size_t old_capacity = ctx->merge_capacity;
+
+	ctx->merge_slots = slots;
+	ctx->merge_capacity = capacity;
+
+	for (size_t i = 0; i < old_capacity; ++i) {
+		if (old[i].gen != ctx->merge_gen)
+			continue;
+
+		*operation_merge_slot_find(ctx, old[i].offset) = old[i];
+	}
+
+	Free(old);
+
+	return 0;
+}
+
+/*
+ * operation_merge_slot_get -- (internal) returns the slot of the offset,
+ *	or the empty slot in which it should be stored, or NULL if the table
+ *	is full
+ */
+static struct operation_merge_slot *
+operation_merge_slot_get(struct operation_context *ctx, uint64_t offset)
+{
+	if ((ctx->merge_nslots + 1) * 2 > ctx->merge_capacity &&
+	    operation_merge_grow(ctx) != 0) {
+		/* this is fine, only the log will get bigger */
+		LOG(2, "out of memory - unable to track entries");
+
+		/* there has to be at least one empty slot to stop probing */
+		if (ctx->merge_nslots + 1 == ctx->merge_capacity)
+			return NULL;
+	}
+
+	return operation_merge_slot_find(ctx, offset);
+}
+
 /*
  * operation_try_merge_entry -- tries to merge the incoming log entry with
- *	existing entries
+ *	the last entry of the shadow log which modifies the same offset
  *
- * Because this requires a reverse foreach, it cannot be implemented using
- * the on-media ulog log structure since there's no way to find what's
- * the previous entry in the log. Instead, the last N entries are stored
- * in a collection and traversed backwards.
+ * Entries of the same type are merged regardless of their distance in the
+ * log, because there's no other entry modifying the offset between them.
  */
 static int
 operation_try_merge_entry(struct operation_context *ctx,
-	void *ptr, uint64_t value, ulog_operation_type type)
+	struct operation_merge_slot *slot, uint64_t value,
+	ulog_operation_type type)
 {
-	int ret = 0;
-	uint64_t offset = OBJ_PTR_TO_OFF(ctx->p_ops->base, ptr);
-
-	struct ulog_entry_val *e;
-	VECQ_FOREACH_REVERSE(e, &ctx->merge_entries) {
-		if (ulog_entry_offset(&e->base) == offset) {
-			if (ulog_entry_type(&e->base) == type) {
-				operation_merge(&e->base, value, type);
-				return 1;
-			} else {
-				break;
-			}
-		}
-	}
+	if (slot == NULL || slot->gen != ctx->merge_gen)
+		return 0;
 
-	return ret;
+	struct ulog_entry_val *e = (struct ulog_entry_val *)
+		(ctx->pshadow_ops.ulog->data + slot->entry);
+	ASSERTeq(ulog_entry_offset(&e->base), slot->offset);
+
+	if (ulog_entry_type(&e->base) != type)
+		return 0;
+
+	operation_merge(&e->base, value, type);
+
+	return 1;
 }
 
 /*
- * operation_merge_entry_add -- adds a new entry to the merge collection,
- *	keeps capacity at OP_MERGE_SEARCH. Removes old entries in FIFO fashion.
+ * operation_merge_entry_add -- (internal) makes the entry the merge
+ *	candidate for its offset
  */
 static void
 operation_merge_entry_add(struct operation_context *ctx,
-	struct ulog_entry_val *entry)
+	struct operation_merge_slot *slot, uint64_t offset, size_t entry)
 {
-	if (VECQ_SIZE(&ctx->merge_entries) == OP_MERGE_SEARCH)
-		(void) VECQ_DEQUEUE(&ctx->merge_entries);
+	if (slot == NULL)
+		return;
 
-	if (VECQ_ENQUEUE(&ctx->merge_entries, entry) != 0) {
-		/* this is fine, only runtime perf will get slower */
-		LOG(2, "out of memory - unable to track entries");
+	if (slot->gen != ctx->merge_gen) {
+		slot->gen = ctx->merge_gen;
+		slot->offset = offset;
+		ctx->merge_nslots++;
 	}
+
+	slot->entry = entry;
 }
 
 /*
@@ -379,24 +492,24 @@ operation_add_typed_entry(struct operation_context *ctx,
 		oplog->capacity += ULOG_BASE_SIZE;
 		oplog->ulog = ulog;
 		oplog->ulog->capacity = oplog->capacity;
-
-		/*
-		 * Realloc invalidated the ulog entries that are inside of this
-		 * vector, need to clear it to avoid use after free.
-		 */
-		VECQ_CLEAR(&ctx->merge_entries);
 	}
 
-	if (log_type == LOG_PERSISTENT &&
-		operation_try_merge_entry(ctx, ptr, value, type) != 0)
-		return 0;
+	uint64_t offset = 0;
+	struct operation_merge_slot *slot = NULL;
+	if (log_type == LOG_PERSISTENT) {
+		offset = OBJ_PTR_TO_OFF(ctx->p_ops->base, ptr);
+		slot = operation_merge_slot_get(ctx, offset);
+		if (operation_try_merge_entry(ctx, slot, value, type) != 0)
+			return 0;
+	}
 
+	size_t entry_offset = oplog->offset;
 	struct ulog_entry_val *entry = ulog_entry_val_create(
-		oplog->ulog, oplog->offset, ptr, value, type,
+		oplog->ulog, entry_offset, ptr, value, type,
 		log_type == LOG_TRANSIENT ? &ctx->t_ops : &ctx->s_ops);
 
 	if (log_type == LOG_PERSISTENT)
-		operation_merge_entry_add(ctx, entry);
+		operation_merge_entry_add(ctx, slot, offset, entry_offset);
 
 	oplog->offset += ulog_entry_size(&entry->base);
 
@@ -663,7 +776,7 @@ operation_process_persistent_redo(struct operation_context *ctx)
 	ulog_process(ctx->pshadow_ops.ulog, OBJ_OFF_IS_VALID_FROM_CTX,
 		ctx->p_ops);
 
-	ulog_clobber(ctx->ulog, &ctx->next, ctx->p_ops);
+	ulog_clobber(ctx->ulog, &ctx->next, ctx->p_ops, 0);
 }
 
 /*
@@ -718,7 +831,8 @@ operation_init(struct operation_context *ctx)
 		plog->capacity);
 	tlog->offset = 0;
 	plog->offset = 0;
-	VECQ_REINIT(&ctx->merge_entries);
+	ctx->merge_gen++;
+	ctx->merge_nslots = 0;
 
 	ctx->ulog_curr_offset = 0;
 	ctx->ulog_curr_capacity = 0;
@@ -807,6 +921,108 @@ operation_process(struct operation_context *ctx)
 		ulog_process(ctx->transient_ops.ulog, NULL, &ctx->t_ops);
 }
 
+/*
+ * operation_set_retain -- sets the policy of retaining the ulogs allocated by
+ *	the extend function across operations, max_capacity of 0 disables it
+ */
+void
+operation_set_retain(struct operation_context *ctx, size_t max_capacity,
+	unsigned percentile)
+{
+	ASSERT(percentile > 0 && percentile <= 100);
+
+	if (max_capacity != 0 && ctx->retain_samples == NULL) {
+		ctx->retain_samples = Zalloc(sizeof(*ctx->retain_samples) *
+			OP_RETAIN_WINDOW);
+		/* without the samples nothing is retained */
+		if (ctx->retain_samples == NULL)
+			return;
+	}
+
+	ctx->retain_max = max_capacity;
+	ctx->retain_percentile = percentile;
+}
+
+/*
+ * operation_get_reused -- returns and resets the number of retained ulogs
+ *	used instead of allocating new ones
+ */
+size_t
+operation_get_reused(struct operation_context *ctx)
+{
+	size_t nreused = ctx->nreused;
+	ctx->nreused = 0;
+
+	return nreused;
+}
+
+/*
+ * operation_get_persistent_size -- returns the size of the persistent log
+ *	entries added in the current operation, after merging
+ */
+size_t
+operation_get_persistent_size(struct operation_context *ctx)
+{
+	return ctx->pshadow_ops.offset;
+}
+
+/*
+ * operation_size_cmp -- (internal) compares two sizes
+ */
+static int
+operation_size_cmp(const void *lhs, const void *rhs)
+{
+	size_t l = *(const size_t *)lhs;
+	size_t r = *(const size_t *)rhs;
+
+	if (l < r)
+		return -1;
+
+	return l > r;
+}
+
+/*
+ * operation_retain_update -- (internal) records the number of bytes logged
+ *	by the operation and periodically recalculates the capacity of the
+ *	ulogs to retain
+ */
+static void
+operation_retain_update(struct operation_context *ctx)
+{
+	/* count the ulogs beyond the second one used by this operation */
+	size_t capacity = ctx->ulog_base_nbytes;
+	size_t used = 0;
+	while (used < VEC_SIZE(&ctx->next) && capacity < ctx->total_logged) {
+		struct ulog *u = ulog_by_offset(*VEC_GET(&ctx->next, used),
+			ctx->p_ops);
+		capacity += u->capacity;
+		used++;
+	}
+	if (used > 1)
+		ctx->nreused += MIN(used - 1, ctx->nretained);
+
+	if (ctx->retain_max == 0 || ctx->retain_samples == NULL) {
+		ctx->retain_capacity = 0;
+		return;
+	}
+
+	ctx->retain_samples[ctx->retain_nsamples++ % OP_RETAIN_WINDOW] =
+		ctx->total_logged;
+	if (ctx->retain_nsamples % OP_RETAIN_INTERVAL != 0)
+		return;
+
+	size_t n = MIN(ctx->retain_nsamples, OP_RETAIN_WINDOW);
+	size_t sorted[OP_RETAIN_WINDOW];
+	memcpy(sorted, ctx->retain_samples, n * sizeof(*sorted));
+	qsort(sorted, n, sizeof(*sorted), operation_size_cmp);
+
+	size_t logged = sorted[(n - 1) * ctx->retain_percentile / 100];
+	size_t retain = logged > ctx->ulog_base_nbytes ?
+		logged - ctx->ulog_base_nbytes : 0;
+
+	ctx->retain_capacity = MIN(retain, ctx->retain_max);
+}
+
 /*
  * operation_finish -- finalizes the operation
  */
@@ -827,10 +1043,16 @@ operation_finish(struct operation_context *ctx, unsigned flags)
 		goto out;
 
 	if (ctx->type == LOG_TYPE_UNDO) {
+		size_t retain = 0;
+		if (!(flags & (ULOG_ANY_USER_BUFFER | ULOG_FREE_AFTER_FIRST))) {
+			operation_retain_update(ctx);
+			retain = ctx->retain_capacity;
+		}
+
 		int ret = ulog_clobber_data(ctx->ulog,
 			&ctx->next, ctx->ulog_free,
 			operation_user_buffer_remove,
-			ctx->p_ops, flags);
+			ctx->p_ops, flags, retain);
 		if (ret == 0)
 			goto out;
 	} else if (ctx->type == LOG_TYPE_REDO) {
@@ -848,5 +1070,10 @@ operation_finish(struct operation_context *ctx, unsigned flags)
 	ulog_rebuild_next_vec(ctx->ulog, &ctx->next, ctx->p_ops);
 
 out:
+	if (ctx->type == LOG_TYPE_UNDO) {
+		ctx->nretained = VEC_SIZE(&ctx->next) > 1 ?
+			VEC_SIZE(&ctx->next) - 1 : 0;
+	}
+
 	ctx->state = OPERATION_IDLE;
 }
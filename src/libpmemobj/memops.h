@@ -75,6 +75,10 @@ int operation_user_buffer_range_cmp(const void *lhs, const void *rhs);
 int operation_reserve(struct operation_context *ctx, size_t new_capacity);
 void operation_process(struct operation_context *ctx);
 void operation_finish(struct operation_context *ctx, unsigned flags);
+void operation_set_retain(struct operation_context *ctx, size_t max_capacity,
+	unsigned percentile);
+size_t operation_get_reused(struct operation_context *ctx);
+size_t operation_get_persistent_size(struct operation_context *ctx);
 void operation_cancel(struct operation_context *ctx);
 
 #ifdef __cplusplus
@@ -13,12 +13,16 @@
 #include "libpmem.h"
 #include "memblock.h"
 #include "critnib.h"
+#include "defrag_daemon.h"
 #include "list.h"
 #include "mmap.h"
 #include "obj.h"
+#include "publish_queue.h"
 #include "ctl_global.h"
 #include "ravl.h"
+#include "replica_mover.h"
 
+#include "heap.h"
 #include "heap_layout.h"
 #include "os.h"
 #include "os_thread.h"
@@ -68,6 +72,31 @@ static os_mutex_t pools_mutex;
 
 __thread struct _pobj_pcache _pobj_cached_pool;
 
+#define POOLS_CACHE_SIZE 16
+
+/*
+ * Per-thread cache of the recently looked up pools, used by
+ * pmemobj_pool_by_oid and pmemobj_pool_by_ptr, which in turn are used on
+ * the misses of the single-entry cache of pmemobj_direct.
+ * Like the latter, it's flushed whenever any pool is closed.
+ */
+struct pools_cache {
+	struct {
+		PMEMobjpool *pop;
+		uint64_t uuid_lo;
+		uintptr_t start;
+		/*
+		 * End of the pool's address range at the time of insert.
+		 * The heap can only grow, so a stale end at most causes a miss.
+		 */
+		uintptr_t end;
+	} entries[POOLS_CACHE_SIZE];
+	unsigned next; /* entry replaced on the next insert */
+	int invalidate;
+};
+
+static __thread struct pools_cache Pools_cache;
+
 /*
  * pmemobj_direct -- returns the direct pointer of an object
  */
@@ -207,6 +236,8 @@ obj_init(void)
 	 */
 	ctl_global_register();
 	pmalloc_global_ctl_register();
+	lane_global_ctl_register();
+	replica_global_ctl_register();
 
 	if (obj_ctl_init_and_load(NULL))
 		FATAL("error: %s", pmemobj_errormsg());
@@ -397,6 +428,139 @@ obj_norep_drain(void *ctx)
 
 static void obj_pool_cleanup(PMEMobjpool *pop);
 
+/*
+ * Maximum number of flushed ranges accumulated in a lane before they are
+ * copied to the replicas regardless of the drain.
+ */
+#define OBJ_REP_DIRTY_MAX 1024
+
+/*
+ * obj_rep_copy -- (internal) copies the range of the master replica to all the
+ *	other replicas
+ */
+static void
+obj_rep_copy(PMEMobjpool *pop, uintptr_t off, size_t len, unsigned flags)
+{
+	PMEMobjpool *rep = pop->replica;
+	while (rep) {
+		rep->memcpy_local((char *)rep + off, (char *)pop + off, len,
+			flags);
+		rep = rep->replica;
+	}
+}
+
+/*
+ * obj_rep_range_cmp -- (internal) compares two flushed ranges by offset
+ */
+static int
+obj_rep_range_cmp(const void *lhs, const void *rhs)
+{
+	const struct lane_range *l = lhs;
+	const struct lane_range *r = rhs;
+
+	if (l->off < r->off)
+		return -1;
+
+	return l->off > r->off;
+}
+
+/*
+ * obj_rep_dirty_push -- (internal) copies all the ranges accumulated in the
+ *	lane to the replicas, merging the overlapping and adjacent ones into
+ *	cache line aligned extents
+ */
+static void
+obj_rep_dirty_push(PMEMobjpool *pop, struct lane *lane)
+{
+	size_t n = VEC_SIZE(&lane->rep_dirty);
+	if (n == 0)
+		return;
+
+	struct lane_range *r = VEC_ARR(&lane->rep_dirty);
+	if (n > 1)
+		qsort(r, n, sizeof(*r), obj_rep_range_cmp);
+
+	uintptr_t off = r[0].off;
+	uintptr_t end = r[0].end;
+	for (size_t i = 1; i < n; ++i) {
+		if (r[i].off <= end) {
+			end = MAX(end, r[i].end);
+			continue;
+		}
+
+		obj_rep_copy(pop, off, end - off, PMEM_F_MEM_NODRAIN);
+		off = r[i].off;
+		end = r[i].end;
+	}
+	obj_rep_copy(pop, off, end - off, PMEM_F_MEM_NODRAIN);
+
+	VEC_CLEAR(&lane->rep_dirty);
+}
+
+/*
+ * obj_rep_dirty_add -- (internal) records the flushed range in the lane held
+ *	by the calling thread, returns -1 if the range has to be copied to the
+ *	replicas right away
+ */
+static int
+obj_rep_dirty_add(PMEMobjpool *pop, const void *addr, size_t len)
+{
+	struct lane *lane = lane_get_held(pop);
+	if (lane == NULL)
+		return -1;
+
+	uintptr_t off = (uintptr_t)addr - (uintptr_t)pop;
+	struct lane_range range = {
+		.off = ALIGN_DOWN(off, CACHELINE_SIZE),
+		.end = ALIGN_UP(off + len, CACHELINE_SIZE),
+	};
+
+	/* the common case of consecutive flushes is merged in place */
+	if (VEC_SIZE(&lane->rep_dirty) != 0) {
+		struct lane_range *last = &VEC_BACK(&lane->rep_dirty);
+		if (range.off <= last->end && range.end >= last->off) {
+			last->off = MIN(last->off, range.off);
+			last->end = MAX(last->end, range.end);
+			return 0;
+		}
+	}
+
+	if (VEC_SIZE(&lane->rep_dirty) >= OBJ_REP_DIRTY_MAX)
+		obj_rep_dirty_push(pop, lane);
+
+	return VEC_PUSH_BACK(&lane->rep_dirty, range);
+}
+
+/*
+ * obj_rep_dirty_push_all -- (internal) copies the ranges left in all the lanes
+ *	to the replicas
+ */
+static void
+obj_rep_dirty_push_all(PMEMobjpool *pop)
+{
+	if (pop->lanes_desc.lane == NULL)
+		return;
+
+	int pushed = 0;
+	for (uint64_t i = 0; i < pop->nlanes; ++i) {
+		struct lane *lane = &pop->lanes_desc.lane[i];
+		if (VEC_SIZE(&lane->rep_dirty) == 0)
+			continue;
+
+		obj_rep_dirty_push(pop, lane);
+		pushed = 1;
+	}
+
+	if (!pushed)
+		return;
+
+	PMEMobjpool *rep = pop->replica;
+	while (rep) {
+		rep->drain_local();
+		rep = rep->replica;
+	}
+}
+
 /*
  * obj_rep_memcpy -- (internal) memcpy with replication
  */
@@ -482,6 +646,25 @@ obj_rep_persist(void *ctx, const void *addr, size_t len, unsigned flags)
 
 	pop->persist_local(addr, len);
 
+	/*
+	 * Persist implies a drain, so the ranges flushed earlier by this
+	 * thread have to reach the replicas as well.
+	 */
+	struct lane *lane = lane_get_held(pop);
+	if (lane != NULL && VEC_SIZE(&lane->rep_dirty) != 0) {
+		obj_rep_copy(pop, (uintptr_t)addr - (uintptr_t)pop, len,
+			PMEM_F_MEM_NODRAIN);
+		obj_rep_dirty_push(pop, lane);
+
+		PMEMobjpool *rep = pop->replica;
+		while (rep) {
+			rep->drain_local();
+			rep = rep->replica;
+		}
+
+		return 0;
+	}
+
 	PMEMobjpool *rep = pop->replica;
 	while (rep) {
 		void *raddr = (char *)rep + (uintptr_t)addr - (uintptr_t)pop;
@@ -506,6 +689,13 @@ obj_rep_flush(void *ctx, const void *addr, size_t len, unsigned flags)
 
 	pop->flush_local(addr, len);
 
+	/*
+	 * Within a lane the copy to the replicas is deferred until the drain,
+	 * where all the ranges flushed in the meantime are copied at once.
+	 */
+	if (obj_rep_dirty_add(pop, addr, len) == 0)
+		return 0;
+
 	PMEMobjpool *rep = pop->replica;
 	while (rep) {
 		void *raddr = (char *)rep + (uintptr_t)addr - (uintptr_t)pop;
@@ -527,6 +717,10 @@ obj_rep_drain(void *ctx)
 
 	pop->drain_local();
 
+	struct lane *lane = lane_get_held(pop);
+	if (lane != NULL)
+		obj_rep_dirty_push(pop, lane);
+
 	PMEMobjpool *rep = pop->replica;
 	while (rep) {
 		rep->drain_local();
@@ -534,6 +728,155 @@ obj_rep_drain(void *ctx)
 	}
 }
 
+/*
+ * obj_rep_async_memcpy -- (internal) memcpy with asynchronous replication
+ */
+static void *
+obj_rep_async_memcpy(void *ctx, void *dest, const void *src, size_t len,
+		unsigned flags)
+{
+	PMEMobjpool *pop = ctx;
+	LOG(15, "pop %p dest %p src %p len %zu flags 0x%x", pop, dest, src, len,
+			flags);
+
+	void *ret = pop->memcpy_local(dest, src, len, flags);
+
+	replica_mover_enqueue(pop->rep_mover, dest, len);
+
+	return ret;
+}
+
+/*
+ * obj_rep_async_memmove -- (internal) memmove with asynchronous replication
+ */
+static void *
+obj_rep_async_memmove(void *ctx, void *dest, const void *src, size_t len,
+		unsigned flags)
+{
+	PMEMobjpool *pop = ctx;
+	LOG(15, "pop %p dest %p src %p len %zu flags 0x%x", pop, dest, src, len,
+			flags);
+
+	void *ret = pop->memmove_local(dest, src, len, flags);
+
+	replica_mover_enqueue(pop->rep_mover, dest, len);
+
+	return ret;
+}
+
+/*
+ * obj_rep_async_memset -- (internal) memset with asynchronous replication
+ */
+static void *
+obj_rep_async_memset(void *ctx, void *dest, int c, size_t len, unsigned flags)
+{
+	PMEMobjpool *pop = ctx;
+	LOG(15, "pop %p dest %p c 0x%02x len %zu flags 0x%x", pop, dest, c, len,
+			flags);
+
+	void *ret = pop->memset_local(dest, c, len, flags);
+
+	replica_mover_enqueue(pop->rep_mover, dest, len);
+
+	return ret;
+}
+
+/*
+ * obj_rep_async_persist -- (internal) persist with asynchronous replication
+ */
+static int
+obj_rep_async_persist(void *ctx, const void *addr, size_t len, unsigned flags)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(flags);
+
+	PMEMobjpool *pop = ctx;
+	LOG(15, "pop %p addr %p len %zu", pop, addr, len);
+
+	pop->persist_local(addr, len);
+
+	replica_mover_enqueue(pop->rep_mover, addr, len);
+
+	return 0;
+}
+
+/*
+ * obj_rep_async_flush -- (internal) flush with asynchronous replication
+ */
+static int
+obj_rep_async_flush(void *ctx, const void *addr, size_t len, unsigned flags)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(flags);
+
+	PMEMobjpool *pop = ctx;
+	LOG(15, "pop %p addr %p len %zu", pop, addr, len);
+
+	pop->flush_local(addr, len);
+
+	replica_mover_enqueue(pop->rep_mover, addr, len);
+
+	return 0;
+}
+
+/*
+ * obj_rep_async_drain -- (internal) drain with asynchronous replication,
+ *	the replicas are drained by the replication thread
+ */
+static void
+obj_rep_async_drain(void *ctx)
+{
+	PMEMobjpool *pop = ctx;
+	LOG(15, "pop %p", pop);
+
+	pop->drain_local();
+}
+
+/*
+ * obj_rep_async_start -- (internal) starts the asynchronous replication
+ *	of the pool, if enabled
+ */
+static int
+obj_rep_async_start(PMEMobjpool *pop)
+{
+	if (pop->replica == NULL || !Replica_async_enabled)
+		return 0;
+
+	pop->rep_mover = replica_mover_new(pop, Replica_async_max_lag);
+	if (pop->rep_mover == NULL)
+		return -1;
+
+	pop->p_ops.persist = obj_rep_async_persist;
+	pop->p_ops.flush = obj_rep_async_flush;
+	pop->p_ops.drain = obj_rep_async_drain;
+	pop->p_ops.memcpy = obj_rep_async_memcpy;
+	pop->p_ops.memmove = obj_rep_async_memmove;
+	pop->p_ops.memset = obj_rep_async_memset;
+
+	return 0;
+}
+
+/*
+ * obj_rep_async_stop -- (internal) makes all the replicas consistent and
+ *	stops the asynchronous replication of the pool
+ */
+static void
+obj_rep_async_stop(PMEMobjpool *pop)
+{
+	if (pop->rep_mover == NULL)
+		return;
+
+	replica_mover_delete(pop->rep_mover);
+	pop->rep_mover = NULL;
+
+	pop->p_ops.persist = obj_rep_persist;
+	pop->p_ops.flush = obj_rep_flush;
+	pop->p_ops.drain = obj_rep_drain;
+	pop->p_ops.memcpy = obj_rep_memcpy;
+	pop->p_ops.memmove = obj_rep_memmove;
+	pop->p_ops.memset = obj_rep_memset;
+}
+
 #if VG_MEMCHECK_ENABLED
 /*
  * Arbitrary value. When there's more undefined regions than MAX_UNDEFS, it's
@@ -900,6 +1243,35 @@ obj_replica_fini(struct pool_replica *repset)
 	LOG(3, "repset %p", repset);
 }
 
+/*
+ * obj_publish_batch -- (internal) publishes a batch of actions collected
+ *	by the publish queue, in a single redo log operation
+ */
+static int
+obj_publish_batch(void *arg, struct pobj_action *actv, size_t actvcnt)
+{
+	PMEMobjpool *pop = arg;
+	struct operation_context *ctx = pmalloc_operation_hold(pop);
+
+	size_t entries_size = actvcnt * sizeof(struct ulog_entry_val);
+
+	if (operation_reserve(ctx, entries_size) != 0) {
+		operation_cancel(ctx);
+		pmalloc_operation_release(pop);
+		return -1;
+	}
+
+	palloc_publish(&pop->heap, actv, actvcnt, ctx);
+
+	pmalloc_operation_release(pop);
+
+	STATS_INC(pop->stats, transient, heap_publish_batches, 1);
+	STATS_INC(pop->stats, transient, heap_publish_batched_actions,
+		actvcnt);
+
+	return 0;
+}
+
 /*
  * obj_runtime_init -- (internal) initialize runtime part of the pool header
  */
@@ -926,6 +1298,10 @@ obj_runtime_init(PMEMobjpool *pop, int rdonly, int boot, unsigned nlanes)
 
 	pop->lanes_desc.runtime_nlanes = nlanes;
 
+	/* the header is not accessible once the pool is opened */
+	pop->heap.huge_align =
+		(pop->hdr.features.incompat & POOL_FEAT_HUGE_ALIGN) != 0;
+
 	pop->tx_params = tx_params_new();
 	if (pop->tx_params == NULL)
 		goto err_tx_params;
@@ -934,6 +1310,17 @@ obj_runtime_init(PMEMobjpool *pop, int rdonly, int boot, unsigned nlanes)
 	if (pop->stats == NULL)
 		goto err_stat;
 
+	pop->defrag = defrag_daemon_new(pop);
+	if (pop->defrag == NULL)
+		goto err_defrag;
+
+	pop->publish_queue = publish_queue_new(obj_publish_batch, pop);
+	if (pop->publish_queue == NULL)
+		goto err_publish_queue;
+
+	if (obj_rep_async_start(pop) != 0)
+		goto err_rep_async;
+
 	pop->user_data = NULL;
 
 	VALGRIND_REMOVE_PMEM_MAPPING(&pop->mutex_head,
@@ -1008,6 +1395,12 @@ err_tree_insert:
 err_critnib_insert:
 	obj_runtime_cleanup_common(pop);
 err_boot:
+	obj_rep_async_stop(pop);
+err_rep_async:
+	publish_queue_delete(pop->publish_queue);
+err_publish_queue:
+	defrag_daemon_delete(pop->defrag);
+err_defrag:
 	stats_delete(pop, pop->stats);
 err_stat:
 	tx_params_delete(pop->tx_params);
@@ -1082,6 +1475,9 @@ pmemobj_createU(const char *path, const char *layout,
 	else
 		adj_pool_attr.features.incompat &= ~POOL_FEAT_SDS;
 
+	if (Default_huge_align)
+		adj_pool_attr.features.incompat |= POOL_FEAT_HUGE_ALIGN;
+
 	if (util_pool_create(&set, path, poolsize, PMEMOBJ_MIN_POOL,
 			PMEMOBJ_MIN_PART, &adj_pool_attr, &runtime_nlanes,
 			REPLICAS_ENABLED) != 0) {
@@ -1506,6 +1902,8 @@ obj_pool_cleanup(PMEMobjpool *pop)
 	ravl_delete(pop->ulog_user_buffers.map);
 	util_mutex_destroy(&pop->ulog_user_buffers.lock);
 
+	publish_queue_delete(pop->publish_queue);
+	defrag_daemon_delete(pop->defrag);
 	stats_delete(pop, pop->stats);
 	tx_params_delete(pop->tx_params);
 	ctl_delete(pop->ctl);
@@ -1513,8 +1911,11 @@ obj_pool_cleanup(PMEMobjpool *pop)
 	obj_pool_lock_cleanup(pop);
 
 	lane_section_cleanup(pop);
+	obj_rep_dirty_push_all(pop);
 	lane_cleanup(pop);
 
+	obj_rep_async_stop(pop);
+
 	/* unmap all the replicas */
 	util_poolset_close(pop->set, DO_NOT_DELETE_PARTS);
 }
@@ -1528,6 +1929,9 @@ pmemobj_close(PMEMobjpool *pop)
 	LOG(3, "pop %p", pop);
 	PMEMOBJ_API_START();
 
+	/* the callbacks of the defragmentation may still use the pool */
+	defrag_daemon_stop(pop->defrag);
+
 	os_mutex_lock(&pools_mutex);
 
 	if (critnib_remove(pools_ht, pop->uuid_lo) != pop) {
@@ -1581,6 +1985,9 @@ pmemobj_checkU(const char *path, const char *layout)
 	if (consistent) {
 		obj_pool_cleanup(pop);
 	} else {
+		obj_rep_async_stop(pop);
+		publish_queue_delete(pop->publish_queue);
+		defrag_daemon_delete(pop->defrag);
 		stats_delete(pop, pop->stats);
 		tx_params_delete(pop->tx_params);
 		ctl_delete(pop->ctl);
@@ -1609,6 +2016,39 @@ pmemobj_check(const char *path, const char *layout)
 	return ret;
 }
 
+/*
+ * pools_cache_get -- (internal) returns the thread's cache of the pools,
+ *	flushing it if any pool was closed since the last lookup
+ */
+static struct pools_cache *
+pools_cache_get(void)
+{
+	struct pools_cache *cache = &Pools_cache;
+	if (cache->invalidate != _pobj_cache_invalidate) {
+		memset(cache->entries, 0, sizeof(cache->entries));
+		cache->next = 0;
+		cache->invalidate = _pobj_cache_invalidate;
+	}
+
+	return cache;
+}
+
+/*
+ * pools_cache_insert -- (internal) caches the pool in place of the least
+ *	recently inserted one
+ */
+static void
+pools_cache_insert(struct pools_cache *cache, PMEMobjpool *pop)
+{
+	unsigned i = cache->next++ % POOLS_CACHE_SIZE;
+
+	cache->entries[i].pop = pop;
+	cache->entries[i].uuid_lo = pop->uuid_lo;
+	cache->entries[i].start = (uintptr_t)pop;
+	cache->entries[i].end = (uintptr_t)pop + pop->heap_offset +
+		pop->heap_size;
+}
+
 /*
  * pmemobj_pool_by_oid -- returns the pool handle associated with the oid
  */
@@ -1621,7 +2061,18 @@ pmemobj_pool_by_oid(PMEMoid oid)
 	if (pools_ht == NULL)
 		return NULL;
 
-	return critnib_get(pools_ht, oid.pool_uuid_lo);
+	struct pools_cache *cache = pools_cache_get();
+	for (unsigned i = 0; i < POOLS_CACHE_SIZE; ++i) {
+		if (cache->entries[i].uuid_lo == oid.pool_uuid_lo &&
+				cache->entries[i].pop != NULL)
+			return cache->entries[i].pop;
+	}
+
+	PMEMobjpool *pop = critnib_get(pools_ht, oid.pool_uuid_lo);
+	if (pop != NULL)
+		pools_cache_insert(cache, pop);
+
+	return pop;
 }
 
 /*
@@ -1642,6 +2093,13 @@ pmemobj_pool_by_ptr(const void *addr)
 	if (pools_tree == NULL)
 		return NULL;
 
+	struct pools_cache *cache = pools_cache_get();
+	for (unsigned i = 0; i < POOLS_CACHE_SIZE; ++i) {
+		if ((uintptr_t)addr >= cache->entries[i].start &&
+				(uintptr_t)addr < cache->entries[i].end)
+			return cache->entries[i].pop;
+	}
+
 	pop = critnib_find_le(pools_tree, (uint64_t)addr);
 	if (pop == NULL)
 		return NULL;
@@ -1650,6 +2108,8 @@ pmemobj_pool_by_ptr(const void *addr)
 	if ((char *)addr >= (char *)pop + pool_size)
 		return NULL;
 
+	pools_cache_insert(cache, pop);
+
 	return pop;
 }
 
@@ -1812,6 +2272,115 @@ pmemobj_xalloc(PMEMobjpool *pop, PMEMoid *oidp, size_t size,
 	return ret;
 }
 
+/*
+ * pmemobj_xalloc_bulk -- allocates 'count' objects of the same size and type
+ *	in a single atomic operation
+ *
+ * All of the reservations are made with a single acquisition of the bucket
+ * and then published, together with the resulting object handles, using
+ * one redo log. Either all of the objects are allocated or none.
+ */
+int
+pmemobj_xalloc_bulk(PMEMobjpool *pop, PMEMoid *oidv, size_t count,
+	size_t size, uint64_t type_num, uint64_t flags,
+	pmemobj_constr constructor, void *arg)
+{
+	LOG(3, "pop %p oidv %p count %zu size %zu type_num %llx flags %llx "
+		"constructor %p arg %p",
+		pop, oidv, count, size, (unsigned long long)type_num,
+		(unsigned long long)flags,
+		constructor, arg);
+
+	/* log notice message if used inside a transaction */
+	_POBJ_DEBUG_NOTICE_IN_TX();
+
+	if (size == 0) {
+		ERR("allocation with size 0");
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (count == 0) {
+		ERR("allocation of 0 objects");
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (flags & ~POBJ_TX_XALLOC_VALID_FLAGS) {
+		ERR("unknown flags 0x%" PRIx64,
+				flags & ~POBJ_TX_XALLOC_VALID_FLAGS);
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (size > PMEMOBJ_MAX_ALLOC_SIZE) {
+		ERR("requested size too large");
+		errno = ENOMEM;
+		return -1;
+	}
+
+	if (count > SIZE_MAX / sizeof(struct pobj_action)) {
+		ERR("requested number of objects too large");
+		errno = ENOMEM;
+		return -1;
+	}
+
+	PMEMOBJ_API_START();
+
+	struct pobj_action *actv = Malloc(count * sizeof(struct pobj_action));
+	if (actv == NULL) {
+		ERR("!Malloc");
+		PMEMOBJ_API_END();
+		return -1;
+	}
+
+	struct constr_args carg;
+
+	carg.zero_init = flags & POBJ_FLAG_ZERO;
+	carg.constructor = constructor;
+	carg.arg = arg;
+
+	int ret = palloc_reserve_bulk(&pop->heap, size, constructor_alloc,
+		&carg, type_num, 0, CLASS_ID_FROM_FLAG(flags),
+		ARENA_ID_FROM_FLAG(flags), actv, count);
+	if (ret != 0)
+		goto out;
+
+	struct operation_context *ctx = pmalloc_operation_hold(pop);
+
+	/* the object handles and the heap metadata, per object */
+	size_t entries_size = count * 3 * sizeof(struct ulog_entry_val);
+
+	if (operation_reserve(ctx, entries_size) != 0) {
+		operation_cancel(ctx);
+		pmalloc_operation_release(pop);
+		palloc_cancel(&pop->heap, actv, count);
+		ret = -1;
+		goto out;
+	}
+
+	/*
+	 * The handles have to be logged before the actions are published,
+	 * because publishing reorders the action vector.
+	 */
+	for (size_t i = 0; i < count; ++i) {
+		operation_add_entry(ctx, &oidv[i].pool_uuid_lo, pop->uuid_lo,
+			ULOG_OPERATION_SET);
+		operation_add_entry(ctx, &oidv[i].off, actv[i].heap.offset,
+			ULOG_OPERATION_SET);
+	}
+
+	palloc_publish(&pop->heap, actv, count, ctx);
+
+	pmalloc_operation_release(pop);
+
+out:
+	Free(actv);
+
+	PMEMOBJ_API_END();
+	return ret;
+}
+
 /* arguments for constructor_realloc and constructor_zrealloc */
 struct carg_realloc {
 	void *ptr;
@@ -2328,6 +2897,21 @@ pmemobj_drain(PMEMobjpool *pop)
 	pmemops_drain(&pop->p_ops);
 }
 
+/*
+ * pmemobj_replica_sync -- waits until all the data written to the pool so far
+ *	is persistent in all of its replicas
+ */
+int
+pmemobj_replica_sync(PMEMobjpool *pop)
+{
+	LOG(15, "pop %p", pop);
+
+	if (pop->rep_mover != NULL)
+		replica_mover_sync(pop->rep_mover);
+
+	return 0;
+}
+
 /*
  * pmemobj_type_num -- returns type number of object
  */
@@ -2625,6 +3209,22 @@ pmemobj_publish(PMEMobjpool *pop, struct pobj_action *actv, size_t actvcnt)
 	return 0;
 }
 
+/*
+ * pmemobj_publish_queued -- publishes a collection of actions together with
+ *	the actions published concurrently by other threads
+ */
+int
+pmemobj_publish_queued(PMEMobjpool *pop, struct pobj_action *actv,
+	size_t actvcnt)
+{
+	PMEMOBJ_API_START();
+
+	int ret = publish_queue_publish(pop->publish_queue, actv, actvcnt);
+
+	PMEMOBJ_API_END();
+	return ret;
+}
+
 /*
  * pmemobj_cancel -- cancels collection of actions
  */
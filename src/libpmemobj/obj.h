@@ -92,7 +92,7 @@ typedef uint64_t type_num_t;
 #define CONVERSION_FLAG_OLD_SET_CACHE ((1ULL) << 0)
 
 /* PMEM_OBJ_POOL_HEAD_SIZE Without the unused and unused2 arrays */
-#define PMEM_OBJ_POOL_HEAD_SIZE 2110
+#define PMEM_OBJ_POOL_HEAD_SIZE 2150
 #define PMEM_OBJ_POOL_UNUSED2_SIZE (PMEM_PAGESIZE \
 					- OBJ_DSC_P_UNUSED\
 					- PMEM_OBJ_POOL_HEAD_SIZE)
@@ -178,6 +178,15 @@ struct pmemobjpool {
 
 	void *user_data;
 
+	/* background replication thread, if the async replication is on */
+	struct replica_mover *rep_mover;
+
+	/* background defragmentation of the heap */
+	struct defrag_daemon *defrag;
+
+	/* batches of actions published by pmemobj_publish_queued */
+	struct publish_queue *publish_queue;
+
 	/* padding to align size of this structure to page boundary */
 	/* sizeof(unused2) == 8192 - offsetof(struct pmemobjpool, unused2) */
 	char unused2[PMEM_OBJ_POOL_UNUSED2_SIZE];
@@ -191,7 +200,9 @@ struct pmemobjpool {
 #define OBJ_INTERNAL_OBJECT_MASK ((1ULL) << 15)
 
 #define CLASS_ID_FROM_FLAG(flag)\
-((uint16_t)((flag) >> 48))
+((uint16_t)((flag) & POBJ_FLAG_HUGE_ALIGN_1G ? PALLOC_CLASS_ID_HUGE_ALIGN_1G :\
+(flag) & POBJ_FLAG_HUGE_ALIGN_2M ? PALLOC_CLASS_ID_HUGE_ALIGN_2M :\
+(flag) >> 48))
 
 #define ARENA_ID_FROM_FLAG(flag)\
 ((uint16_t)((flag) >> 32))
@@ -158,9 +158,13 @@ alloc_prep_block(struct palloc_heap *heap, const struct memory_block *m,
 	return 0;
 }
 
+static void
+palloc_heap_action_on_cancel(struct palloc_heap *heap,
+	struct pobj_action_internal *act);
+
 /*
- * palloc_reservation_create -- creates a volatile reservation of a
- *	memory block.
+ * palloc_reservation_create_bulk -- creates volatile reservations of
+ *	'count' memory blocks of the same size.
  *
  * The first step in the allocation of a new block is reserving it in
  * the transient heap - which is represented by the bucket abstraction.
@@ -173,24 +177,37 @@ alloc_prep_block(struct palloc_heap *heap, const struct memory_block *m,
  * Once the bucket is selected, just enough memory is reserved for the
  * requested size. The underlying block allocation algorithm
  * (best-fit, next-fit, ...) varies depending on the bucket container.
+ *
+ * The bucket, if needed at all, is acquired only once for all of the
+ * reservations. If any of the reservations fails, the ones already created
+ * are canceled.
  */
 static int
-palloc_reservation_create(struct palloc_heap *heap, size_t size,
+palloc_reservation_create_bulk(struct palloc_heap *heap, size_t size,
 	palloc_constr constructor, void *arg,
 	uint64_t extra_field, uint16_t object_flags,
 	uint16_t class_id, uint16_t arena_id,
-	struct pobj_action_internal *out)
+	struct pobj_action_internal *outv, size_t count)
 {
 	int err = 0;
 
-	struct memory_block *new_block = &out->m;
-	out->type = POBJ_ACTION_TYPE_HEAP;
-
-	ASSERT(class_id < UINT8_MAX);
-	struct alloc_class *c = class_id == 0 ?
-		heap_get_best_class(heap, size) :
-		alloc_class_by_id(heap_alloc_classes(heap),
-			(uint8_t)class_id);
+	struct alloc_class_collection *ac = heap_alloc_classes(heap);
+	struct alloc_class *c;
+	switch (class_id) {
+		case DEFAULT_ALLOC_CLASS_ID:
+			c = heap_get_best_class(heap, size);
+			break;
+		case PALLOC_CLASS_ID_HUGE_ALIGN_2M:
+			c = alloc_class_huge_aligned(ac, HUGE_ALIGNMENT_2M);
+			break;
+		case PALLOC_CLASS_ID_HUGE_ALIGN_1G:
+			c = alloc_class_huge_aligned(ac, HUGE_ALIGNMENT_1G);
+			break;
+		default:
+			ASSERT(class_id < UINT8_MAX);
+			c = alloc_class_by_id(ac, (uint8_t)class_id);
+			break;
+	}
 
 	if (c == NULL) {
 		ERR("no allocation class for size %lu bytes", size);
@@ -214,50 +231,109 @@ palloc_reservation_create(struct palloc_heap *heap, size_t size,
 		return -1;
 	}
 	ASSERT(size_idx <= UINT32_MAX);
-	*new_block = MEMORY_BLOCK_NONE;
-	new_block->size_idx = (uint32_t)size_idx;
 
-	struct bucket *b = heap_bucket_acquire(heap, c->id, arena_id);
+	struct bucket *b = NULL;
+	size_t n;
+	for (n = 0; n < count; ++n) {
+		struct pobj_action_internal *out = &outv[n];
+		struct memory_block *new_block = &out->m;
+		out->type = POBJ_ACTION_TYPE_HEAP;
 
-	err = heap_get_bestfit_block(heap, b, new_block);
-	if (err != 0)
-		goto out;
+		*new_block = MEMORY_BLOCK_NONE;
+		new_block->size_idx = (uint32_t)size_idx;
 
-	if (alloc_prep_block(heap, new_block, constructor, arg,
-		extra_field, object_flags, out) != 0) {
 		/*
-		 * Constructor returned non-zero value which means
-		 * the memory block reservation has to be rolled back.
+		 * Small allocations from the thread's own arena are first
+		 * attempted from the thread cache, which doesn't require
+		 * taking the bucket lock. Once the bucket is held, the cache
+		 * is no longer used, its refill acquires the same bucket.
 		 */
-		if (new_block->type == MEMORY_BLOCK_HUGE) {
-			bucket_insert_block(b, new_block);
+		if (b == NULL && size_idx == 1 &&
+		    arena_id == HEAP_ARENA_PER_THREAD &&
+		    heap_thread_cache_get(heap, c, new_block,
+			    &out->mresv) == 0) {
+			if (alloc_prep_block(heap, new_block, constructor, arg,
+				extra_field, object_flags, out) != 0) {
+				heap_thread_cache_put(heap, c, new_block,
+					out->mresv);
+				err = ECANCELED;
+				break;
+			}
+
+			out->lock = new_block->m_ops->get_lock(new_block);
+			out->new_state = MEMBLOCK_ALLOCATED;
+
+			continue;
 		}
-		err = ECANCELED;
-		goto out;
-	}
 
-	/*
-	 * Each as of yet unfulfilled reservation needs to be tracked in the
-	 * runtime state.
-	 * The memory block cannot be put back into the global state unless
-	 * there are no active reservations.
-	 */
-	if ((out->mresv = bucket_active_block(b)) != NULL)
-		util_fetch_and_add64(&out->mresv->nresv, 1);
+		/* all the huge classes share the default bucket */
+		if (b == NULL)
+			b = heap_bucket_acquire(heap, c->type == CLASS_HUGE ?
+				DEFAULT_ALLOC_CLASS_ID : c->id, arena_id);
+
+		if (c->type == CLASS_HUGE && (c->flags & CHUNK_FLAG_ALIGNED))
+			err = heap_get_aligned_huge_block(heap, b, new_block,
+				c->rdsc.alignment);
+		else
+			err = heap_get_bestfit_block(heap, b, new_block);
+		if (err != 0)
+			break;
+
+		if (alloc_prep_block(heap, new_block, constructor, arg,
+			extra_field, object_flags, out) != 0) {
+			/*
+			 * Constructor returned non-zero value which means
+			 * the memory block reservation has to be rolled back.
+			 */
+			if (new_block->type == MEMORY_BLOCK_HUGE) {
+				bucket_insert_block(b, new_block);
+			}
+			err = ECANCELED;
+			break;
+		}
 
-	out->lock = new_block->m_ops->get_lock(new_block);
-	out->new_state = MEMBLOCK_ALLOCATED;
+		/*
+		 * Each as of yet unfulfilled reservation needs to be tracked
+		 * in the runtime state.
+		 * The memory block cannot be put back into the global state
+		 * unless there are no active reservations.
+		 */
+		if ((out->mresv = bucket_active_block(b)) != NULL)
+			util_fetch_and_add64(&out->mresv->nresv, 1);
 
-out:
-	heap_bucket_release(b);
+		out->lock = new_block->m_ops->get_lock(new_block);
+		out->new_state = MEMBLOCK_ALLOCATED;
+	}
+
+	if (b != NULL)
+		heap_bucket_release(b);
 
 	if (err == 0)
 		return 0;
 
+	/* roll back the reservations that already succeeded */
+	for (size_t i = 0; i < n; ++i)
+		palloc_heap_action_on_cancel(heap, &outv[i]);
+
 	errno = err;
 	return -1;
 }
 
+/*
+ * palloc_reservation_create -- creates a volatile reservation of a
+ *	memory block.
+ */
+static int
+palloc_reservation_create(struct palloc_heap *heap, size_t size,
+	palloc_constr constructor, void *arg,
+	uint64_t extra_field, uint16_t object_flags,
+	uint16_t class_id, uint16_t arena_id,
+	struct pobj_action_internal *out)
+{
+	return palloc_reservation_create_bulk(heap, size, constructor, arg,
+		extra_field, object_flags, class_id, arena_id, out, 1);
+}
+
 /*
  * palloc_heap_action_exec -- executes a single heap action (alloc, free)
  */
@@ -396,6 +472,7 @@ palloc_heap_action_on_process(struct palloc_heap *heap,
 			STATS_INC(heap->stats, transient, heap_run_allocated,
 				act->m.m_ops->get_real_size(&act->m));
 		}
+		heap_class_occupancy_update(heap, &act->m);
 	} else if (act->new_state == MEMBLOCK_FREE) {
 		if (On_memcheck) {
 			void *ptr = act->m.m_ops->get_user_data(&act->m);
@@ -603,6 +680,25 @@ palloc_reserve(struct palloc_heap *heap, size_t size,
 		(struct pobj_action_internal *)act);
 }
 
+/*
+ * palloc_reserve_bulk -- creates 'actvcnt' reservations of the same size,
+ *	either all of them are created or none
+ */
+int
+palloc_reserve_bulk(struct palloc_heap *heap, size_t size,
+	palloc_constr constructor, void *arg,
+	uint64_t extra_field, uint16_t object_flags,
+	uint16_t class_id, uint16_t arena_id,
+	struct pobj_action *actv, size_t actvcnt)
+{
+	COMPILE_ERROR_ON(sizeof(struct pobj_action) !=
+		sizeof(struct pobj_action_internal));
+
+	return palloc_reservation_create_bulk(heap, size, constructor, arg,
+		extra_field, object_flags, class_id, arena_id,
+		(struct pobj_action_internal *)actv, actvcnt);
+}
+
 /*
  * palloc_defer_free -- creates an internal deferred free action
  */
@@ -23,6 +23,13 @@ extern "C" {
 
 #define PALLOC_CTL_DEBUG_NO_PATTERN (-1)
 
+/*
+ * Class ids of the huge allocation classes with data aligned to 2MiB and 1GiB,
+ * outside of the range of the ids of the allocation classes.
+ */
+#define PALLOC_CLASS_ID_HUGE_ALIGN_2M (UINT8_MAX + 1)
+#define PALLOC_CLASS_ID_HUGE_ALIGN_1G (UINT8_MAX + 2)
+
 struct palloc_heap {
 	struct pmem_ops p_ops;
 	struct heap_layout *layout;
@@ -36,6 +43,9 @@ struct palloc_heap {
 	void *base;
 
 	int alloc_pattern;
+
+	/* the pool supports huge blocks with aligned data */
+	int huge_align;
 };
 
 struct memory_block;
@@ -56,6 +66,13 @@ palloc_reserve(struct palloc_heap *heap, size_t size,
 	uint16_t class_id, uint16_t arena_id,
 	struct pobj_action *act);
 
+int
+palloc_reserve_bulk(struct palloc_heap *heap, size_t size,
+	palloc_constr constructor, void *arg,
+	uint64_t extra_field, uint16_t object_flags,
+	uint16_t class_id, uint16_t arena_id,
+	struct pobj_action *actv, size_t actvcnt);
+
 void
 palloc_defer_free(struct palloc_heap *heap, uint64_t off,
 	struct pobj_action *act);
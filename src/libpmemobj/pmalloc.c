@@ -12,6 +12,7 @@
 #include <inttypes.h>
 #include "bucket.h"
 #include "ctl.h"
+#include "defrag_daemon.h"
 #include "libpmemobj/ctl.h"
 #include "valgrind_internal.h"
 #include "heap.h"
@@ -22,6 +23,7 @@
 #include "out.h"
 #include "palloc.h"
 #include "pmalloc.h"
+#include "publish_queue.h"
 #include "alloc_class.h"
 #include "set.h"
 #include "mmap.h"
@@ -224,22 +226,49 @@ CTL_WRITE_HANDLER(desc)(void *ctx,
 	struct alloc_class_collection *ac = heap_alloc_classes(&pop->heap);
 	struct pobj_alloc_class_desc *p = arg;
 
-	if (p->unit_size <= 0 || p->unit_size > PMEMOBJ_MAX_ALLOC_SIZE ||
-		p->units_per_block <= 0) {
+	if (p->unit_size <= 0 || p->unit_size > PMEMOBJ_MAX_ALLOC_SIZE) {
 		errno = EINVAL;
 		return -1;
 	}
 
-	if (p->alignment != 0 && p->unit_size % p->alignment != 0) {
-		ERR("unit size must be evenly divisible by alignment");
-		errno = EINVAL;
-		return -1;
-	}
+	/*
+	 * Classes without units per block are huge classes, which place
+	 * the data of objects at 2MiB or 1GiB boundaries of the pool.
+	 */
+	int huge = p->units_per_block == 0;
+	if (huge) {
+		if (p->unit_size != CHUNKSIZE) {
+			ERR("unit size of huge classes must be equal to %zu",
+				CHUNKSIZE);
+			errno = EINVAL;
+			return -1;
+		}
 
-	if (p->alignment > (MEGABYTE * 2)) {
-		ERR("alignment cannot be larger than 2 megabytes");
-		errno = EINVAL;
-		return -1;
+		if (p->alignment != HUGE_ALIGNMENT_2M &&
+			p->alignment != HUGE_ALIGNMENT_1G) {
+			ERR("alignment of huge classes must be equal to "
+				"2 megabytes or 1 gigabyte");
+			errno = EINVAL;
+			return -1;
+		}
+
+		if (p->header_type != POBJ_HEADER_COMPACT) {
+			ERR("huge classes must use the compact header");
+			errno = EINVAL;
+			return -1;
+		}
+	} else {
+		if (p->alignment != 0 && p->unit_size % p->alignment != 0) {
+			ERR("unit size must be evenly divisible by alignment");
+			errno = EINVAL;
+			return -1;
+		}
+
+		if (p->alignment > (MEGABYTE * 2)) {
+			ERR("alignment cannot be larger than 2 megabytes");
+			errno = EINVAL;
+			return -1;
+		}
 	}
 
 	enum header_type lib_htype = MAX_HEADER_TYPES;
@@ -285,20 +314,23 @@ CTL_WRITE_HANDLER(desc)(void *ctx,
 		}
 	}
 
-	size_t runsize_bytes =
-		CHUNK_ALIGN_UP((p->units_per_block * p->unit_size) +
-		RUN_BASE_METADATA_SIZE);
+	uint32_t size_idx = 1;
+	if (!huge) {
+		size_t runsize_bytes =
+			CHUNK_ALIGN_UP((p->units_per_block * p->unit_size) +
+			RUN_BASE_METADATA_SIZE);
 
-	/* aligning the buffer might require up-to to 'alignment' bytes */
-	if (p->alignment != 0)
-		runsize_bytes += p->alignment;
+		/* aligning the buffer might require up-to 'alignment' bytes */
+		if (p->alignment != 0)
+			runsize_bytes += p->alignment;
 
-	uint32_t size_idx = (uint32_t)(runsize_bytes / CHUNKSIZE);
-	if (size_idx > UINT16_MAX)
-		size_idx = UINT16_MAX;
+		size_idx = (uint32_t)(runsize_bytes / CHUNKSIZE);
+		if (size_idx > UINT16_MAX)
+			size_idx = UINT16_MAX;
+	}
 
 	struct alloc_class *c = alloc_class_new(id,
-		heap_alloc_classes(&pop->heap), CLASS_RUN,
+		heap_alloc_classes(&pop->heap), huge ? CLASS_HUGE : CLASS_RUN,
 		lib_htype, p->unit_size, p->alignment, size_idx);
 	if (c == NULL) {
 		errno = EINVAL;
@@ -311,7 +343,7 @@ CTL_WRITE_HANDLER(desc)(void *ctx,
 	}
 
 	p->class_id = c->id;
-	p->units_per_block = c->rdsc.nallocs;
+	p->units_per_block = huge ? 0 : c->rdsc.nallocs;
 
 	return 0;
 }
@@ -717,6 +749,42 @@ CTL_READ_HANDLER(automatic)(void *ctx,
 
 static struct ctl_argument CTL_ARG(automatic) = CTL_ARG_BOOLEAN;
 
+/*
+ * CTL_READ_HANDLER(numa_node) -- reads the numa node the arena is bound to
+ */
+static int
+CTL_READ_HANDLER(numa_node)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(source);
+
+	PMEMobjpool *pop = ctx;
+	int *arg_out = arg;
+	unsigned arena_id;
+
+	struct ctl_index *idx = PMDK_SLIST_FIRST(indexes);
+	ASSERTeq(strcmp(idx->name, "arena_id"), 0);
+	arena_id = (unsigned)idx->value;
+
+	unsigned narenas = heap_get_narenas_total(&pop->heap);
+
+	/*
+	 * check if index is not bigger than number of arenas
+	 * or if it is not equal zero
+	 */
+	if (arena_id < 1 || arena_id > narenas) {
+		LOG(1, "arena id outside of the allowed range: <1,%u>",
+			narenas);
+		errno = ERANGE;
+		return -1;
+	}
+
+	*arg_out = heap_get_arena_numa_node(&pop->heap, arena_id);
+
+	return 0;
+}
+
 static const struct ctl_node CTL_NODE(size)[] = {
 	CTL_LEAF_RW(granularity),
 	CTL_LEAF_RUNNABLE(extend),
@@ -806,6 +874,7 @@ CTL_RUNNABLE_HANDLER(create)(void *ctx,
 static const struct ctl_node CTL_NODE(arena_id)[] = {
 	CTL_LEAF_RO(size),
 	CTL_LEAF_RW(automatic),
+	CTL_LEAF_RO(numa_node),
 
 	CTL_NODE_END
 };
@@ -831,12 +900,455 @@ static const struct ctl_node CTL_NODE(thread)[] = {
 	CTL_NODE_END
 };
 
+/*
+ * CTL_READ_HANDLER(enabled) -- reads whether the thread caches are enabled
+ */
+static int
+CTL_READ_HANDLER(enabled)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(source, indexes);
+
+	PMEMobjpool *pop = ctx;
+	int *arg_out = arg;
+
+	*arg_out = heap_get_thread_cache_enabled(&pop->heap);
+
+	return 0;
+}
+
+/*
+ * CTL_WRITE_HANDLER(enabled) -- enables or disables the thread caches
+ */
+static int
+CTL_WRITE_HANDLER(enabled)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(source, indexes);
+
+	PMEMobjpool *pop = ctx;
+	int arg_in = *(int *)arg;
+
+	return heap_set_thread_cache_enabled(&pop->heap, arg_in);
+}
+
+static const struct ctl_argument CTL_ARG(enabled) = CTL_ARG_BOOLEAN;
+
+/*
+ * CTL_READ_HANDLER(bin_size) -- reads the number of blocks reserved per
+ *	allocation class in a single thread cache refill
+ */
+static int
+CTL_READ_HANDLER(bin_size)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(source, indexes);
+
+	PMEMobjpool *pop = ctx;
+	unsigned *arg_out = arg;
+
+	*arg_out = heap_get_thread_cache_bin_size(&pop->heap);
+
+	return 0;
+}
+
+/*
+ * CTL_WRITE_HANDLER(bin_size) -- changes the number of blocks reserved per
+ *	allocation class in a single thread cache refill
+ */
+static int
+CTL_WRITE_HANDLER(bin_size)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(source, indexes);
+
+	PMEMobjpool *pop = ctx;
+	unsigned arg_in = *(unsigned *)arg;
+
+	return heap_set_thread_cache_bin_size(&pop->heap, arg_in);
+}
+
+static const struct ctl_argument CTL_ARG(bin_size) = CTL_ARG_LONG_LONG;
+
+/*
+ * CTL_READ_HANDLER(max_size) -- reads the largest unit size of an allocation
+ *	class served from the thread caches
+ */
+static int
+CTL_READ_HANDLER(max_size)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(source, indexes);
+
+	PMEMobjpool *pop = ctx;
+	ssize_t *arg_out = arg;
+
+	*arg_out = (ssize_t)heap_get_thread_cache_max_size(&pop->heap);
+
+	return 0;
+}
+
+/*
+ * CTL_WRITE_HANDLER(max_size) -- changes the largest unit size of
+ *	an allocation class served from the thread caches
+ */
+static int
+CTL_WRITE_HANDLER(max_size)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(source, indexes);
+
+	PMEMobjpool *pop = ctx;
+	ssize_t arg_in = *(ssize_t *)arg;
+
+	if (arg_in < 0) {
+		ERR("thread cache max size cannot be negative");
+		errno = EINVAL;
+		return -1;
+	}
+
+	heap_set_thread_cache_max_size(&pop->heap, (size_t)arg_in);
+
+	return 0;
+}
+
+static const struct ctl_argument CTL_ARG(max_size) = CTL_ARG_LONG_LONG;
+
+/*
+ * CTL_RUNNABLE_HANDLER(flush) -- returns the blocks cached by the calling
+ *	thread back to the heap
+ */
+static int
+CTL_RUNNABLE_HANDLER(flush)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(source, arg, indexes);
+
+	PMEMobjpool *pop = ctx;
+
+	heap_thread_cache_flush(&pop->heap);
+
+	return 0;
+}
+
+static const struct ctl_node CTL_NODE(thread_cache)[] = {
+	CTL_LEAF_RW(enabled),
+	CTL_LEAF_RW(bin_size),
+	CTL_LEAF_RW(max_size),
+	CTL_LEAF_RUNNABLE(flush),
+
+	CTL_NODE_END
+};
+
+/*
+ * CTL_RUNNABLE_HANDLER(start) -- starts the background defragmentation
+ */
+static int
+CTL_RUNNABLE_HANDLER(start)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(source, indexes);
+
+	PMEMobjpool *pop = ctx;
+
+	return defrag_daemon_start(pop->defrag, arg);
+}
+
+/*
+ * CTL_RUNNABLE_HANDLER(stop) -- stops the background defragmentation
+ */
+static int
+CTL_RUNNABLE_HANDLER(stop)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(source, arg, indexes);
+
+	PMEMobjpool *pop = ctx;
+
+	defrag_daemon_stop(pop->defrag);
+
+	return 0;
+}
+
+/*
+ * CTL_READ_HANDLER(fill_threshold) -- reads the percentage of used units
+ *	below which the runs are defragmented
+ */
+static int
+CTL_READ_HANDLER(fill_threshold)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(source, indexes);
+
+	PMEMobjpool *pop = ctx;
+
+	unsigned *arg_out = arg;
+
+	*arg_out = defrag_daemon_get_fill_threshold(pop->defrag);
+
+	return 0;
+}
+
+/*
+ * CTL_WRITE_HANDLER(fill_threshold) -- sets the percentage of used units
+ *	below which the runs are defragmented
+ */
+static int
+CTL_WRITE_HANDLER(fill_threshold)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(source, indexes);
+
+	PMEMobjpool *pop = ctx;
+
+	ssize_t arg_in = *(ssize_t *)arg;
+
+	/* palloc_defrag doesn't move the objects of runs filled above that */
+	if (arg_in < 0 || arg_in > DEFRAG_MAX_FILL_THRESHOLD) {
+		ERR("fill threshold must be between 0 and %d",
+			DEFRAG_MAX_FILL_THRESHOLD);
+		errno = EINVAL;
+		return -1;
+	}
+
+	defrag_daemon_set_fill_threshold(pop->defrag, (unsigned)arg_in);
+
+	return 0;
+}
+
+static const struct ctl_argument CTL_ARG(fill_threshold) = CTL_ARG_LONG_LONG;
+
+/*
+ * CTL_READ_HANDLER(bandwidth) -- reads the maximum number of bytes relocated
+ *	by the background defragmentation per second
+ */
+static int
+CTL_READ_HANDLER(bandwidth)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(source, indexes);
+
+	PMEMobjpool *pop = ctx;
+
+	uint64_t *arg_out = arg;
+
+	*arg_out = defrag_daemon_get_bandwidth(pop->defrag);
+
+	return 0;
+}
+
+/*
+ * CTL_WRITE_HANDLER(bandwidth) -- sets the maximum number of bytes relocated
+ *	by the background defragmentation per second
+ */
+static int
+CTL_WRITE_HANDLER(bandwidth)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(source, indexes);
+
+	PMEMobjpool *pop = ctx;
+
+	ssize_t arg_in = *(ssize_t *)arg;
+
+	if (arg_in < 0) {
+		ERR("bandwidth must not be negative");
+		errno = EINVAL;
+		return -1;
+	}
+
+	defrag_daemon_set_bandwidth(pop->defrag, (uint64_t)arg_in);
+
+	return 0;
+}
+
+static const struct ctl_argument CTL_ARG(bandwidth) = CTL_ARG_LONG_LONG;
+
+/*
+ * CTL_READ_HANDLER(interval) -- reads the time, in milliseconds, between
+ *	the searches for sparse runs
+ */
+static int
+CTL_READ_HANDLER(interval)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(source, indexes);
+
+	PMEMobjpool *pop = ctx;
+
+	uint64_t *arg_out = arg;
+
+	*arg_out = defrag_daemon_get_interval(pop->defrag);
+
+	return 0;
+}
+
+/*
+ * CTL_WRITE_HANDLER(interval) -- sets the time, in milliseconds, between
+ *	the searches for sparse runs
+ */
+static int
+CTL_WRITE_HANDLER(interval)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(source, indexes);
+
+	PMEMobjpool *pop = ctx;
+
+	ssize_t arg_in = *(ssize_t *)arg;
+
+	if (arg_in < 0) {
+		ERR("interval must not be negative");
+		errno = EINVAL;
+		return -1;
+	}
+
+	defrag_daemon_set_interval(pop->defrag, (uint64_t)arg_in);
+
+	return 0;
+}
+
+static const struct ctl_argument CTL_ARG(interval) = CTL_ARG_LONG_LONG;
+
+static const struct ctl_node CTL_NODE(defrag)[] = {
+	CTL_LEAF_RUNNABLE(start),
+	CTL_LEAF_RUNNABLE(stop),
+	CTL_LEAF_RW(fill_threshold),
+	CTL_LEAF_RW(bandwidth),
+	CTL_LEAF_RW(interval),
+
+	CTL_NODE_END
+};
+
+/*
+ * CTL_READ_HANDLER(max_actions) -- reads the number of actions after which
+ *	a batch of the publish queue is published without waiting any longer
+ */
+static int
+CTL_READ_HANDLER(max_actions)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(source, indexes);
+
+	PMEMobjpool *pop = ctx;
+
+	uint64_t *arg_out = arg;
+
+	*arg_out = publish_queue_get_max_actions(pop->publish_queue);
+
+	return 0;
+}
+
+/*
+ * CTL_WRITE_HANDLER(max_actions) -- sets the number of actions after which
+ *	a batch of the publish queue is published without waiting any longer
+ */
+static int
+CTL_WRITE_HANDLER(max_actions)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(source, indexes);
+
+	PMEMobjpool *pop = ctx;
+
+	ssize_t arg_in = *(ssize_t *)arg;
+
+	if (arg_in < 1 || arg_in > PUBLISH_QUEUE_MAX_MAX_ACTIONS) {
+		ERR("max_actions must be between 1 and %d",
+			PUBLISH_QUEUE_MAX_MAX_ACTIONS);
+		errno = EINVAL;
+		return -1;
+	}
+
+	publish_queue_set_max_actions(pop->publish_queue, (size_t)arg_in);
+
+	return 0;
+}
+
+static const struct ctl_argument CTL_ARG(max_actions) = CTL_ARG_LONG_LONG;
+
+/*
+ * CTL_READ_HANDLER(max_wait) -- reads the maximum time, in microseconds,
+ *	for which a batch of the publish queue collects the actions
+ */
+static int
+CTL_READ_HANDLER(max_wait)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(source, indexes);
+
+	PMEMobjpool *pop = ctx;
+
+	uint64_t *arg_out = arg;
+
+	*arg_out = publish_queue_get_max_wait(pop->publish_queue);
+
+	return 0;
+}
+
+/*
+ * CTL_WRITE_HANDLER(max_wait) -- sets the maximum time, in microseconds,
+ *	for which a batch of the publish queue collects the actions
+ */
+static int
+CTL_WRITE_HANDLER(max_wait)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(source, indexes);
+
+	PMEMobjpool *pop = ctx;
+
+	ssize_t arg_in = *(ssize_t *)arg;
+
+	if (arg_in < 0 || arg_in > PUBLISH_QUEUE_MAX_MAX_WAIT) {
+		ERR("max_wait must be between 0 and %d",
+			PUBLISH_QUEUE_MAX_MAX_WAIT);
+		errno = EINVAL;
+		return -1;
+	}
+
+	publish_queue_set_max_wait(pop->publish_queue, (uint64_t)arg_in);
+
+	return 0;
+}
+
+static const struct ctl_argument CTL_ARG(max_wait) = CTL_ARG_LONG_LONG;
+
+static const struct ctl_node CTL_NODE(publish_queue)[] = {
+	CTL_LEAF_RW(max_actions),
+	CTL_LEAF_RW(max_wait),
+
+	CTL_NODE_END
+};
+
 static const struct ctl_node CTL_NODE(heap)[] = {
 	CTL_CHILD(alloc_class),
 	CTL_CHILD(arena),
 	CTL_CHILD(size),
 	CTL_CHILD(thread),
 	CTL_CHILD(narenas),
+	CTL_CHILD(thread_cache),
+	CTL_CHILD(defrag),
+	CTL_CHILD(publish_queue),
 
 	CTL_NODE_END
 };
@@ -900,6 +1412,8 @@ arenas_assignment_type_parser(const void *arg, void *dest, size_t dest_size)
 		*atype = POBJ_ARENAS_ASSIGNMENT_GLOBAL;
 	} else if (strcmp(vstr, "thread") == 0) {
 		*atype = POBJ_ARENAS_ASSIGNMENT_THREAD_KEY;
+	} else if (strcmp(vstr, "numa") == 0) {
+		*atype = POBJ_ARENAS_ASSIGNMENT_NUMA;
 	} else {
 		ERR("invalid arena assignment type");
 		errno = EINVAL;
@@ -963,9 +1477,173 @@ CTL_WRITE_HANDLER(arenas_default_max)(void *ctx,
 static const struct ctl_argument CTL_ARG(arenas_default_max) =
 	CTL_ARG_LONG_LONG;
 
+/*
+ * CTL_READ_HANDLER(parallel_reclaim) -- reads the number of threads used
+ *	to reclaim the heap zones at pool open
+ */
+static int
+CTL_READ_HANDLER(parallel_reclaim)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(ctx, source, indexes);
+
+	unsigned *nthreads = arg;
+
+	*nthreads = Default_parallel_reclaim;
+
+	return 0;
+}
+
+/*
+ * CTL_WRITE_HANDLER(parallel_reclaim) -- writes the number of threads used
+ *	to reclaim the heap zones at pool open
+ */
+static int
+CTL_WRITE_HANDLER(parallel_reclaim)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(ctx, source, indexes);
+
+	Default_parallel_reclaim = *(unsigned *)arg;
+
+	return 0;
+}
+
+static const struct ctl_argument CTL_ARG(parallel_reclaim) =
+	CTL_ARG_LONG_LONG;
+
+/*
+ * CTL_READ_HANDLER(huge_container) -- reads the type of the container of
+ *	the free chunks created at pool open
+ */
+static int
+CTL_READ_HANDLER(huge_container)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(ctx, source, indexes);
+
+	enum pobj_huge_container_type *dest = arg;
+
+	*dest = Default_huge_container;
+
+	return 0;
+}
+
+/*
+ * CTL_WRITE_HANDLER(huge_container) -- writes the type of the container of
+ *	the free chunks created at pool open
+ */
+static int
+CTL_WRITE_HANDLER(huge_container)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(ctx, source, indexes);
+
+	enum pobj_huge_container_type type =
+		*(enum pobj_huge_container_type *)arg;
+
+	if (type != POBJ_HUGE_CONTAINER_RAVL &&
+	    type != POBJ_HUGE_CONTAINER_CRITNIB) {
+		ERR("invalid huge container type");
+		errno = EINVAL;
+		return -1;
+	}
+
+	Default_huge_container = type;
+
+	return 0;
+}
+
+/*
+ * huge_container_parser -- parses the huge container enum
+ */
+static int
+huge_container_parser(const void *arg, void *dest, size_t dest_size)
+{
+	const char *vstr = arg;
+	enum pobj_huge_container_type *type = dest;
+	ASSERTeq(dest_size, sizeof(enum pobj_huge_container_type));
+
+	if (strcmp(vstr, "ravl") == 0) {
+		*type = POBJ_HUGE_CONTAINER_RAVL;
+	} else if (strcmp(vstr, "critnib") == 0) {
+		*type = POBJ_HUGE_CONTAINER_CRITNIB;
+	} else {
+		ERR("invalid huge container type");
+		errno = EINVAL;
+		return -1;
+	}
+
+	return 0;
+}
+
+static const struct ctl_argument CTL_ARG(huge_container) = {
+	.dest_size = sizeof(enum pobj_huge_container_type),
+	.parsers = {
+		CTL_ARG_PARSER(enum pobj_huge_container_type,
+			huge_container_parser),
+		CTL_ARG_PARSER_END
+	}
+};
+
+static const struct ctl_node CTL_NODE(open)[] = {
+	CTL_LEAF_RW(parallel_reclaim),
+	CTL_LEAF_RW(huge_container),
+
+	CTL_NODE_END
+};
+
+/*
+ * CTL_READ_HANDLER(huge_align) -- reads whether the pools created afterwards
+ *	support huge blocks with aligned data
+ */
+static int
+CTL_READ_HANDLER(huge_align)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(ctx, source, indexes);
+
+	int *arg_out = arg;
+
+	*arg_out = Default_huge_align;
+
+	return 0;
+}
+
+/*
+ * CTL_WRITE_HANDLER(huge_align) -- sets whether the pools created afterwards
+ *	support huge blocks with aligned data
+ */
+static int
+CTL_WRITE_HANDLER(huge_align)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(ctx, source, indexes);
+
+	Default_huge_align = *(int *)arg;
+
+	return 0;
+}
+
+static const struct ctl_argument CTL_ARG(huge_align) = CTL_ARG_BOOLEAN;
+
+static const struct ctl_node CTL_NODE(create)[] = {
+	CTL_LEAF_RW(huge_align),
+
+	CTL_NODE_END
+};
+
 static const struct ctl_node CTL_NODE(heap_global)[] = {
 	CTL_LEAF_RW(arenas_assignment_type),
 	CTL_LEAF_RW(arenas_default_max),
+	CTL_CHILD(open),
+	CTL_CHILD(create),
 
 	CTL_NODE_END
 };
@@ -0,0 +1,283 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2026, Intel Corporation */
+
+/*
+ * publish_queue.c -- batching the publications of actions from many threads
+ *
+ * A thread publishing its actions through the queue appends them to the batch
+ * which is currently being formed and waits. The first thread that appends to
+ * a batch becomes its leader: it waits, up to the maximum wait time, for the
+ * batch to collect the maximum number of actions, then publishes all the
+ * actions of the batch in a single redo log operation and wakes up the other
+ * members of the batch.
+ *
+ * Once the leader takes a batch out of the queue, the next thread to arrive
+ * starts forming a new one, so the batches are published concurrently,
+ * each in its own lane.
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+
+#include "alloc.h"
+#include "os.h"
+#include "os_thread.h"
+#include "out.h"
+#include "publish_queue.h"
+#include "sys_util.h"
+
+struct publish_queue_member {
+	struct pobj_action *actv;
+	size_t actvcnt;
+
+	struct publish_queue_member *next;
+	int done;
+	int ret;
+	int error; /* errno of the failed publication */
+};
+
+struct publish_queue {
+	os_mutex_t lock;
+	os_cond_t cond; /* signaled when the state of any batch changes */
+
+	/* members of the batch being formed, in the order of arrival */
+	struct publish_queue_member *forming;
+	struct publish_queue_member **forming_tail;
+	size_t nactions; /* number of actions in the batch being formed */
+	int leader; /* the batch being formed already has a leader */
+
+	size_t max_actions;
+	uint64_t max_wait; /* in microseconds */
+
+	publish_queue_fn publish;
+	void *arg;
+};
+
+/*
+ * publish_queue_new -- creates a new publish queue
+ */
+struct publish_queue *
+publish_queue_new(publish_queue_fn publish, void *arg)
+{
+	struct publish_queue *q = Zalloc(sizeof(*q));
+	if (q == NULL) {
+		ERR("!Zalloc");
+		return NULL;
+	}
+
+	util_mutex_init(&q->lock);
+	os_cond_init(&q->cond);
+
+	q->forming_tail = &q->forming;
+	q->max_actions = PUBLISH_QUEUE_DEFAULT_MAX_ACTIONS;
+	q->max_wait = PUBLISH_QUEUE_DEFAULT_MAX_WAIT;
+	q->publish = publish;
+	q->arg = arg;
+
+	return q;
+}
+
+/*
+ * publish_queue_delete -- deletes the publish queue
+ */
+void
+publish_queue_delete(struct publish_queue *q)
+{
+	ASSERTeq(q->forming, NULL);
+
+	os_cond_destroy(&q->cond);
+	util_mutex_destroy(&q->lock);
+	Free(q);
+}
+
+/*
+ * publish_queue_deadline -- (internal) calculates the absolute time
+ *	at which the leader stops waiting for the batch to fill up
+ */
+static void
+publish_queue_deadline(struct timespec *deadline, uint64_t max_wait)
+{
+	os_clock_gettime(CLOCK_REALTIME, deadline);
+
+	uint64_t nsec = (uint64_t)deadline->tv_nsec + max_wait * 1000;
+	deadline->tv_sec += (time_t)(nsec / 1000000000);
+	deadline->tv_nsec = (long)(nsec % 1000000000);
+}
+
+/*
+ * publish_queue_member_publish -- (internal) publishes the actions of
+ *	a single member
+ */
+static void
+publish_queue_member_publish(struct publish_queue *q,
+	struct publish_queue_member *m)
+{
+	m->ret = q->publish(q->arg, m->actv, m->actvcnt);
+	m->error = m->ret != 0 ? errno : 0;
+}
+
+/*
+ * publish_queue_batch_publish -- (internal) publishes the actions of all
+ *	the members of a batch at once
+ */
+static void
+publish_queue_batch_publish(struct publish_queue *q,
+	struct publish_queue_member *batch, size_t nactions)
+{
+	if (batch->next == NULL) {
+		publish_queue_member_publish(q, batch);
+		return;
+	}
+
+	/* publishing reorders the actions, so they are copied */
+	struct pobj_action *actv = Malloc(sizeof(*actv) * nactions);
+	if (actv == NULL) {
+		LOG(2, "!failed to allocate the batch, publishing separately");
+		for (struct publish_queue_member *m = batch; m != NULL;
+				m = m->next)
+			publish_queue_member_publish(q, m);
+		return;
+	}
+
+	size_t n = 0;
+	for (struct publish_queue_member *m = batch; m != NULL; m = m->next) {
+		memcpy(&actv[n], m->actv, sizeof(*actv) * m->actvcnt);
+		n += m->actvcnt;
+	}
+	ASSERTeq(n, nactions);
+
+	int ret = q->publish(q->arg, actv, nactions);
+	int error = ret != 0 ? errno : 0;
+
+	Free(actv);
+
+	for (struct publish_queue_member *m = batch; m != NULL; m = m->next) {
+		m->ret = ret;
+		m->error = error;
+	}
+}
+
+/*
+ * publish_queue_publish -- publishes the actions together with the actions
+ *	of the other threads publishing at the same time, and waits until
+ *	they are published
+ */
+int
+publish_queue_publish(struct publish_queue *q, struct pobj_action *actv,
+	size_t actvcnt)
+{
+	struct publish_queue_member self = {actv, actvcnt, NULL, 0, 0, 0};
+
+	util_mutex_lock(&q->lock);
+
+	*q->forming_tail = &self;
+	q->forming_tail = &self.next;
+	q->nactions += actvcnt;
+
+	if (q->leader) {
+		if (q->nactions >= q->max_actions)
+			os_cond_broadcast(&q->cond);
+
+		while (!self.done)
+			os_cond_wait(&q->cond, &q->lock);
+
+		util_mutex_unlock(&q->lock);
+
+		if (self.ret != 0)
+			errno = self.error;
+		return self.ret;
+	}
+
+	q->leader = 1;
+
+	if (q->max_wait != 0) {
+		struct timespec deadline;
+		publish_queue_deadline(&deadline, q->max_wait);
+
+		while (q->nactions < q->max_actions) {
+			if (os_cond_timedwait(&q->cond, &q->lock,
+					&deadline) == ETIMEDOUT)
+				break;
+		}
+	}
+
+	struct publish_queue_member *batch = q->forming;
+	size_t nactions = q->nactions;
+
+	q->forming = NULL;
+	q->forming_tail = &q->forming;
+	q->nactions = 0;
+	q->leader = 0;
+
+	util_mutex_unlock(&q->lock);
+
+	publish_queue_batch_publish(q, batch, nactions);
+
+	util_mutex_lock(&q->lock);
+
+	while (batch != NULL) {
+		struct publish_queue_member *next = batch->next;
+		batch->done = 1;
+		batch = next;
+	}
+
+	os_cond_broadcast(&q->cond);
+	util_mutex_unlock(&q->lock);
+
+	if (self.ret != 0)
+		errno = self.error;
+	return self.ret;
+}
+
+/*
+ * publish_queue_get_max_actions -- returns the number of actions after which
+ *	a batch is published without waiting any longer
+ */
+size_t
+publish_queue_get_max_actions(struct publish_queue *q)
+{
+	util_mutex_lock(&q->lock);
+	size_t max_actions = q->max_actions;
+	util_mutex_unlock(&q->lock);
+
+	return max_actions;
+}
+
+/*
+ * publish_queue_set_max_actions -- sets the number of actions after which
+ *	a batch is published without waiting any longer
+ */
+void
+publish_queue_set_max_actions(struct publish_queue *q, size_t max_actions)
+{
+	util_mutex_lock(&q->lock);
+	q->max_actions = max_actions;
+	util_mutex_unlock(&q->lock);
+}
+
+/*
+ * publish_queue_get_max_wait -- returns the maximum time the leader of
+ *	a batch waits for the batch to fill up
+ */
+uint64_t
+publish_queue_get_max_wait(struct publish_queue *q)
+{
+	util_mutex_lock(&q->lock);
+	uint64_t max_wait = q->max_wait;
+	util_mutex_unlock(&q->lock);
+
+	return max_wait;
+}
+
+/*
+ * publish_queue_set_max_wait -- sets the maximum time the leader of a batch
+ *	waits for the batch to fill up
+ */
+void
+publish_queue_set_max_wait(struct publish_queue *q, uint64_t max_wait)
+{
+	util_mutex_lock(&q->lock);
+	q->max_wait = max_wait;
+	util_mutex_unlock(&q->lock);
+}
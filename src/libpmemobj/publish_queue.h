@@ -0,0 +1,49 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright 2026, Intel Corporation */
+
+/*
+ * publish_queue.h -- internal definitions for batching the publications of
+ *	actions from many threads
+ */
+
+#ifndef LIBPMEMOBJ_PUBLISH_QUEUE_H
+#define LIBPMEMOBJ_PUBLISH_QUEUE_H 1
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "libpmemobj/action_base.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PUBLISH_QUEUE_DEFAULT_MAX_ACTIONS 1024
+#define PUBLISH_QUEUE_MAX_MAX_ACTIONS (1 << 20)
+#define PUBLISH_QUEUE_DEFAULT_MAX_WAIT 50 /* microseconds */
+#define PUBLISH_QUEUE_MAX_MAX_WAIT 1000000 /* one second */
+
+struct publish_queue;
+
+/* publishes a batch of actions, returns 0 or -1 with errno set */
+typedef int (*publish_queue_fn)(void *arg, struct pobj_action *actv,
+	size_t actvcnt);
+
+struct publish_queue *publish_queue_new(publish_queue_fn publish, void *arg);
+void publish_queue_delete(struct publish_queue *q);
+
+int publish_queue_publish(struct publish_queue *q, struct pobj_action *actv,
+	size_t actvcnt);
+
+size_t publish_queue_get_max_actions(struct publish_queue *q);
+void publish_queue_set_max_actions(struct publish_queue *q,
+	size_t max_actions);
+
+uint64_t publish_queue_get_max_wait(struct publish_queue *q);
+void publish_queue_set_max_wait(struct publish_queue *q, uint64_t max_wait);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
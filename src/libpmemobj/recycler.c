@@ -16,6 +16,9 @@
 
 #define THRESHOLD_MUL 4
 
+/* the maximum number of runs inspected when looking for a sparse one */
+#define SPARSE_SEARCH_LIMIT 1024
+
 /*
  * recycler_element_cmp -- compares two recycler elements
  */
@@ -199,6 +202,74 @@ out:
 	return ret;
 }
 
+/*
+ * recycler_get_sparse -- retrieves the run with the least number of used
+ *	units, provided that there are no more than max_used of them
+ *
+ * Empty runs are left in the recycler, those are turned into free chunks
+ * by the recalculation of the scores. The runs with unaccounted frees have
+ * their free space recalculated, but the scores in the tree are not updated.
+ */
+int
+recycler_get_sparse(struct recycler *r, uint32_t max_used,
+	struct memory_block *m)
+{
+	util_mutex_lock(&r->lock);
+
+	struct ravl_node *best = NULL;
+	uint32_t best_used = UINT32_MAX;
+
+	struct memory_block nm = MEMORY_BLOCK_NONE;
+	struct ravl_node *n;
+	struct recycler_element next = {0, 0, 0, 0};
+	enum ravl_predicate p = RAVL_PREDICATE_GREATER_EQUAL;
+	for (unsigned i = 0; i < SPARSE_SEARCH_LIMIT; ++i) {
+		if ((n = ravl_find(r->runs, &next, p)) == NULL)
+			break;
+
+		p = RAVL_PREDICATE_GREATER;
+
+		struct recycler_element *ne = ravl_data(n);
+		next = *ne;
+
+		uint32_t free_space = ne->free_space;
+		if (r->unaccounted_units[ne->chunk_id] != 0) {
+			nm.chunk_id = ne->chunk_id;
+			nm.zone_id = ne->zone_id;
+			memblock_rebuild_state(r->heap, &nm);
+			free_space = recycler_element_new(r->heap,
+				&nm).free_space;
+		}
+
+		uint32_t used = (uint32_t)r->nallocs - free_space;
+		if (used == 0 || used > max_used || used >= best_used)
+			continue;
+
+		best = n;
+		best_used = used;
+	}
+
+	if (best == NULL) {
+		util_mutex_unlock(&r->lock);
+		return ENOMEM;
+	}
+
+	struct recycler_element *be = ravl_data(best);
+	m->chunk_id = be->chunk_id;
+	m->zone_id = be->zone_id;
+
+	ravl_remove(r->runs, best);
+
+	struct chunk_header *hdr = heap_get_chunk_hdr(r->heap, m);
+	m->size_idx = hdr->size_idx;
+
+	memblock_rebuild_state(r->heap, m);
+
+	util_mutex_unlock(&r->lock);
+
+	return 0;
+}
+
 /*
  * recycler_recalc -- recalculates the scores of runs in the recycler to match
  *	the updated persistent state
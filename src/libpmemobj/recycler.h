@@ -38,6 +38,8 @@ struct recycler_element recycler_element_new(struct palloc_heap *heap,
 int recycler_put(struct recycler *r, struct recycler_element element);
 
 int recycler_get(struct recycler *r, struct memory_block *m);
+int recycler_get_sparse(struct recycler *r, uint32_t max_used,
+	struct memory_block *m);
 
 struct empty_runs recycler_recalc(struct recycler *r, int force);
 
@@ -0,0 +1,339 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2026, Intel Corporation */
+
+/*
+ * replica_mover.c -- asynchronous propagation of writes to the replicas
+ *
+ * In the asynchronous replication mode, the master replica is written to
+ * synchronously, and the modified ranges are queued to a background thread
+ * which copies them to all the other replicas. The number of bytes waiting
+ * in the queue is bounded, and writers are stalled once that limit is
+ * exceeded. The replicas are made consistent with the master replica by
+ * replica_mover_sync and when the pool is closed.
+ */
+
+#include <errno.h>
+
+#include "ctl.h"
+#include "libpmem.h"
+#include "obj.h"
+#include "os_thread.h"
+#include "out.h"
+#include "replica_mover.h"
+#include "sys_util.h"
+#include "vec.h"
+
+int Replica_async_enabled;
+size_t Replica_async_max_lag = REPLICA_ASYNC_DEFAULT_MAX_LAG;
+
+struct replica_range {
+	uintptr_t off;
+	size_t len;
+};
+
+VEC(replica_range_vec, struct replica_range);
+
+struct replica_mover {
+	PMEMobjpool *pop;
+	size_t max_lag;
+
+	os_mutex_t lock;
+	os_cond_t work_cond; /* signaled when there are new ranges */
+	os_cond_t done_cond; /* signaled when a batch of ranges is copied */
+
+	struct replica_range_vec pending;
+	size_t nbytes; /* queued and in-flight bytes */
+
+	uint64_t queued; /* sequence number of the last queued range */
+	uint64_t completed; /* sequence number of the last copied range */
+
+	int stop;
+	os_thread_t thread;
+};
+
+/*
+ * replica_mover_copy -- (internal) copies a batch of ranges from the master
+ *	replica to all the other replicas
+ */
+static void
+replica_mover_copy(PMEMobjpool *pop, struct replica_range *ranges,
+	size_t nranges)
+{
+	for (PMEMobjpool *rep = pop->replica; rep != NULL;
+			rep = rep->replica) {
+		for (size_t i = 0; i < nranges; ++i) {
+			rep->memcpy_local((char *)rep + ranges[i].off,
+				(char *)pop + ranges[i].off, ranges[i].len,
+				PMEM_F_MEM_NODRAIN);
+		}
+		rep->drain_local();
+	}
+}
+
+/*
+ * replica_mover_worker -- (internal) the background replication thread
+ */
+static void *
+replica_mover_worker(void *arg)
+{
+	struct replica_mover *m = arg;
+	struct replica_range_vec batch = VEC_INITIALIZER;
+
+	util_mutex_lock(&m->lock);
+	for (;;) {
+		while (VEC_SIZE(&m->pending) == 0 && !m->stop)
+			os_cond_wait(&m->work_cond, &m->lock);
+
+		if (VEC_SIZE(&m->pending) == 0)
+			break;
+
+		/* take all the queued ranges, leaving an empty queue */
+		struct replica_range_vec tmp = batch;
+		batch = m->pending;
+		m->pending = tmp;
+		VEC_CLEAR(&m->pending);
+
+		uint64_t seq = m->queued;
+		util_mutex_unlock(&m->lock);
+
+		replica_mover_copy(m->pop, batch.buffer, VEC_SIZE(&batch));
+
+		size_t nbytes = 0;
+		struct replica_range *r;
+		VEC_FOREACH_BY_PTR(r, &batch)
+			nbytes += r->len;
+
+		util_mutex_lock(&m->lock);
+		m->nbytes -= nbytes;
+		m->completed = seq;
+		os_cond_broadcast(&m->done_cond);
+	}
+	util_mutex_unlock(&m->lock);
+
+	VEC_DELETE(&batch);
+
+	return NULL;
+}
+
+/*
+ * replica_mover_new -- creates and starts a new replication thread
+ */
+struct replica_mover *
+replica_mover_new(PMEMobjpool *pop, size_t max_lag)
+{
+	struct replica_mover *m = Zalloc(sizeof(*m));
+	if (m == NULL) {
+		ERR("!Zalloc");
+		return NULL;
+	}
+
+	m->pop = pop;
+	m->max_lag = max_lag;
+	VEC_INIT(&m->pending);
+
+	util_mutex_init(&m->lock);
+	os_cond_init(&m->work_cond);
+	os_cond_init(&m->done_cond);
+
+	int ret = os_thread_create(&m->thread, NULL, replica_mover_worker, m);
+	if (ret != 0) {
+		errno = ret;
+		ERR("!os_thread_create");
+		goto error_thread_create;
+	}
+
+	return m;
+
+error_thread_create:
+	os_cond_destroy(&m->done_cond);
+	os_cond_destroy(&m->work_cond);
+	util_mutex_destroy(&m->lock);
+	VEC_DELETE(&m->pending);
+	Free(m);
+	return NULL;
+}
+
+/*
+ * replica_mover_delete -- copies all the outstanding ranges to the replicas,
+ *	and stops the replication thread
+ */
+void
+replica_mover_delete(struct replica_mover *m)
+{
+	util_mutex_lock(&m->lock);
+	m->stop = 1;
+	os_cond_signal(&m->work_cond);
+	util_mutex_unlock(&m->lock);
+
+	os_thread_join(&m->thread, NULL);
+
+	ASSERTeq(m->nbytes, 0);
+	ASSERTeq(m->queued, m->completed);
+
+	os_cond_destroy(&m->done_cond);
+	os_cond_destroy(&m->work_cond);
+	util_mutex_destroy(&m->lock);
+	VEC_DELETE(&m->pending);
+	Free(m);
+}
+
+/*
+ * replica_mover_enqueue -- queues a modified range of the master replica
+ *	to be copied to the other replicas
+ *
+ * Waits for the replication thread if the number of outstanding bytes
+ * exceeds the maximum replication lag.
+ */
+void
+replica_mover_enqueue(struct replica_mover *m, const void *addr, size_t len)
+{
+	if (len == 0)
+		return;
+
+	struct replica_range range = {
+		(uintptr_t)addr - (uintptr_t)m->pop, len
+	};
+
+	util_mutex_lock(&m->lock);
+
+	/* extend the last range if the new one directly follows it */
+	struct replica_range *last = VEC_SIZE(&m->pending) == 0 ? NULL :
+		&VEC_BACK(&m->pending);
+	if (last != NULL && last->off + last->len == range.off) {
+		last->len += range.len;
+	} else if (VEC_PUSH_BACK(&m->pending, range) != 0) {
+		/* no memory for the queue, copy the range synchronously */
+		util_mutex_unlock(&m->lock);
+		replica_mover_copy(m->pop, &range, 1);
+		return;
+	}
+
+	m->nbytes += len;
+	m->queued++;
+	os_cond_signal(&m->work_cond);
+
+	while (m->nbytes > m->max_lag)
+		os_cond_wait(&m->done_cond, &m->lock);
+
+	util_mutex_unlock(&m->lock);
+}
+
+/*
+ * replica_mover_sync -- waits until all the ranges queued so far are
+ *	persistent in all the replicas
+ */
+void
+replica_mover_sync(struct replica_mover *m)
+{
+	util_mutex_lock(&m->lock);
+
+	uint64_t seq = m->queued;
+	while (m->completed < seq)
+		os_cond_wait(&m->done_cond, &m->lock);
+
+	util_mutex_unlock(&m->lock);
+}
+
+/*
+ * CTL_READ_HANDLER(enabled) -- returns whether the asynchronous replication
+ *	is enabled for newly opened pools
+ */
+static int
+CTL_READ_HANDLER(enabled)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(ctx, source, indexes);
+
+	int *arg_out = arg;
+
+	*arg_out = Replica_async_enabled;
+
+	return 0;
+}
+
+/*
+ * CTL_WRITE_HANDLER(enabled) -- enables or disables the asynchronous
+ *	replication for newly opened pools
+ */
+static int
+CTL_WRITE_HANDLER(enabled)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(ctx, source, indexes);
+
+	Replica_async_enabled = *(int *)arg;
+
+	return 0;
+}
+
+static const struct ctl_argument CTL_ARG(enabled) = CTL_ARG_BOOLEAN;
+
+/*
+ * CTL_READ_HANDLER(max_lag) -- reads the maximum number of bytes waiting
+ *	to be copied to the replicas
+ */
+static int
+CTL_READ_HANDLER(max_lag)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(ctx, source, indexes);
+
+	size_t *arg_out = arg;
+
+	*arg_out = Replica_async_max_lag;
+
+	return 0;
+}
+
+/*
+ * CTL_WRITE_HANDLER(max_lag) -- sets the maximum number of bytes waiting
+ *	to be copied to the replicas
+ */
+static int
+CTL_WRITE_HANDLER(max_lag)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(ctx, source, indexes);
+
+	ssize_t arg_in = *(ssize_t *)arg;
+
+	if (arg_in <= 0) {
+		ERR("maximum replication lag must be a positive value");
+		errno = EINVAL;
+		return -1;
+	}
+
+	Replica_async_max_lag = (size_t)arg_in;
+
+	return 0;
+}
+
+static const struct ctl_argument CTL_ARG(max_lag) = CTL_ARG_LONG_LONG;
+
+static const struct ctl_node CTL_NODE(async)[] = {
+	CTL_LEAF_RW(enabled),
+	CTL_LEAF_RW(max_lag),
+
+	CTL_NODE_END
+};
+
+static const struct ctl_node CTL_NODE(replica_global)[] = {
+	CTL_CHILD(async),
+
+	CTL_NODE_END
+};
+
+/*
+ * replica_global_ctl_register -- registers global ctl entries of
+ *	the replication
+ */
+void
+replica_global_ctl_register(void)
+{
+	ctl_register_module_node(NULL, "replica",
+		(struct ctl_node *)CTL_NODE(replica_global));
+}
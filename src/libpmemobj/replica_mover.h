@@ -0,0 +1,40 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright 2026, Intel Corporation */
+
+/*
+ * replica_mover.h -- internal definitions for asynchronous replication
+ */
+
+#ifndef LIBPMEMOBJ_REPLICA_MOVER_H
+#define LIBPMEMOBJ_REPLICA_MOVER_H 1
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define REPLICA_ASYNC_DEFAULT_MAX_LAG (1 << 26) /* 64 megabytes */
+
+extern int Replica_async_enabled;
+extern size_t Replica_async_max_lag;
+
+struct pmemobjpool;
+struct replica_mover;
+
+struct replica_mover *replica_mover_new(struct pmemobjpool *pop,
+	size_t max_lag);
+void replica_mover_delete(struct replica_mover *mover);
+
+void replica_mover_enqueue(struct replica_mover *mover,
+	const void *addr, size_t len);
+void replica_mover_sync(struct replica_mover *mover);
+
+void replica_global_ctl_register(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -5,18 +5,427 @@
  * stats.c -- implementation of statistics
  */
 
+#include <inttypes.h>
+#include <time.h>
+
+#include "alloc_class.h"
+#include "heap.h"
 #include "obj.h"
+#include "os.h"
 #include "stats.h"
 
 STATS_CTL_HANDLER(persistent, curr_allocated, heap_curr_allocated);
 
 STATS_CTL_HANDLER(transient, run_allocated, heap_run_allocated);
 STATS_CTL_HANDLER(transient, run_active, heap_run_active);
+STATS_CTL_HANDLER(transient, defrag_runs, heap_defrag_runs);
+STATS_CTL_HANDLER(transient, defrag_objects, heap_defrag_objects);
+STATS_CTL_HANDLER(transient, defrag_bytes, heap_defrag_bytes);
+STATS_CTL_HANDLER(transient, huge_align_fallbacks, heap_huge_align_fallbacks);
+STATS_CTL_HANDLER(transient, publish_batches, heap_publish_batches);
+STATS_CTL_HANDLER(transient, publish_batched_actions,
+	heap_publish_batched_actions);
+
+/*
+ * CTL_READ_HANDLER(occupancy, alloc_class) -- reads the occupancy of
+ *	the allocation class
+ */
+static int
+CTL_READ_HANDLER(occupancy, alloc_class)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(source);
+
+	PMEMobjpool *pop = ctx;
+
+	struct ctl_index *idx = PMDK_SLIST_FIRST(indexes);
+	ASSERTeq(strcmp(idx->name, "class_id"), 0);
+
+	if (idx->value < 0 || idx->value >= MAX_ALLOCATION_CLASSES) {
+		ERR("class id outside of the allowed range");
+		errno = ERANGE;
+		return -1;
+	}
+
+	if (heap_get_class_occupancy(&pop->heap, (unsigned)idx->value,
+			arg) != 0) {
+		ERR("class with the given id does not exist");
+		errno = ENOENT;
+		return -1;
+	}
+
+	return 0;
+}
+
+static const struct ctl_node CTL_NODE(class_id)[] = {
+	CTL_LEAF_RO(occupancy, alloc_class),
+
+	CTL_NODE_END
+};
+
+static const struct ctl_node CTL_NODE(alloc_class)[] = {
+	CTL_INDEXED(class_id),
+
+	CTL_NODE_END
+};
+
+/*
+ * CTL_READ_HANDLER(occupancy, zone) -- reads the free chunks of the zone
+ */
+static int
+CTL_READ_HANDLER(occupancy, zone)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(source);
+
+	PMEMobjpool *pop = ctx;
+
+	struct ctl_index *idx = PMDK_SLIST_FIRST(indexes);
+	ASSERTeq(strcmp(idx->name, "zone_id"), 0);
+
+	if (idx->value < 0 ||
+	    heap_get_zone_occupancy(&pop->heap, (unsigned)idx->value,
+			arg) != 0) {
+		ERR("zone id outside of the heap");
+		errno = ERANGE;
+		return -1;
+	}
+
+	return 0;
+}
+
+static const struct ctl_node CTL_NODE(zone_id)[] = {
+	CTL_LEAF_RO(occupancy, zone),
+
+	CTL_NODE_END
+};
+
+static const struct ctl_node CTL_NODE(zone)[] = {
+	CTL_INDEXED(zone_id),
+
+	CTL_NODE_END
+};
+
+/*
+ * CTL_READ_HANDLER(nzones) -- reads the number of zones of the heap
+ */
+static int
+CTL_READ_HANDLER(nzones)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(source, indexes);
+
+	PMEMobjpool *pop = ctx;
+	unsigned *nzones = arg;
+
+	*nzones = heap_get_nzones(&pop->heap);
+
+	return 0;
+}
 
 static const struct ctl_node CTL_NODE(heap)[] = {
 	STATS_CTL_LEAF(persistent, curr_allocated),
 	STATS_CTL_LEAF(transient, run_allocated),
 	STATS_CTL_LEAF(transient, run_active),
+	STATS_CTL_LEAF(transient, defrag_runs),
+	STATS_CTL_LEAF(transient, defrag_objects),
+	STATS_CTL_LEAF(transient, defrag_bytes),
+	STATS_CTL_LEAF(transient, huge_align_fallbacks),
+	STATS_CTL_LEAF(transient, publish_batches),
+	STATS_CTL_LEAF(transient, publish_batched_actions),
+	CTL_LEAF_RO(nzones),
+	CTL_CHILD(alloc_class),
+	CTL_CHILD(zone),
+
+	CTL_NODE_END
+};
+
+STATS_CTL_HANDLER(transient, recovered, lanes_recovered);
+STATS_CTL_HANDLER(transient, recovery_time, lanes_recovery_time);
+STATS_CTL_HANDLER(transient, spins, lanes_spins);
+STATS_CTL_HANDLER(transient, waits, lanes_waits);
+STATS_CTL_HANDLER(transient, wait_time, lanes_wait_time);
+
+/*
+ * CTL_READ_HANDLER(recovery_time, lane) -- returns the time spent on
+ *	the recovery of the specified lane at pool open
+ */
+static int
+CTL_READ_HANDLER(recovery_time, lane)(void *ctx,
+	enum ctl_query_source source, void *arg,
+	struct ctl_indexes *indexes)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(source);
+
+	PMEMobjpool *pop = ctx;
+	uint64_t *time = arg;
+
+	struct ctl_index *idx = PMDK_SLIST_FIRST(indexes);
+	ASSERTeq(strcmp(idx->name, "lane_id"), 0);
+
+	if (idx->value < 0 || (uint64_t)idx->value >= pop->nlanes) {
+		LOG(1, "lane id outside of the allowed range: <0,%" PRIu64 ")",
+			pop->nlanes);
+		errno = ERANGE;
+		return -1;
+	}
+
+	*time = pop->lanes_desc.lane[idx->value].recovery_time;
+
+	return 0;
+}
+
+static const struct ctl_node CTL_NODE(lane_id)[] = {
+	CTL_LEAF_RO(recovery_time, lane),
+
+	CTL_NODE_END
+};
+
+static const struct ctl_node CTL_NODE(lanes)[] = {
+	STATS_CTL_LEAF(transient, recovered),
+	STATS_CTL_LEAF(transient, recovery_time),
+	STATS_CTL_LEAF(transient, spins),
+	STATS_CTL_LEAF(transient, waits),
+	STATS_CTL_LEAF(transient, wait_time),
+	CTL_INDEXED(lane_id),
+
+	CTL_NODE_END
+};
+
+STATS_CTL_HANDLER(transient, undo_extensions_avoided,
+	tx_undo_extensions_avoided);
+STATS_CTL_HANDLER(transient, group_commits, tx_group_commits);
+STATS_CTL_HANDLER(transient, group_commit_drains, tx_group_commit_drains);
+
+/*
+ * stats_histogram_bucket -- (internal) returns the index of the bucket of
+ *	the value
+ */
+static inline unsigned
+stats_histogram_bucket(uint64_t value)
+{
+	if (value < (1ULL << STATS_HIST_SUB_BITS))
+		return (unsigned)value;
+
+	unsigned msb = util_mssb_index64(value);
+	unsigned shift = msb - STATS_HIST_SUB_BITS;
+	unsigned sub = (unsigned)(value >> shift) &
+		((1U << STATS_HIST_SUB_BITS) - 1);
+
+	return ((shift + 1) << STATS_HIST_SUB_BITS) | sub;
+}
+
+/*
+ * stats_histogram_bucket_max -- (internal) returns the largest value that
+ *	belongs to the bucket
+ */
+static inline uint64_t
+stats_histogram_bucket_max(unsigned bucket)
+{
+	if (bucket < (1U << STATS_HIST_SUB_BITS))
+		return bucket;
+
+	unsigned shift = (bucket >> STATS_HIST_SUB_BITS) - 1;
+	uint64_t sub = bucket & ((1U << STATS_HIST_SUB_BITS) - 1);
+	uint64_t min = ((1ULL << STATS_HIST_SUB_BITS) | sub) << shift;
+
+	return min + ((1ULL << shift) - 1);
+}
+
+/*
+ * stats_time_ns -- returns the monotonic time in nanoseconds
+ */
+uint64_t
+stats_time_ns(void)
+{
+	struct timespec t;
+	os_clock_gettime(CLOCK_MONOTONIC, &t);
+
+	return (uint64_t)t.tv_sec * 1000000000ULL + (uint64_t)t.tv_nsec;
+}
+
+/*
+ * stats_histogram_record -- adds the value to the histogram
+ */
+void
+stats_histogram_record(struct stats_histogram *hist, uint64_t value)
+{
+	util_fetch_and_add64(&hist->buckets[stats_histogram_bucket(value)], 1);
+	util_fetch_and_add64(&hist->total, value);
+
+	uint64_t cur;
+	util_atomic_load_explicit64(&hist->max, &cur, memory_order_relaxed);
+	while (value > cur &&
+	    !util_bool_compare_and_swap64(&hist->max, cur, value))
+		util_atomic_load_explicit64(&hist->max, &cur,
+			memory_order_relaxed);
+
+	/* the minimum is not set until the first value is counted */
+	util_atomic_load_explicit64(&hist->min, &cur, memory_order_relaxed);
+	while ((cur == 0 || value < cur) &&
+	    !util_bool_compare_and_swap64(&hist->min, cur, value))
+		util_atomic_load_explicit64(&hist->min, &cur,
+			memory_order_relaxed);
+
+	util_fetch_and_add64(&hist->count, 1);
+}
+
+/*
+ * stats_histogram_read -- (internal) summarizes the histogram
+ */
+static void
+stats_histogram_read(struct stats_histogram *hist,
+	struct pobj_tx_latency *out)
+{
+	static const unsigned permille[] = {500, 900, 990, 999};
+	uint64_t *pout[] = {&out->p50, &out->p90, &out->p99, &out->p999};
+
+	util_atomic_load_explicit64(&hist->count, &out->count,
+		memory_order_acquire);
+	util_atomic_load_explicit64(&hist->total, &out->total,
+		memory_order_relaxed);
+	util_atomic_load_explicit64(&hist->min, &out->min,
+		memory_order_relaxed);
+	util_atomic_load_explicit64(&hist->max, &out->max,
+		memory_order_relaxed);
+
+	/* the buckets can be updated concurrently, so count them again */
+	uint64_t counts[STATS_HIST_NBUCKETS];
+	uint64_t count = 0;
+	for (unsigned b = 0; b < STATS_HIST_NBUCKETS; ++b) {
+		util_atomic_load_explicit64(&hist->buckets[b], &counts[b],
+			memory_order_relaxed);
+		count += counts[b];
+	}
+
+	unsigned p = 0;
+	uint64_t seen = 0;
+	for (unsigned b = 0; b < STATS_HIST_NBUCKETS && p < ARRAY_SIZE(pout);
+			++b) {
+		seen += counts[b];
+		while (p < ARRAY_SIZE(pout) && counts[b] != 0 &&
+		    seen * 1000 >= count * permille[p]) {
+			*pout[p] = MIN(stats_histogram_bucket_max(b),
+				out->max);
+			p++;
+		}
+	}
+
+	for (; p < ARRAY_SIZE(pout); ++p)
+		*pout[p] = 0;
+}
+
+/*
+ * STATS_LATENCY_CTL_HANDLER -- defines the handler which reads
+ *	the latencies of the transaction phase
+ */
+#define STATS_LATENCY_CTL_HANDLER(name, phase)\
+static int CTL_READ_HANDLER(name, latency)(void *ctx,\
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)\
+{\
+	/* suppress unused-parameter errors */\
+	SUPPRESS_UNUSED(source, indexes);\
+\
+	PMEMobjpool *pop = ctx;\
+	stats_histogram_read(&pop->stats->tx_latency[phase], arg);\
+	return 0;\
+}
+
+STATS_LATENCY_CTL_HANDLER(begin, STATS_TX_PHASE_BEGIN);
+STATS_LATENCY_CTL_HANDLER(add_range, STATS_TX_PHASE_ADD_RANGE);
+STATS_LATENCY_CTL_HANDLER(alloc, STATS_TX_PHASE_ALLOC);
+STATS_LATENCY_CTL_HANDLER(commit_flush, STATS_TX_PHASE_COMMIT_FLUSH);
+STATS_LATENCY_CTL_HANDLER(commit_drain, STATS_TX_PHASE_COMMIT_DRAIN);
+STATS_LATENCY_CTL_HANDLER(redo_apply, STATS_TX_PHASE_REDO_APPLY);
+STATS_LATENCY_CTL_HANDLER(end, STATS_TX_PHASE_END);
+
+/*
+ * CTL_READ_HANDLER(enabled, latency) -- returns whether the latencies of
+ *	the transaction phases are recorded
+ */
+static int
+CTL_READ_HANDLER(enabled, latency)(void *ctx,
+	enum ctl_query_source source, void *arg,
+	struct ctl_indexes *indexes)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(source, indexes);
+
+	PMEMobjpool *pop = ctx;
+
+	int *arg_out = arg;
+
+	*arg_out = pop->stats->tx_latency_enabled;
+
+	return 0;
+}
+
+/*
+ * CTL_WRITE_HANDLER(enabled, latency) -- enables or disables recording of
+ *	the latencies of the transaction phases
+ */
+static int
+CTL_WRITE_HANDLER(enabled, latency)(void *ctx,
+	enum ctl_query_source source, void *arg,
+	struct ctl_indexes *indexes)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(source, indexes);
+
+	PMEMobjpool *pop = ctx;
+
+	pop->stats->tx_latency_enabled = *(int *)arg;
+
+	return 0;
+}
+
+static const struct ctl_argument CTL_ARG(latency_enabled) = CTL_ARG_BOOLEAN;
+
+/*
+ * CTL_RUNNABLE_HANDLER(reset, latency) -- clears the latency histograms
+ */
+static int
+CTL_RUNNABLE_HANDLER(reset, latency)(void *ctx,
+	enum ctl_query_source source, void *arg,
+	struct ctl_indexes *indexes)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(source, arg, indexes);
+
+	PMEMobjpool *pop = ctx;
+
+	memset(pop->stats->tx_latency, 0,
+		sizeof(struct stats_histogram) * MAX_STATS_TX_PHASE);
+
+	return 0;
+}
+
+static const struct ctl_node CTL_NODE(latency)[] = {
+	CTL_LEAF_RO(begin, latency),
+	CTL_LEAF_RO(add_range, latency),
+	CTL_LEAF_RO(alloc, latency),
+	CTL_LEAF_RO(commit_flush, latency),
+	CTL_LEAF_RO(commit_drain, latency),
+	CTL_LEAF_RO(redo_apply, latency),
+	CTL_LEAF_RO(end, latency),
+	{CTL_STR(enabled), CTL_NODE_LEAF,
+		{CTL_READ_HANDLER(enabled, latency),
+		CTL_WRITE_HANDLER(enabled, latency), NULL},
+		&CTL_ARG(latency_enabled), NULL},
+	CTL_LEAF_RUNNABLE(reset, latency),
+
+	CTL_NODE_END
+};
+
+static const struct ctl_node CTL_NODE(tx)[] = {
+	STATS_CTL_LEAF(transient, undo_extensions_avoided),
+	STATS_CTL_LEAF(transient, group_commits),
+	STATS_CTL_LEAF(transient, group_commit_drains),
+	CTL_CHILD(latency),
 
 	CTL_NODE_END
 };
@@ -104,6 +513,8 @@ static const struct ctl_argument CTL_ARG(enabled) = {
 
 static const struct ctl_node CTL_NODE(stats)[] = {
 	CTL_CHILD(heap),
+	CTL_CHILD(lanes),
+	CTL_CHILD(tx),
 	CTL_LEAF_RW(enabled),
 
 	CTL_NODE_END
@@ -128,8 +539,16 @@ stats_new(PMEMobjpool *pop)
 	if (s->transient == NULL)
 		goto error_transient_alloc;
 
+	s->tx_latency_enabled = 0;
+	s->tx_latency = Zalloc(sizeof(struct stats_histogram) *
+		MAX_STATS_TX_PHASE);
+	if (s->tx_latency == NULL)
+		goto error_tx_latency_alloc;
+
 	return s;
 
+error_tx_latency_alloc:
+	Free(s->transient);
 error_transient_alloc:
 	Free(s);
 	return NULL;
@@ -143,6 +562,7 @@ stats_delete(PMEMobjpool *pop, struct stats *s)
 {
 	pmemops_persist(&pop->p_ops, s->persistent,
 	sizeof(struct stats_persistent));
+	Free(s->tx_latency);
 	Free(s->transient);
 	Free(s);
 }
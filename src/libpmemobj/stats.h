@@ -18,16 +18,64 @@ extern "C" {
 struct stats_transient {
 	uint64_t heap_run_allocated;
 	uint64_t heap_run_active;
+	uint64_t heap_defrag_runs;
+	uint64_t heap_defrag_objects;
+	uint64_t heap_defrag_bytes;
+	uint64_t heap_huge_align_fallbacks;
+	uint64_t heap_publish_batches;
+	uint64_t heap_publish_batched_actions;
+	uint64_t lanes_recovered;
+	uint64_t lanes_recovery_time;
+	uint64_t lanes_spins;
+	uint64_t lanes_waits;
+	uint64_t lanes_wait_time;
+	uint64_t tx_undo_extensions_avoided;
+	uint64_t tx_group_commits;
+	uint64_t tx_group_commit_drains;
 };
 
 struct stats_persistent {
 	uint64_t heap_curr_allocated;
 };
 
+/*
+ * Phases of transactions whose latencies are recorded in the histograms.
+ */
+enum stats_tx_phase {
+	STATS_TX_PHASE_BEGIN,
+	STATS_TX_PHASE_ADD_RANGE,
+	STATS_TX_PHASE_ALLOC,
+	STATS_TX_PHASE_COMMIT_FLUSH,
+	STATS_TX_PHASE_COMMIT_DRAIN,
+	STATS_TX_PHASE_REDO_APPLY,
+	STATS_TX_PHASE_END,
+
+	MAX_STATS_TX_PHASE
+};
+
+/*
+ * Every power of two of the recorded values is split into
+ * 2^STATS_HIST_SUB_BITS linear buckets, which bounds the relative error of
+ * the percentiles read from the histogram.
+ */
+#define STATS_HIST_SUB_BITS 3
+#define STATS_HIST_NBUCKETS ((64 - STATS_HIST_SUB_BITS + 1) <<\
+	STATS_HIST_SUB_BITS)
+
+struct stats_histogram {
+	uint64_t count;
+	uint64_t total;
+	uint64_t min;
+	uint64_t max;
+	uint64_t buckets[STATS_HIST_NBUCKETS];
+};
+
 struct stats {
 	enum pobj_stats_enabled enabled;
+	int tx_latency_enabled;
 	struct stats_transient *transient;
 	struct stats_persistent *persistent;
+	struct stats_histogram *tx_latency; /* one for every tx phase */
 };
 
 #define STATS_INC(stats, type, name, value) do {\
@@ -99,6 +147,38 @@ static int CTL_READ_HANDLER(type##_##name)(void *ctx,\
 	return 0;\
 }
 
+uint64_t stats_time_ns(void);
+void stats_histogram_record(struct stats_histogram *hist, uint64_t value);
+
+/*
+ * stats_latency_start -- returns the start time of a transaction phase, or 0
+ *	if the latencies are not recorded
+ */
+static inline uint64_t
+stats_latency_start(struct stats *stats)
+{
+	if (!stats->tx_latency_enabled ||
+	    (stats->enabled != POBJ_STATS_ENABLED_TRANSIENT &&
+	    stats->enabled != POBJ_STATS_ENABLED_BOTH))
+		return 0;
+
+	return stats_time_ns();
+}
+
+/*
+ * stats_latency_end -- records the latency of a transaction phase started
+ *	at the given time
+ */
+static inline void
+stats_latency_end(struct stats *stats, enum stats_tx_phase phase,
+	uint64_t start)
+{
+	if (start != 0) {
+		stats_histogram_record(&stats->tx_latency[phase],
+			stats_time_ns() - start);
+	}
+}
+
 void stats_ctl_register(PMEMobjpool *pop);
 
 struct stats *stats_new(PMEMobjpool *pop);
@@ -14,6 +14,7 @@
 #include "out.h"
 #include "pmalloc.h"
 #include "tx.h"
+#include "tx_range_map.h"
 #include "valgrind_internal.h"
 #include "memops.h"
 
@@ -32,6 +33,9 @@ struct tx {
 	PMDK_SLIST_HEAD(txd, tx_data) tx_entries;
 
 	struct ravl *ranges;
+	/* replaces the ranges tree in transactions with many ranges */
+	struct tx_range_map *range_map;
+	size_t nranges;
 
 	VEC(, struct pobj_action) actions;
 	VEC(, struct user_buffer_def) redo_userbufs;
@@ -113,6 +117,17 @@ tx_params_new(void)
 		return NULL;
 
 	tx_params->cache_size = TX_DEFAULT_RANGE_CACHE_SIZE;
+	tx_params->range_map_threshold = TX_DEFAULT_RANGE_MAP_THRESHOLD;
+	tx_params->undo_retain_size = 0;
+	tx_params->undo_retain_percentile = TX_DEFAULT_UNDO_RETAIN_PERCENTILE;
+	tx_params->group_commit_enabled = 0;
+	tx_params->group_commit_max_wait = TX_DEFAULT_GROUP_COMMIT_MAX_WAIT;
+
+	tx_params->group_commit = tx_group_commit_new();
+	if (tx_params->group_commit == NULL) {
+		Free(tx_params);
+		return NULL;
+	}
 
 	return tx_params;
 }
@@ -123,6 +138,7 @@ tx_params_new(void)
 void
 tx_params_delete(struct tx_parameters *tx_params)
 {
+	tx_group_commit_delete(tx_params->group_commit);
 	Free(tx_params);
 }
 
@@ -396,6 +412,9 @@ tx_abort_set(PMEMobjpool *pop, struct lane *lane)
 		tx_undo_entry_apply, NULL, &pop->p_ops);
 	pmemops_drain(&pop->p_ops);
 	operation_finish(lane->undo, ULOG_INC_FIRST_GEN_NUM);
+
+	STATS_INC(pop->stats, transient, tx_undo_extensions_avoided,
+		operation_get_reused(lane->undo));
 }
 
 /*
@@ -427,6 +446,32 @@ tx_clean_range(void *data, void *ctx)
 	VALGRIND_SET_CLEAN(OBJ_OFF_TO_PTR(pop, range->offset), range->size);
 }
 
+/*
+ * tx_range_map_flush -- (internal) flush one range of the range map
+ */
+static void
+tx_range_map_flush(uint64_t offset, uint64_t size, int flush, void *ctx)
+{
+	struct tx_range_def range = {offset, size,
+		flush ? 0 : POBJ_FLAG_NO_FLUSH};
+
+	tx_flush_range(&range, ctx);
+}
+
+/*
+ * tx_range_map_clean -- (internal) clean one range of the range map
+ */
+static void
+tx_range_map_clean(uint64_t offset, uint64_t size, int flush, void *ctx)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(flush);
+
+	struct tx_range_def range = {offset, size, 0};
+
+	tx_clean_range(&range, ctx);
+}
+
 /*
  * tx_pre_commit -- (internal) do pre-commit operations
  */
@@ -436,8 +481,169 @@ tx_pre_commit(struct tx *tx)
 	LOG(5, NULL);
 
 	/* Flush all regions and destroy the whole tree. */
-	ravl_delete_cb(tx->ranges, tx_flush_range, tx->pop);
-	tx->ranges = NULL;
+	if (tx->range_map != NULL) {
+		tx_range_map_delete_cb(tx->range_map, tx_range_map_flush,
+			tx->pop);
+		tx->range_map = NULL;
+	} else {
+		ravl_delete_cb(tx->ranges, tx_flush_range, tx->pop);
+		tx->ranges = NULL;
+	}
+}
+
+struct tx_commit_ranges {
+	PMEMobjpool *pop;
+	VEC(, struct tx_group_commit_range) ranges;
+	int flushed; /* some of the ranges were flushed by this thread */
+};
+
+/*
+ * tx_collect_range -- (internal) collects one range to be flushed by
+ *	the leader of the commit group
+ *
+ * The ranges added with POBJ_FLAG_NO_FLUSH are collected as well, because
+ * the drain of the leader does not wait for the flushes issued by the user.
+ */
+static void
+tx_collect_range(struct tx_commit_ranges *c, uint64_t offset, uint64_t size)
+{
+	void *addr = OBJ_OFF_TO_PTR(c->pop, offset);
+	VALGRIND_REMOVE_FROM_TX(addr, size);
+
+	struct tx_group_commit_range range = {addr, size};
+	if (VEC_PUSH_BACK(&c->ranges, range) != 0) {
+		pmemops_xflush(&c->pop->p_ops, addr, size, PMEMOBJ_F_RELAXED);
+		c->flushed = 1;
+	}
+}
+
+/*
+ * tx_collect_tree_range -- (internal) collects one range of the ranges tree
+ */
+static void
+tx_collect_tree_range(void *data, void *ctx)
+{
+	struct tx_range_def *range = data;
+
+	tx_collect_range(ctx, range->offset, range->size);
+}
+
+/*
+ * tx_collect_map_range -- (internal) collects one range of the range map
+ */
+static void
+tx_collect_map_range(uint64_t offset, uint64_t size, int flush, void *ctx)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(flush);
+
+	tx_collect_range(ctx, offset, size);
+}
+
+/*
+ * tx_group_persist -- (internal) makes the collected ranges persistent
+ *	together with the ones of the other transactions committing at
+ *	the same time
+ */
+static void
+tx_group_persist(struct tx_commit_ranges *c)
+{
+	PMEMobjpool *pop = c->pop;
+	struct tx_parameters *params = pop->tx_params;
+
+	int leader = tx_group_commit_persist(params->group_commit,
+		&pop->p_ops, VEC_ARR(&c->ranges), VEC_SIZE(&c->ranges),
+		params->group_commit_max_wait);
+
+	/* the drain of the leader doesn't cover the flushes of this thread */
+	if (c->flushed && !leader)
+		pmemops_drain(&pop->p_ops);
+
+	c->flushed = 0;
+	VEC_CLEAR(&c->ranges);
+
+	STATS_INC(pop->stats, transient, tx_group_commits, 1);
+	STATS_INC(pop->stats, transient, tx_group_commit_drains,
+		(uint64_t)leader);
+}
+
+/*
+ * tx_group_commit -- (internal) commits the outermost transaction, sharing
+ *	the drains with the other transactions committing at the same time
+ *
+ * The modified ranges are made persistent by the group. Then, if the only
+ * action of the transaction is the invalidation of the undo log, the lane
+ * state transition goes through the group as well, instead of the redo log.
+ */
+static void
+tx_group_commit(struct tx *tx)
+{
+	PMEMobjpool *pop = tx->pop;
+	struct tx_group_commit *gc = pop->tx_params->group_commit;
+
+	tx_group_commit_enter(gc);
+
+	uint64_t start = stats_latency_start(pop->stats);
+
+	struct tx_commit_ranges c;
+	c.pop = pop;
+	c.flushed = 0;
+	VEC_INIT(&c.ranges);
+
+	if (tx->range_map != NULL) {
+		tx_range_map_delete_cb(tx->range_map, tx_collect_map_range,
+			&c);
+		tx->range_map = NULL;
+	} else {
+		ravl_delete_cb(tx->ranges, tx_collect_tree_range, &c);
+		tx->ranges = NULL;
+	}
+
+	stats_latency_end(pop->stats, STATS_TX_PHASE_COMMIT_FLUSH, start);
+	start = stats_latency_start(pop->stats);
+
+	tx_group_persist(&c);
+
+	stats_latency_end(pop->stats, STATS_TX_PHASE_COMMIT_DRAIN, start);
+	start = stats_latency_start(pop->stats);
+
+	size_t nactions = VEC_SIZE(&tx->actions);
+	int undo_only = VEC_SIZE(&tx->redo_userbufs) == 0 &&
+		(nactions == 0 || (nactions == 1 && !tx->first_snapshot));
+
+	if (!undo_only) {
+		/*
+		 * the redo log doesn't go through the group, the leader must
+		 * not wait for this thread while it's being processed
+		 */
+		tx_group_commit_leave(gc);
+
+		operation_start(tx->lane->external);
+
+		struct user_buffer_def *userbuf;
+		VEC_FOREACH_BY_PTR(userbuf, &tx->redo_userbufs)
+			operation_add_user_buffer(tx->lane->external, userbuf);
+
+		palloc_publish(&pop->heap, VEC_ARR(&tx->actions),
+			nactions, tx->lane->external);
+	} else {
+		if (nactions != 0) {
+			/* same as the action created with the first snapshot */
+			uint64_t *n = &tx->lane->layout->undo.gen_num;
+			VALGRIND_ADD_TO_TX(n, sizeof(*n));
+			*n += 1;
+
+			tx_collect_range(&c, OBJ_PTR_TO_OFF(pop, n),
+				sizeof(*n));
+			tx_group_persist(&c);
+		}
+
+		tx_group_commit_leave(gc);
+	}
+
+	VEC_DELETE(&c.ranges);
+
+	stats_latency_end(pop->stats, STATS_TX_PHASE_REDO_APPLY, start);
 }
 
 /*
@@ -452,10 +658,15 @@ tx_abort(PMEMobjpool *pop, struct lane *lane)
 
 	tx_abort_set(pop, lane);
 
-	ravl_delete_cb(tx->ranges, tx_clean_range, pop);
+	if (tx->range_map != NULL) {
+		tx_range_map_delete_cb(tx->range_map, tx_range_map_clean, pop);
+		tx->range_map = NULL;
+	} else {
+		ravl_delete_cb(tx->ranges, tx_clean_range, pop);
+		tx->ranges = NULL;
+	}
 	palloc_cancel(&pop->heap,
 		VEC_ARR(&tx->actions), VEC_SIZE(&tx->actions));
-	tx->ranges = NULL;
 }
 
 /*
@@ -568,12 +779,67 @@ tx_lane_ranges_insert_def(PMEMobjpool *pop, struct tx *tx,
 	LOG(3, "rdef->offset %"PRIu64" rdef->size %"PRIu64,
 		rdef->offset, rdef->size);
 
+	if (tx->range_map != NULL) {
+		return tx_range_map_add(tx->range_map, rdef->offset,
+			rdef->size, !(rdef->flags & POBJ_FLAG_NO_FLUSH),
+			NULL, NULL);
+	}
+
 	int ret = ravl_emplace_copy(tx->ranges, rdef);
 	if (ret && errno == EEXIST)
 		FATAL("invalid state of ranges tree");
+	if (ret == 0)
+		tx->nranges++;
 	return ret;
 }
 
+struct tx_range_map_switch_arg {
+	struct tx_range_map *map;
+	int ret;
+};
+
+/*
+ * tx_range_map_insert_def -- (internal) inserts a range definition from the
+ *	ranges tree into the range map
+ */
+static void
+tx_range_map_insert_def(void *data, void *arg)
+{
+	struct tx_range_map_switch_arg *sarg = arg;
+	struct tx_range_def *rdef = data;
+
+	if (sarg->ret == 0)
+		sarg->ret = tx_range_map_add(sarg->map, rdef->offset,
+			rdef->size, !(rdef->flags & POBJ_FLAG_NO_FLUSH),
+			NULL, NULL);
+}
+
+/*
+ * tx_range_map_switch -- (internal) moves all the ranges of the transaction
+ *	from the ranges tree to the range map
+ *
+ * The ranges tree is kept if the map cannot be created.
+ */
+static void
+tx_range_map_switch(struct tx *tx)
+{
+	LOG(4, "nranges %zu", tx->nranges);
+
+	struct tx_range_map_switch_arg sarg = {tx_range_map_new(), 0};
+	if (sarg.map == NULL)
+		return;
+
+	ravl_foreach(tx->ranges, tx_range_map_insert_def, &sarg);
+	if (sarg.ret != 0) {
+		tx_range_map_delete(sarg.map);
+		return;
+	}
+
+	ravl_delete(tx->ranges);
+	tx->ranges = NULL;
+	tx->range_map = sarg.map;
+}
+
 /*
  * tx_alloc_common -- (internal) common function for alloc and zalloc
  */
@@ -589,6 +855,7 @@ tx_alloc_common(struct tx *tx, size_t size, type_num_t type_num,
 	}
 
 	PMEMobjpool *pop = tx->pop;
+	uint64_t start = stats_latency_start(pop->stats);
 
 	struct pobj_action *action = tx_action_add(tx);
 	if (action == NULL)
@@ -609,6 +876,8 @@ tx_alloc_common(struct tx *tx, size_t size, type_num_t type_num,
 	if (tx_lane_ranges_insert_def(pop, tx, &r) != 0)
 		goto err_oom;
 
+	stats_latency_end(pop->stats, STATS_TX_PHASE_ALLOC, start);
+
 	return retoid;
 
 err_oom:
@@ -729,6 +998,7 @@ pmemobj_tx_begin(PMEMobjpool *pop, jmp_buf env, ...)
 
 	int err = 0;
 	struct tx *tx = get_tx();
+	uint64_t start;
 
 	enum pobj_tx_failure_behavior failure_behavior = POBJ_TX_FAILURE_ABORT;
 
@@ -739,16 +1009,23 @@ pmemobj_tx_begin(PMEMobjpool *pop, jmp_buf env, ...)
 			return obj_tx_fail_err(EINVAL, 0);
 		}
 
+		start = stats_latency_start(pop->stats);
+
 		/* inherits this value from the parent transaction */
 		struct tx_data *txd = PMDK_SLIST_FIRST(&tx->tx_entries);
 		failure_behavior = txd->failure_behavior;
 
 		VALGRIND_START_TX;
 	} else if (tx->stage == TX_STAGE_NONE) {
+		start = stats_latency_start(pop->stats);
+
 		VALGRIND_START_TX;
 
 		lane_hold(pop, &tx->lane);
 		operation_start(tx->lane->undo);
+		operation_set_retain(tx->lane->undo,
+			pop->tx_params->undo_retain_size,
+			pop->tx_params->undo_retain_percentile);
 
 		VEC_INIT(&tx->actions);
 		VEC_INIT(&tx->redo_userbufs);
@@ -758,6 +1035,8 @@ pmemobj_tx_begin(PMEMobjpool *pop, jmp_buf env, ...)
 
 		tx->ranges = ravl_new_sized(tx_range_def_cmp,
 			sizeof(struct tx_range_def));
+		tx->range_map = NULL;
+		tx->nranges = 0;
 
 		tx->pop = pop;
 
@@ -821,6 +1100,8 @@ pmemobj_tx_begin(PMEMobjpool *pop, jmp_buf env, ...)
 	}
 	va_end(argp);
 
+	stats_latency_end(pop->stats, STATS_TX_PHASE_BEGIN, start);
+
 	ASSERT(err == 0);
 	return 0;
 
@@ -977,6 +1258,9 @@ static void
 tx_post_commit(struct tx *tx)
 {
 	operation_finish(tx->lane->undo, 0);
+
+	STATS_INC(tx->pop->stats, transient, tx_undo_extensions_avoided,
+		operation_get_reused(tx->lane->undo));
 }
 
 /*
@@ -1005,19 +1289,37 @@ pmemobj_tx_commit(void)
 
 		PMEMobjpool *pop = tx->pop;
 
-		/* pre-commit phase */
-		tx_pre_commit(tx);
+		if (pop->tx_params->group_commit_enabled) {
+			tx_group_commit(tx);
+		} else {
+			uint64_t start = stats_latency_start(pop->stats);
 
-		pmemops_drain(&pop->p_ops);
+			/* pre-commit phase */
+			tx_pre_commit(tx);
 
-		operation_start(tx->lane->external);
+			stats_latency_end(pop->stats,
+				STATS_TX_PHASE_COMMIT_FLUSH, start);
+			start = stats_latency_start(pop->stats);
 
-		struct user_buffer_def *userbuf;
-		VEC_FOREACH_BY_PTR(userbuf, &tx->redo_userbufs)
-			operation_add_user_buffer(tx->lane->external, userbuf);
+			pmemops_drain(&pop->p_ops);
 
-		palloc_publish(&pop->heap, VEC_ARR(&tx->actions),
-			VEC_SIZE(&tx->actions), tx->lane->external);
+			stats_latency_end(pop->stats,
+				STATS_TX_PHASE_COMMIT_DRAIN, start);
+			start = stats_latency_start(pop->stats);
+
+			operation_start(tx->lane->external);
+
+			struct user_buffer_def *userbuf;
+			VEC_FOREACH_BY_PTR(userbuf, &tx->redo_userbufs)
+				operation_add_user_buffer(tx->lane->external,
+					userbuf);
+
+			palloc_publish(&pop->heap, VEC_ARR(&tx->actions),
+				VEC_SIZE(&tx->actions), tx->lane->external);
+
+			stats_latency_end(pop->stats,
+				STATS_TX_PHASE_REDO_APPLY, start);
+		}
 
 		tx_post_commit(tx);
 
@@ -1049,6 +1351,9 @@ pmemobj_tx_end(void)
 	if (tx->pop == NULL)
 		FATAL("pmemobj_tx_end called without pmemobj_tx_begin");
 
+	struct stats *stats = tx->pop->stats;
+	uint64_t start = stats_latency_start(stats);
+
 	if (tx->stage_callback &&
 			(tx->stage == TX_STAGE_ONCOMMIT ||
 			tx->stage == TX_STAGE_ONABORT)) {
@@ -1092,6 +1397,8 @@ pmemobj_tx_end(void)
 			obj_tx_abort(tx->last_errnum, 0);
 	}
 
+	stats_latency_end(stats, STATS_TX_PHASE_END, start);
+
 	return ret;
 }
 
@@ -1219,6 +1526,37 @@ pmemobj_tx_merge_flags(struct tx_range_def *dest, struct tx_range_def *merged)
 	}
 }
 
+/*
+ * pmemobj_tx_add_missing -- (internal) creates a snapshot of the part of
+ * the range which was not yet added to the transaction
+ */
+static int
+pmemobj_tx_add_missing(uint64_t offset, uint64_t size, void *arg)
+{
+	struct tx_range_def snapshot = *(struct tx_range_def *)arg;
+	snapshot.offset = offset;
+	snapshot.size = size;
+
+	return pmemobj_tx_add_snapshot(get_tx(), &snapshot);
+}
+
+/*
+ * pmemobj_tx_add_range_map -- (internal) adds persistent memory into
+ * the transaction which tracks its ranges in the range map
+ */
+static int
+pmemobj_tx_add_range_map(struct tx *tx, struct tx_range_def *args)
+{
+	if (tx_range_map_add(tx->range_map, args->offset, args->size,
+			!(args->flags & POBJ_XADD_NO_FLUSH),
+			pmemobj_tx_add_missing, args) != 0) {
+		ERR("out of memory");
+		return obj_tx_fail_err(ENOMEM, args->flags);
+	}
+
+	return 0;
+}
+
 /*
  * pmemobj_tx_add_common -- (internal) common code for adding persistent memory
  * into the transaction
@@ -1240,6 +1578,20 @@ pmemobj_tx_add_common(struct tx *tx, struct tx_range_def *args)
 		return obj_tx_fail_err(EINVAL, args->flags);
 	}
 
+	uint64_t start = stats_latency_start(tx->pop->stats);
+
+	size_t threshold = tx->pop->tx_params->range_map_threshold;
+	if (tx->range_map == NULL && threshold != 0 &&
+			tx->nranges >= threshold)
+		tx_range_map_switch(tx);
+
+	if (tx->range_map != NULL) {
+		int ret = pmemobj_tx_add_range_map(tx, args);
+		stats_latency_end(tx->pop->stats, STATS_TX_PHASE_ADD_RANGE,
+			start);
+		return ret;
+	}
+
 	int ret = 0;
 
 	/*
@@ -1380,6 +1732,8 @@ pmemobj_tx_add_common(struct tx *tx, struct tx_range_def *args)
 		return obj_tx_fail_err(ENOMEM, args->flags);
 	}
 
+	stats_latency_end(tx->pop->stats, STATS_TX_PHASE_ADD_RANGE, start);
+
 	return 0;
 }
 
@@ -1844,15 +2198,36 @@ pmemobj_tx_xfree(PMEMoid oid, uint64_t flags)
 	PMEMOBJ_API_START();
 
 	struct pobj_action *action;
-
-	struct tx_range_def range = {oid.off, 0, 0};
-	struct ravl_node *n = ravl_find(tx->ranges, &range,
-		RAVL_PREDICATE_EQUAL);
+	struct ravl_node *n = NULL;
 
 	/*
 	 * If attempting to free an object allocated within the same
 	 * transaction, simply cancel the alloc and remove it from the actions.
 	 */
+	if (tx->range_map != NULL) {
+		if (tx_range_map_contains(tx->range_map, oid.off)) {
+			VEC_FOREACH_BY_PTR(action, &tx->actions) {
+				if (action->type != POBJ_ACTION_TYPE_HEAP ||
+					action->heap.offset != oid.off)
+					continue;
+
+				size_t size = action->heap.usable_size;
+				void *ptr = OBJ_OFF_TO_PTR(pop, oid.off);
+				VALGRIND_SET_CLEAN(ptr, size);
+				VALGRIND_REMOVE_FROM_TX(ptr, size);
+				tx_range_map_remove(tx->range_map, oid.off,
+					size);
+				palloc_cancel(&pop->heap, action, 1);
+				VEC_ERASE_BY_PTR(&tx->actions, action);
+				PMEMOBJ_API_END();
+				return 0;
+			}
+		}
+	} else {
+		struct tx_range_def range = {oid.off, 0, 0};
+		n = ravl_find(tx->ranges, &range, RAVL_PREDICATE_EQUAL);
+	}
+
 	if (n != NULL) {
 		VEC_FOREACH_BY_PTR(action, &tx->actions) {
 			if (action->type == POBJ_ACTION_TYPE_HEAP &&
@@ -2253,6 +2628,261 @@ static const struct ctl_node CTL_NODE(cache)[] = {
 	CTL_NODE_END
 };
 
+/*
+ * CTL_READ_HANDLER(map_threshold) -- gets the number of ranges after which
+ *	a transaction switches to the range map
+ */
+static int
+CTL_READ_HANDLER(map_threshold)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(source, indexes);
+
+	PMEMobjpool *pop = ctx;
+
+	ssize_t *arg_out = arg;
+
+	*arg_out = (ssize_t)pop->tx_params->range_map_threshold;
+
+	return 0;
+}
+
+/*
+ * CTL_WRITE_HANDLER(map_threshold) -- sets the number of ranges after which
+ *	a transaction switches to the range map
+ */
+static int
+CTL_WRITE_HANDLER(map_threshold)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(source, indexes);
+
+	PMEMobjpool *pop = ctx;
+
+	ssize_t arg_in = *(long long *)arg;
+
+	if (arg_in < 0) {
+		errno = EINVAL;
+		ERR("invalid range map threshold, must not be negative");
+		return -1;
+	}
+
+	pop->tx_params->range_map_threshold = (size_t)arg_in;
+
+	return 0;
+}
+
+static const struct ctl_argument CTL_ARG(map_threshold) = CTL_ARG_LONG_LONG;
+
+static const struct ctl_node CTL_NODE(ranges)[] = {
+	CTL_LEAF_RW(map_threshold),
+
+	CTL_NODE_END
+};
+
+/*
+ * CTL_READ_HANDLER(retain_size) -- gets the max capacity of the undo log
+ *	extensions retained by a lane between transactions
+ */
+static int
+CTL_READ_HANDLER(retain_size)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(source, indexes);
+
+	PMEMobjpool *pop = ctx;
+
+	ssize_t *arg_out = arg;
+
+	*arg_out = (ssize_t)pop->tx_params->undo_retain_size;
+
+	return 0;
+}
+
+/*
+ * CTL_WRITE_HANDLER(retain_size) -- sets the max capacity of the undo log
+ *	extensions retained by a lane between transactions
+ */
+static int
+CTL_WRITE_HANDLER(retain_size)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(source, indexes);
+
+	PMEMobjpool *pop = ctx;
+
+	ssize_t arg_in = *(long long *)arg;
+
+	if (arg_in < 0 || arg_in > (ssize_t)PMEMOBJ_MAX_ALLOC_SIZE) {
+		errno = EINVAL;
+		ERR("invalid retain size, must be between 0 and "
+			"max alloc size");
+		return -1;
+	}
+
+	pop->tx_params->undo_retain_size = (size_t)arg_in;
+
+	return 0;
+}
+
+static const struct ctl_argument CTL_ARG(retain_size) = CTL_ARG_LONG_LONG;
+
+/*
+ * CTL_READ_HANDLER(retain_percentile) -- gets the percentile of the recent
+ *	undo log sizes the retained extensions are sized to
+ */
+static int
+CTL_READ_HANDLER(retain_percentile)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(source, indexes);
+
+	PMEMobjpool *pop = ctx;
+
+	int *arg_out = arg;
+
+	*arg_out = (int)pop->tx_params->undo_retain_percentile;
+
+	return 0;
+}
+
+/*
+ * CTL_WRITE_HANDLER(retain_percentile) -- sets the percentile of the recent
+ *	undo log sizes the retained extensions are sized to
+ */
+static int
+CTL_WRITE_HANDLER(retain_percentile)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(source, indexes);
+
+	PMEMobjpool *pop = ctx;
+
+	int arg_in = *(int *)arg;
+
+	if (arg_in < 1 || arg_in > 100) {
+		errno = EINVAL;
+		ERR("invalid retain percentile, must be between 1 and 100");
+		return -1;
+	}
+
+	pop->tx_params->undo_retain_percentile = (unsigned)arg_in;
+
+	return 0;
+}
+
+static const struct ctl_argument CTL_ARG(retain_percentile) = CTL_ARG_INT;
+
+static const struct ctl_node CTL_NODE(undo)[] = {
+	CTL_LEAF_RW(retain_size),
+	CTL_LEAF_RW(retain_percentile),
+
+	CTL_NODE_END
+};
+
+/*
+ * CTL_READ_HANDLER(enabled) -- returns whether the transactions are committed
+ *	in the group mode
+ */
+static int
+CTL_READ_HANDLER(enabled)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(source, indexes);
+
+	PMEMobjpool *pop = ctx;
+
+	int *arg_out = arg;
+
+	*arg_out = pop->tx_params->group_commit_enabled;
+
+	return 0;
+}
+
+/*
+ * CTL_WRITE_HANDLER(enabled) -- enables or disables the group commit mode
+ */
+static int
+CTL_WRITE_HANDLER(enabled)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(source, indexes);
+
+	PMEMobjpool *pop = ctx;
+
+	int arg_in = *(int *)arg;
+
+	pop->tx_params->group_commit_enabled = arg_in;
+
+	return 0;
+}
+
+static const struct ctl_argument CTL_ARG(enabled) = CTL_ARG_BOOLEAN;
+
+/*
+ * CTL_READ_HANDLER(max_wait) -- gets the maximum time, in microseconds,
+ *	the leader of a commit group waits for the other transactions
+ */
+static int
+CTL_READ_HANDLER(max_wait)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(source, indexes);
+
+	PMEMobjpool *pop = ctx;
+
+	ssize_t *arg_out = arg;
+
+	*arg_out = (ssize_t)pop->tx_params->group_commit_max_wait;
+
+	return 0;
+}
+
+/*
+ * CTL_WRITE_HANDLER(max_wait) -- sets the maximum time, in microseconds,
+ *	the leader of a commit group waits for the other transactions
+ */
+static int
+CTL_WRITE_HANDLER(max_wait)(void *ctx,
+	enum ctl_query_source source, void *arg, struct ctl_indexes *indexes)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(source, indexes);
+
+	PMEMobjpool *pop = ctx;
+
+	ssize_t arg_in = *(long long *)arg;
+
+	if (arg_in < 0 || arg_in > TX_MAX_GROUP_COMMIT_MAX_WAIT) {
+		errno = EINVAL;
+		ERR("invalid group commit max wait, must be between 0 and "
+			"%d microseconds", TX_MAX_GROUP_COMMIT_MAX_WAIT);
+		return -1;
+	}
+
+	pop->tx_params->group_commit_max_wait = (uint64_t)arg_in;
+
+	return 0;
+}
+
+static const struct ctl_argument CTL_ARG(max_wait) = CTL_ARG_LONG_LONG;
+
+static const struct ctl_node CTL_NODE(group_commit)[] = {
+	CTL_LEAF_RW(enabled),
+	CTL_LEAF_RW(max_wait),
+
+	CTL_NODE_END
+};
+
 /*
  * CTL_READ_HANDLER(skip_expensive_checks) -- returns "skip_expensive_checks"
  * var from pool ctl
@@ -2409,6 +3039,9 @@ static const struct ctl_node CTL_NODE(post_commit)[] = {
 static const struct ctl_node CTL_NODE(tx)[] = {
 	CTL_CHILD(debug),
 	CTL_CHILD(cache),
+	CTL_CHILD(ranges),
+	CTL_CHILD(undo),
+	CTL_CHILD(group_commit),
 	CTL_CHILD(post_commit),
 
 	CTL_NODE_END
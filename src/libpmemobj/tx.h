@@ -11,6 +11,7 @@
 #include <stdint.h>
 #include "obj.h"
 #include "ulog.h"
+#include "tx_group_commit.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -18,6 +19,8 @@ extern "C" {
 
 #define TX_DEFAULT_RANGE_CACHE_SIZE (1 << 15)
 #define TX_DEFAULT_RANGE_CACHE_THRESHOLD (1 << 12)
+#define TX_DEFAULT_RANGE_MAP_THRESHOLD (1 << 10)
+#define TX_DEFAULT_UNDO_RETAIN_PERCENTILE 99
 
 #define TX_RANGE_MASK (8ULL - 1)
 #define TX_RANGE_MASK_LEGACY (32ULL - 1)
@@ -34,6 +37,13 @@ extern "C" {
 
 struct tx_parameters {
 	size_t cache_size;
+	size_t range_map_threshold;
+	size_t undo_retain_size;
+	unsigned undo_retain_percentile;
+
+	int group_commit_enabled;
+	uint64_t group_commit_max_wait; /* in microseconds */
+	struct tx_group_commit *group_commit;
 };
 
 /*
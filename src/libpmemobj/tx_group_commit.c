@@ -0,0 +1,200 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2026, Intel Corporation */
+
+/*
+ * tx_group_commit.c -- sharing the drains of concurrently committed
+ *	transactions
+ *
+ * A transaction committed in the group mode does not flush and drain its
+ * ranges by itself. Instead, it joins the group which is currently being
+ * formed and waits. The first thread that joins a group becomes its leader:
+ * it waits, up to the maximum wait time, for the other committing threads to
+ * join, then flushes the ranges of all the members and issues a single drain
+ * for the whole group. The ranges are flushed by the leader, because a drain
+ * only waits for the flushes issued by the same thread.
+ *
+ * The leader stops waiting as soon as all the threads which are currently
+ * committing have joined a group, so a lone thread never waits.
+ */
+
+#include <errno.h>
+#include <time.h>
+
+#include "alloc.h"
+#include "libpmemobj/base.h"
+#include "os.h"
+#include "os_thread.h"
+#include "out.h"
+#include "sys_util.h"
+#include "tx_group_commit.h"
+
+struct tx_group_commit_member {
+	const struct tx_group_commit_range *ranges;
+	size_t nranges;
+
+	struct tx_group_commit_member *next;
+	int done;
+};
+
+struct tx_group_commit {
+	os_mutex_t lock;
+	os_cond_t cond; /* signaled when the state of any group changes */
+
+	struct tx_group_commit_member *forming; /* members of the next group */
+	unsigned nforming;
+	int leader; /* the group being formed already has a leader */
+
+	unsigned nflushing; /* members of the groups being persisted */
+	unsigned nactive; /* threads committing in the group mode */
+};
+
+/*
+ * tx_group_commit_new -- creates a new group commit instance
+ */
+struct tx_group_commit *
+tx_group_commit_new(void)
+{
+	struct tx_group_commit *gc = Zalloc(sizeof(*gc));
+	if (gc == NULL) {
+		ERR("!Zalloc");
+		return NULL;
+	}
+
+	util_mutex_init(&gc->lock);
+	os_cond_init(&gc->cond);
+
+	return gc;
+}
+
+/*
+ * tx_group_commit_delete -- deletes the group commit instance
+ */
+void
+tx_group_commit_delete(struct tx_group_commit *gc)
+{
+	ASSERTeq(gc->nactive, 0);
+
+	os_cond_destroy(&gc->cond);
+	util_mutex_destroy(&gc->lock);
+	Free(gc);
+}
+
+/*
+ * tx_group_commit_enter -- registers a thread which started to commit
+ *	a transaction in the group mode
+ */
+void
+tx_group_commit_enter(struct tx_group_commit *gc)
+{
+	util_mutex_lock(&gc->lock);
+	gc->nactive++;
+	util_mutex_unlock(&gc->lock);
+}
+
+/*
+ * tx_group_commit_leave -- unregisters a thread which finished the commit
+ */
+void
+tx_group_commit_leave(struct tx_group_commit *gc)
+{
+	util_mutex_lock(&gc->lock);
+	ASSERTne(gc->nactive, 0);
+	gc->nactive--;
+
+	/* the leader might be waiting for this thread */
+	if (gc->leader)
+		os_cond_broadcast(&gc->cond);
+	util_mutex_unlock(&gc->lock);
+}
+
+/*
+ * tx_group_commit_deadline -- (internal) calculates the absolute time
+ *	at which the leader stops waiting for the other members
+ */
+static void
+tx_group_commit_deadline(struct timespec *deadline, uint64_t max_wait)
+{
+	os_clock_gettime(CLOCK_REALTIME, deadline);
+
+	uint64_t nsec = (uint64_t)deadline->tv_nsec + max_wait * 1000;
+	deadline->tv_sec += (time_t)(nsec / 1000000000);
+	deadline->tv_nsec = (long)(nsec % 1000000000);
+}
+
+/*
+ * tx_group_commit_persist -- makes the ranges persistent, sharing the drain
+ *	with the other threads committing at the same time
+ *
+ * Returns 1 if the calling thread led the group and issued the drain,
+ * 0 otherwise.
+ */
+int
+tx_group_commit_persist(struct tx_group_commit *gc,
+	const struct pmem_ops *p_ops,
+	const struct tx_group_commit_range *ranges, size_t nranges,
+	uint64_t max_wait)
+{
+	struct tx_group_commit_member self = {ranges, nranges, NULL, 0};
+
+	util_mutex_lock(&gc->lock);
+
+	self.next = gc->forming;
+	gc->forming = &self;
+	gc->nforming++;
+
+	if (gc->leader) {
+		os_cond_broadcast(&gc->cond);
+		while (!self.done)
+			os_cond_wait(&gc->cond, &gc->lock);
+
+		util_mutex_unlock(&gc->lock);
+		return 0;
+	}
+
+	gc->leader = 1;
+
+	if (max_wait != 0) {
+		struct timespec deadline;
+		tx_group_commit_deadline(&deadline, max_wait);
+
+		/* the members of the flushed groups are not waited for */
+		while (gc->nforming + gc->nflushing < gc->nactive) {
+			if (os_cond_timedwait(&gc->cond, &gc->lock,
+					&deadline) == ETIMEDOUT)
+				break;
+		}
+	}
+
+	struct tx_group_commit_member *group = gc->forming;
+	unsigned nmembers = gc->nforming;
+
+	gc->forming = NULL;
+	gc->nforming = 0;
+	gc->leader = 0;
+	gc->nflushing += nmembers;
+
+	util_mutex_unlock(&gc->lock);
+
+	for (struct tx_group_commit_member *m = group; m != NULL;
+			m = m->next) {
+		for (size_t i = 0; i < m->nranges; ++i) {
+			pmemops_xflush(p_ops, m->ranges[i].addr,
+				m->ranges[i].size, PMEMOBJ_F_RELAXED);
+		}
+	}
+	pmemops_drain(p_ops);
+
+	util_mutex_lock(&gc->lock);
+
+	while (group != NULL) {
+		struct tx_group_commit_member *next = group->next;
+		group->done = 1;
+		group = next;
+	}
+	gc->nflushing -= nmembers;
+
+	os_cond_broadcast(&gc->cond);
+	util_mutex_unlock(&gc->lock);
+
+	return 1;
+}
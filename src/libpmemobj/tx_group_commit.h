@@ -0,0 +1,46 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright 2026, Intel Corporation */
+
+/*
+ * tx_group_commit.h -- internal definitions for sharing the drains of
+ *	concurrently committed transactions
+ */
+
+#ifndef LIBPMEMOBJ_TX_GROUP_COMMIT_H
+#define LIBPMEMOBJ_TX_GROUP_COMMIT_H 1
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "pmemops.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TX_DEFAULT_GROUP_COMMIT_MAX_WAIT 50 /* microseconds */
+#define TX_MAX_GROUP_COMMIT_MAX_WAIT 1000000 /* one second */
+
+struct tx_group_commit;
+
+struct tx_group_commit_range {
+	void *addr;
+	size_t size;
+};
+
+struct tx_group_commit *tx_group_commit_new(void);
+void tx_group_commit_delete(struct tx_group_commit *gc);
+
+void tx_group_commit_enter(struct tx_group_commit *gc);
+void tx_group_commit_leave(struct tx_group_commit *gc);
+
+int tx_group_commit_persist(struct tx_group_commit *gc,
+	const struct pmem_ops *p_ops,
+	const struct tx_group_commit_range *ranges, size_t nranges,
+	uint64_t max_wait);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
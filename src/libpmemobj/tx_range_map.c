@@ -0,0 +1,748 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2026, Intel Corporation */
+
+/*
+ * tx_range_map.c -- cache line granular map of the ranges added to
+ *	a transaction
+ *
+ * The ranges shorter than a line are kept in an open addressing hash table
+ * keyed by the index of a 64 byte line of the pool. Each entry holds two
+ * bitmaps, one bit per byte of the line: the bytes already added to
+ * the transaction and the bytes which have to be flushed on commit. Unlike
+ * the ranges tree, looking up such a range costs a constant number of probes
+ * and adding it does not allocate memory, except for the occasional growth of
+ * the table.
+ *
+ * The ranges of a line or more are kept as whole extents in a ravl tree, as
+ * without the map, so that their size doesn't translate into the size of
+ * the table. A byte is present either in the table or in the tree, never in
+ * both.
+ */
+
+#include <stdlib.h>
+
+#include "alloc.h"
+#include "out.h"
+#include "ravl.h"
+#include "tx_range_map.h"
+#include "util.h"
+
+/* the size of a line, fixed by the number of bits in the bitmaps */
+#define TX_RANGE_MAP_LINE 64
+
+#define TX_RANGE_MAP_INIT_CAPACITY 1024
+
+struct tx_range_line {
+	uint64_t key; /* index of the line + 1, 0 marks an empty slot */
+	uint64_t snapshot; /* bytes of the line added to the transaction */
+	uint64_t flush; /* bytes which have to be flushed on commit */
+};
+
+struct tx_range_extent {
+	uint64_t offset;
+	uint64_t size;
+	int flush; /* the extent has to be flushed on commit */
+};
+
+struct tx_range_map {
+	struct tx_range_line *lines;
+	size_t capacity; /* always a power of two */
+	size_t nlines;
+
+	struct ravl *extents; /* the ranges of at least a line */
+};
+
+/*
+ * tx_range_map_bits -- (internal) returns a mask of len bits starting at bit
+ */
+static inline uint64_t
+tx_range_map_bits(uint64_t bit, uint64_t len)
+{
+	if (len >= TX_RANGE_MAP_LINE)
+		return UINT64_MAX;
+
+	return ((1ULL << len) - 1) << bit;
+}
+
+/*
+ * tx_range_map_run -- (internal) returns the length of the run of set bits
+ *	starting at bit
+ */
+static inline unsigned
+tx_range_map_run(uint64_t bits, unsigned bit)
+{
+	uint64_t rest = ~(bits >> bit);
+
+	return rest == 0 ? TX_RANGE_MAP_LINE - bit : util_lssb_index64(rest);
+}
+
+/*
+ * tx_range_map_slot -- (internal) returns the first slot to probe for the key
+ */
+static inline size_t
+tx_range_map_slot(uint64_t key, size_t capacity)
+{
+	uint64_t h = key * 0x9E3779B97F4A7C15ULL;
+	h ^= h >> 32;
+
+	return (size_t)h & (capacity - 1);
+}
+
+/*
+ * tx_range_map_find -- (internal) returns the entry of the line or NULL
+ */
+static struct tx_range_line *
+tx_range_map_find(struct tx_range_map *map, uint64_t line)
+{
+	uint64_t key = line + 1;
+	size_t mask = map->capacity - 1;
+
+	for (size_t i = tx_range_map_slot(key, map->capacity); 1;
+			i = (i + 1) & mask) {
+		struct tx_range_line *l = &map->lines[i];
+		if (l->key == key)
+			return l;
+		if (l->key == 0)
+			return NULL;
+	}
+}
+
+/*
+ * tx_range_map_get -- (internal) returns the entry of the line, creating it
+ *	if necessary, there must be enough free slots in the table
+ */
+static struct tx_range_line *
+tx_range_map_get(struct tx_range_map *map, uint64_t line)
+{
+	uint64_t key = line + 1;
+	size_t mask = map->capacity - 1;
+
+	for (size_t i = tx_range_map_slot(key, map->capacity); 1;
+			i = (i + 1) & mask) {
+		struct tx_range_line *l = &map->lines[i];
+		if (l->key == key)
+			return l;
+		if (l->key == 0) {
+			l->key = key;
+			l->snapshot = 0;
+			l->flush = 0;
+			map->nlines++;
+			return l;
+		}
+	}
+}
+
+/*
+ * tx_range_map_reserve -- (internal) makes sure that n more lines can be
+ *	inserted while keeping the load factor below one half
+ */
+static int
+tx_range_map_reserve(struct tx_range_map *map, uint64_t n)
+{
+	uint64_t needed = (map->nlines + n) * 2;
+	if (needed <= map->capacity)
+		return 0;
+
+	size_t capacity = map->capacity;
+	while (capacity < needed)
+		capacity *= 2;
+
+	struct tx_range_line *lines = Zalloc(sizeof(*lines) * capacity);
+	if (lines == NULL) {
+		ERR("!Zalloc");
+		return -1;
+	}
+
+	struct tx_range_line *old = map->lines;
+	size_t old_capacity = map->capacity;
+
+	map->lines = lines;
+	map->capacity = capacity;
+	map->nlines = 0;
+
+	for (size_t i = 0; i < old_capacity; ++i) {
+		if (old[i].key == 0)
+			continue;
+
+		struct tx_range_line *l = tx_range_map_get(map, old[i].key - 1);
+		l->snapshot = old[i].snapshot;
+		l->flush = old[i].flush;
+	}
+
+	Free(old);
+
+	return 0;
+}
+
+/*
+ * tx_range_map_extent_cmp -- (internal) compares two extents by their offset
+ */
+static int
+tx_range_map_extent_cmp(const void *lhs, const void *rhs)
+{
+	const struct tx_range_extent *l = lhs;
+	const struct tx_range_extent *r = rhs;
+
+	if (l->offset < r->offset)
+		return -1;
+
+	return l->offset > r->offset;
+}
+
+/*
+ * tx_range_map_extent_next -- (internal) returns the node of the first extent
+ *	which ends after the offset or NULL
+ */
+static struct ravl_node *
+tx_range_map_extent_next(struct tx_range_map *map, uint64_t offset)
+{
+	struct tx_range_extent key = {offset, 0, 0};
+
+	struct ravl_node *n = ravl_find(map->extents, &key,
+		RAVL_PREDICATE_LESS_EQUAL);
+	if (n != NULL) {
+		struct tx_range_extent *x = ravl_data(n);
+		if (x->offset + x->size > offset)
+			return n;
+	}
+
+	return ravl_find(map->extents, &key, RAVL_PREDICATE_GREATER);
+}
+
+/*
+ * tx_range_map_new -- creates a new, empty map
+ */
+struct tx_range_map *
+tx_range_map_new(void)
+{
+	struct tx_range_map *map = Malloc(sizeof(*map));
+	if (map == NULL) {
+		ERR("!Malloc");
+		return NULL;
+	}
+
+	map->lines = Zalloc(sizeof(*map->lines) * TX_RANGE_MAP_INIT_CAPACITY);
+	if (map->lines == NULL) {
+		ERR("!Zalloc");
+		goto err_lines;
+	}
+
+	map->extents = ravl_new_sized(tx_range_map_extent_cmp,
+		sizeof(struct tx_range_extent));
+	if (map->extents == NULL) {
+		ERR("!ravl_new_sized");
+		goto err_extents;
+	}
+
+	map->capacity = TX_RANGE_MAP_INIT_CAPACITY;
+	map->nlines = 0;
+
+	return map;
+
+err_extents:
+	Free(map->lines);
+err_lines:
+	Free(map);
+	return NULL;
+}
+
+/*
+ * tx_range_map_delete -- deletes the map
+ */
+void
+tx_range_map_delete(struct tx_range_map *map)
+{
+	ravl_delete(map->extents);
+	Free(map->lines);
+	Free(map);
+}
+
+/*
+ * tx_range_map_mark -- (internal) marks the range as present in the table
+ */
+static void
+tx_range_map_mark(struct tx_range_map *map, uint64_t offset, uint64_t size,
+	int flush)
+{
+	uint64_t end = offset + size;
+
+	while (offset < end) {
+		uint64_t line = offset / TX_RANGE_MAP_LINE;
+		uint64_t base = line * TX_RANGE_MAP_LINE;
+		uint64_t len = MIN(end, base + TX_RANGE_MAP_LINE) - offset;
+		uint64_t bits = tx_range_map_bits(offset - base, len);
+
+		struct tx_range_line *l = tx_range_map_get(map, line);
+		l->snapshot |= bits;
+		if (flush)
+			l->flush |= bits;
+
+		offset += len;
+	}
+}
+
+/*
+ * tx_range_map_clear_line -- (internal) removes the part of the range which
+ *	falls into the line, returns the removed bytes which had to be flushed
+ */
+static uint64_t
+tx_range_map_clear_line(struct tx_range_line *l, uint64_t offset, uint64_t end)
+{
+	uint64_t base = (l->key - 1) * TX_RANGE_MAP_LINE;
+	if (end <= base || offset >= base + TX_RANGE_MAP_LINE)
+		return 0;
+
+	uint64_t b = MAX(offset, base) - base;
+	uint64_t e = MIN(end, base + TX_RANGE_MAP_LINE) - base;
+	uint64_t bits = tx_range_map_bits(b, e - b);
+	uint64_t flush = l->snapshot & l->flush & bits;
+
+	l->snapshot &= ~bits;
+	l->flush &= ~bits;
+
+	return flush;
+}
+
+/*
+ * tx_range_map_clear -- (internal) removes the range from the table, returns
+ *	non-zero if any of the removed bytes had to be flushed
+ */
+static int
+tx_range_map_clear(struct tx_range_map *map, uint64_t offset, uint64_t size)
+{
+	if (map->nlines == 0 || size == 0)
+		return 0;
+
+	uint64_t end = offset + size;
+	uint64_t first = offset / TX_RANGE_MAP_LINE;
+	uint64_t last = (end - 1) / TX_RANGE_MAP_LINE;
+	uint64_t flush = 0;
+
+	if (last - first >= map->capacity) {
+		/* going through the whole table is cheaper */
+		for (size_t i = 0; i < map->capacity; ++i) {
+			if (map->lines[i].key != 0)
+				flush |= tx_range_map_clear_line(
+					&map->lines[i], offset, end);
+		}
+
+		return flush != 0;
+	}
+
+	for (uint64_t line = first; line <= last; ++line) {
+		struct tx_range_line *l = tx_range_map_find(map, line);
+		if (l != NULL)
+			flush |= tx_range_map_clear_line(l, offset, end);
+	}
+
+	return flush != 0;
+}
+
+/*
+ * tx_range_map_extent_add -- (internal) adds the range to the tree, merging
+ *	it with the extents it overlaps, and moves the bytes of the range out of
+ *	the table
+ */
+static int
+tx_range_map_extent_add(struct tx_range_map *map, uint64_t offset,
+	uint64_t size, int flush)
+{
+	uint64_t end = offset + size;
+	struct tx_range_extent *x = NULL;
+
+	struct ravl_node *n = tx_range_map_extent_next(map, offset);
+	if (n != NULL) {
+		x = ravl_data(n);
+		if (x->offset >= end)
+			x = NULL;
+	}
+
+	if (x == NULL) {
+		struct tx_range_extent e = {offset, size, flush};
+		if (ravl_emplace_copy(map->extents, &e) != 0) {
+			ERR("!ravl_emplace_copy");
+			return -1;
+		}
+
+		x = ravl_data(ravl_find(map->extents, &e,
+			RAVL_PREDICATE_EQUAL));
+	} else {
+		/*
+		 * The first overlapping extent is extended in place, no other
+		 * extent starts between its old and new offset, so its
+		 * position in the tree doesn't change.
+		 */
+		end = MAX(end, x->offset + x->size);
+		x->offset = MIN(x->offset, offset);
+		x->flush |= flush;
+
+		while ((n = ravl_find(map->extents, x,
+				RAVL_PREDICATE_GREATER)) != NULL) {
+			struct tx_range_extent *next = ravl_data(n);
+			if (next->offset >= end)
+				break;
+
+			end = MAX(end, next->offset + next->size);
+			x->flush |= next->flush;
+			ravl_remove(map->extents, n);
+		}
+
+		x->size = end - x->offset;
+	}
+
+	if (tx_range_map_clear(map, x->offset, x->size))
+		x->flush = 1;
+
+	return 0;
+}
+
+/*
+ * tx_range_map_line_add -- (internal) marks the parts of the range which are
+ *	not covered by the extents in the table, the extents covering the rest
+ *	inherit the flush requirement of the range
+ */
+static void
+tx_range_map_line_add(struct tx_range_map *map, uint64_t offset,
+	uint64_t size, int flush)
+{
+	uint64_t end = offset + size;
+
+	while (offset < end) {
+		struct ravl_node *n = tx_range_map_extent_next(map, offset);
+		struct tx_range_extent *x = n ? ravl_data(n) : NULL;
+
+		if (x == NULL || x->offset >= end) {
+			tx_range_map_mark(map, offset, end - offset, flush);
+			return;
+		}
+
+		if (x->offset > offset)
+			tx_range_map_mark(map, offset, x->offset - offset,
+				flush);
+
+		x->flush |= flush;
+		offset = x->offset + x->size;
+	}
+}
+
+/* the parts of the added range which were not present in the map */
+struct tx_range_map_missing {
+	tx_range_map_missing_fn cb;
+	void *arg;
+	int extent; /* the range is going to be added to the tree */
+	uint64_t start; /* the run which is not yet passed to the callback */
+	uint64_t end;
+};
+
+/*
+ * tx_range_map_missing_flush -- (internal) calls the callback for the pending
+ *	run and, unless the whole range goes to the tree afterwards, marks it
+ *	as present in the table once it succeeds
+ */
+static int
+tx_range_map_missing_flush(struct tx_range_map *map,
+	struct tx_range_map_missing *m)
+{
+	if (m->end == m->start)
+		return 0;
+
+	int ret = m->cb(m->start, m->end - m->start, m->arg);
+	if (ret != 0)
+		return ret;
+
+	if (!m->extent)
+		tx_range_map_mark(map, m->start, m->end - m->start, 0);
+	m->start = m->end;
+
+	return 0;
+}
+
+/*
+ * tx_range_map_missing_add -- (internal) appends the missing bytes to
+ *	the pending run, or replaces the run if they aren't adjacent
+ */
+static int
+tx_range_map_missing_add(struct tx_range_map *map,
+	struct tx_range_map_missing *m, uint64_t offset, uint64_t end)
+{
+	if (m->end != offset) {
+		if (tx_range_map_missing_flush(map, m) != 0)
+			return -1;
+		m->start = offset;
+	}
+	m->end = end;
+
+	return 0;
+}
+
+/*
+ * tx_range_map_missing_gap -- (internal) looks for the missing bytes in
+ *	the part of the range which is not covered by any extent
+ */
+static int
+tx_range_map_missing_gap(struct tx_range_map *map,
+	struct tx_range_map_missing *m, uint64_t offset, uint64_t end)
+{
+	if (map->nlines == 0)
+		return tx_range_map_missing_add(map, m, offset, end);
+
+	uint64_t first = offset / TX_RANGE_MAP_LINE;
+	uint64_t last = (end - 1) / TX_RANGE_MAP_LINE;
+
+	for (uint64_t line = first; line <= last; ++line) {
+		uint64_t base = line * TX_RANGE_MAP_LINE;
+		uint64_t b = MAX(offset, base) - base;
+		uint64_t e = MIN(end, base + TX_RANGE_MAP_LINE) - base;
+
+		struct tx_range_line *l = tx_range_map_find(map, line);
+		uint64_t missing = tx_range_map_bits(b, e - b);
+		if (l != NULL)
+			missing &= ~l->snapshot;
+
+		while (missing != 0) {
+			unsigned bit = util_lssb_index64(missing);
+			unsigned len = tx_range_map_run(missing, bit);
+
+			if (tx_range_map_missing_add(map, m, base + bit,
+					base + bit + len) != 0)
+				return -1;
+
+			missing &= ~tx_range_map_bits(bit, len);
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * tx_range_map_add -- adds the range to the map, calling the callback for all
+ *	the parts of the range which were not present in the map before
+ *
+ * The bytes added with the flush flag are flushed on commit, even if they
+ * were previously added without it. Since the flush is done at the cache
+ * line granularity, this matches the merging of the POBJ_XADD_NO_FLUSH flag
+ * between adjacent and overlapping ranges in the ranges tree.
+ */
+int
+tx_range_map_add(struct tx_range_map *map, uint64_t offset, uint64_t size,
+	int flush, tx_range_map_missing_fn cb, void *arg)
+{
+	if (size == 0)
+		return 0;
+
+	uint64_t end = offset + size;
+	int extent = size >= TX_RANGE_MAP_LINE;
+
+	if (!extent) {
+		uint64_t first = offset / TX_RANGE_MAP_LINE;
+		uint64_t last = (end - 1) / TX_RANGE_MAP_LINE;
+		if (tx_range_map_reserve(map, last - first + 1) != 0)
+			return -1;
+	}
+
+	if (cb != NULL) {
+		struct tx_range_map_missing m = {cb, arg, extent,
+			offset, offset};
+		uint64_t pos = offset;
+		int ret = 0;
+
+		while (ret == 0 && pos < end) {
+			struct ravl_node *n = tx_range_map_extent_next(map,
+				pos);
+			struct tx_range_extent *x = n ? ravl_data(n) : NULL;
+			uint64_t gap_end = x == NULL ? end :
+				MIN(end, x->offset);
+
+			if (pos < gap_end)
+				ret = tx_range_map_missing_gap(map, &m, pos,
+					gap_end);
+
+			pos = x == NULL ? end : x->offset + x->size;
+		}
+
+		if (ret == 0)
+			ret = tx_range_map_missing_flush(map, &m);
+
+		if (ret != 0) {
+			/* the part already snapshotted stays in the map */
+			if (extent && m.start != offset)
+				(void) tx_range_map_extent_add(map, offset,
+					m.start - offset, 0);
+			return -1;
+		}
+	}
+
+	if (extent)
+		return tx_range_map_extent_add(map, offset, size, flush);
+
+	tx_range_map_line_add(map, offset, size, flush);
+
+	return 0;
+}
+
+/*
+ * tx_range_map_remove -- removes the range from the map
+ *
+ * If the range is in the middle of an extent which cannot be split, the extent
+ * is left intact, which only means that its bytes are flushed on commit.
+ */
+void
+tx_range_map_remove(struct tx_range_map *map, uint64_t offset, uint64_t size)
+{
+	uint64_t end = offset + size;
+
+	tx_range_map_clear(map, offset, size);
+
+	struct ravl_node *n;
+	while ((n = tx_range_map_extent_next(map, offset)) != NULL) {
+		struct tx_range_extent *x = ravl_data(n);
+		if (x->offset >= end)
+			break;
+
+		uint64_t xend = x->offset + x->size;
+		if (x->offset < offset) {
+			if (xend > end) {
+				struct tx_range_extent right = {end,
+					xend - end, x->flush};
+				if (ravl_emplace_copy(map->extents,
+						&right) != 0) {
+					ERR("!ravl_emplace_copy");
+					return;
+				}
+			}
+			x->size = offset - x->offset;
+		} else if (xend > end) {
+			/* the extent keeps its position in the tree */
+			x->offset = end;
+			x->size = xend - end;
+		} else {
+			ravl_remove(map->extents, n);
+		}
+	}
+}
+
+/*
+ * tx_range_map_contains -- returns 1 if the byte at offset is in the map
+ */
+int
+tx_range_map_contains(struct tx_range_map *map, uint64_t offset)
+{
+	struct tx_range_line *l =
+		tx_range_map_find(map, offset / TX_RANGE_MAP_LINE);
+	if (l != NULL && ((l->snapshot >> (offset % TX_RANGE_MAP_LINE)) & 1))
+		return 1;
+
+	struct ravl_node *n = tx_range_map_extent_next(map, offset);
+	if (n == NULL)
+		return 0;
+
+	return ((struct tx_range_extent *)ravl_data(n))->offset <= offset;
+}
+
+/*
+ * tx_range_map_line_cmp -- (internal) compares two lines by their index
+ */
+static int
+tx_range_map_line_cmp(const void *lhs, const void *rhs)
+{
+	const struct tx_range_line *l = lhs;
+	const struct tx_range_line *r = rhs;
+
+	if (l->key < r->key)
+		return -1;
+
+	return l->key > r->key;
+}
+
+/* the continuous range which is being passed to the callback */
+struct tx_range_map_emit {
+	tx_range_map_range_fn cb;
+	void *arg;
+	uint64_t start;
+	uint64_t end;
+	int flush;
+};
+
+/*
+ * tx_range_map_emit -- (internal) appends the range to the pending one, or
+ *	passes the pending one to the callback if they can't be joined
+ */
+static void
+tx_range_map_emit(struct tx_range_map_emit *e, uint64_t offset,
+	uint64_t size, int flush)
+{
+	if (e->end != offset || e->flush != flush) {
+		if (e->end != e->start)
+			e->cb(e->start, e->end - e->start, e->flush, e->arg);
+		e->start = offset;
+		e->flush = flush;
+	}
+	e->end = offset + size;
+}
+
+/*
+ * tx_range_map_emit_extents -- (internal) emits the extents, starting from
+ *	the given node, which begin before the offset, returns the node of
+ *	the next extent
+ */
+static struct ravl_node *
+tx_range_map_emit_extents(struct tx_range_map_emit *e,
+	struct tx_range_map *map, struct ravl_node *n, uint64_t offset)
+{
+	while (n != NULL) {
+		struct tx_range_extent *x = ravl_data(n);
+		if (x->offset >= offset)
+			break;
+
+		tx_range_map_emit(e, x->offset, x->size, x->flush);
+		n = ravl_find(map->extents, x, RAVL_PREDICATE_GREATER);
+	}
+
+	return n;
+}
+
+/*
+ * tx_range_map_delete_cb -- calls the callback for every continuous range in
+ *	the map, in the ascending order of offsets, and deletes the map
+ */
+void
+tx_range_map_delete_cb(struct tx_range_map *map, tx_range_map_range_fn cb,
+	void *arg)
+{
+	/* the table is no longer needed, compact and sort it in place */
+	size_t n = 0;
+	for (size_t i = 0; i < map->capacity; ++i) {
+		if (map->lines[i].snapshot != 0)
+			map->lines[n++] = map->lines[i];
+	}
+	qsort(map->lines, n, sizeof(*map->lines), tx_range_map_line_cmp);
+
+	/* the lines and the extents never overlap, they are merged by offset */
+	struct tx_range_map_emit e = {cb, arg, 0, 0, 0};
+	struct ravl_node *next = ravl_first(map->extents);
+
+	for (size_t i = 0; i < n; ++i) {
+		struct tx_range_line *l = &map->lines[i];
+		uint64_t base = (l->key - 1) * TX_RANGE_MAP_LINE;
+		uint64_t s = l->snapshot;
+		uint64_t f = l->flush & s;
+
+		while (s != 0) {
+			unsigned bit = util_lssb_index64(s);
+			int fbit = (int)((f >> bit) & 1);
+			unsigned len = tx_range_map_run(fbit ? f : s & ~f, bit);
+			uint64_t off = base + bit;
+
+			next = tx_range_map_emit_extents(&e, map, next, off);
+			tx_range_map_emit(&e, off, len, fbit);
+
+			s &= ~tx_range_map_bits(bit, len);
+		}
+	}
+
+	tx_range_map_emit_extents(&e, map, next, UINT64_MAX);
+	if (e.end != e.start)
+		cb(e.start, e.end - e.start, e.flush, arg);
+
+	tx_range_map_delete(map);
+}
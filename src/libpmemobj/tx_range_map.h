@@ -0,0 +1,49 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright 2026, Intel Corporation */
+
+/*
+ * tx_range_map.h -- internal definitions for the cache line granular map of
+ *	the ranges added to a transaction
+ */
+
+#ifndef LIBPMEMOBJ_TX_RANGE_MAP_H
+#define LIBPMEMOBJ_TX_RANGE_MAP_H 1
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct tx_range_map;
+
+/*
+ * Called for every part of the added range which is not yet present in
+ * the map, in the ascending order of offsets.
+ */
+typedef int (*tx_range_map_missing_fn)(uint64_t offset, uint64_t size,
+	void *arg);
+
+/*
+ * Called for every continuous range with the same flush requirement.
+ */
+typedef void (*tx_range_map_range_fn)(uint64_t offset, uint64_t size,
+	int flush, void *arg);
+
+struct tx_range_map *tx_range_map_new(void);
+void tx_range_map_delete(struct tx_range_map *map);
+void tx_range_map_delete_cb(struct tx_range_map *map,
+	tx_range_map_range_fn cb, void *arg);
+
+int tx_range_map_add(struct tx_range_map *map, uint64_t offset, uint64_t size,
+	int flush, tx_range_map_missing_fn cb, void *arg);
+void tx_range_map_remove(struct tx_range_map *map, uint64_t offset,
+	uint64_t size);
+int tx_range_map_contains(struct tx_range_map *map, uint64_t offset);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -519,6 +519,34 @@ ulog_entry_buf_create(struct ulog *ulog, size_t offset, uint64_t gen_num,
 	return e;
 }
 
+/*
+ * ulog_entry_apply_value -- (internal) applies the modification of a single
+ *	value entry, without flushing it
+ */
+static void
+ulog_entry_apply_value(const struct ulog_entry_base *e, uint64_t *dst)
+{
+	const struct ulog_entry_val *ev = (const struct ulog_entry_val *)e;
+
+	VALGRIND_ADD_TO_TX(dst, sizeof(*dst));
+
+	switch (ulog_entry_type(e)) {
+		case ULOG_OPERATION_AND:
+			*dst &= ev->value;
+		break;
+		case ULOG_OPERATION_OR:
+			*dst |= ev->value;
+		break;
+		case ULOG_OPERATION_SET:
+			*dst = ev->value;
+		break;
+		default:
+			ASSERT(0);
+	}
+
+	VALGRIND_REMOVE_FROM_TX(dst, sizeof(*dst));
+}
+
 /*
  * ulog_entry_apply -- applies modifications of a single ulog entry
  */
@@ -532,36 +560,18 @@ ulog_entry_apply(const struct ulog_entry_base *e, int persist,
 	size_t dst_size = sizeof(uint64_t);
 	uint64_t *dst = (uint64_t *)((uintptr_t)p_ops->base + offset);
 
-	struct ulog_entry_val *ev;
 	struct ulog_entry_buf *eb;
 
 	flush_fn f = persist ? p_ops->persist : p_ops->flush;
 
 	switch (t) {
 		case ULOG_OPERATION_AND:
-			ev = (struct ulog_entry_val *)e;
-
-			VALGRIND_ADD_TO_TX(dst, dst_size);
-			*dst &= ev->value;
-			f(p_ops->base, dst, sizeof(uint64_t),
-				PMEMOBJ_F_RELAXED);
-		break;
 		case ULOG_OPERATION_OR:
-			ev = (struct ulog_entry_val *)e;
-
-			VALGRIND_ADD_TO_TX(dst, dst_size);
-			*dst |= ev->value;
-			f(p_ops->base, dst, sizeof(uint64_t),
-				PMEMOBJ_F_RELAXED);
-		break;
 		case ULOG_OPERATION_SET:
-			ev = (struct ulog_entry_val *)e;
-
-			VALGRIND_ADD_TO_TX(dst, dst_size);
-			*dst = ev->value;
+			ulog_entry_apply_value(e, dst);
 			f(p_ops->base, dst, sizeof(uint64_t),
 				PMEMOBJ_F_RELAXED);
-		break;
+		return;
 		case ULOG_OPERATION_BUF_SET:
 			eb = (struct ulog_entry_buf *)e;
 
@@ -584,6 +594,37 @@ ulog_entry_apply(const struct ulog_entry_base *e, int persist,
 	VALGRIND_REMOVE_FROM_TX(dst, dst_size);
 }
 
+/*
+ * ulog_process_state -- the range modified by the preceding value entries
+ *	which is not flushed yet
+ *
+ * Redo logs tend to contain runs of value entries modifying the same cache
+ * line (e.g. the chunk headers and the run bitmaps of the heap), so instead
+ * of flushing each of them separately, the flush is deferred until an entry
+ * targeting a different cache line is found.
+ */
+struct ulog_process_state {
+	uintptr_t start;
+	uintptr_t end;
+};
+
+/*
+ * ulog_process_flush -- (internal) flushes the range modified by
+ *	the preceding value entries
+ */
+static void
+ulog_process_flush(struct ulog_process_state *state,
+	const struct pmem_ops *p_ops)
+{
+	if (state->start == state->end)
+		return;
+
+	pmemops_xflush(p_ops, (void *)state->start,
+		state->end - state->start, PMEMOBJ_F_RELAXED);
+
+	state->start = state->end = 0;
+}
+
 /*
  * ulog_process_entry -- (internal) processes a single ulog entry
  */
@@ -591,10 +632,31 @@ static int
 ulog_process_entry(struct ulog_entry_base *e, void *arg,
 	const struct pmem_ops *p_ops)
 {
-	/* suppress unused-parameter errors */
-	SUPPRESS_UNUSED(arg);
+	struct ulog_process_state *state = arg;
+	ulog_operation_type t = ulog_entry_type(e);
+
+	if (t == ULOG_OPERATION_BUF_SET || t == ULOG_OPERATION_BUF_CPY) {
+		ulog_process_flush(state, p_ops);
+		ulog_entry_apply(e, 0, p_ops);
+
+		return 0;
+	}
+
+	uintptr_t dst = (uintptr_t)p_ops->base + ulog_entry_offset(e);
 
-	ulog_entry_apply(e, 0, p_ops);
+	if (ALIGN_DOWN(dst, CACHELINE_SIZE) !=
+			ALIGN_DOWN(state->start, CACHELINE_SIZE))
+		ulog_process_flush(state, p_ops);
+
+	ulog_entry_apply_value(e, (uint64_t *)dst);
+
+	if (state->start == state->end) {
+		state->start = dst;
+		state->end = dst + sizeof(uint64_t);
+	} else {
+		state->start = MIN(state->start, dst);
+		state->end = MAX(state->end, dst + sizeof(uint64_t));
+	}
 
 	return 0;
 }
@@ -692,7 +754,7 @@ out:
  */
 void
 ulog_clobber(struct ulog *dest, struct ulog_next *next,
-	const struct pmem_ops *p_ops)
+	const struct pmem_ops *p_ops, unsigned flags)
 {
 	struct ulog empty;
 	memset(&empty, 0, sizeof(empty));
@@ -703,17 +765,21 @@ ulog_clobber(struct ulog *dest, struct ulog_next *next,
 		empty.next = dest->next;
 
 	pmemops_memcpy(p_ops, dest, &empty, sizeof(empty),
-		PMEMOBJ_F_MEM_WC);
+		PMEMOBJ_F_MEM_WC | flags);
 }
 
 /*
  * ulog_clobber_data -- zeroes out 'nbytes' of data in the logs
+ *
+ * Apart from the second ulog, which is always kept, the following internal
+ * ulogs are kept as long as their total capacity, including the second one,
+ * does not reach 'retain' bytes.
  */
 int
 ulog_clobber_data(struct ulog *ulog_first,
 	struct ulog_next *next, ulog_free_fn ulog_free,
 	ulog_rm_user_buffer_fn user_buff_remove,
-	const struct pmem_ops *p_ops, unsigned flags)
+	const struct pmem_ops *p_ops, unsigned flags, size_t retain)
 {
 	ASSERTne(ulog_first, NULL);
 
@@ -767,10 +833,26 @@ ulog_clobber_data(struct ulog *ulog_first,
 		 * each transaction is an acceptable overhead for the average
 		 * case.
 		 */
-		if (flags & ULOG_FREE_AFTER_FIRST)
+		if (flags & ULOG_FREE_AFTER_FIRST) {
 			u = ulog_first;
-		else
+		} else {
 			u = ulog_second;
+
+			/*
+			 * The retained ulogs are reused just like the second
+			 * one, and so their gen_nums have to be kept in sync.
+			 */
+			size_t kept = u == NULL ? 0 : u->capacity;
+			while (u != NULL && kept < retain && u->next != 0) {
+				struct ulog *n = ulog_by_offset(u->next, p_ops);
+				if (n->flags & ULOG_USER_OWNED)
+					break;
+
+				ulog_inc_gen_num(n, NULL);
+				kept += n->capacity;
+				u = n;
+			}
+		}
 	}
 
 	if (u == NULL)
@@ -796,7 +878,10 @@ ulog_process(struct ulog *ulog, ulog_check_offset_fn check,
 		ulog_check(ulog, check, p_ops);
 #endif
 
-	ulog_foreach_entry(ulog, ulog_process_entry, NULL, p_ops);
+	struct ulog_process_state state = {0, 0};
+
+	ulog_foreach_entry(ulog, ulog_process_entry, &state, p_ops);
+	ulog_process_flush(&state, p_ops);
 	pmemops_drain(p_ops);
 }
 
@@ -838,20 +923,25 @@ ulog_recovery_needed(struct ulog *ulog, int verify_checksum)
 }
 
 /*
- * ulog_recover -- recovery of ulog
+ * ulog_recover -- recovery of ulog, returns 1 if the ulog had to be processed
  *
  * The ulog_recover shall be preceded by ulog_check call.
+ * The clobbered ulog header is not drained, this is the caller's
+ * responsibility, which allows many ulogs to be recovered with a single drain.
  */
-void
+int
 ulog_recover(struct ulog *ulog, ulog_check_offset_fn check,
 	const struct pmem_ops *p_ops)
 {
 	LOG(15, "ulog %p", ulog);
 
-	if (ulog_recovery_needed(ulog, 1)) {
-		ulog_process(ulog, check, p_ops);
-		ulog_clobber(ulog, NULL, p_ops);
-	}
+	if (!ulog_recovery_needed(ulog, 1))
+		return 0;
+
+	ulog_process(ulog, check, p_ops);
+	ulog_clobber(ulog, NULL, p_ops, PMEMOBJ_F_MEM_NODRAIN);
+
+	return 1;
 }
 
 /*
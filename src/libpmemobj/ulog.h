@@ -123,11 +123,11 @@ int ulog_free_next(struct ulog *u, const struct pmem_ops *p_ops,
 		ulog_free_fn ulog_free, ulog_rm_user_buffer_fn user_buff_remove,
 		uint64_t flags);
 void ulog_clobber(struct ulog *dest, struct ulog_next *next,
-	const struct pmem_ops *p_ops);
+	const struct pmem_ops *p_ops, unsigned flags);
 int ulog_clobber_data(struct ulog *dest,
 	struct ulog_next *next, ulog_free_fn ulog_free,
 	ulog_rm_user_buffer_fn user_buff_remove,
-	const struct pmem_ops *p_ops, unsigned flags);
+	const struct pmem_ops *p_ops, unsigned flags, size_t retain);
 void ulog_clobber_entry(const struct ulog_entry_base *e,
 	const struct pmem_ops *p_ops);
 
@@ -157,7 +157,7 @@ void ulog_entry_apply(const struct ulog_entry_base *e, int persist,
 
 size_t ulog_entry_size(const struct ulog_entry_base *entry);
 
-void ulog_recover(struct ulog *ulog, ulog_check_offset_fn check,
+int ulog_recover(struct ulog *ulog, ulog_check_offset_fn check,
 	const struct pmem_ops *p_ops);
 int ulog_check(struct ulog *ulog, ulog_check_offset_fn check,
 	const struct pmem_ops *p_ops);
@@ -26,6 +26,7 @@ static const features_t f_singlehdr = FEAT_INCOMPAT(SINGLEHDR);
 static const features_t f_cksum_2k = FEAT_INCOMPAT(CKSUM_2K);
 static const features_t f_sds = FEAT_INCOMPAT(SDS);
 static const features_t f_chkbb = FEAT_COMPAT(CHECK_BAD_BLOCKS);
+static const features_t f_huge_align = FEAT_INCOMPAT(HUGE_ALIGN);
 
 #define FEAT_INVALID \
 	{UINT32_MAX, UINT32_MAX, UINT32_MAX};
@@ -562,6 +563,59 @@ query_badblocks_checking(const char *path)
 	return query_feature(path, f_chkbb);
 }
 
+/*
+ * enable_huge_align -- (internal) enable POOL_FEAT_HUGE_ALIGN
+ */
+static int
+enable_huge_align(const char *path)
+{
+	struct pool_set *set = poolset_open(path, RW);
+	if (!set)
+		return -1;
+
+	int ret = 0;
+	if (!require_feature_is(set, f_huge_align, DISABLED))
+		goto exit;
+
+	/* only the obj pools have huge blocks */
+	if (pool_hdr_get_type(get_hdr(set, 0, 0)) != POOL_TYPE_OBJ) {
+		ERR("%s can be enabled only in an obj pool",
+			util_feature2str(f_huge_align, NULL));
+		errno = EINVAL;
+		ret = -1;
+		goto exit;
+	}
+
+	feature_set(set, f_huge_align, ENABLED);
+exit:
+	poolset_close(set);
+	return ret;
+}
+
+/*
+ * disable_huge_align -- (internal) disable POOL_FEAT_HUGE_ALIGN
+ *
+ * The pool might already contain huge blocks with aligned data, which would
+ * be misplaced without the feature.
+ */
+static int
+disable_huge_align(const char *path)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(path);
+
+	return unsupported_feature(f_huge_align);
+}
+
+/*
+ * query_huge_align -- (internal) query POOL_FEAT_HUGE_ALIGN
+ */
+static int
+query_huge_align(const char *path)
+{
+	return query_feature(path, f_huge_align);
+}
+
 struct feature_funcs {
 	int (*enable)(const char *);
 	int (*disable)(const char *);
@@ -589,6 +643,11 @@ static struct feature_funcs features[] = {
 			.disable = disable_badblocks_checking,
 			.query = query_badblocks_checking
 		},
+		{
+			.enable = enable_huge_align,
+			.disable = disable_huge_align,
+			.query = query_huge_align
+		},
 };
 
 #define FEATURE_FUNCS_MAX ARRAY_SIZE(features)
@@ -1,5 +1,5 @@
 // SPDX-License-Identifier: BSD-3-Clause
-/* Copyright 2014-2018, Intel Corporation */
+/* Copyright 2014-2026, Intel Corporation */
 
 /*
  * checksum.c -- unit test for library internal checksum routine
@@ -10,6 +10,7 @@
 #include <endian.h>
 #include "unittest.h"
 #include "util.h"
+#include "util_checksum.h"
 #include <inttypes.h>
 
 /*
@@ -36,6 +37,60 @@ fletcher64(void *addr, size_t len)
 	return htole64((uint64_t)hi32 << 32 | lo32);
 }
 
+#define IMPL_BUF_SIZE 4096
+#define IMPL_MAX_SHIFT 16
+
+/*
+ * check_impl -- compares the implementation of the sequential checksum with
+ *	the generic one, for all the lengths and word aligned offsets of
+ *	the data
+ */
+static void
+check_impl(const char *name, const uint32_t *buf,
+	uint64_t (*impl)(const void *, size_t, uint64_t))
+{
+	for (size_t shift = 0; shift < IMPL_MAX_SHIFT; ++shift) {
+		const uint32_t *data = buf + shift;
+		size_t max = IMPL_BUF_SIZE - shift * sizeof(uint32_t);
+
+		for (size_t len = 0; len <= max; len += sizeof(uint32_t)) {
+			uint64_t seed = (uint64_t)buf[len % IMPL_BUF_SIZE /
+				sizeof(uint32_t)] << 32 | len;
+			uint64_t gold = util_checksum_seq_generic(data, len,
+				seed);
+			uint64_t csum = impl(data, len, seed);
+			if (csum != gold)
+				UT_FATAL("%s: shift %zu len %zu: 0x%" PRIx64
+					" != 0x%" PRIx64, name, shift, len,
+					csum, gold);
+		}
+	}
+}
+
+/*
+ * check_impls -- compares all the implementations of the sequential checksum
+ *	available on the CPU with the generic one
+ */
+static void
+check_impls(void)
+{
+	uint32_t *buf = MALLOC(IMPL_BUF_SIZE);
+	for (size_t i = 0; i < IMPL_BUF_SIZE / sizeof(uint32_t); ++i)
+		buf[i] = (uint32_t)rand() * 2654435761U + (uint32_t)i;
+
+	check_impl("dispatched", buf, util_checksum_seq);
+
+#if defined(__x86_64__) || defined(__amd64__)
+	check_impl("sse2", buf, util_checksum_seq_sse2);
+
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+		check_impl("avx2", buf, util_checksum_seq_avx2);
+#endif
+
+	FREE(buf);
+}
+
 int
 main(int argc, char *argv[])
 {
@@ -44,6 +99,8 @@ main(int argc, char *argv[])
 	if (argc < 2)
 		UT_FATAL("usage: %s files...", argv[0]);
 
+	check_impls();
+
 	for (int arg = 1; arg < argc; arg++) {
 		int fd = OPEN(argv[arg], O_RDONLY);
 
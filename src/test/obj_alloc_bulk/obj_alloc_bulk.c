@@ -0,0 +1,299 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2026, Intel Corporation */
+
+/*
+ * obj_alloc_bulk.c -- unit tests for pmemobj_xalloc_bulk
+ * usage:
+ * obj_alloc_bulk <file> b - test for successful bulk allocations
+ *
+ * obj_alloc_bulk <file> c - test for canceled and failed bulk allocations
+ *
+ * obj_alloc_bulk <file> m - test for bulk allocations which miss the thread
+ *	cache and then could be served from it
+ */
+
+#include "libpmemobj/ctl.h"
+#include "unittest.h"
+
+#define LAYOUT "obj_alloc_bulk"
+#define NOBJECTS 100
+#define NHUGE 3
+#define SMALL_SIZE 128
+#define HUGE_SIZE (1 << 20)
+#define TYPE_NUM 5
+
+struct root {
+	PMEMoid oids[NOBJECTS];
+};
+
+static PMEMobjpool *pop;
+
+/*
+ * count_objects -- returns the number of allocated objects in the pool
+ */
+static unsigned
+count_objects(void)
+{
+	unsigned n = 0;
+	PMEMoid oid;
+	POBJ_FOREACH(pop, oid)
+		n++;
+
+	return n;
+}
+
+/*
+ * curr_allocated -- returns the number of bytes currently allocated
+ */
+static size_t
+curr_allocated(void)
+{
+	size_t allocated;
+	int ret = pmemobj_ctl_get(pop, "stats.heap.curr_allocated",
+		&allocated);
+	UT_ASSERTeq(ret, 0);
+
+	return allocated;
+}
+
+/*
+ * counting_constructor -- fills the object and counts the invocations,
+ *	fails once the number of calls reaches the limit (if any)
+ */
+static int
+counting_constructor(PMEMobjpool *pop, void *ptr, void *arg)
+{
+	unsigned *ncalls = arg;
+	(*ncalls)++;
+
+	if (ncalls[1] != 0 && ncalls[0] == ncalls[1])
+		return -1;
+
+	pmemobj_memset_persist(pop, ptr, 0xc, SMALL_SIZE);
+
+	return 0;
+}
+
+/*
+ * check_objects -- verifies the objects allocated by a bulk allocation
+ */
+static void
+check_objects(PMEMoid *oidv, size_t count, size_t size, int zeroed)
+{
+	for (size_t i = 0; i < count; ++i) {
+		UT_ASSERT(!OID_IS_NULL(oidv[i]));
+		UT_ASSERTeq(pmemobj_pool_by_oid(oidv[i]), pop);
+		UT_ASSERTeq(pmemobj_type_num(oidv[i]), TYPE_NUM);
+		UT_ASSERT(pmemobj_alloc_usable_size(oidv[i]) >= size);
+
+		if (zeroed) {
+			char *p = pmemobj_direct(oidv[i]);
+			for (size_t j = 0; j < size; ++j)
+				UT_ASSERTeq(p[j], 0);
+		}
+
+		for (size_t j = 0; j < i; ++j)
+			UT_ASSERTne(oidv[i].off, oidv[j].off);
+	}
+}
+
+/*
+ * test_bulk -- checks the successful bulk allocations
+ */
+static void
+test_bulk(void)
+{
+	PMEMoid root = pmemobj_root(pop, sizeof(struct root));
+	UT_ASSERT(!OID_IS_NULL(root));
+	struct root *rootp = pmemobj_direct(root);
+
+	/* handles stored in the pool */
+	unsigned ncalls[2] = {0, 0};
+	int ret = pmemobj_xalloc_bulk(pop, rootp->oids, NOBJECTS, SMALL_SIZE,
+		TYPE_NUM, 0, counting_constructor, ncalls);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(ncalls[0], NOBJECTS);
+	check_objects(rootp->oids, NOBJECTS, SMALL_SIZE, 0);
+	for (unsigned i = 0; i < NOBJECTS; ++i) {
+		char *p = pmemobj_direct(rootp->oids[i]);
+		UT_ASSERTeq(p[SMALL_SIZE - 1], 0xc);
+	}
+
+	/* zeroed huge objects, handles in volatile memory */
+	PMEMoid huge[NHUGE];
+	ret = pmemobj_xalloc_bulk(pop, huge, NHUGE, HUGE_SIZE, TYPE_NUM,
+		POBJ_XALLOC_ZERO, NULL, NULL);
+	UT_ASSERTeq(ret, 0);
+	check_objects(huge, NHUGE, HUGE_SIZE, 1);
+
+	/* the thread cache path */
+	int enabled = 1;
+	ret = pmemobj_ctl_set(pop, "heap.thread_cache.enabled", &enabled);
+	UT_ASSERTeq(ret, 0);
+
+	PMEMoid cached[NOBJECTS];
+	ret = pmemobj_xalloc_bulk(pop, cached, NOBJECTS, SMALL_SIZE, TYPE_NUM,
+		POBJ_XALLOC_ZERO, NULL, NULL);
+	UT_ASSERTeq(ret, 0);
+	check_objects(cached, NOBJECTS, SMALL_SIZE, 1);
+
+	UT_ASSERTeq(count_objects(), 2 * NOBJECTS + NHUGE);
+
+	for (unsigned i = 0; i < NOBJECTS; ++i) {
+		pmemobj_free(&cached[i]);
+		pmemobj_free(&rootp->oids[i]);
+	}
+	for (unsigned i = 0; i < NHUGE; ++i)
+		pmemobj_free(&huge[i]);
+
+	UT_ASSERTeq(count_objects(), 0);
+}
+
+/*
+ * test_cancel -- checks that a failed bulk allocation leaves no objects
+ *	behind
+ */
+static void
+test_cancel(void)
+{
+	int enabled = 1;
+	int ret = pmemobj_ctl_set(pop, "stats.enabled", &enabled);
+	UT_ASSERTeq(ret, 0);
+
+	PMEMoid oids[NOBJECTS];
+	for (unsigned i = 0; i < NOBJECTS; ++i)
+		oids[i] = OID_NULL;
+
+	ret = pmemobj_xalloc_bulk(pop, oids, 0, SMALL_SIZE, TYPE_NUM, 0,
+		NULL, NULL);
+	UT_ASSERTeq(ret, -1);
+	UT_ASSERTeq(errno, EINVAL);
+
+	ret = pmemobj_xalloc_bulk(pop, oids, NOBJECTS, 0, TYPE_NUM, 0,
+		NULL, NULL);
+	UT_ASSERTeq(ret, -1);
+	UT_ASSERTeq(errno, EINVAL);
+
+	ret = pmemobj_xalloc_bulk(pop, oids, NOBJECTS, SMALL_SIZE, TYPE_NUM,
+		POBJ_FLAG_ASSUME_INITIALIZED, NULL, NULL);
+	UT_ASSERTeq(ret, -1);
+	UT_ASSERTeq(errno, EINVAL);
+
+	/* constructor fails in the middle of the batch */
+	unsigned ncalls[2] = {0, NOBJECTS / 2};
+	ret = pmemobj_xalloc_bulk(pop, oids, NOBJECTS, SMALL_SIZE, TYPE_NUM,
+		0, counting_constructor, ncalls);
+	UT_ASSERTeq(ret, -1);
+	UT_ASSERTeq(errno, ECANCELED);
+	UT_ASSERTeq(ncalls[0], NOBJECTS / 2);
+
+	ncalls[0] = 0;
+	ncalls[1] = 2;
+	ret = pmemobj_xalloc_bulk(pop, oids, NHUGE, HUGE_SIZE, TYPE_NUM,
+		0, counting_constructor, ncalls);
+	UT_ASSERTeq(ret, -1);
+	UT_ASSERTeq(errno, ECANCELED);
+
+	/* not enough space for all of the objects */
+	ret = pmemobj_xalloc_bulk(pop, oids, NOBJECTS, HUGE_SIZE * 4,
+		TYPE_NUM, 0, NULL, NULL);
+	UT_ASSERTeq(ret, -1);
+	UT_ASSERTeq(errno, ENOMEM);
+
+	for (unsigned i = 0; i < NOBJECTS; ++i)
+		UT_ASSERT(OID_IS_NULL(oids[i]));
+
+	UT_ASSERTeq(count_objects(), 0);
+	UT_ASSERTeq(curr_allocated(), 0);
+
+	/* the canceled space is reusable */
+	ret = pmemobj_xalloc_bulk(pop, oids, NOBJECTS, SMALL_SIZE, TYPE_NUM,
+		0, NULL, NULL);
+	UT_ASSERTeq(ret, 0);
+	check_objects(oids, NOBJECTS, SMALL_SIZE, 0);
+	UT_ASSERTeq(count_objects(), NOBJECTS);
+
+	for (unsigned i = 0; i < NOBJECTS; ++i)
+		pmemobj_free(&oids[i]);
+}
+
+/*
+ * enabling_constructor -- enables the thread cache in the middle of the bulk
+ *	allocation, after the first object was served from the bucket
+ */
+static int
+enabling_constructor(PMEMobjpool *pop, void *ptr, void *arg)
+{
+	int enabled = 1;
+	int ret = pmemobj_ctl_set(pop, "heap.thread_cache.enabled", &enabled);
+	UT_ASSERTeq(ret, 0);
+
+	return counting_constructor(pop, ptr, arg);
+}
+
+/*
+ * test_cache_miss -- checks a bulk allocation whose first object misses
+ *	the thread cache, the rest of the objects must not be taken from
+ *	the cache, whose refill would acquire the bucket already held
+ */
+static void
+test_cache_miss(void)
+{
+	PMEMoid oids[NOBJECTS];
+	unsigned ncalls[2] = {0, 0};
+	int ret = pmemobj_xalloc_bulk(pop, oids, NOBJECTS, SMALL_SIZE,
+		TYPE_NUM, 0, enabling_constructor, ncalls);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(ncalls[0], NOBJECTS);
+	check_objects(oids, NOBJECTS, SMALL_SIZE, 0);
+
+	/* the following allocations are served from the cache */
+	PMEMoid cached[NOBJECTS];
+	ret = pmemobj_xalloc_bulk(pop, cached, NOBJECTS, SMALL_SIZE, TYPE_NUM,
+		POBJ_XALLOC_ZERO, NULL, NULL);
+	UT_ASSERTeq(ret, 0);
+	check_objects(cached, NOBJECTS, SMALL_SIZE, 1);
+
+	UT_ASSERTeq(count_objects(), 2 * NOBJECTS);
+
+	for (unsigned i = 0; i < NOBJECTS; ++i) {
+		pmemobj_free(&oids[i]);
+		pmemobj_free(&cached[i]);
+	}
+
+	UT_ASSERTeq(count_objects(), 0);
+}
+
+int
+main(int argc, char *argv[])
+{
+	START(argc, argv, "obj_alloc_bulk");
+
+	if (argc != 3)
+		UT_FATAL("usage: %s file-name b|c|m", argv[0]);
+
+	const char *path = argv[1];
+	char t = argv[2][0];
+
+	if ((pop = pmemobj_create(path, LAYOUT, PMEMOBJ_MIN_POOL * 20,
+		S_IWUSR | S_IRUSR)) == NULL)
+		UT_FATAL("!pmemobj_create: %s", path);
+
+	switch (t) {
+		case 'b':
+			test_bulk();
+			break;
+		case 'c':
+			test_cancel();
+			break;
+		case 'm':
+			test_cache_miss();
+			break;
+		default:
+			UT_FATAL("unknown test type %c", t);
+	}
+
+	pmemobj_close(pop);
+
+	DONE(NULL);
+}
@@ -30,6 +30,10 @@
  *
  * obj_ctl_arenas <file> b - test for config change of
  *	heap.arenas_default_max
+ *
+ * obj_ctl_arenas <file> u - test for config change of
+ *	heap.arenas_assignment_type for numa type and
+ *	heap.arena.[idx].numa_node (RO)
  */
 
 #include <sched.h>
@@ -251,6 +255,39 @@ worker_arena_ref_obj(struct arena_alloc *ref)
 	UT_ASSERTeq(ret, 0);
 }
 
+/*
+ * worker_arenas_numa -- allocates objects and checks the numa binding of
+ *	the thread's arena
+ */
+static void *
+worker_arenas_numa(void *arg)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(arg);
+
+	for (int i = 0; i < NOBJECT_THREAD; ++i) {
+		int ret = pmemobj_alloc(pop, NULL, alloc_class[0].unit_size, 0,
+			NULL, NULL);
+		UT_ASSERTeq(ret, 0);
+	}
+
+	unsigned arena_id;
+	int ret = pmemobj_ctl_get(pop, "heap.thread.arena_id", &arena_id);
+	UT_ASSERTeq(ret, 0);
+
+	char arena_idx_numa_node[CTL_QUERY_LEN];
+	SNPRINTF(arena_idx_numa_node, CTL_QUERY_LEN,
+		"heap.arena.%u.numa_node", arena_id);
+
+	/* the arena is bound to a node on the first allocation */
+	int numa_node;
+	ret = pmemobj_ctl_get(pop, arena_idx_numa_node, &numa_node);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERT(numa_node >= 0);
+
+	return NULL;
+}
+
 #define MAX_KEYS 1024
 
 int
@@ -259,7 +296,8 @@ main(int argc, char *argv[])
 	START(argc, argv, "obj_ctl_arenas");
 
 	if (argc != 3)
-		UT_FATAL("usage: %s poolset [n|s|c|f|q|m|a|g|p|d|b]", argv[0]);
+		UT_FATAL("usage: %s poolset [n|s|c|f|q|m|a|g|p|d|b|u]",
+			argv[0]);
 
 	const char *path = argv[1];
 	char t = argv[2][0];
@@ -549,6 +587,36 @@ main(int argc, char *argv[])
 		ret = pmemobj_ctl_get(pop, "heap.narenas.total", &narenas);
 		UT_ASSERTeq(ret, 0);
 		UT_ASSERTeq(narenas, target_narenas);
+	} else if (t == 'u') {
+		enum pobj_arenas_assignment_type atype;
+		ret = pmemobj_ctl_get(pop,
+			"heap.arenas_assignment_type", &atype);
+		UT_ASSERTeq(ret, 0);
+		UT_ASSERTeq(atype, POBJ_ARENAS_ASSIGNMENT_NUMA);
+
+		/* no arena is bound before the first allocation */
+		int numa_node;
+		ret = pmemobj_ctl_get(pop, "heap.arena.1.numa_node",
+			&numa_node);
+		UT_ASSERTeq(ret, 0);
+		UT_ASSERTeq(numa_node, -1);
+
+		os_thread_t threads[NTHREADX];
+		for (int i = 0; i < NTHREADX; i++)
+			THREAD_CREATE(&threads[i], NULL, worker_arenas_numa,
+				NULL);
+
+		for (int i = 0; i < NTHREADX; i++)
+			THREAD_JOIN(&threads[i], NULL);
+
+		unsigned expected = NTHREADX * NOBJECT_THREAD;
+		unsigned nobjects = 0;
+		PMEMoid oid, oid2;
+		POBJ_FOREACH_SAFE(pop, oid, oid2) {
+			pmemobj_free(&oid);
+			nobjects++;
+		}
+		UT_ASSERTeq(nobjects, expected);
 	} else {
 		UT_ASSERT(0);
 	}
@@ -0,0 +1,203 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2026, Intel Corporation */
+
+/*
+ * obj_ctl_heap_occupancy.c -- tests for the occupancy statistics of
+ *	the allocation classes and the zones
+ * usage: obj_ctl_heap_occupancy <file>
+ */
+
+#include "unittest.h"
+
+#define LAYOUT "obj_ctl_heap_occupancy"
+#define NOBJS 100
+#define HUGE_SIZE (4 << 20)
+#define POOL_SIZE (32 << 20)
+
+static PMEMoid objs[NOBJS];
+
+/*
+ * get_class -- reads the occupancy of the allocation class
+ */
+static void
+get_class(PMEMobjpool *pop, unsigned class_id,
+	struct pobj_alloc_class_stats *s)
+{
+	char name[128];
+	SNPRINTF(name, sizeof(name),
+		"stats.heap.alloc_class.%u.occupancy", class_id);
+
+	int ret = pmemobj_ctl_get(pop, name, s);
+	UT_ASSERTeq(ret, 0);
+
+	if (s->used_blocks + s->free_blocks != 0)
+		UT_ASSERTeq(s->fill_pct, s->used_blocks * 100 /
+			(s->used_blocks + s->free_blocks));
+}
+
+/*
+ * get_zone -- reads the free chunks of the zone
+ */
+static void
+get_zone(PMEMobjpool *pop, unsigned zone_id, struct pobj_zone_stats *s)
+{
+	char name[128];
+	SNPRINTF(name, sizeof(name), "stats.heap.zone.%u.occupancy", zone_id);
+
+	int ret = pmemobj_ctl_get(pop, name, s);
+	UT_ASSERTeq(ret, 0);
+
+	uint64_t nextents = 0;
+	for (unsigned i = 0; i < POBJ_ZONE_STATS_NBUCKETS; ++i)
+		nextents += s->extents[i];
+
+	UT_ASSERTeq(nextents, s->free_extents);
+	UT_ASSERT(s->free_chunks <= s->chunks);
+	UT_ASSERT(s->free_extents <= s->free_chunks);
+}
+
+/*
+ * test_invalid -- checks the indexes which are out of range
+ */
+static void
+test_invalid(PMEMobjpool *pop)
+{
+	struct pobj_alloc_class_stats c;
+	int ret = pmemobj_ctl_get(pop,
+		"stats.heap.alloc_class.254.occupancy", &c);
+	UT_ASSERTne(ret, 0);
+	UT_ASSERTeq(errno, ENOENT);
+
+	ret = pmemobj_ctl_get(pop, "stats.heap.alloc_class.255.occupancy", &c);
+	UT_ASSERTne(ret, 0);
+	UT_ASSERTeq(errno, ERANGE);
+
+	unsigned nzones;
+	ret = pmemobj_ctl_get(pop, "stats.heap.nzones", &nzones);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(nzones, 1);
+
+	struct pobj_zone_stats z;
+	ret = pmemobj_ctl_get(pop, "stats.heap.zone.1.occupancy", &z);
+	UT_ASSERTne(ret, 0);
+	UT_ASSERTeq(errno, ERANGE);
+}
+
+/*
+ * test_runs -- checks the occupancy of a class of runs
+ */
+static void
+test_runs(PMEMobjpool *pop)
+{
+	struct pobj_alloc_class_desc desc;
+	desc.header_type = POBJ_HEADER_COMPACT;
+	desc.unit_size = 200;
+	desc.alignment = 0;
+	desc.units_per_block = 500;
+
+	int ret = pmemobj_ctl_set(pop, "heap.alloc_class.new.desc", &desc);
+	UT_ASSERTeq(ret, 0);
+
+	struct pobj_alloc_class_stats s;
+	get_class(pop, desc.class_id, &s);
+	UT_ASSERTeq(s.runs, 0);
+	UT_ASSERTeq(s.used_blocks, 0);
+	UT_ASSERTeq(s.free_blocks, 0);
+	UT_ASSERTeq(s.fill_pct, 0);
+
+	for (int i = 0; i < NOBJS; ++i) {
+		ret = pmemobj_xalloc(pop, &objs[i], 100, 0,
+			POBJ_CLASS_ID(desc.class_id), NULL, NULL);
+		UT_ASSERTeq(ret, 0);
+	}
+
+	get_class(pop, desc.class_id, &s);
+	UT_ASSERTeq(s.runs, 1);
+	UT_ASSERTeq(s.used_blocks, NOBJS);
+	UT_ASSERTeq(s.free_blocks, desc.units_per_block - NOBJS);
+
+	for (int i = 0; i < NOBJS / 2; ++i)
+		pmemobj_free(&objs[i]);
+
+	get_class(pop, desc.class_id, &s);
+	UT_ASSERTeq(s.used_blocks, NOBJS / 2);
+	UT_ASSERTeq(s.free_blocks, desc.units_per_block - NOBJS / 2);
+}
+
+/*
+ * test_huge -- checks that the huge allocations are reflected both in
+ *	the huge class and in the free chunks of the zone
+ */
+static void
+test_huge(PMEMobjpool *pop, PMEMoid *oid)
+{
+	struct pobj_alloc_class_stats before;
+	struct pobj_zone_stats zbefore;
+	get_class(pop, 0, &before);
+	get_zone(pop, 0, &zbefore);
+
+	UT_ASSERTeq(before.runs, 0);
+	UT_ASSERTeq(before.free_blocks, zbefore.free_chunks);
+	UT_ASSERTne(zbefore.free_extents, 0);
+
+	int ret = pmemobj_alloc(pop, oid, HUGE_SIZE, 0, NULL, NULL);
+	UT_ASSERTeq(ret, 0);
+
+	struct pobj_alloc_class_stats after;
+	struct pobj_zone_stats zafter;
+	get_class(pop, 0, &after);
+	get_zone(pop, 0, &zafter);
+
+	uint64_t nchunks = after.used_blocks - before.used_blocks;
+	UT_ASSERT(nchunks * (256 << 10) >= HUGE_SIZE);
+	UT_ASSERTeq(zbefore.free_chunks - zafter.free_chunks, nchunks);
+	UT_ASSERTeq(after.free_blocks, zafter.free_chunks);
+}
+
+int
+main(int argc, char *argv[])
+{
+	START(argc, argv, "obj_ctl_heap_occupancy");
+
+	if (argc != 2)
+		UT_FATAL("usage: %s file-name", argv[0]);
+
+	const char *path = argv[1];
+	PMEMobjpool *pop = pmemobj_create(path, LAYOUT, POOL_SIZE,
+		S_IWUSR | S_IRUSR);
+	if (pop == NULL)
+		UT_FATAL("!pmemobj_create: %s", path);
+
+	test_invalid(pop);
+	test_runs(pop);
+
+	PMEMoid huge;
+	test_huge(pop, &huge);
+
+	struct pobj_alloc_class_stats huge_class;
+	get_class(pop, 0, &huge_class);
+
+	pmemobj_close(pop);
+
+	pop = pmemobj_open(path, LAYOUT);
+	if (pop == NULL)
+		UT_FATAL("!pmemobj_open: %s", path);
+
+	/* reading the zone rebuilds its state */
+	struct pobj_zone_stats z;
+	get_zone(pop, 0, &z);
+
+	struct pobj_alloc_class_stats s;
+	get_class(pop, 0, &s);
+	UT_ASSERTeq(s.used_blocks, huge_class.used_blocks);
+	UT_ASSERTeq(s.free_blocks, z.free_chunks);
+
+	pmemobj_free(&huge);
+
+	get_class(pop, 0, &s);
+	UT_ASSERT(s.used_blocks < huge_class.used_blocks);
+
+	pmemobj_close(pop);
+
+	DONE(NULL);
+}
@@ -0,0 +1,288 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2026, Intel Corporation */
+
+/*
+ * obj_ctl_thread_cache.c -- tests for the heap.thread_cache ctl entry points
+ * usage:
+ * obj_ctl_thread_cache <file> c - test for heap.thread_cache.* (RW)
+ *
+ * obj_ctl_thread_cache <file> a - test for allocations served from
+ *	the thread cache
+ *
+ * obj_ctl_thread_cache <file> t - mt test for returning the cached blocks
+ *	on thread exit and pool close
+ */
+
+#include "libpmemobj/ctl.h"
+#include "unittest.h"
+
+#define LAYOUT "obj_ctl_thread_cache"
+#define NTHREADS 8
+#define NOBJECTS 256
+#define SMALL_SIZE 64
+#define LARGE_SIZE 4096
+
+static PMEMobjpool *pop;
+
+/*
+ * count_objects -- returns the number of allocated objects in the pool
+ */
+static unsigned
+count_objects(void)
+{
+	unsigned n = 0;
+	PMEMoid oid;
+	POBJ_FOREACH(pop, oid)
+		n++;
+
+	return n;
+}
+
+/*
+ * enable_thread_cache -- enables the thread cache and the statistics
+ */
+static void
+enable_thread_cache(void)
+{
+	int enabled = 1;
+	int ret = pmemobj_ctl_set(pop, "heap.thread_cache.enabled", &enabled);
+	UT_ASSERTeq(ret, 0);
+
+	ret = pmemobj_ctl_set(pop, "stats.enabled", &enabled);
+	UT_ASSERTeq(ret, 0);
+}
+
+/*
+ * test_ctl -- checks the defaults and the validation of the ctl entries
+ */
+static void
+test_ctl(void)
+{
+	int enabled;
+	int ret = pmemobj_ctl_get(pop, "heap.thread_cache.enabled", &enabled);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(enabled, 0);
+
+	unsigned bin_size;
+	ret = pmemobj_ctl_get(pop, "heap.thread_cache.bin_size", &bin_size);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(bin_size, 16);
+
+	ssize_t max_size;
+	ret = pmemobj_ctl_get(pop, "heap.thread_cache.max_size", &max_size);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(max_size, 1024);
+
+	enabled = 1;
+	ret = pmemobj_ctl_set(pop, "heap.thread_cache.enabled", &enabled);
+	UT_ASSERTeq(ret, 0);
+	ret = pmemobj_ctl_get(pop, "heap.thread_cache.enabled", &enabled);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(enabled, 1);
+
+	bin_size = 0;
+	ret = pmemobj_ctl_set(pop, "heap.thread_cache.bin_size", &bin_size);
+	UT_ASSERTne(ret, 0);
+	UT_ASSERTeq(errno, EINVAL);
+
+	bin_size = 65;
+	ret = pmemobj_ctl_set(pop, "heap.thread_cache.bin_size", &bin_size);
+	UT_ASSERTne(ret, 0);
+	UT_ASSERTeq(errno, EINVAL);
+
+	bin_size = 64;
+	ret = pmemobj_ctl_set(pop, "heap.thread_cache.bin_size", &bin_size);
+	UT_ASSERTeq(ret, 0);
+	ret = pmemobj_ctl_get(pop, "heap.thread_cache.bin_size", &bin_size);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(bin_size, 64);
+
+	max_size = -1;
+	ret = pmemobj_ctl_set(pop, "heap.thread_cache.max_size", &max_size);
+	UT_ASSERTne(ret, 0);
+	UT_ASSERTeq(errno, EINVAL);
+
+	max_size = 512;
+	ret = pmemobj_ctl_set(pop, "heap.thread_cache.max_size", &max_size);
+	UT_ASSERTeq(ret, 0);
+	ret = pmemobj_ctl_get(pop, "heap.thread_cache.max_size", &max_size);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(max_size, 512);
+
+	ret = pmemobj_ctl_exec(pop, "heap.thread_cache.flush", NULL);
+	UT_ASSERTeq(ret, 0);
+
+	enabled = 0;
+	ret = pmemobj_ctl_set(pop, "heap.thread_cache.enabled", &enabled);
+	UT_ASSERTeq(ret, 0);
+}
+
+/*
+ * failing_constructor -- constructor which always cancels the allocation
+ */
+static int
+failing_constructor(PMEMobjpool *pop, void *ptr, void *arg)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(pop, ptr, arg);
+
+	return -1;
+}
+
+/*
+ * test_alloc -- checks that the allocations served from the thread cache
+ *	behave just like the regular ones
+ */
+static void
+test_alloc(void)
+{
+	enable_thread_cache();
+
+	PMEMoid oids[NOBJECTS];
+	for (unsigned i = 0; i < NOBJECTS; ++i) {
+		int ret = pmemobj_alloc(pop, &oids[i], SMALL_SIZE, 0,
+			NULL, NULL);
+		UT_ASSERTeq(ret, 0);
+		UT_ASSERT(pmemobj_alloc_usable_size(oids[i]) >= SMALL_SIZE);
+		memset(pmemobj_direct(oids[i]), 0xc, SMALL_SIZE);
+
+		for (unsigned j = 0; j < i; ++j)
+			UT_ASSERTne(oids[i].off, oids[j].off);
+	}
+	UT_ASSERTeq(count_objects(), NOBJECTS);
+
+	/* sizes above heap.thread_cache.max_size bypass the cache */
+	PMEMoid large;
+	int ret = pmemobj_alloc(pop, &large, LARGE_SIZE, 0, NULL, NULL);
+	UT_ASSERTeq(ret, 0);
+	pmemobj_free(&large);
+
+	/* canceled allocations are given back to the cache */
+	ret = pmemobj_alloc(pop, NULL, SMALL_SIZE, 0,
+		failing_constructor, NULL);
+	UT_ASSERTne(ret, 0);
+	UT_ASSERTeq(errno, ECANCELED);
+
+	struct pobj_action act;
+	PMEMoid reserved = pmemobj_reserve(pop, &act, SMALL_SIZE, 0);
+	UT_ASSERT(!OID_IS_NULL(reserved));
+	pmemobj_cancel(pop, &act, 1);
+
+	TX_BEGIN(pop) {
+		pmemobj_tx_alloc(SMALL_SIZE, 0);
+		pmemobj_tx_abort(ECANCELED);
+	} TX_END
+
+	UT_ASSERTeq(count_objects(), NOBJECTS);
+
+	for (unsigned i = 0; i < NOBJECTS; ++i)
+		pmemobj_free(&oids[i]);
+
+	ret = pmemobj_ctl_exec(pop, "heap.thread_cache.flush", NULL);
+	UT_ASSERTeq(ret, 0);
+
+	size_t allocated;
+	ret = pmemobj_ctl_get(pop, "stats.heap.curr_allocated", &allocated);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(allocated, 0);
+	UT_ASSERTeq(count_objects(), 0);
+}
+
+/*
+ * worker_alloc -- allocates objects and leaves some of them in the cache
+ *	when exiting
+ */
+static void *
+worker_alloc(void *arg)
+{
+	/* suppress unused-parameter errors */
+	SUPPRESS_UNUSED(arg);
+
+	PMEMoid oids[NOBJECTS];
+	for (unsigned i = 0; i < NOBJECTS; ++i) {
+		int ret = pmemobj_alloc(pop, &oids[i], SMALL_SIZE, 0,
+			NULL, NULL);
+		UT_ASSERTeq(ret, 0);
+	}
+
+	/* every other object survives the thread */
+	for (unsigned i = 0; i < NOBJECTS; i += 2)
+		pmemobj_free(&oids[i]);
+
+	return NULL;
+}
+
+/*
+ * test_cleanup -- checks that the cached blocks are returned to the heap
+ *	when the threads exit and when the pool is closed
+ */
+static void
+test_cleanup(const char *path)
+{
+	enable_thread_cache();
+
+	os_thread_t threads[NTHREADS];
+	for (unsigned i = 0; i < NTHREADS; ++i)
+		THREAD_CREATE(&threads[i], NULL, worker_alloc, NULL);
+
+	for (unsigned i = 0; i < NTHREADS; ++i)
+		THREAD_JOIN(&threads[i], NULL);
+
+	unsigned expected = NTHREADS * NOBJECTS / 2;
+	UT_ASSERTeq(count_objects(), expected);
+
+	/* leave some blocks cached by the main thread at pool close */
+	int ret = pmemobj_alloc(pop, NULL, SMALL_SIZE, 0, NULL, NULL);
+	UT_ASSERTeq(ret, 0);
+	expected++;
+
+	pmemobj_close(pop);
+
+	ret = pmemobj_check(path, LAYOUT);
+	UT_ASSERTeq(ret, 1);
+
+	pop = pmemobj_open(path, LAYOUT);
+	UT_ASSERTne(pop, NULL);
+
+	UT_ASSERTeq(count_objects(), expected);
+
+	PMEMoid oid, next;
+	POBJ_FOREACH_SAFE(pop, oid, next)
+		pmemobj_free(&oid);
+
+	UT_ASSERTeq(count_objects(), 0);
+}
+
+int
+main(int argc, char *argv[])
+{
+	START(argc, argv, "obj_ctl_thread_cache");
+
+	if (argc != 3)
+		UT_FATAL("usage: %s file-name c|a|t", argv[0]);
+
+	const char *path = argv[1];
+	char t = argv[2][0];
+
+	if ((pop = pmemobj_create(path, LAYOUT, PMEMOBJ_MIN_POOL * 20,
+		S_IWUSR | S_IRUSR)) == NULL)
+		UT_FATAL("!pmemobj_create: %s", path);
+
+	switch (t) {
+		case 'c':
+			test_ctl();
+			break;
+		case 'a':
+			test_alloc();
+			break;
+		case 't':
+			test_cleanup(path);
+			break;
+		default:
+			UT_FATAL("unknown test type %c", t);
+	}
+
+	pmemobj_close(pop);
+
+	DONE(NULL);
+}
@@ -0,0 +1,262 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2026, Intel Corporation */
+
+/*
+ * obj_defrag_daemon.c -- tests for the background defragmentation
+ * usage: obj_defrag_daemon <file>
+ */
+
+#include <unistd.h>
+
+#include "unittest.h"
+
+#define LAYOUT "obj_defrag_daemon"
+#define NOBJS 10000
+#define OBJ_SIZE 100
+#define KEEP_EVERY 10
+#define POOL_SIZE (32 << 20)
+#define MAX_WAIT_MS 10000
+
+/* objects for which the references can't be used the first time */
+#define TOO_MANY_REFS(idx) ((idx) % (3 * KEEP_EVERY) == 0)
+#define INVALID_REF(idx) ((idx) % (3 * KEEP_EVERY) == KEEP_EVERY)
+
+enum reject_state {
+	NOT_REJECTED,
+	REJECTED, /* waiting for moved */
+	RETRIED,
+};
+
+struct root {
+	PMEMoid objs[NOBJS];
+};
+
+struct moved_count {
+	PMEMobjpool *pop;
+	struct root *root;
+	uint64_t nrefs;
+	uint64_t ncalls; /* calls of moved */
+	uint64_t nmoved;
+	enum reject_state rejected[NOBJS];
+};
+
+/* used by the defragmentation thread until the pool is closed */
+static struct moved_count c;
+
+/*
+ * defrag_refs -- returns the root slot which references the object, some
+ *	of the objects get too many or invalid references when first queried
+ */
+static size_t
+defrag_refs(PMEMobjpool *pop, PMEMoid oid, PMEMoid **refs, size_t nrefs,
+	void *arg)
+{
+	struct moved_count *mc = arg;
+	UT_ASSERTeq(pop, mc->pop);
+	UT_ASSERT(nrefs >= 1);
+
+	uint64_t idx = *(uint64_t *)pmemobj_direct(oid);
+	UT_ASSERT(idx < NOBJS);
+	UT_ASSERT(OID_EQUALS(mc->root->objs[idx], oid));
+
+	mc->nrefs++;
+	refs[0] = &mc->root->objs[idx];
+
+	if (mc->rejected[idx] == NOT_REJECTED &&
+			(TOO_MANY_REFS(idx) || INVALID_REF(idx))) {
+		mc->rejected[idx] = REJECTED;
+		if (TOO_MANY_REFS(idx))
+			return nrefs + 1;
+
+		/* the next slot holds a freed object */
+		refs[0] = &mc->root->objs[idx + 1];
+	}
+
+	return 1;
+}
+
+/*
+ * defrag_moved -- counts the calls and the relocated objects
+ */
+static void
+defrag_moved(PMEMobjpool *pop, PMEMoid oid, PMEMoid new_oid, void *arg)
+{
+	struct moved_count *mc = arg;
+	UT_ASSERTeq(pop, mc->pop);
+
+	uint64_t idx = *(uint64_t *)pmemobj_direct(new_oid);
+	UT_ASSERT(OID_EQUALS(mc->root->objs[idx], new_oid));
+	mc->ncalls++;
+
+	if (mc->rejected[idx] == REJECTED) {
+		UT_ASSERT(OID_EQUALS(oid, new_oid));
+		mc->rejected[idx] = RETRIED;
+	}
+
+	if (!OID_EQUALS(oid, new_oid))
+		mc->nmoved++;
+}
+
+/*
+ * get_stat -- reads the statistic of the background defragmentation
+ */
+static uint64_t
+get_stat(PMEMobjpool *pop, const char *name)
+{
+	uint64_t value;
+	int ret = pmemobj_ctl_get(pop, name, &value);
+	UT_ASSERTeq(ret, 0);
+
+	return value;
+}
+
+/*
+ * test_ctl -- checks the configuration entry points
+ */
+static void
+test_ctl(PMEMobjpool *pop)
+{
+	unsigned fill;
+	int ret = pmemobj_ctl_get(pop, "heap.defrag.fill_threshold", &fill);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(fill, 25);
+
+	ssize_t arg = 51;
+	ret = pmemobj_ctl_set(pop, "heap.defrag.fill_threshold", &arg);
+	UT_ASSERTne(ret, 0);
+	UT_ASSERTeq(errno, EINVAL);
+
+	arg = 20;
+	ret = pmemobj_ctl_set(pop, "heap.defrag.fill_threshold", &arg);
+	UT_ASSERTeq(ret, 0);
+	ret = pmemobj_ctl_get(pop, "heap.defrag.fill_threshold", &fill);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(fill, 20);
+
+	uint64_t value;
+	ret = pmemobj_ctl_get(pop, "heap.defrag.interval", &value);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(value, 1000);
+
+	arg = 10;
+	ret = pmemobj_ctl_set(pop, "heap.defrag.interval", &arg);
+	UT_ASSERTeq(ret, 0);
+
+	ret = pmemobj_ctl_get(pop, "heap.defrag.bandwidth", &value);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(value, 0);
+
+	arg = -1;
+	ret = pmemobj_ctl_set(pop, "heap.defrag.bandwidth", &arg);
+	UT_ASSERTne(ret, 0);
+	UT_ASSERTeq(errno, EINVAL);
+
+	struct pobj_defrag_callbacks cb = {NULL, NULL, NULL};
+	ret = pmemobj_ctl_exec(pop, "heap.defrag.start", &cb);
+	UT_ASSERTne(ret, 0);
+	UT_ASSERTeq(errno, EINVAL);
+
+	/* stopping the defragmentation which isn't running is a noop */
+	ret = pmemobj_ctl_exec(pop, "heap.defrag.stop", NULL);
+	UT_ASSERTeq(ret, 0);
+}
+
+/*
+ * test_defrag -- checks that the sparse runs are emptied and that
+ *	the references are updated
+ */
+static void
+test_defrag(PMEMobjpool *pop)
+{
+	enum pobj_stats_enabled enabled = POBJ_STATS_ENABLED_TRANSIENT;
+	int ret = pmemobj_ctl_set(pop, "stats.enabled", &enabled);
+	UT_ASSERTeq(ret, 0);
+
+	PMEMoid root_oid = pmemobj_root(pop, sizeof(struct root));
+	struct root *root = pmemobj_direct(root_oid);
+
+	for (uint64_t i = 0; i < NOBJS; ++i) {
+		ret = pmemobj_alloc(pop, &root->objs[i], OBJ_SIZE, 0,
+			NULL, NULL);
+		UT_ASSERTeq(ret, 0);
+		uint64_t *data = pmemobj_direct(root->objs[i]);
+		*data = i;
+		pmemobj_persist(pop, data, sizeof(*data));
+	}
+
+	for (uint64_t i = 0; i < NOBJS; ++i) {
+		if (i % KEEP_EVERY != 0)
+			pmemobj_free(&root->objs[i]);
+	}
+
+	c.pop = pop;
+	c.root = root;
+	struct pobj_defrag_callbacks cb = {defrag_refs, defrag_moved, &c};
+	ret = pmemobj_ctl_exec(pop, "heap.defrag.start", &cb);
+	UT_ASSERTeq(ret, 0);
+
+	ret = pmemobj_ctl_exec(pop, "heap.defrag.start", &cb);
+	UT_ASSERTne(ret, 0);
+	UT_ASSERTeq(errno, EBUSY);
+
+	for (int ms = 0; ms < MAX_WAIT_MS; ++ms) {
+		if (get_stat(pop, "stats.heap.defrag_runs") != 0)
+			break;
+		usleep(1000);
+	}
+
+	ret = pmemobj_ctl_exec(pop, "heap.defrag.stop", NULL);
+	UT_ASSERTeq(ret, 0);
+
+	UT_ASSERTne(get_stat(pop, "stats.heap.defrag_runs"), 0);
+	UT_ASSERTne(c.nmoved, 0);
+	UT_ASSERT(c.nmoved <= c.nrefs);
+	UT_ASSERTeq(c.ncalls, c.nrefs);
+	UT_ASSERTeq(get_stat(pop, "stats.heap.defrag_objects"), c.nmoved);
+	UT_ASSERT(get_stat(pop, "stats.heap.defrag_bytes") >=
+		c.nmoved * OBJ_SIZE);
+
+	for (uint64_t i = 0; i < NOBJS; i += KEEP_EVERY) {
+		uint64_t *data = pmemobj_direct(root->objs[i]);
+		UT_ASSERTeq(*data, i);
+	}
+
+	/* closing the pool stops the defragmentation */
+	ret = pmemobj_ctl_exec(pop, "heap.defrag.start", &cb);
+	UT_ASSERTeq(ret, 0);
+}
+
+int
+main(int argc, char *argv[])
+{
+	START(argc, argv, "obj_defrag_daemon");
+
+	if (argc != 2)
+		UT_FATAL("usage: %s file-name", argv[0]);
+
+	const char *path = argv[1];
+	PMEMobjpool *pop = pmemobj_create(path, LAYOUT, POOL_SIZE,
+		S_IWUSR | S_IRUSR);
+	if (pop == NULL)
+		UT_FATAL("!pmemobj_create: %s", path);
+
+	test_ctl(pop);
+	test_defrag(pop);
+
+	pmemobj_close(pop);
+
+	pop = pmemobj_open(path, LAYOUT);
+	if (pop == NULL)
+		UT_FATAL("!pmemobj_open: %s", path);
+
+	struct root *root = pmemobj_direct(pmemobj_root(pop,
+		sizeof(struct root)));
+	for (uint64_t i = 0; i < NOBJS; i += KEEP_EVERY) {
+		uint64_t *data = pmemobj_direct(root->objs[i]);
+		UT_ASSERTeq(*data, i);
+	}
+
+	pmemobj_close(pop);
+
+	DONE(NULL);
+}
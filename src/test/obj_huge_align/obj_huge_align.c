@@ -0,0 +1,285 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2026, Intel Corporation */
+
+/*
+ * obj_huge_align.c -- tests for the huge allocations aligned to 2 megabytes
+ * usage: obj_huge_align <file> <file-without-feature>
+ */
+
+#include "unittest.h"
+
+#define LAYOUT "obj_huge_align"
+#define POOL_SIZE (64 << 20)
+#define CHUNK_SIZE (256 << 10)
+#define ALIGN_2M (2 << 20)
+#define OBJ_SIZE (3 << 20)
+#define NOBJS 3
+
+struct root {
+	PMEMoid objs[NOBJS];
+	PMEMoid tx_obj;
+	PMEMoid class_obj;
+};
+
+/*
+ * get_fallbacks -- reads the number of aligned allocations which fell back
+ *	to the best-fit placement
+ */
+static uint64_t
+get_fallbacks(PMEMobjpool *pop)
+{
+	uint64_t value;
+	int ret = pmemobj_ctl_get(pop, "stats.heap.huge_align_fallbacks",
+		&value);
+	UT_ASSERTeq(ret, 0);
+
+	return value;
+}
+
+/*
+ * check_aligned -- verifies the alignment and the size of an object
+ */
+static void
+check_aligned(PMEMobjpool *pop, PMEMoid oid, size_t size)
+{
+	UT_ASSERT(!OID_IS_NULL(oid));
+	UT_ASSERTeq(oid.off % ALIGN_2M, 0);
+	UT_ASSERTeq((uintptr_t)pmemobj_direct(oid) % ALIGN_2M, 0);
+	UT_ASSERT(pmemobj_alloc_usable_size(oid) >= size);
+}
+
+/*
+ * fill -- writes and persists the pattern of an object
+ */
+static void
+fill(PMEMobjpool *pop, PMEMoid oid, size_t size, int c)
+{
+	pmemobj_memset_persist(pop, pmemobj_direct(oid), c, size);
+}
+
+/*
+ * verify -- checks the pattern of an object
+ */
+static void
+verify(PMEMoid oid, size_t size, int c)
+{
+	unsigned char *data = pmemobj_direct(oid);
+	for (size_t i = 0; i < size; i += 4096)
+		UT_ASSERTeq(data[i], c);
+	UT_ASSERTeq(data[size - 1], c);
+}
+
+/*
+ * test_flags -- allocates the objects aligned by the allocation flags
+ */
+static void
+test_flags(PMEMobjpool *pop, struct root *root)
+{
+	for (int i = 0; i < NOBJS; ++i) {
+		int ret = pmemobj_xalloc(pop, &root->objs[i], OBJ_SIZE, 0,
+			POBJ_XALLOC_HUGE_ALIGN_2M | POBJ_XALLOC_ZERO,
+			NULL, NULL);
+		UT_ASSERTeq(ret, 0);
+		check_aligned(pop, root->objs[i], OBJ_SIZE);
+		verify(root->objs[i], OBJ_SIZE, 0);
+		fill(pop, root->objs[i], OBJ_SIZE, i + 1);
+	}
+
+	TX_BEGIN(pop) {
+		pmemobj_tx_add_range_direct(&root->tx_obj, sizeof(PMEMoid));
+		root->tx_obj = pmemobj_tx_xalloc(OBJ_SIZE, 0,
+			POBJ_XALLOC_HUGE_ALIGN_2M);
+	} TX_ONABORT {
+		UT_ASSERT(0);
+	} TX_END
+	check_aligned(pop, root->tx_obj, OBJ_SIZE);
+	fill(pop, root->tx_obj, OBJ_SIZE, NOBJS + 1);
+
+	UT_ASSERTeq(get_fallbacks(pop), 0);
+
+	/* the heap is too small for this alignment */
+	PMEMoid oid;
+	int ret = pmemobj_xalloc(pop, &oid, OBJ_SIZE, 0,
+		POBJ_XALLOC_HUGE_ALIGN_1G, NULL, NULL);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERT(pmemobj_alloc_usable_size(oid) >= OBJ_SIZE);
+	UT_ASSERTeq(get_fallbacks(pop), 1);
+	pmemobj_free(&oid);
+
+	/* the objects are found when iterating over the heap */
+	int found = 0;
+	POBJ_FOREACH(pop, oid) {
+		for (int i = 0; i < NOBJS; ++i)
+			found += OID_EQUALS(oid, root->objs[i]);
+		found += OID_EQUALS(oid, root->tx_obj);
+	}
+	UT_ASSERTeq(found, NOBJS + 1);
+}
+
+/*
+ * test_class -- allocates the objects from a huge class with aligned data
+ */
+static void
+test_class(PMEMobjpool *pop, struct root *root)
+{
+	struct pobj_alloc_class_desc desc;
+	desc.header_type = POBJ_HEADER_COMPACT;
+	desc.unit_size = CHUNK_SIZE;
+	desc.units_per_block = 0;
+
+	desc.alignment = 4096;
+	int ret = pmemobj_ctl_set(pop, "heap.alloc_class.new.desc", &desc);
+	UT_ASSERTne(ret, 0);
+	UT_ASSERTeq(errno, EINVAL);
+
+	desc.alignment = ALIGN_2M;
+	desc.header_type = POBJ_HEADER_NONE;
+	ret = pmemobj_ctl_set(pop, "heap.alloc_class.new.desc", &desc);
+	UT_ASSERTne(ret, 0);
+	UT_ASSERTeq(errno, EINVAL);
+
+	desc.header_type = POBJ_HEADER_COMPACT;
+	desc.unit_size = CHUNK_SIZE * 2;
+	ret = pmemobj_ctl_set(pop, "heap.alloc_class.new.desc", &desc);
+	UT_ASSERTne(ret, 0);
+	UT_ASSERTeq(errno, EINVAL);
+
+	desc.unit_size = CHUNK_SIZE;
+	ret = pmemobj_ctl_set(pop, "heap.alloc_class.new.desc", &desc);
+	UT_ASSERTeq(ret, 0);
+
+	char query[64];
+	SNPRINTF(query, sizeof(query), "heap.alloc_class.%u.desc",
+		desc.class_id);
+
+	struct pobj_alloc_class_desc read_desc;
+	ret = pmemobj_ctl_get(pop, query, &read_desc);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(read_desc.unit_size, CHUNK_SIZE);
+	UT_ASSERTeq(read_desc.alignment, ALIGN_2M);
+	UT_ASSERTeq(read_desc.units_per_block, 0);
+	UT_ASSERTeq(read_desc.header_type, POBJ_HEADER_COMPACT);
+
+	/* even small objects of the class are aligned */
+	ret = pmemobj_xalloc(pop, &root->class_obj, 100, 0,
+		POBJ_CLASS_ID(desc.class_id), NULL, NULL);
+	UT_ASSERTeq(ret, 0);
+	check_aligned(pop, root->class_obj, 100);
+}
+
+/*
+ * test_reuse -- checks the objects after reopening the pool and reuses their
+ *	memory for the objects which are not aligned
+ */
+static void
+test_reuse(PMEMobjpool *pop, struct root *root)
+{
+	for (int i = 0; i < NOBJS; ++i) {
+		check_aligned(pop, root->objs[i], OBJ_SIZE);
+		verify(root->objs[i], OBJ_SIZE, i + 1);
+	}
+	check_aligned(pop, root->tx_obj, OBJ_SIZE);
+	verify(root->tx_obj, OBJ_SIZE, NOBJS + 1);
+
+	for (int i = 0; i < NOBJS; ++i)
+		pmemobj_free(&root->objs[i]);
+	pmemobj_free(&root->tx_obj);
+	pmemobj_free(&root->class_obj);
+
+	/* allocate all the memory of the pool using the default class */
+	PMEMoid oids[POOL_SIZE / OBJ_SIZE];
+	int n = 0;
+	while (n < POOL_SIZE / OBJ_SIZE && pmemobj_alloc(pop, &oids[n],
+			OBJ_SIZE, 0, NULL, NULL) == 0) {
+		UT_ASSERT(pmemobj_alloc_usable_size(oids[n]) >= OBJ_SIZE);
+		fill(pop, oids[n], OBJ_SIZE, n);
+		n++;
+	}
+	UT_ASSERT(n > NOBJS + 1);
+
+	for (int i = 0; i < n; ++i) {
+		verify(oids[i], OBJ_SIZE, i);
+		pmemobj_free(&oids[i]);
+	}
+}
+
+/*
+ * test_no_feature -- checks that the aligned allocations are placed without
+ *	the alignment in a pool created without the feature
+ */
+static void
+test_no_feature(const char *path)
+{
+	int huge_align = 0;
+	int ret = pmemobj_ctl_set(NULL, "heap.create.huge_align", &huge_align);
+	UT_ASSERTeq(ret, 0);
+
+	PMEMobjpool *pop = pmemobj_create(path, LAYOUT, POOL_SIZE,
+		S_IWUSR | S_IRUSR);
+	if (pop == NULL)
+		UT_FATAL("!pmemobj_create: %s", path);
+
+	PMEMoid oid;
+	ret = pmemobj_xalloc(pop, &oid, OBJ_SIZE, 0,
+		POBJ_XALLOC_HUGE_ALIGN_2M, NULL, NULL);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERT(pmemobj_alloc_usable_size(oid) >= OBJ_SIZE);
+	UT_ASSERTeq(get_fallbacks(pop), 1);
+	pmemobj_free(&oid);
+
+	pmemobj_close(pop);
+}
+
+int
+main(int argc, char *argv[])
+{
+	START(argc, argv, "obj_huge_align");
+
+	if (argc != 3)
+		UT_FATAL("usage: %s file-name file-name-without-feature",
+			argv[0]);
+
+	const char *path = argv[1];
+
+	int huge_align = 0;
+	int ret = pmemobj_ctl_get(NULL, "heap.create.huge_align", &huge_align);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(huge_align, 0);
+
+	huge_align = 1;
+	ret = pmemobj_ctl_set(NULL, "heap.create.huge_align", &huge_align);
+	UT_ASSERTeq(ret, 0);
+
+	PMEMobjpool *pop = pmemobj_create(path, LAYOUT, POOL_SIZE,
+		S_IWUSR | S_IRUSR);
+	if (pop == NULL)
+		UT_FATAL("!pmemobj_create: %s", path);
+
+	enum pobj_stats_enabled enabled = POBJ_STATS_ENABLED_TRANSIENT;
+	ret = pmemobj_ctl_set(pop, "stats.enabled", &enabled);
+	UT_ASSERTeq(ret, 0);
+
+	struct root *root = pmemobj_direct(pmemobj_root(pop,
+		sizeof(struct root)));
+
+	test_flags(pop, root);
+	test_class(pop, root);
+
+	pmemobj_close(pop);
+
+	ret = pmemobj_check(path, LAYOUT);
+	UT_ASSERTeq(ret, 1);
+
+	pop = pmemobj_open(path, LAYOUT);
+	if (pop == NULL)
+		UT_FATAL("!pmemobj_open: %s", path);
+
+	root = pmemobj_direct(pmemobj_root(pop, sizeof(struct root)));
+	test_reuse(pop, root);
+
+	pmemobj_close(pop);
+
+	test_no_feature(argv[2]);
+
+	DONE(NULL);
+}
@@ -0,0 +1,162 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2026, Intel Corporation */
+
+/*
+ * obj_huge_container.c -- tests for the containers of the free chunks
+ * usage: obj_huge_container <file> <ravl|critnib>
+ */
+
+#include "unittest.h"
+
+#define LAYOUT "obj_huge_container"
+#define POOL_SIZE (128 << 20)
+#define CHUNK_SIZE (256 << 10)
+#define NOBJS 14
+
+/* in chunks, the last one is bigger than the directly indexed sizes */
+static const size_t Sizes[] = {1, 2, 3, 5, 8, 13, 70};
+
+#define NSIZES (sizeof(Sizes) / sizeof(Sizes[0]))
+
+struct root {
+	PMEMoid objs[NOBJS];
+};
+
+/*
+ * obj_size -- returns the size of the n-th object
+ */
+static size_t
+obj_size(int n)
+{
+	return Sizes[(size_t)n % NSIZES] * CHUNK_SIZE - 1024;
+}
+
+/*
+ * alloc_obj -- allocates and fills the n-th object
+ */
+static void
+alloc_obj(PMEMobjpool *pop, struct root *root, int n)
+{
+	int ret = pmemobj_alloc(pop, &root->objs[n], obj_size(n), 0,
+		NULL, NULL);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERT(pmemobj_alloc_usable_size(root->objs[n]) >= obj_size(n));
+
+	pmemobj_memset_persist(pop, pmemobj_direct(root->objs[n]), n + 1,
+		obj_size(n));
+}
+
+/*
+ * verify_objs -- checks the patterns of all the objects
+ */
+static void
+verify_objs(struct root *root)
+{
+	for (int n = 0; n < NOBJS; ++n) {
+		unsigned char *data = pmemobj_direct(root->objs[n]);
+		UT_ASSERTne(data, NULL);
+		for (size_t i = 0; i < obj_size(n); i += 4096)
+			UT_ASSERTeq(data[i], n + 1);
+		UT_ASSERTeq(data[obj_size(n) - 1], n + 1);
+	}
+}
+
+/*
+ * test_ctl -- checks the selected container and the invalid values
+ */
+static void
+test_ctl(enum pobj_huge_container_type expected)
+{
+	enum pobj_huge_container_type type;
+	int ret = pmemobj_ctl_get(NULL, "heap.open.huge_container", &type);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(type, expected);
+
+	type = (enum pobj_huge_container_type)100;
+	ret = pmemobj_ctl_set(NULL, "heap.open.huge_container", &type);
+	UT_ASSERTne(ret, 0);
+	UT_ASSERTeq(errno, EINVAL);
+
+	ret = pmemobj_ctl_get(NULL, "heap.open.huge_container", &type);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(type, expected);
+}
+
+/*
+ * test_alloc_free -- reuses the freed chunks and checks that all the free
+ *	chunks are coalesced back
+ */
+static void
+test_alloc_free(PMEMobjpool *pop, struct root *root)
+{
+	for (int n = 0; n < NOBJS; ++n)
+		alloc_obj(pop, root, n);
+
+	for (int n = 1; n < NOBJS; n += 2)
+		pmemobj_free(&root->objs[n]);
+
+	for (int n = NOBJS - 1; n > 0; n -= 2)
+		alloc_obj(pop, root, n);
+
+	verify_objs(root);
+
+	for (int n = 0; n < NOBJS; ++n)
+		pmemobj_free(&root->objs[n]);
+
+	PMEMoid oid;
+	int ret = pmemobj_alloc(pop, &oid, POOL_SIZE / 4 * 3, 0, NULL, NULL);
+	UT_ASSERTeq(ret, 0);
+	pmemobj_free(&oid);
+
+	for (int n = 0; n < NOBJS; ++n)
+		alloc_obj(pop, root, n);
+}
+
+int
+main(int argc, char *argv[])
+{
+	START(argc, argv, "obj_huge_container");
+
+	if (argc != 3)
+		UT_FATAL("usage: %s file-name ravl|critnib", argv[0]);
+
+	const char *path = argv[1];
+	enum pobj_huge_container_type type;
+	if (strcmp(argv[2], "ravl") == 0)
+		type = POBJ_HUGE_CONTAINER_RAVL;
+	else if (strcmp(argv[2], "critnib") == 0)
+		type = POBJ_HUGE_CONTAINER_CRITNIB;
+	else
+		UT_FATAL("unknown container: %s", argv[2]);
+
+	test_ctl(type);
+
+	PMEMobjpool *pop = pmemobj_create(path, LAYOUT, POOL_SIZE,
+		S_IWUSR | S_IRUSR);
+	if (pop == NULL)
+		UT_FATAL("!pmemobj_create: %s", path);
+
+	struct root *root = pmemobj_direct(pmemobj_root(pop,
+		sizeof(struct root)));
+
+	test_alloc_free(pop, root);
+
+	pmemobj_close(pop);
+
+	int ret = pmemobj_check(path, LAYOUT);
+	UT_ASSERTeq(ret, 1);
+
+	pop = pmemobj_open(path, LAYOUT);
+	if (pop == NULL)
+		UT_FATAL("!pmemobj_open: %s", path);
+
+	root = pmemobj_direct(pmemobj_root(pop, sizeof(struct root)));
+	verify_objs(root);
+
+	for (int n = 0; n < NOBJS; ++n)
+		pmemobj_free(&root->objs[n]);
+
+	pmemobj_close(pop);
+
+	DONE(NULL);
+}
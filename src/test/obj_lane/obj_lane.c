@@ -129,6 +129,10 @@ test_lane_hold_release(void)
 	pop->p.lanes_desc.next_lane_idx = 0;
 
 	pop->p.lanes_desc.lane_locks = CALLOC(OBJ_NLANES, sizeof(uint64_t));
+	pop->p.lanes_desc.lane_waiters = CALLOC(OBJ_NLANES,
+		sizeof(struct lane_waiters));
+	pop->p.lanes_desc.any_waiters.seq = 0;
+	pop->p.lanes_desc.any_waiters.nwaiters = 0;
 	pop->p.lanes_offset = (uint64_t)&pop->l - (uint64_t)&pop->p;
 	pop->p.uuid_lo = 123456;
 	base_ptr = &pop->p;
@@ -159,6 +163,7 @@ test_lane_hold_release(void)
 	SIGACTION(SIGABRT, &old, NULL);
 
 	FREE(pop->p.lanes_desc.lane_locks);
+	FREE(pop->p.lanes_desc.lane_waiters);
 	FREE(pop);
 	operation_delete(ctx);
 	FREE(mock_ulog);
@@ -0,0 +1,166 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2026, Intel Corporation */
+
+/*
+ * obj_lane_policy.c -- tests for the lane selection policies
+ * usage:
+ * obj_lane_policy <file> c - test for lane.policy (RW)
+ *
+ * obj_lane_policy <file> t <policy> - runs concurrent transactions on a pool
+ *	with fewer lanes than threads, with the given policy set through
+ *	the configuration
+ */
+
+#include "unittest.h"
+
+#define LAYOUT "obj_lane_policy"
+#define NTHREADS 8
+#define NOPS 100
+
+struct root {
+	uint64_t counters[NTHREADS];
+};
+
+TOID_DECLARE_ROOT(struct root);
+
+static PMEMobjpool *pop;
+
+/*
+ * get_stat -- reads a statistic
+ */
+static uint64_t
+get_stat(const char *name)
+{
+	uint64_t value;
+	int ret = pmemobj_ctl_get(pop, name, &value);
+	UT_ASSERTeq(ret, 0);
+
+	return value;
+}
+
+/*
+ * test_ctl -- checks the default and the validation of lane.policy
+ */
+static void
+test_ctl(void)
+{
+	enum pobj_lane_policy policy;
+	int ret = pmemobj_ctl_get(NULL, "lane.policy", &policy);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(policy, POBJ_LANE_POLICY_ROUND_ROBIN);
+
+	policy = POBJ_LANE_POLICY_PINNED;
+	ret = pmemobj_ctl_set(NULL, "lane.policy", &policy);
+	UT_ASSERTeq(ret, 0);
+	ret = pmemobj_ctl_get(NULL, "lane.policy", &policy);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(policy, POBJ_LANE_POLICY_PINNED);
+
+	policy = (enum pobj_lane_policy)(POBJ_LANE_POLICY_PINNED + 1);
+	ret = pmemobj_ctl_set(NULL, "lane.policy", &policy);
+	UT_ASSERTne(ret, 0);
+	UT_ASSERTeq(errno, EINVAL);
+
+	ret = pmemobj_ctl_get(NULL, "lane.policy", &policy);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(policy, POBJ_LANE_POLICY_PINNED);
+
+	policy = POBJ_LANE_POLICY_ROUND_ROBIN;
+	ret = pmemobj_ctl_set(NULL, "lane.policy", &policy);
+	UT_ASSERTeq(ret, 0);
+
+	UT_ASSERTeq(get_stat("stats.lanes.spins"), 0);
+	UT_ASSERTeq(get_stat("stats.lanes.waits"), 0);
+	UT_ASSERTeq(get_stat("stats.lanes.wait_time"), 0);
+}
+
+/*
+ * worker -- increments its counter in transactions holding the lane for
+ *	a while
+ */
+static void *
+worker(void *arg)
+{
+	unsigned idx = *(unsigned *)arg;
+	TOID(struct root) root = POBJ_ROOT(pop, struct root);
+
+	for (int i = 0; i < NOPS; ++i) {
+		TX_BEGIN(pop) {
+			TX_ADD_FIELD(root, counters[idx]);
+			D_RW(root)->counters[idx]++;
+			usleep(50);
+		} TX_ONABORT {
+			UT_ASSERT(0);
+		} TX_END
+	}
+
+	return NULL;
+}
+
+/*
+ * test_threads -- runs the workers and checks the results and the contention
+ *	statistics
+ */
+static void
+test_threads(enum pobj_lane_policy expected)
+{
+	enum pobj_lane_policy policy;
+	int ret = pmemobj_ctl_get(NULL, "lane.policy", &policy);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(policy, expected);
+
+	int enabled = 1;
+	ret = pmemobj_ctl_set(pop, "stats.enabled", &enabled);
+	UT_ASSERTeq(ret, 0);
+
+	os_thread_t threads[NTHREADS];
+	unsigned idx[NTHREADS];
+	for (unsigned i = 0; i < NTHREADS; ++i) {
+		idx[i] = i;
+		THREAD_CREATE(&threads[i], NULL, worker, &idx[i]);
+	}
+
+	for (unsigned i = 0; i < NTHREADS; ++i)
+		THREAD_JOIN(&threads[i], NULL);
+
+	TOID(struct root) root = POBJ_ROOT(pop, struct root);
+	for (unsigned i = 0; i < NTHREADS; ++i)
+		UT_ASSERTeq(D_RO(root)->counters[i], NOPS);
+
+	UT_ASSERTne(get_stat("stats.lanes.spins"), 0);
+	UT_ASSERTne(get_stat("stats.lanes.waits"), 0);
+	UT_ASSERTne(get_stat("stats.lanes.wait_time"), 0);
+}
+
+int
+main(int argc, char *argv[])
+{
+	START(argc, argv, "obj_lane_policy");
+
+	if (argc < 3)
+		UT_FATAL("usage: %s file-name c|t [policy]", argv[0]);
+
+	const char *path = argv[1];
+
+	if ((pop = pmemobj_create(path, LAYOUT, PMEMOBJ_MIN_POOL,
+		S_IWUSR | S_IRUSR)) == NULL)
+		UT_FATAL("!pmemobj_create: %s", path);
+
+	switch (argv[2][0]) {
+		case 'c':
+			test_ctl();
+			break;
+		case 't':
+			if (argc != 4)
+				UT_FATAL("usage: %s file-name t policy",
+					argv[0]);
+			test_threads((enum pobj_lane_policy)atoi(argv[3]));
+			break;
+		default:
+			UT_FATAL("unknown test type %c", argv[2][0]);
+	}
+
+	pmemobj_close(pop);
+
+	DONE(NULL);
+}
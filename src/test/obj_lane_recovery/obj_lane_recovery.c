@@ -0,0 +1,173 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2026, Intel Corporation */
+
+/*
+ * obj_lane_recovery.c -- tests for the recovery of many lanes at pool open
+ * usage:
+ * obj_lane_recovery <file> c - crashes with transactions in progress
+ *	on many lanes
+ *
+ * obj_lane_recovery <file> o <nthreads> - checks that all the transactions
+ *	were rolled back, and the recovery statistics
+ */
+
+#include "unittest.h"
+
+#define LAYOUT "obj_lane_recovery"
+#define NTHREADS 16
+#define INIT_VALUE 0xabcdULL
+#define CRASH_VALUE 0xdeadULL
+
+struct root {
+	uint64_t values[NTHREADS];
+};
+
+static PMEMobjpool *pop;
+static PMEMoid root;
+
+static os_mutex_t lock;
+static os_cond_t cond;
+static unsigned nready;
+
+/*
+ * worker_crash -- modifies a value in a transaction that never finishes
+ */
+static void *
+worker_crash(void *arg)
+{
+	uint64_t *value = arg;
+
+	TX_BEGIN(pop) {
+		pmemobj_tx_add_range_direct(value, sizeof(*value));
+		*value = CRASH_VALUE;
+		pmemobj_persist(pop, value, sizeof(*value));
+
+		os_mutex_lock(&lock);
+		nready++;
+		os_cond_broadcast(&cond);
+
+		/* wait for the crash while holding the lane */
+		while (1)
+			os_cond_wait(&cond, &lock);
+	} TX_END
+
+	return NULL;
+}
+
+/*
+ * test_crash -- leaves the pool with an unfinished transaction on each
+ *	of NTHREADS lanes
+ */
+static void
+test_crash(void)
+{
+	struct root *r = pmemobj_direct(root);
+
+	TX_BEGIN(pop) {
+		pmemobj_tx_add_range(root, 0, sizeof(*r));
+		for (unsigned i = 0; i < NTHREADS; ++i)
+			r->values[i] = INIT_VALUE;
+	} TX_END
+
+	os_mutex_init(&lock);
+	os_cond_init(&cond);
+
+	os_thread_t threads[NTHREADS];
+	for (unsigned i = 0; i < NTHREADS; ++i)
+		THREAD_CREATE(&threads[i], NULL, worker_crash,
+			&r->values[i]);
+
+	os_mutex_lock(&lock);
+	while (nready != NTHREADS)
+		os_cond_wait(&cond, &lock);
+
+	exit(0); /* simulate a crash */
+}
+
+/*
+ * test_recovery -- checks the state of the pool after the recovery
+ */
+static void
+test_recovery(unsigned nthreads)
+{
+	unsigned val;
+	int ret = pmemobj_ctl_get(NULL, "lane.recovery.nthreads", &val);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(val, nthreads);
+
+	struct root *r = pmemobj_direct(root);
+	for (unsigned i = 0; i < NTHREADS; ++i)
+		UT_ASSERTeq(r->values[i], INIT_VALUE);
+
+	uint64_t recovered;
+	ret = pmemobj_ctl_get(pop, "stats.lanes.recovered", &recovered);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERT(recovered >= NTHREADS);
+
+	uint64_t total;
+	ret = pmemobj_ctl_get(pop, "stats.lanes.recovery_time", &total);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTne(total, 0);
+
+	uint64_t time;
+	ret = pmemobj_ctl_get(pop, "stats.lanes.0.recovery_time", &time);
+	UT_ASSERTeq(ret, 0);
+	if (nthreads <= 1)
+		UT_ASSERT(time <= total);
+
+	ret = pmemobj_ctl_get(pop, "stats.lanes.1000000.recovery_time", &time);
+	UT_ASSERTne(ret, 0);
+	UT_ASSERTeq(errno, ERANGE);
+
+	/* the recovered lanes are usable */
+	TX_BEGIN(pop) {
+		pmemobj_tx_add_range(root, 0, sizeof(*r));
+		for (unsigned i = 0; i < NTHREADS; ++i)
+			r->values[i] = CRASH_VALUE;
+	} TX_END
+
+	for (unsigned i = 0; i < NTHREADS; ++i)
+		UT_ASSERTeq(r->values[i], CRASH_VALUE);
+}
+
+int
+main(int argc, char *argv[])
+{
+	START(argc, argv, "obj_lane_recovery");
+
+	if (argc < 3)
+		UT_FATAL("usage: %s file-name c|o [nthreads]", argv[0]);
+
+	const char *path = argv[1];
+	char t = argv[2][0];
+
+	switch (t) {
+		case 'c':
+			pop = pmemobj_create(path, LAYOUT, PMEMOBJ_MIN_POOL,
+				S_IWUSR | S_IRUSR);
+			if (pop == NULL)
+				UT_FATAL("!pmemobj_create: %s", path);
+
+			root = pmemobj_root(pop, sizeof(struct root));
+			test_crash();
+			break;
+		case 'o':
+			if (argc != 4)
+				UT_FATAL("usage: %s file-name o nthreads",
+					argv[0]);
+
+			pop = pmemobj_open(path, LAYOUT);
+			if (pop == NULL)
+				UT_FATAL("!pmemobj_open: %s", path);
+
+			root = pmemobj_root(pop, sizeof(struct root));
+			test_recovery(ATOU(argv[3]));
+			break;
+		default:
+			UT_FATAL("unknown test type %c", t);
+	}
+
+	pmemobj_close(pop);
+
+	DONE(NULL);
+}
@@ -304,6 +304,7 @@ FUNC_MOCK(lane_recover_and_section_boot, int, PMEMobjpool *pop)
 	FUNC_MOCK_RUN_DEFAULT {
 		ulog_recover((struct ulog *)&Lane.layout->external,
 			OBJ_OFF_IS_VALID_FROM_CTX, &pop->p_ops);
+		pmemops_drain(&pop->p_ops);
 		return 0;
 	}
 FUNC_MOCK_END
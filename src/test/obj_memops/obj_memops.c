@@ -143,6 +143,47 @@ test_merge_op(struct operation_context *ctx, struct test_object *object)
 	UT_ASSERTeq(object->values[0], 0b01);
 }
 
+/*
+ * test_merge_far -- merges the entries separated by more entries than fit
+ *	in the persistent log
+ */
+static void
+test_merge_far(struct operation_context *ctx, struct test_object *object)
+{
+	operation_start(ctx);
+
+	for (unsigned round = 0; round < 3; ++round) {
+		for (size_t i = 0; i < TEST_VALUES; ++i)
+			operation_add_typed_entry(ctx,
+				&object->values[i], 1ULL << round,
+				ULOG_OPERATION_OR, LOG_PERSISTENT);
+	}
+
+	operation_add_typed_entry(ctx,
+		&object->values[0], 0b001,
+		ULOG_OPERATION_AND, LOG_PERSISTENT);
+
+	operation_add_typed_entry(ctx,
+		&object->values[0], 0b100,
+		ULOG_OPERATION_OR, LOG_PERSISTENT);
+
+	/*
+	 * Only one entry per value, plus the two for the first one - the
+	 * entries of each value are TEST_VALUES apart, which is more than
+	 * any bounded merge window would cover.
+	 */
+	size_t size = (TEST_VALUES + 2) * sizeof(struct ulog_entry_val);
+	UT_ASSERTeq(operation_get_persistent_size(ctx), size);
+	UT_ASSERTeq(operation_reserve(ctx, size), 0);
+
+	operation_process(ctx);
+	operation_finish(ctx, 0);
+
+	UT_ASSERTeq(object->values[0], 0b101);
+	for (size_t i = 1; i < TEST_VALUES; ++i)
+		UT_ASSERTeq(object->values[i], 0b111);
+}
+
 static void
 test_same_twice(struct operation_context *ctx, struct test_object *object)
 {
@@ -181,6 +222,8 @@ test_redo(PMEMobjpool *pop, struct test_object *object)
 	clear_test_values(object);
 	test_merge_op(ctx, object);
 	clear_test_values(object);
+	test_merge_far(ctx, object);
+	clear_test_values(object);
 	test_set_entries(pop, ctx, object, 100, FAIL_NONE, LOG_PERSISTENT);
 	clear_test_values(object);
 	test_set_entries(pop, ctx, object, 100, FAIL_CHECKSUM, LOG_PERSISTENT);
@@ -79,6 +79,15 @@ main(int argc, char *argv[])
 		UT_ASSERTeq(pmemobj_pool_by_oid(oids[i]), pops[i]);
 	}
 
+	/* alternate between the pools, possibly more than are cached */
+	for (unsigned r = 0; r < 3; ++r) {
+		for (unsigned i = 0; i < npools; ++i) {
+			UT_ASSERTeq(pmemobj_pool_by_oid(oids[i]), pops[i]);
+			void *ptr = pmemobj_direct(oids[i]);
+			UT_ASSERTeq(pmemobj_pool_by_ptr(ptr), pops[i]);
+		}
+	}
+
 	UT_ASSERTeq(pmemobj_pool_by_ptr(NULL), NULL);
 	UT_ASSERTeq(pmemobj_pool_by_ptr((void *)0xCBA), NULL);
 
@@ -0,0 +1,205 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2026, Intel Corporation */
+
+/*
+ * obj_publish_queue.c -- tests for the batched publication of actions
+ * usage: obj_publish_queue <file>
+ */
+
+#include "unittest.h"
+
+#define LAYOUT "obj_publish_queue"
+#define NTHREADS 8
+#define NOPS 200
+#define OBJ_SIZE 64
+
+struct root {
+	PMEMoid objs[NTHREADS][NOPS];
+	uint64_t counters[NTHREADS];
+};
+
+struct worker_args {
+	PMEMobjpool *pop;
+	struct root *root;
+	unsigned idx;
+};
+
+/*
+ * test_ctl -- checks the defaults and the invalid values of the publish
+ *	queue parameters
+ */
+static void
+test_ctl(PMEMobjpool *pop)
+{
+	uint64_t max_actions;
+	uint64_t max_wait;
+
+	int ret = pmemobj_ctl_get(pop, "heap.publish_queue.max_actions",
+		&max_actions);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(max_actions, 1024);
+
+	ret = pmemobj_ctl_get(pop, "heap.publish_queue.max_wait", &max_wait);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(max_wait, 50);
+
+	ssize_t val = 0;
+	ret = pmemobj_ctl_set(pop, "heap.publish_queue.max_actions", &val);
+	UT_ASSERTne(ret, 0);
+	UT_ASSERTeq(errno, EINVAL);
+
+	val = 2000000;
+	ret = pmemobj_ctl_set(pop, "heap.publish_queue.max_wait", &val);
+	UT_ASSERTne(ret, 0);
+	UT_ASSERTeq(errno, EINVAL);
+
+	val = 64;
+	ret = pmemobj_ctl_set(pop, "heap.publish_queue.max_actions", &val);
+	UT_ASSERTeq(ret, 0);
+
+	val = 1000;
+	ret = pmemobj_ctl_set(pop, "heap.publish_queue.max_wait", &val);
+	UT_ASSERTeq(ret, 0);
+
+	ret = pmemobj_ctl_get(pop, "heap.publish_queue.max_actions",
+		&max_actions);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(max_actions, 64);
+
+	ret = pmemobj_ctl_get(pop, "heap.publish_queue.max_wait", &max_wait);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(max_wait, 1000);
+}
+
+/*
+ * worker -- reserves the objects of the thread and publishes each of them
+ *	together with the update of the thread's counter
+ */
+static void *
+worker(void *arg)
+{
+	struct worker_args *a = arg;
+	struct root *root = a->root;
+
+	for (unsigned i = 0; i < NOPS; ++i) {
+		struct pobj_action act[3];
+
+		PMEMoid oid = pmemobj_reserve(a->pop, &act[0], OBJ_SIZE, 0);
+		UT_ASSERT(!OID_IS_NULL(oid));
+
+		uint64_t *data = pmemobj_direct(oid);
+		data[0] = a->idx;
+		data[1] = i;
+		pmemobj_persist(a->pop, data, 2 * sizeof(uint64_t));
+
+		pmemobj_set_value(a->pop, &act[1],
+			&root->objs[a->idx][i].pool_uuid_lo,
+			oid.pool_uuid_lo);
+		pmemobj_set_value(a->pop, &act[2], &root->objs[a->idx][i].off,
+			oid.off);
+
+		int ret = pmemobj_publish_queued(a->pop, act, 3);
+		UT_ASSERTeq(ret, 0);
+
+		root->counters[a->idx]++;
+		pmemobj_persist(a->pop, &root->counters[a->idx],
+			sizeof(root->counters[a->idx]));
+	}
+
+	return NULL;
+}
+
+/*
+ * verify_objs -- checks that all the published objects are in place
+ */
+static void
+verify_objs(struct root *root)
+{
+	for (unsigned t = 0; t < NTHREADS; ++t) {
+		UT_ASSERTeq(root->counters[t], NOPS);
+		for (unsigned i = 0; i < NOPS; ++i) {
+			uint64_t *data = pmemobj_direct(root->objs[t][i]);
+			UT_ASSERTne(data, NULL);
+			UT_ASSERTeq(data[0], t);
+			UT_ASSERTeq(data[1], i);
+		}
+	}
+}
+
+/*
+ * test_publish -- publishes the actions from many threads and checks
+ *	the statistics of the batches
+ */
+static void
+test_publish(PMEMobjpool *pop, struct root *root)
+{
+	int enabled = 1;
+	int ret = pmemobj_ctl_set(pop, "stats.enabled", &enabled);
+	UT_ASSERTeq(ret, 0);
+
+	os_thread_t threads[NTHREADS];
+	struct worker_args args[NTHREADS];
+
+	for (unsigned t = 0; t < NTHREADS; ++t) {
+		args[t].pop = pop;
+		args[t].root = root;
+		args[t].idx = t;
+		THREAD_CREATE(&threads[t], NULL, worker, &args[t]);
+	}
+
+	for (unsigned t = 0; t < NTHREADS; ++t)
+		THREAD_JOIN(&threads[t], NULL);
+
+	uint64_t batches;
+	ret = pmemobj_ctl_get(pop, "stats.heap.publish_batches", &batches);
+	UT_ASSERTeq(ret, 0);
+
+	uint64_t actions;
+	ret = pmemobj_ctl_get(pop, "stats.heap.publish_batched_actions",
+		&actions);
+	UT_ASSERTeq(ret, 0);
+
+	UT_ASSERTne(batches, 0);
+	UT_ASSERT(batches <= NTHREADS * NOPS);
+	UT_ASSERTeq(actions, NTHREADS * NOPS * 3);
+
+	verify_objs(root);
+}
+
+int
+main(int argc, char *argv[])
+{
+	START(argc, argv, "obj_publish_queue");
+
+	if (argc != 2)
+		UT_FATAL("usage: %s file-name", argv[0]);
+
+	const char *path = argv[1];
+
+	PMEMobjpool *pop = pmemobj_create(path, LAYOUT, PMEMOBJ_MIN_POOL * 4,
+		S_IWUSR | S_IRUSR);
+	if (pop == NULL)
+		UT_FATAL("!pmemobj_create: %s", path);
+
+	struct root *root = pmemobj_direct(pmemobj_root(pop,
+		sizeof(struct root)));
+
+	test_ctl(pop);
+	test_publish(pop, root);
+
+	pmemobj_close(pop);
+
+	int ret = pmemobj_check(path, LAYOUT);
+	UT_ASSERTeq(ret, 1);
+
+	pop = pmemobj_open(path, LAYOUT);
+	if (pop == NULL)
+		UT_FATAL("!pmemobj_open: %s", path);
+
+	root = pmemobj_direct(pmemobj_root(pop, sizeof(struct root)));
+	verify_objs(root);
+
+	pmemobj_close(pop);
+
+	DONE(NULL);
+}
@@ -0,0 +1,237 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2026, Intel Corporation */
+
+/*
+ * obj_replica_async.c -- tests for the asynchronous replication
+ * usage:
+ * obj_replica_async <file> c - test for replica.async.* (RW)
+ *
+ * obj_replica_async <file> w - mt test for writes to a replicated pool,
+ *	the replicas are compared after the drain, while the pool is still
+ *	open, and by the test script after the pool is closed
+ */
+
+#include "unittest.h"
+#include "heap.h"
+#include "heap_layout.h"
+#include "lane.h"
+#include "obj.h"
+
+#define LAYOUT "obj_replica_async"
+#define NTHREADS 8
+#define NOBJECTS 128
+#define OBJ_SIZE 512
+
+static PMEMobjpool *pop;
+
+/*
+ * test_ctl -- checks the defaults and the validation of the ctl entries
+ */
+static void
+test_ctl(void)
+{
+	int enabled;
+	int ret = pmemobj_ctl_get(NULL, "replica.async.enabled", &enabled);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(enabled, 0);
+
+	ssize_t max_lag;
+	ret = pmemobj_ctl_get(NULL, "replica.async.max_lag", &max_lag);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(max_lag, 1 << 26);
+
+	max_lag = 0;
+	ret = pmemobj_ctl_set(NULL, "replica.async.max_lag", &max_lag);
+	UT_ASSERTne(ret, 0);
+	UT_ASSERTeq(errno, EINVAL);
+
+	max_lag = 4096;
+	ret = pmemobj_ctl_set(NULL, "replica.async.max_lag", &max_lag);
+	UT_ASSERTeq(ret, 0);
+	ret = pmemobj_ctl_get(NULL, "replica.async.max_lag", &max_lag);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(max_lag, 4096);
+
+	enabled = 1;
+	ret = pmemobj_ctl_set(NULL, "replica.async.enabled", &enabled);
+	UT_ASSERTeq(ret, 0);
+	ret = pmemobj_ctl_get(NULL, "replica.async.enabled", &enabled);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(enabled, 1);
+}
+
+/*
+ * worker_write -- allocates and modifies objects in transactions
+ */
+static void *
+worker_write(void *arg)
+{
+	unsigned char c = (unsigned char)(uintptr_t)arg;
+
+	PMEMoid oids[NOBJECTS];
+	for (unsigned i = 0; i < NOBJECTS; ++i) {
+		TX_BEGIN(pop) {
+			oids[i] = pmemobj_tx_alloc(OBJ_SIZE, 0);
+			pmemobj_memset(pop, pmemobj_direct(oids[i]), c,
+				OBJ_SIZE, 0);
+		} TX_ONABORT {
+			UT_ASSERT(0);
+		} TX_END
+	}
+
+	/* free every other object, and overwrite the rest */
+	for (unsigned i = 0; i < NOBJECTS; ++i) {
+		if (i % 2 == 0) {
+			pmemobj_free(&oids[i]);
+			continue;
+		}
+
+		TX_BEGIN(pop) {
+			pmemobj_tx_add_range(oids[i], 0, OBJ_SIZE);
+			memset(pmemobj_direct(oids[i]), ~c, OBJ_SIZE);
+		} TX_ONABORT {
+			UT_ASSERT(0);
+		} TX_END
+	}
+
+	return NULL;
+}
+
+/*
+ * compare_range -- checks that the given range of the replica matches
+ *	the master replica
+ */
+static void
+compare_range(PMEMobjpool *rep, unsigned repn, size_t off, size_t len)
+{
+	const char *master = (char *)pop + off;
+	const char *replica = (char *)rep + off;
+
+	for (size_t i = 0; i < len; ++i) {
+		if (master[i] != replica[i])
+			UT_FATAL("replica %u differs at offset %zu", repn,
+				off + i);
+	}
+}
+
+/*
+ * compare_ptr -- checks that the given object of the master replica matches
+ *	the replica
+ */
+static void
+compare_ptr(PMEMobjpool *rep, unsigned repn, const void *ptr, size_t len)
+{
+	compare_range(rep, repn, (size_t)((char *)ptr - (char *)pop), len);
+}
+
+/*
+ * compare_replicas -- checks that the lanes and the heap of every replica
+ *	match the master replica, except for the chunk footers and the contents
+ *	of the free chunks, which are not persistent
+ */
+static void
+compare_replicas(void)
+{
+	struct palloc_heap *heap = &pop->heap;
+	struct heap_layout *layout = heap->layout;
+	unsigned nzones = heap_get_nzones(heap);
+
+	unsigned repn = 0;
+	for (PMEMobjpool *rep = pop->replica; rep != NULL; rep = rep->replica) {
+		repn++;
+
+		compare_range(rep, repn, pop->lanes_offset,
+			pop->nlanes * sizeof(struct lane_layout));
+		compare_ptr(rep, repn, &layout->header, sizeof(layout->header));
+
+		for (unsigned z = 0; z < nzones; ++z) {
+			struct zone *zone = ZID_TO_ZONE(layout, z);
+			compare_ptr(rep, repn, &zone->header,
+				sizeof(zone->header));
+
+			for (uint32_t c = 0; c < zone->header.size_idx; ++c) {
+				struct chunk_header *hdr =
+					&zone->chunk_headers[c];
+				if (hdr->type != CHUNK_TYPE_FOOTER)
+					compare_ptr(rep, repn, hdr,
+						sizeof(*hdr));
+			}
+
+			for (uint32_t c = 0; c < zone->header.size_idx; ) {
+				struct chunk_header *hdr =
+					&zone->chunk_headers[c];
+				UT_ASSERTne(hdr->size_idx, 0);
+
+				if (hdr->type != CHUNK_TYPE_FREE)
+					compare_ptr(rep, repn,
+						&zone->chunks[c],
+						hdr->size_idx * CHUNKSIZE);
+
+				c += hdr->size_idx;
+			}
+		}
+	}
+
+	UT_ASSERTne(repn, 0);
+}
+
+/*
+ * test_write -- writes to a replicated pool from many threads
+ */
+static void
+test_write(void)
+{
+	os_thread_t threads[NTHREADS];
+	for (unsigned i = 0; i < NTHREADS; ++i)
+		THREAD_CREATE(&threads[i], NULL, worker_write,
+			(void *)(uintptr_t)(i + 1));
+
+	for (unsigned i = 0; i < NTHREADS; ++i)
+		THREAD_JOIN(&threads[i], NULL);
+
+	int ret = pmemobj_replica_sync(pop);
+	UT_ASSERTeq(ret, 0);
+
+	/* everything written so far must already be in the replicas */
+	compare_replicas();
+
+	unsigned n = 0;
+	PMEMoid oid;
+	POBJ_FOREACH(pop, oid)
+		n++;
+	UT_ASSERTeq(n, NTHREADS * NOBJECTS / 2);
+}
+
+int
+main(int argc, char *argv[])
+{
+	START(argc, argv, "obj_replica_async");
+
+	if (argc != 3)
+		UT_FATAL("usage: %s file-name c|w", argv[0]);
+
+	const char *path = argv[1];
+	char t = argv[2][0];
+
+	if (t == 'c')
+		test_ctl();
+
+	if ((pop = pmemobj_create(path, LAYOUT, 0, S_IWUSR | S_IRUSR)) == NULL)
+		UT_FATAL("!pmemobj_create: %s", path);
+
+	switch (t) {
+		case 'c':
+			/* a no-op for a pool without replicas */
+			UT_ASSERTeq(pmemobj_replica_sync(pop), 0);
+			break;
+		case 'w':
+			test_write();
+			break;
+		default:
+			UT_FATAL("unknown test type %c", t);
+	}
+
+	pmemobj_close(pop);
+
+	DONE(NULL);
+}
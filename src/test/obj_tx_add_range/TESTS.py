@@ -46,3 +46,15 @@ class TEST3(t.Test):
     def run(self, ctx):
         testfile = path.join(ctx.testdir, 'testfile3')
         ctx.exec('obj_tx_add_range', testfile, '0')
+
+
+@t.require_valgrind_disabled('memcheck', 'pmemcheck')
+class TEST4(t.Test):
+    test_type = t.Medium
+
+    def run(self, ctx):
+        # track the ranges in the range map from the first range onwards
+        ctx.env['PMEMOBJ_CONF'] = 'tx.ranges.map_threshold=1'
+
+        testfile = path.join(ctx.testdir, 'testfile4')
+        ctx.exec('obj_tx_add_range', testfile, '0')
@@ -886,6 +886,77 @@ do_tx_add_range_overlapping(PMEMobjpool *pop)
 	UT_ASSERT(util_is_zeroed(D_RO(obj)->data, OVERLAP_SIZE));
 }
 
+/* ranges shorter and longer than a cache line, overlapping each other */
+static const struct {
+	size_t off;
+	size_t size;
+} Line_ranges[] = {
+	{10, 8}, {60, 8}, {0, 64}, {200, 300}, {100, 200}, {150, 4},
+	{498, 10}, {1000, 24}, {0, OBJ_SIZE},
+};
+
+/*
+ * do_tx_add_range_lines -- call pmemobj_tx_add_range with ranges shorter and
+ * longer than a cache line
+ */
+static void
+do_tx_add_range_lines(PMEMobjpool *pop)
+{
+	TOID(struct object) obj;
+	TOID_ASSIGN(obj, do_tx_zalloc(pop, TYPE_OBJ));
+	uint8_t *data = pmemobj_direct(obj.oid);
+	uint8_t expected[OBJ_SIZE] = {0};
+	size_t n = ARRAY_SIZE(Line_ranges);
+
+	TX_BEGIN(pop) {
+		for (size_t i = 0; i < n; ++i) {
+			pmemobj_tx_add_range(obj.oid, Line_ranges[i].off,
+				Line_ranges[i].size);
+			memset(data + Line_ranges[i].off, (int)i + 1,
+				Line_ranges[i].size);
+		}
+
+		pmemobj_tx_abort(-1);
+	} TX_ONCOMMIT {
+		UT_ASSERT(0);
+	} TX_END
+
+	UT_ASSERT(util_is_zeroed(data, OBJ_SIZE));
+
+	/* all but the range covering the whole object */
+	TX_BEGIN(pop) {
+		for (size_t i = 0; i < n - 1; ++i) {
+			pmemobj_tx_add_range(obj.oid, Line_ranges[i].off,
+				Line_ranges[i].size);
+			memset(data + Line_ranges[i].off, (int)i + 1,
+				Line_ranges[i].size);
+			memset(expected + Line_ranges[i].off, (int)i + 1,
+				Line_ranges[i].size);
+		}
+	} TX_ONABORT {
+		UT_ASSERT(0);
+	} TX_END
+
+	UT_ASSERTeq(memcmp(data, expected, OBJ_SIZE), 0);
+
+	TOID(struct object) obj2;
+	TX_BEGIN(pop) {
+		pmemobj_tx_add_range(obj.oid, 0, OBJ_SIZE);
+		memset(data, 0, OBJ_SIZE);
+
+		/* the range of an object allocated and freed in the tx */
+		TOID_ASSIGN(obj2, do_tx_zalloc(pop, TYPE_OBJ));
+		pmemobj_tx_add_range(obj2.oid, 8, 16);
+		TX_FREE(obj2);
+
+		pmemobj_tx_abort(-1);
+	} TX_ONCOMMIT {
+		UT_ASSERT(0);
+	} TX_END
+
+	UT_ASSERTeq(memcmp(data, expected, OBJ_SIZE), 0);
+}
+
 /*
  * do_tx_add_range_flag_merge_right -- call pmemobj_tx_add_range with
  * overlapping ranges, but different flags
@@ -1115,6 +1186,8 @@ main(int argc, char *argv[])
 		VALGRIND_WRITE_STATS;
 		do_tx_add_range_overlapping(pop);
 		VALGRIND_WRITE_STATS;
+		do_tx_add_range_lines(pop);
+		VALGRIND_WRITE_STATS;
 		do_tx_add_range_too_large(pop);
 		VALGRIND_WRITE_STATS;
 		do_tx_add_huge_range_abort(pop);
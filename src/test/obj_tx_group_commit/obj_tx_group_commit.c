@@ -0,0 +1,224 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2026, Intel Corporation */
+
+/*
+ * obj_tx_group_commit.c -- tests for committing transactions in the group mode
+ * usage:
+ * obj_tx_group_commit <file> c - test for tx.group_commit.* (RW)
+ *
+ * obj_tx_group_commit <file> t - runs concurrent transactions, some of which
+ *	allocate or abort, in the group mode
+ *
+ * obj_tx_group_commit <file> o - checks the pool written by the 't' test
+ *	after reopening it
+ */
+
+#include "unittest.h"
+
+#define LAYOUT "obj_tx_group_commit"
+#define NTHREADS 8
+#define NOPS 200
+
+struct root {
+	uint64_t counters[NTHREADS];
+	PMEMoid objs[NTHREADS];
+};
+
+TOID_DECLARE_ROOT(struct root);
+
+static PMEMobjpool *pop;
+
+/*
+ * get_stat -- reads a statistic
+ */
+static uint64_t
+get_stat(const char *name)
+{
+	uint64_t value;
+	int ret = pmemobj_ctl_get(pop, name, &value);
+	UT_ASSERTeq(ret, 0);
+
+	return value;
+}
+
+/*
+ * test_ctl -- checks the defaults and the validation of the ctl entries
+ */
+static void
+test_ctl(void)
+{
+	int enabled;
+	int ret = pmemobj_ctl_get(pop, "tx.group_commit.enabled", &enabled);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(enabled, 0);
+
+	ssize_t max_wait;
+	ret = pmemobj_ctl_get(pop, "tx.group_commit.max_wait", &max_wait);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(max_wait, 50);
+
+	max_wait = -1;
+	ret = pmemobj_ctl_set(pop, "tx.group_commit.max_wait", &max_wait);
+	UT_ASSERTne(ret, 0);
+	UT_ASSERTeq(errno, EINVAL);
+
+	max_wait = 1000001;
+	ret = pmemobj_ctl_set(pop, "tx.group_commit.max_wait", &max_wait);
+	UT_ASSERTne(ret, 0);
+	UT_ASSERTeq(errno, EINVAL);
+
+	max_wait = 0;
+	ret = pmemobj_ctl_set(pop, "tx.group_commit.max_wait", &max_wait);
+	UT_ASSERTeq(ret, 0);
+	ret = pmemobj_ctl_get(pop, "tx.group_commit.max_wait", &max_wait);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(max_wait, 0);
+
+	enabled = 1;
+	ret = pmemobj_ctl_set(pop, "tx.group_commit.enabled", &enabled);
+	UT_ASSERTeq(ret, 0);
+	ret = pmemobj_ctl_get(pop, "tx.group_commit.enabled", &enabled);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(enabled, 1);
+
+	UT_ASSERTeq(get_stat("stats.tx.group_commits"), 0);
+	UT_ASSERTeq(get_stat("stats.tx.group_commit_drains"), 0);
+}
+
+/*
+ * worker -- increments its counter, periodically reallocating its object
+ *	and aborting a transaction
+ */
+static void *
+worker(void *arg)
+{
+	unsigned idx = *(unsigned *)arg;
+	TOID(struct root) root = POBJ_ROOT(pop, struct root);
+
+	for (int i = 0; i < NOPS; ++i) {
+		TX_BEGIN(pop) {
+			TX_ADD_FIELD(root, counters[idx]);
+			D_RW(root)->counters[idx]++;
+
+			if (i % 10 == 0) {
+				TX_ADD_FIELD(root, objs[idx]);
+				pmemobj_tx_free(D_RO(root)->objs[idx]);
+				D_RW(root)->objs[idx] = pmemobj_tx_zalloc(
+					sizeof(uint64_t) * (size_t)(i + 1), 0);
+			}
+
+			if (i % 17 == 0)
+				pmemobj_tx_abort(ECANCELED);
+		} TX_END
+	}
+
+	return NULL;
+}
+
+/*
+ * expected_count -- returns the number of committed increments
+ */
+static uint64_t
+expected_count(void)
+{
+	uint64_t n = 0;
+	for (int i = 0; i < NOPS; ++i)
+		n += i % 17 != 0;
+
+	return n;
+}
+
+/*
+ * check_root -- verifies the counters and the objects
+ */
+static void
+check_root(void)
+{
+	TOID(struct root) root = POBJ_ROOT(pop, struct root);
+	for (unsigned i = 0; i < NTHREADS; ++i) {
+		UT_ASSERTeq(D_RO(root)->counters[i], expected_count());
+
+		PMEMoid obj = D_RO(root)->objs[i];
+		UT_ASSERT(!OID_IS_NULL(obj));
+		UT_ASSERTeq(pmemobj_alloc_usable_size(obj) >=
+			sizeof(uint64_t) * 191, 1);
+	}
+}
+
+/*
+ * test_threads -- runs the workers in the group mode and checks the results
+ */
+static void
+test_threads(void)
+{
+	int enabled = 1;
+	int ret = pmemobj_ctl_set(pop, "stats.enabled", &enabled);
+	UT_ASSERTeq(ret, 0);
+	ret = pmemobj_ctl_set(pop, "tx.group_commit.enabled", &enabled);
+	UT_ASSERTeq(ret, 0);
+
+	os_thread_t threads[NTHREADS];
+	unsigned idx[NTHREADS];
+	for (unsigned i = 0; i < NTHREADS; ++i) {
+		idx[i] = i;
+		THREAD_CREATE(&threads[i], NULL, worker, &idx[i]);
+	}
+
+	for (unsigned i = 0; i < NTHREADS; ++i)
+		THREAD_JOIN(&threads[i], NULL);
+
+	check_root();
+
+	uint64_t commits = get_stat("stats.tx.group_commits");
+	uint64_t drains = get_stat("stats.tx.group_commit_drains");
+
+	/* the transactions with allocations persist only the ranges */
+	UT_ASSERT(commits >= NTHREADS * expected_count());
+	UT_ASSERTne(drains, 0);
+	UT_ASSERT(drains <= commits);
+}
+
+int
+main(int argc, char *argv[])
+{
+	START(argc, argv, "obj_tx_group_commit");
+
+	if (argc != 3)
+		UT_FATAL("usage: %s file-name c|t|o", argv[0]);
+
+	const char *path = argv[1];
+	char t = argv[2][0];
+
+	if (t == 'o') {
+		int ret = pmemobj_check(path, LAYOUT);
+		UT_ASSERTeq(ret, 1);
+
+		pop = pmemobj_open(path, LAYOUT);
+		if (pop == NULL)
+			UT_FATAL("!pmemobj_open: %s", path);
+
+		check_root();
+		pmemobj_close(pop);
+
+		DONE(NULL);
+	}
+
+	if ((pop = pmemobj_create(path, LAYOUT, PMEMOBJ_MIN_POOL,
+		S_IWUSR | S_IRUSR)) == NULL)
+		UT_FATAL("!pmemobj_create: %s", path);
+
+	switch (t) {
+		case 'c':
+			test_ctl();
+			break;
+		case 't':
+			test_threads();
+			break;
+		default:
+			UT_FATAL("unknown test type %c", t);
+	}
+
+	pmemobj_close(pop);
+
+	DONE(NULL);
+}
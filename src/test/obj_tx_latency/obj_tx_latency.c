@@ -0,0 +1,155 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2026, Intel Corporation */
+
+/*
+ * obj_tx_latency.c -- tests for the latency histograms of transaction phases
+ * usage: obj_tx_latency <file>
+ */
+
+#include "unittest.h"
+
+#define LAYOUT "obj_tx_latency"
+#define NOPS 100
+
+struct root {
+	uint64_t value;
+	PMEMoid obj;
+};
+
+TOID_DECLARE_ROOT(struct root);
+
+static const char *phases[] = {
+	"begin",
+	"add_range",
+	"alloc",
+	"commit_flush",
+	"commit_drain",
+	"redo_apply",
+	"end",
+};
+
+/*
+ * get_latency -- reads the latencies of the transaction phase
+ */
+static void
+get_latency(PMEMobjpool *pop, const char *phase, struct pobj_tx_latency *l)
+{
+	char name[64];
+	SNPRINTF(name, sizeof(name), "stats.tx.latency.%s", phase);
+
+	int ret = pmemobj_ctl_get(pop, name, l);
+	UT_ASSERTeq(ret, 0);
+}
+
+/*
+ * run_txs -- runs transactions which snapshot, allocate and abort
+ */
+static void
+run_txs(PMEMobjpool *pop)
+{
+	TOID(struct root) root = POBJ_ROOT(pop, struct root);
+
+	for (int i = 0; i < NOPS; ++i) {
+		TX_BEGIN(pop) {
+			TX_ADD_FIELD(root, value);
+			D_RW(root)->value++;
+			if (i % 2 == 0) {
+				TX_ADD_FIELD(root, obj);
+				pmemobj_tx_free(D_RO(root)->obj);
+				D_RW(root)->obj = pmemobj_tx_alloc(64, 0);
+			}
+			if (i % 10 == 0)
+				pmemobj_tx_abort(ECANCELED);
+		} TX_END
+	}
+}
+
+/*
+ * check_phases -- checks the consistency of the latencies of all the phases
+ */
+static void
+check_phases(PMEMobjpool *pop, int expect_empty)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(phases); ++i) {
+		struct pobj_tx_latency l;
+		get_latency(pop, phases[i], &l);
+
+		if (expect_empty) {
+			UT_ASSERTeq(l.count, 0);
+			UT_ASSERTeq(l.total, 0);
+			UT_ASSERTeq(l.max, 0);
+			UT_ASSERTeq(l.p999, 0);
+			continue;
+		}
+
+		UT_ASSERTne(l.count, 0);
+		UT_ASSERT(l.min <= l.max);
+		UT_ASSERT(l.total >= l.max);
+		UT_ASSERT(l.p50 <= l.p90);
+		UT_ASSERT(l.p90 <= l.p99);
+		UT_ASSERT(l.p99 <= l.p999);
+		UT_ASSERT(l.p999 <= l.max);
+	}
+
+	if (expect_empty)
+		return;
+
+	struct pobj_tx_latency begin;
+	get_latency(pop, "begin", &begin);
+	UT_ASSERTeq(begin.count, NOPS);
+
+	/* aborted transactions don't commit */
+	struct pobj_tx_latency flush;
+	get_latency(pop, "commit_flush", &flush);
+	UT_ASSERTeq(flush.count, NOPS - NOPS / 10);
+}
+
+int
+main(int argc, char *argv[])
+{
+	START(argc, argv, "obj_tx_latency");
+
+	if (argc != 2)
+		UT_FATAL("usage: %s file-name", argv[0]);
+
+	const char *path = argv[1];
+	PMEMobjpool *pop = pmemobj_create(path, LAYOUT, PMEMOBJ_MIN_POOL,
+		S_IWUSR | S_IRUSR);
+	if (pop == NULL)
+		UT_FATAL("!pmemobj_create: %s", path);
+
+	int enabled;
+	int ret = pmemobj_ctl_get(pop, "stats.tx.latency.enabled", &enabled);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(enabled, 0);
+
+	/* nothing is recorded by default */
+	run_txs(pop);
+	check_phases(pop, 1);
+
+	enabled = 1;
+	ret = pmemobj_ctl_set(pop, "stats.tx.latency.enabled", &enabled);
+	UT_ASSERTeq(ret, 0);
+	ret = pmemobj_ctl_get(pop, "stats.tx.latency.enabled", &enabled);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(enabled, 1);
+
+	run_txs(pop);
+	check_phases(pop, 0);
+
+	ret = pmemobj_ctl_exec(pop, "stats.tx.latency.reset", NULL);
+	UT_ASSERTeq(ret, 0);
+	check_phases(pop, 1);
+
+	/* the histograms depend on the transient statistics */
+	enum pobj_stats_enabled stats = POBJ_STATS_DISABLED;
+	ret = pmemobj_ctl_set(pop, "stats.enabled", &stats);
+	UT_ASSERTeq(ret, 0);
+
+	run_txs(pop);
+	check_phases(pop, 1);
+
+	pmemobj_close(pop);
+
+	DONE(NULL);
+}
@@ -0,0 +1,230 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2026, Intel Corporation */
+
+/*
+ * obj_tx_undo_retain.c -- tests for retaining the undo log extensions
+ *	between transactions
+ * usage:
+ * obj_tx_undo_retain <file> c - test for tx.undo.* (RW)
+ *
+ * obj_tx_undo_retain <file> r - test for the retained extensions being reused
+ *	and freed once the retention is disabled
+ *
+ * obj_tx_undo_retain <file> o - test for reopening a pool with retained
+ *	extensions
+ */
+
+#include "unittest.h"
+
+#define LAYOUT "obj_tx_undo_retain"
+#define OBJ_SIZE (256 * 1024)
+#define NTX 64
+#define RETAIN_SIZE (1 << 20)
+
+static PMEMobjpool *pop;
+static PMEMoid obj;
+
+/*
+ * set_retain_size -- sets the tx.undo.retain_size entry point
+ */
+static void
+set_retain_size(ssize_t size)
+{
+	int ret = pmemobj_ctl_set(pop, "tx.undo.retain_size", &size);
+	UT_ASSERTeq(ret, 0);
+}
+
+/*
+ * get_stat -- reads a statistic
+ */
+static size_t
+get_stat(const char *name)
+{
+	size_t value;
+	int ret = pmemobj_ctl_get(pop, name, &value);
+	UT_ASSERTeq(ret, 0);
+
+	return value;
+}
+
+/*
+ * do_tx -- snapshots and overwrites the whole object, optionally aborting
+ */
+static void
+do_tx(int c, int abort)
+{
+	TX_BEGIN(pop) {
+		pmemobj_tx_add_range(obj, 0, OBJ_SIZE);
+		memset(pmemobj_direct(obj), c, OBJ_SIZE);
+		if (abort)
+			pmemobj_tx_abort(ECANCELED);
+	} TX_END
+}
+
+/*
+ * check_obj -- verifies the contents of the object
+ */
+static void
+check_obj(int c)
+{
+	unsigned char *data = pmemobj_direct(obj);
+	for (size_t i = 0; i < OBJ_SIZE; ++i)
+		UT_ASSERTeq(data[i], (unsigned char)c);
+}
+
+/*
+ * test_ctl -- checks the defaults and the validation of the ctl entries
+ */
+static void
+test_ctl(void)
+{
+	ssize_t size;
+	int ret = pmemobj_ctl_get(pop, "tx.undo.retain_size", &size);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(size, 0);
+
+	int percentile;
+	ret = pmemobj_ctl_get(pop, "tx.undo.retain_percentile", &percentile);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(percentile, 99);
+
+	size = -1;
+	ret = pmemobj_ctl_set(pop, "tx.undo.retain_size", &size);
+	UT_ASSERTne(ret, 0);
+	UT_ASSERTeq(errno, EINVAL);
+
+	size = RETAIN_SIZE;
+	ret = pmemobj_ctl_set(pop, "tx.undo.retain_size", &size);
+	UT_ASSERTeq(ret, 0);
+	ret = pmemobj_ctl_get(pop, "tx.undo.retain_size", &size);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(size, RETAIN_SIZE);
+
+	percentile = 0;
+	ret = pmemobj_ctl_set(pop, "tx.undo.retain_percentile", &percentile);
+	UT_ASSERTne(ret, 0);
+	UT_ASSERTeq(errno, EINVAL);
+
+	percentile = 101;
+	ret = pmemobj_ctl_set(pop, "tx.undo.retain_percentile", &percentile);
+	UT_ASSERTne(ret, 0);
+	UT_ASSERTeq(errno, EINVAL);
+
+	percentile = 50;
+	ret = pmemobj_ctl_set(pop, "tx.undo.retain_percentile", &percentile);
+	UT_ASSERTeq(ret, 0);
+	ret = pmemobj_ctl_get(pop, "tx.undo.retain_percentile", &percentile);
+	UT_ASSERTeq(ret, 0);
+	UT_ASSERTeq(percentile, 50);
+
+	UT_ASSERTeq(get_stat("stats.tx.undo_extensions_avoided"), 0);
+}
+
+/*
+ * test_retain -- checks that the retained extensions are reused, and that
+ *	they are freed once the retention is disabled
+ */
+static void
+test_retain(void)
+{
+	int enabled = 1;
+	int ret = pmemobj_ctl_set(pop, "stats.enabled", &enabled);
+	UT_ASSERTeq(ret, 0);
+
+	/* the default policy keeps only the first extension */
+	do_tx(1, 0);
+	do_tx(2, 0);
+	size_t allocated = get_stat("stats.heap.curr_allocated");
+	UT_ASSERTeq(get_stat("stats.tx.undo_extensions_avoided"), 0);
+
+	set_retain_size(RETAIN_SIZE);
+	for (int i = 0; i < NTX; ++i)
+		do_tx(i, 0);
+	check_obj(NTX - 1);
+
+	size_t avoided = get_stat("stats.tx.undo_extensions_avoided");
+	UT_ASSERTne(avoided, 0);
+	UT_ASSERT(get_stat("stats.heap.curr_allocated") > allocated);
+
+	/* the retained extensions hold a valid snapshot on abort */
+	do_tx(0xff, 1);
+	check_obj(NTX - 1);
+	UT_ASSERT(get_stat("stats.tx.undo_extensions_avoided") > avoided);
+
+	/* the first transaction after disabling frees the extensions */
+	set_retain_size(0);
+	do_tx(3, 0);
+	avoided = get_stat("stats.tx.undo_extensions_avoided");
+	do_tx(4, 0);
+	do_tx(5, 0);
+	check_obj(5);
+
+	UT_ASSERTeq(get_stat("stats.tx.undo_extensions_avoided"), avoided);
+	UT_ASSERTeq(get_stat("stats.heap.curr_allocated"), allocated);
+}
+
+/*
+ * test_reopen -- checks that a pool closed with retained extensions is
+ *	consistent and can be used after reopening
+ */
+static void
+test_reopen(const char *path)
+{
+	set_retain_size(RETAIN_SIZE);
+	for (int i = 0; i < NTX; ++i)
+		do_tx(i, 0);
+
+	pmemobj_close(pop);
+
+	int ret = pmemobj_check(path, LAYOUT);
+	UT_ASSERTeq(ret, 1);
+
+	pop = pmemobj_open(path, LAYOUT);
+	UT_ASSERTne(pop, NULL);
+
+	obj = pmemobj_first(pop);
+	UT_ASSERT(!OID_IS_NULL(obj));
+	check_obj(NTX - 1);
+
+	do_tx(0xff, 1);
+	check_obj(NTX - 1);
+	do_tx(1, 0);
+	check_obj(1);
+}
+
+int
+main(int argc, char *argv[])
+{
+	START(argc, argv, "obj_tx_undo_retain");
+
+	if (argc != 3)
+		UT_FATAL("usage: %s file-name c|r|o", argv[0]);
+
+	const char *path = argv[1];
+	char t = argv[2][0];
+
+	if ((pop = pmemobj_create(path, LAYOUT, PMEMOBJ_MIN_POOL * 4,
+		S_IWUSR | S_IRUSR)) == NULL)
+		UT_FATAL("!pmemobj_create: %s", path);
+
+	int ret = pmemobj_zalloc(pop, &obj, OBJ_SIZE, 0);
+	UT_ASSERTeq(ret, 0);
+
+	switch (t) {
+		case 'c':
+			test_ctl();
+			break;
+		case 'r':
+			test_retain();
+			break;
+		case 'o':
+			test_reopen(path);
+			break;
+		default:
+			UT_FATAL("unknown test type %c", t);
+	}
+
+	pmemobj_close(pop);
+
+	DONE(NULL);
+}
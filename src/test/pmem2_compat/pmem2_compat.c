@@ -16,6 +16,7 @@ main(int argc, char *argv[])
 	UT_COMPILE_ERROR_ON(PMEM_F_MEM_WC != PMEM2_F_MEM_WC);
 	UT_COMPILE_ERROR_ON(PMEM_F_MEM_WB != PMEM2_F_MEM_WB);
 	UT_COMPILE_ERROR_ON(PMEM_F_MEM_NOFLUSH != PMEM2_F_MEM_NOFLUSH);
+	UT_COMPILE_ERROR_ON(PMEM_F_MEM_PARALLEL != PMEM2_F_MEM_PARALLEL);
 
 	return 0;
 }
@@ -0,0 +1,39 @@
+#!../env.py
+# SPDX-License-Identifier: BSD-3-Clause
+# Copyright 2026, Intel Corporation
+#
+import testframework as t
+from testframework import granularity as g
+
+
+@g.no_testdir()
+class PMEM2_FLUSH_SET(t.Test):
+    test_type = t.Short
+
+    def run(self, ctx):
+        ctx.exec('pmem2_flush_set', self.test_case)
+
+
+class TEST0(PMEM2_FLUSH_SET):
+    """overlapping and repeated ranges are flushed once, in order"""
+    test_case = "test_flush_set_dedup"
+
+
+class TEST1(PMEM2_FLUSH_SET):
+    """many scattered ranges, more than the flush set can hold"""
+    test_case = "test_flush_set_many"
+
+
+class TEST2(PMEM2_FLUSH_SET):
+    """ranges are rounded to pages on the page granularity"""
+    test_case = "test_flush_set_page"
+
+
+class TEST3(PMEM2_FLUSH_SET):
+    """nothing is flushed on the byte granularity"""
+    test_case = "test_flush_set_byte"
+
+
+class TEST4(PMEM2_FLUSH_SET):
+    """ranges beyond the mapping are rejected"""
+    test_case = "test_flush_set_range_beyond_mapping"
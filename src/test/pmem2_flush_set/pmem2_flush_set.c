@@ -0,0 +1,285 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2026, Intel Corporation */
+
+/*
+ * pmem2_flush_set.c -- unit test for pmem2_flush_set_*()
+ *
+ * usage: pmem2_flush_set test_case
+ *
+ * The flush and drain functions of the mapping are replaced by mocks which
+ * count how many times each cache line of the mapping is flushed.
+ */
+
+#include "map.h"
+#include "pmem2_utils.h"
+#include "ut_pmem2_utils.h"
+#include "unittest.h"
+
+#define MAP_LINES (256 * 1024)
+#define MAP_SIZE ((size_t)MAP_LINES * CACHELINE_SIZE)
+
+static char *Map_base;
+static unsigned char Flushed[MAP_LINES];
+static uintptr_t Last_flush_end;
+static int n_flushes;
+static int n_fences;
+
+/*
+ * mock_flush -- counts the flushed lines, checks that the ranges are
+ *	flushed in the order of their addresses
+ */
+static void
+mock_flush(const void *addr, size_t len)
+{
+	uintptr_t start = (uintptr_t)addr;
+
+	UT_ASSERT(start >= (uintptr_t)Map_base);
+	UT_ASSERT(start + len <= (uintptr_t)Map_base + MAP_SIZE);
+	UT_ASSERT(start > Last_flush_end || Last_flush_end == 0);
+	Last_flush_end = start + len;
+
+	size_t first = (start - (uintptr_t)Map_base) / CACHELINE_SIZE;
+	for (size_t i = 0; i < len / CACHELINE_SIZE; ++i)
+		++Flushed[first + i];
+
+	++n_flushes;
+}
+
+/*
+ * mock_drain -- counts drain calls
+ */
+static void
+mock_drain(void)
+{
+	Last_flush_end = 0;
+	++n_fences;
+}
+
+/*
+ * map_init -- fills pmem2_map in minimal scope
+ */
+static void
+map_init(struct pmem2_map *map, enum pmem2_granularity gran)
+{
+	map->addr = Map_base;
+	map->content_length = MAP_SIZE;
+	map->effective_granularity = gran;
+	map->flush_fn = mock_flush;
+	map->drain_fn = mock_drain;
+}
+
+/*
+ * counters_check_n_reset -- checks the number of flushes and drains,
+ *	and that no line was flushed more than once
+ */
+static void
+counters_check_n_reset(int flushes, int fences, size_t nlines)
+{
+	size_t flushed = 0;
+	for (size_t i = 0; i < MAP_LINES; ++i) {
+		UT_ASSERT(Flushed[i] <= 1);
+		flushed += Flushed[i];
+	}
+
+	UT_ASSERTeq(flushed, nlines);
+	if (flushes >= 0)
+		UT_ASSERTeq(n_flushes, flushes);
+	UT_ASSERTeq(n_fences, fences);
+
+	memset(Flushed, 0, sizeof(Flushed));
+	n_flushes = 0;
+	n_fences = 0;
+}
+
+/*
+ * test_flush_set_dedup -- overlapping and repeated ranges are flushed once,
+ *	in the order of their addresses
+ */
+static int
+test_flush_set_dedup(const struct test_case *tc, int argc, char *argv[])
+{
+	struct pmem2_map map;
+	map_init(&map, PMEM2_GRANULARITY_CACHE_LINE);
+
+	struct pmem2_flush_set *fs;
+	int ret = pmem2_flush_set_new(&fs, &map);
+	UT_PMEM2_EXPECT_RETURN(ret, 0);
+
+	/* the first 256 bytes and the line at 4 KiB, many times */
+	char *base = Map_base;
+	for (int i = 0; i < 3; ++i) {
+		UT_ASSERTeq(pmem2_flush_set_add(fs, base + 200, 10), 0);
+		UT_ASSERTeq(pmem2_flush_set_add(fs, base + 4096, 64), 0);
+		UT_ASSERTeq(pmem2_flush_set_add(fs, base, 1), 0);
+		UT_ASSERTeq(pmem2_flush_set_add(fs, base + 4100, 3), 0);
+		UT_ASSERTeq(pmem2_flush_set_add(fs, base + 70, 100), 0);
+		UT_ASSERTeq(pmem2_flush_set_add(fs, base + 1000, 0), 0);
+	}
+
+	/* nothing is flushed before the commit */
+	counters_check_n_reset(0, 0, 0);
+
+	pmem2_flush_set_commit(fs);
+	counters_check_n_reset(2, 1, 256 / CACHELINE_SIZE + 1);
+
+	/* the committed ranges are forgotten */
+	pmem2_flush_set_commit(fs);
+	counters_check_n_reset(0, 1, 0);
+
+	ret = pmem2_flush_set_delete(&fs);
+	UT_PMEM2_EXPECT_RETURN(ret, 0);
+	UT_ASSERTeq(fs, NULL);
+
+	return 0;
+}
+
+/*
+ * test_flush_set_many -- adds many scattered ranges, each flushed range must
+ *	be flushed exactly once, even if the flush set could not hold them all
+ */
+static int
+test_flush_set_many(const struct test_case *tc, int argc, char *argv[])
+{
+	struct pmem2_map map;
+	map_init(&map, PMEM2_GRANULARITY_CACHE_LINE);
+
+	struct pmem2_flush_set *fs;
+	int ret = pmem2_flush_set_new(&fs, &map);
+	UT_PMEM2_EXPECT_RETURN(ret, 0);
+
+	/* every fourth line, from the end, a few times */
+	const size_t nlines = 16 * 1024;
+	for (int pass = 0; pass < 3; ++pass) {
+		for (size_t i = nlines; i > 0; --i) {
+			char *addr = Map_base + (i - 1) * 4 * CACHELINE_SIZE;
+			UT_ASSERTeq(pmem2_flush_set_add(fs, addr, 8), 0);
+		}
+	}
+
+	pmem2_flush_set_commit(fs);
+	counters_check_n_reset((int)nlines, 1, nlines);
+
+	/* every other line of the whole mapping, the set has to flush early */
+	for (size_t i = 0; i < MAP_LINES / 2; ++i) {
+		char *addr = Map_base + i * 2 * CACHELINE_SIZE;
+		UT_ASSERTeq(pmem2_flush_set_add(fs, addr, CACHELINE_SIZE), 0);
+	}
+
+	pmem2_flush_set_commit(fs);
+	counters_check_n_reset(-1, 1, MAP_LINES / 2);
+
+	pmem2_flush_set_delete(&fs);
+
+	return 0;
+}
+
+/*
+ * test_flush_set_page -- ranges are rounded to pages on the page granularity
+ */
+static int
+test_flush_set_page(const struct test_case *tc, int argc, char *argv[])
+{
+	struct pmem2_map map;
+	map_init(&map, PMEM2_GRANULARITY_PAGE);
+
+	struct pmem2_flush_set *fs;
+	int ret = pmem2_flush_set_new(&fs, &map);
+	UT_PMEM2_EXPECT_RETURN(ret, 0);
+
+	UT_ASSERTeq(pmem2_flush_set_add(fs, Map_base + 10, 1), 0);
+	UT_ASSERTeq(pmem2_flush_set_add(fs, Map_base + Pagesize - 1, 2), 0);
+	UT_ASSERTeq(pmem2_flush_set_add(fs, Map_base + 3 * Pagesize, 1), 0);
+
+	pmem2_flush_set_commit(fs);
+	counters_check_n_reset(2, 1, 3 * Pagesize / CACHELINE_SIZE);
+
+	pmem2_flush_set_delete(&fs);
+
+	return 0;
+}
+
+/*
+ * test_flush_set_byte -- nothing is flushed on the byte granularity
+ */
+static int
+test_flush_set_byte(const struct test_case *tc, int argc, char *argv[])
+{
+	struct pmem2_map map;
+	map_init(&map, PMEM2_GRANULARITY_BYTE);
+
+	struct pmem2_flush_set *fs;
+	int ret = pmem2_flush_set_new(&fs, &map);
+	UT_PMEM2_EXPECT_RETURN(ret, 0);
+
+	for (size_t i = 0; i < 1024; ++i)
+		UT_ASSERTeq(pmem2_flush_set_add(fs, Map_base + i * 100, 100),
+			0);
+
+	pmem2_flush_set_commit(fs);
+	counters_check_n_reset(0, 1, 0);
+
+	pmem2_flush_set_delete(&fs);
+
+	return 0;
+}
+
+/*
+ * test_flush_set_range_beyond_mapping -- ranges which go beyond the mapping
+ *	are rejected
+ */
+static int
+test_flush_set_range_beyond_mapping(const struct test_case *tc, int argc,
+		char *argv[])
+{
+	struct pmem2_map map;
+	map_init(&map, PMEM2_GRANULARITY_CACHE_LINE);
+
+	struct pmem2_flush_set *fs;
+	int ret = pmem2_flush_set_new(&fs, &map);
+	UT_PMEM2_EXPECT_RETURN(ret, 0);
+
+	ret = pmem2_flush_set_add(fs, Map_base - 1, 2);
+	UT_PMEM2_EXPECT_RETURN(ret, PMEM2_E_LENGTH_OUT_OF_RANGE);
+
+	ret = pmem2_flush_set_add(fs, Map_base + MAP_SIZE - 1, 2);
+	UT_PMEM2_EXPECT_RETURN(ret, PMEM2_E_LENGTH_OUT_OF_RANGE);
+
+	ret = pmem2_flush_set_add(fs, Map_base + MAP_SIZE, 0);
+	UT_PMEM2_EXPECT_RETURN(ret, 0);
+
+	pmem2_flush_set_commit(fs);
+	counters_check_n_reset(0, 1, 0);
+
+	pmem2_flush_set_delete(&fs);
+
+	return 0;
+}
+
+/*
+ * test_cases -- available test cases
+ */
+static struct test_case test_cases[] = {
+	TEST_CASE(test_flush_set_dedup),
+	TEST_CASE(test_flush_set_many),
+	TEST_CASE(test_flush_set_page),
+	TEST_CASE(test_flush_set_byte),
+	TEST_CASE(test_flush_set_range_beyond_mapping),
+};
+
+#define NTESTS (sizeof(test_cases) / sizeof(test_cases[0]))
+
+int
+main(int argc, char *argv[])
+{
+	START(argc, argv, "pmem2_flush_set");
+	util_init();
+
+	/* the mapping is page aligned, one more page precedes it */
+	char *buf = MALLOC(MAP_SIZE + 2 * Pagesize);
+	Map_base = (char *)PAGE_ALIGN_UP((uintptr_t)buf + 1);
+
+	TEST_CASE_PROCESS(argc, argv, test_cases, NTESTS);
+
+	FREE(buf);
+	DONE(NULL);
+}
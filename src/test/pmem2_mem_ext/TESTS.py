@@ -205,6 +205,8 @@ class Pmem2MemExt(t.Test):
 
     def run(self, ctx):
         ctx.env['PMEM2_LOG_LEVEL'] = '15'
+        # the calibration would alternate the kind of stores
+        ctx.env['PMEM_MOVNT_CALIBRATE'] = '0'
 
         if ctx.wc_workaround() == 'on':
             ctx.env['PMEM_WC_WORKAROUND'] = '1'
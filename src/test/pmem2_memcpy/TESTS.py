@@ -78,3 +78,8 @@ class TEST4(Pmem2Memcpy):
 @t.add_params('wc_workaround', ['on', 'off', 'default'])
 class TEST5(Pmem2Memcpy):
     envs1 = ("PMEM_MOVDIR64B",)
+
+
+@t.add_params('wc_workaround', ['default'])
+class TEST6(Pmem2Memcpy):
+    envs0 = ("PMEM_PARALLEL_THRESHOLD",)
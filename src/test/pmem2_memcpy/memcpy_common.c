@@ -99,8 +99,10 @@ unsigned Flags[] = {
 		PMEM_F_MEM_WC,
 		PMEM_F_MEM_WB,
 		PMEM_F_MEM_NOFLUSH,
+		PMEM_F_MEM_PARALLEL,
+		PMEM_F_MEM_PARALLEL | PMEM_F_MEM_NONTEMPORAL,
 		/* all possible flags */
 		PMEM_F_MEM_NODRAIN | PMEM_F_MEM_NOFLUSH |
 			PMEM_F_MEM_NONTEMPORAL | PMEM_F_MEM_TEMPORAL |
-			PMEM_F_MEM_WC | PMEM_F_MEM_WB,
+			PMEM_F_MEM_WC | PMEM_F_MEM_WB | PMEM_F_MEM_PARALLEL,
 };
@@ -14,7 +14,7 @@ typedef void *(*memcpy_fn)(void *pmemdest, const void *src, size_t len,
 		unsigned flags);
 typedef void (*persist_fn)(const void *ptr, size_t len);
 
-extern unsigned Flags[10];
+extern unsigned Flags[12];
 
 void do_memcpy(int fd, char *dest, int dest_off, char *src, int src_off,
     size_t bytes, size_t mapped_len, const char *file_name, memcpy_fn fn,
@@ -1,5 +1,5 @@
 // SPDX-License-Identifier: BSD-3-Clause
-/* Copyright 2020-2023, Intel Corporation */
+/* Copyright 2020-2026, Intel Corporation */
 
 /*
  * pmem2_memcpy.c -- test for doing a memcpy from libpmem2
@@ -8,6 +8,8 @@
  *
  */
 
+#include <sys/wait.h>
+
 #include "unittest.h"
 #include "file.h"
 #include "ut_pmem2.h"
@@ -28,6 +30,32 @@ do_memcpy_variants(int fd, char *dest, int dest_off, char *src, int src_off,
 	}
 }
 
+/*
+ * do_memcpy_parallel_fork -- checks that a child process which does
+ *	a parallel memcpy can exit, it must not wait for the workers of
+ *	the parent
+ */
+static void
+do_memcpy_parallel_fork(char *dest, char *src, size_t bytes,
+		pmem2_memcpy_fn memcpy_fn)
+{
+	pid_t pid = fork();
+	if (pid < 0)
+		UT_FATAL("!fork");
+
+	if (pid == 0) {
+		memcpy_fn(dest, src, bytes, PMEM2_F_MEM_PARALLEL);
+		exit(memcmp(dest, src, bytes) != 0);
+	}
+
+	int status;
+	if (waitpid(pid, &status, 0) != pid)
+		UT_FATAL("!waitpid");
+
+	UT_ASSERT(WIFEXITED(status));
+	UT_ASSERTeq(WEXITSTATUS(status), 0);
+}
+
 int
 main(int argc, char *argv[])
 {
@@ -99,6 +127,10 @@ main(int argc, char *argv[])
 	do_memcpy_variants(fd, dest, dest_off, src, src_off, bytes, mapped_len,
 		argv[1], persist, memcpy_fn);
 
+	/* the parallel workers were started by the variants above */
+	if (os_getenv("PMEM_PARALLEL_THRESHOLD"))
+		do_memcpy_parallel_fork(dest, src, bytes, memcpy_fn);
+
 	ret = pmem2_map_delete(&map);
 	UT_ASSERTeq(ret, 0);
 
@@ -0,0 +1,216 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2026, Intel Corporation */
+
+/*
+ * pmem2_memcpy_crc32c.c -- test for the memcpy computing the CRC32C checksum
+ *	of the copied data and for the mcsafe read doing the same
+ *
+ * usage: pmem2_memcpy_crc32c file
+ */
+
+#include "unittest.h"
+#include "ut_pmem2.h"
+
+#define SRC_SIZE (128 * 1024)
+
+/* the checksum of "123456789" */
+#define CRC32C_CHECK 0xe3069283U
+
+static const size_t Lengths[] = {
+	0, 1, 7, 8, 63, 64, 65, 255, 767, 768, 769, 4095, 4096, 4097,
+	3 * 8192 - 1, 3 * 8192 + 5, 100000,
+};
+
+static const size_t Dest_offsets[] = {0, 7, 63, 4096 - 5};
+
+static const size_t Src_offsets[] = {0, 3};
+
+static const unsigned Flags[] = {
+	0,
+	PMEM2_F_MEM_NODRAIN,
+	PMEM2_F_MEM_NONTEMPORAL,
+	PMEM2_F_MEM_TEMPORAL,
+	PMEM2_F_MEM_WC,
+	PMEM2_F_MEM_WB,
+	PMEM2_F_MEM_NOFLUSH,
+	PMEM2_F_MEM_PARALLEL,
+};
+
+/*
+ * crc32c_ref -- computes the checksum one bit at a time
+ */
+static uint32_t
+crc32c_ref(uint32_t crc, const void *addr, size_t len)
+{
+	const unsigned char *p = addr;
+
+	crc = ~crc;
+	for (size_t i = 0; i < len; ++i) {
+		crc ^= p[i];
+		for (int k = 0; k < 8; ++k)
+			crc = (crc >> 1) ^ (0x82f63b78U & (0U - (crc & 1)));
+	}
+
+	return ~crc;
+}
+
+/*
+ * test_known_value -- checks the checksum of the standard check string
+ */
+static void
+test_known_value(char *dest, pmem2_memcpy_crc32c_fn fn)
+{
+	const char *check = "123456789";
+	uint32_t crc = 0;
+
+	UT_ASSERTeq(crc32c_ref(0, check, 9), CRC32C_CHECK);
+
+	fn(dest, check, 9, 0, &crc);
+	UT_ASSERTeq(crc, CRC32C_CHECK);
+	UT_ASSERTeq(memcmp(dest, check, 9), 0);
+
+	/* the checksum can be computed piecewise */
+	crc = 0;
+	fn(dest, check, 4, 0, &crc);
+	fn(dest + 4, check + 4, 5, 0, &crc);
+	UT_ASSERTeq(crc, CRC32C_CHECK);
+}
+
+/*
+ * test_copy -- copies the buffers of many lengths and alignments, verifies
+ *	the copied data and the checksum, including the bytes around
+ *	the destination
+ */
+static void
+test_copy(char *dest, size_t mapped_len, const char *src,
+		pmem2_memcpy_crc32c_fn fn)
+{
+	for (size_t f = 0; f < ARRAY_SIZE(Flags); ++f)
+	for (size_t d = 0; d < ARRAY_SIZE(Dest_offsets); ++d)
+	for (size_t s = 0; s < ARRAY_SIZE(Src_offsets); ++s)
+	for (size_t l = 0; l < ARRAY_SIZE(Lengths); ++l) {
+		char *to = dest + Dest_offsets[d] + 1;
+		const char *from = src + Src_offsets[s];
+		size_t len = Lengths[l];
+
+		UT_ASSERT(Src_offsets[s] + len <= SRC_SIZE);
+		UT_ASSERT(Dest_offsets[d] + len + 2 <= mapped_len);
+
+		to[-1] = 0x5a;
+		memset(to, 0, len);
+		to[len] = 0x5a;
+
+		uint32_t crc = 0;
+		fn(to, from, len, Flags[f], &crc);
+
+		if (memcmp(to, from, len))
+			UT_FATAL("data mismatch, len %zu dest offset %zu "
+				"src offset %zu flags 0x%x", len,
+				Dest_offsets[d], Src_offsets[s], Flags[f]);
+
+		UT_ASSERTeq(crc, crc32c_ref(0, from, len));
+		UT_ASSERTeq(to[-1], 0x5a);
+		UT_ASSERTeq(to[len], 0x5a);
+
+		/* two copies give the checksum of the concatenation */
+		size_t half = len / 3;
+		crc = 0;
+		fn(to, from, half, Flags[f], &crc);
+		fn(to + half, from + half, len - half, Flags[f], &crc);
+		UT_ASSERTeq(crc, crc32c_ref(0, from, len));
+		UT_ASSERTeq(memcmp(to, from, len), 0);
+	}
+}
+
+/*
+ * test_pread_mcsafe -- reads the data back with the mcsafe read computing
+ *	the checksum
+ */
+static void
+test_pread_mcsafe(struct pmem2_map *map, struct pmem2_source *psrc,
+		const char *src)
+{
+	char *dest = pmem2_map_get_address(map);
+	pmem2_memcpy_fn memcpy_fn = pmem2_get_memcpy_fn(map);
+	char *buf = MALLOC(SRC_SIZE);
+
+	memcpy_fn(dest, src, SRC_SIZE, 0);
+
+	for (size_t l = 0; l < ARRAY_SIZE(Lengths); ++l) {
+		size_t len = Lengths[l];
+		size_t offset = 13;
+
+		memset(buf, 0, SRC_SIZE);
+
+		uint32_t crc = 0;
+		int ret = pmem2_source_pread_mcsafe_crc32c(psrc, buf, len,
+			offset, &crc);
+		UT_PMEM2_EXPECT_RETURN(ret, 0);
+
+		UT_ASSERTeq(memcmp(buf, dest + offset, len), 0);
+		UT_ASSERTeq(crc, crc32c_ref(0, dest + offset, len));
+	}
+
+	/* the read beyond the source is rejected */
+	size_t size = pmem2_map_get_size(map);
+	uint32_t crc = 0;
+	int ret = pmem2_source_pread_mcsafe_crc32c(psrc, buf, 2, size - 1,
+		&crc);
+	UT_PMEM2_EXPECT_RETURN(ret, PMEM2_E_LENGTH_OUT_OF_RANGE);
+	UT_ASSERTeq(crc, 0);
+
+	FREE(buf);
+}
+
+int
+main(int argc, char *argv[])
+{
+	struct pmem2_config *cfg;
+	struct pmem2_source *psrc;
+	struct pmem2_map *map;
+
+	if (argc != 2)
+		UT_FATAL("usage: %s file", argv[0]);
+
+	const char *thr = os_getenv("PMEM_MOVNT_THRESHOLD");
+	const char *avx = os_getenv("PMEM_AVX");
+	const char *avx512f = os_getenv("PMEM_AVX512F");
+
+	START(argc, argv, "pmem2_memcpy_crc32c %s %savx %savx512f",
+			thr ? thr : "default",
+			avx ? "" : "!",
+			avx512f ? "" : "!");
+
+	int fd = OPEN(argv[1], O_RDWR);
+
+	PMEM2_CONFIG_NEW(&cfg);
+	PMEM2_SOURCE_FROM_FD(&psrc, fd);
+	PMEM2_CONFIG_SET_GRANULARITY(cfg, PMEM2_GRANULARITY_PAGE);
+
+	int ret = pmem2_map_new(&map, cfg, psrc);
+	UT_PMEM2_EXPECT_RETURN(ret, 0);
+
+	PMEM2_CONFIG_DELETE(&cfg);
+
+	char *dest = pmem2_map_get_address(map);
+	size_t mapped_len = pmem2_map_get_size(map);
+	pmem2_memcpy_crc32c_fn fn = pmem2_get_memcpy_crc32c_fn(map);
+
+	char *src = MALLOC(SRC_SIZE);
+	for (size_t i = 0; i < SRC_SIZE; ++i)
+		src[i] = (char)(i * 31 + (i >> 8));
+
+	test_known_value(dest, fn);
+	test_copy(dest, mapped_len, src, fn);
+	test_pread_mcsafe(map, psrc, src);
+
+	FREE(src);
+
+	ret = pmem2_map_delete(&map);
+	UT_ASSERTeq(ret, 0);
+
+	PMEM2_SOURCE_DELETE(&psrc);
+	CLOSE(fd);
+
+	DONE(NULL);
+}
@@ -0,0 +1,39 @@
+#!../env.py
+# SPDX-License-Identifier: BSD-3-Clause
+# Copyright 2026, Intel Corporation
+#
+
+import testframework as t
+
+
+class Pmem2Memcpyv(t.Test):
+    test_type = t.Short
+    filesize = 4 * t.MiB
+    envs0 = ()
+    envs1 = ()
+
+    def run(self, ctx):
+        for env in self.envs0:
+            ctx.env[env] = '0'
+        for env in self.envs1:
+            ctx.env[env] = '1'
+
+        filepath = ctx.create_holey_file(self.filesize, 'testfile',)
+        ctx.exec('pmem2_memcpyv', filepath)
+
+
+class TEST0(Pmem2Memcpyv):
+    pass
+
+
+class TEST1(Pmem2Memcpyv):
+    envs1 = ("PMEM_NO_MOVNT",)
+
+
+@t.require_architectures('x86_64')
+class TEST2(Pmem2Memcpyv):
+    envs0 = ("PMEM_AVX512F", "PMEM_AVX",)
+
+
+class TEST3(Pmem2Memcpyv):
+    envs0 = ("PMEM_PARALLEL_THRESHOLD",)
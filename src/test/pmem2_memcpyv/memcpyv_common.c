@@ -0,0 +1,119 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2026, Intel Corporation */
+
+/*
+ * memcpyv_common.c -- common part for tests doing a scatter-gather memcpy
+ */
+
+#include "memcpyv_common.h"
+
+#define MAX_IOV 16
+#define SRC_SIZE (64 * 1024)
+
+/* lengths of the buffers, terminated by SIZE_MAX */
+static const size_t Lengths[][MAX_IOV + 1] = {
+	/* no buffers at all */
+	{SIZE_MAX},
+	{5, SIZE_MAX},
+	{0, 0, SIZE_MAX},
+	{8192, SIZE_MAX},
+	/* whole lines */
+	{64, 64, 64, SIZE_MAX},
+	/* joins inside and at the bounds of lines */
+	{1, 63, 64, 65, 3, 200, 0, 4096, 7, SIZE_MAX},
+	{13, 13, 13, 13, 13, 13, 13, 13, 13, 13, SIZE_MAX},
+	{100, 28, 4000, 1, 1, 1, 62, 300, SIZE_MAX},
+	{1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, SIZE_MAX},
+};
+
+static const size_t Dest_offsets[] = {0, 7, 63, 64 + 13};
+
+static const unsigned Flags[] = {
+	0,
+	PMEM_F_MEM_NODRAIN,
+	PMEM_F_MEM_NONTEMPORAL,
+	PMEM_F_MEM_TEMPORAL,
+	PMEM_F_MEM_NONTEMPORAL | PMEM_F_MEM_NODRAIN,
+	PMEM_F_MEM_WC,
+	PMEM_F_MEM_WB,
+	PMEM_F_MEM_NOFLUSH,
+	PMEM_F_MEM_PARALLEL,
+	/* all possible flags */
+	PMEM_F_MEM_NODRAIN | PMEM_F_MEM_NOFLUSH |
+		PMEM_F_MEM_NONTEMPORAL | PMEM_F_MEM_TEMPORAL |
+		PMEM_F_MEM_WC | PMEM_F_MEM_WB | PMEM_F_MEM_PARALLEL,
+};
+
+/*
+ * do_memcpyv -- copies the buffers of the given lengths to dest and
+ *	verifies the result, including the bytes around the destination
+ */
+static void
+do_memcpyv(char *dest, size_t mapped_len, char *src, char *expected,
+		const size_t *lengths, memcpyv_fn fn, unsigned flags)
+{
+	struct iovec iov[MAX_IOV];
+	int iovcnt = 0;
+	size_t total = 0;
+	size_t src_off = 0;
+
+	for (; lengths[iovcnt] != SIZE_MAX; ++iovcnt) {
+		/* every buffer starts at a different alignment */
+		src_off += (size_t)iovcnt * 7 % 64;
+		UT_ASSERT(src_off + lengths[iovcnt] <= SRC_SIZE);
+
+		iov[iovcnt].iov_base = src + src_off;
+		iov[iovcnt].iov_len = lengths[iovcnt];
+
+		memcpy(expected + total, src + src_off, lengths[iovcnt]);
+
+		src_off += lengths[iovcnt];
+		total += lengths[iovcnt];
+	}
+
+	UT_ASSERT(total + 1 < mapped_len);
+
+	/* the guard bytes around the destination */
+	dest[-1] = 0x5a;
+	memset(dest, 0, total);
+	dest[total] = 0x5a;
+
+	void *ret = fn(dest, iov, iovcnt, flags);
+	UT_ASSERTeq(ret, dest);
+
+	if (memcmp(dest, expected, total) != 0)
+		UT_FATAL("memcpyv: data mismatch, total %zu flags 0x%x",
+			total, flags);
+
+	UT_ASSERTeq(dest[-1], 0x5a);
+	UT_ASSERTeq(dest[total], 0x5a);
+}
+
+/*
+ * do_memcpyv_variants -- tests all the buffer layouts with all the flags
+ */
+void
+do_memcpyv_variants(char *dest, size_t mapped_len, memcpyv_fn fn)
+{
+	char *src = MALLOC(SRC_SIZE);
+	char *expected = MALLOC(SRC_SIZE);
+
+	for (size_t i = 0; i < SRC_SIZE; ++i)
+		src[i] = (char)(i * 31 + i / 256);
+
+	/* dest[-1] is a guard byte */
+	char *base = dest + 64;
+
+	for (size_t f = 0; f < ARRAY_SIZE(Flags); ++f) {
+		for (size_t o = 0; o < ARRAY_SIZE(Dest_offsets); ++o) {
+			for (size_t l = 0; l < ARRAY_SIZE(Lengths); ++l)
+				do_memcpyv(base + Dest_offsets[o],
+					mapped_len - 128 - Dest_offsets[o],
+					src, expected, Lengths[l], fn,
+					Flags[f]);
+		}
+	}
+
+	FREE(expected);
+	FREE(src);
+}
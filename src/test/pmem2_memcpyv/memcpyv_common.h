@@ -0,0 +1,19 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright 2026, Intel Corporation */
+
+/*
+ * memcpyv_common.h -- header file for common memcpyv utilities
+ */
+#ifndef MEMCPYV_COMMON_H
+#define MEMCPYV_COMMON_H 1
+
+#include <sys/uio.h>
+
+#include "unittest.h"
+
+typedef void *(*memcpyv_fn)(void *pmemdest, const struct iovec *iov,
+		int iovcnt, unsigned flags);
+
+void do_memcpyv_variants(char *dest, size_t mapped_len, memcpyv_fn fn);
+
+#endif
@@ -0,0 +1,56 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2026, Intel Corporation */
+
+/*
+ * pmem2_memcpyv.c -- test for doing a scatter-gather memcpy from libpmem2
+ *
+ * usage: pmem2_memcpyv file
+ */
+
+#include "unittest.h"
+#include "ut_pmem2.h"
+#include "memcpyv_common.h"
+
+int
+main(int argc, char *argv[])
+{
+	struct pmem2_config *cfg;
+	struct pmem2_source *psrc;
+	struct pmem2_map *map;
+
+	if (argc != 2)
+		UT_FATAL("usage: %s file", argv[0]);
+
+	const char *thr = os_getenv("PMEM_MOVNT_THRESHOLD");
+	const char *avx = os_getenv("PMEM_AVX");
+	const char *avx512f = os_getenv("PMEM_AVX512F");
+
+	START(argc, argv, "pmem2_memcpyv %s %savx %savx512f",
+			thr ? thr : "default",
+			avx ? "" : "!",
+			avx512f ? "" : "!");
+
+	int fd = OPEN(argv[1], O_RDWR);
+
+	PMEM2_CONFIG_NEW(&cfg);
+	PMEM2_SOURCE_FROM_FD(&psrc, fd);
+	PMEM2_CONFIG_SET_GRANULARITY(cfg, PMEM2_GRANULARITY_PAGE);
+
+	int ret = pmem2_map_new(&map, cfg, psrc);
+	UT_PMEM2_EXPECT_RETURN(ret, 0);
+
+	PMEM2_CONFIG_DELETE(&cfg);
+	PMEM2_SOURCE_DELETE(&psrc);
+
+	char *dest = pmem2_map_get_address(map);
+	size_t mapped_len = pmem2_map_get_size(map);
+
+	do_memcpyv_variants(dest, mapped_len, pmem2_get_memcpyv_fn(map));
+
+	ret = pmem2_map_delete(&map);
+	UT_ASSERTeq(ret, 0);
+
+	CLOSE(fd);
+
+	DONE(NULL);
+}
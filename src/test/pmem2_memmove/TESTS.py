@@ -83,3 +83,7 @@ class TEST3(Pmem2Memmove):
 
 class TEST4(Pmem2Memmove):
     envs1 = ("PMEM_NO_MOVNT", "PMEM_NO_GENERIC_MEMCPY")
+
+
+class TEST5(Pmem2Memmove):
+    envs0 = ("PMEM_PARALLEL_THRESHOLD",)
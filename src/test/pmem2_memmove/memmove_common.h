@@ -10,7 +10,7 @@
 #include "unittest.h"
 #include "file.h"
 
-extern unsigned Flags[10];
+extern unsigned Flags[12];
 
 #define USAGE() do { UT_FATAL("usage: %s file  b:length [d:{offset}] "\
 	"[s:{offset}] [o:{0|1}]", argv[0]); } while (0)
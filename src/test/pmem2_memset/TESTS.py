@@ -68,3 +68,8 @@ class TEST4(Pmem2Memset):
 @t.add_params('wc_workaround', ['on', 'off', 'default'])
 class TEST5(Pmem2Memset):
     envs1 = ("PMEM_MOVDIR64B",)
+
+
+@t.add_params('wc_workaround', ['default'])
+class TEST6(Pmem2Memset):
+    envs0 = ("PMEM_PARALLEL_THRESHOLD",)
@@ -10,7 +10,7 @@
 #include "unittest.h"
 #include "file.h"
 
-extern unsigned Flags[10];
+extern unsigned Flags[12];
 
 typedef void *(*memset_fn)(void *pmemdest, int c, size_t len, unsigned flags);
 typedef void (*persist_fn)(const void *ptr, size_t len);
@@ -0,0 +1,58 @@
+#!../env.py
+# SPDX-License-Identifier: BSD-3-Clause
+# Copyright 2026, Intel Corporation
+#
+
+
+import testframework as t
+from testframework import granularity as g
+
+
+class Pmem2MovntThreshold(t.Test):
+    test_type = t.Short
+    filesize = 4 * t.MiB
+    args = ()
+    envs = {}
+
+    def run(self, ctx):
+        filepath = ctx.create_holey_file(self.filesize, 'testfile',)
+        for env, val in self.envs.items():
+            ctx.env[env] = val
+        ctx.exec('pmem2_movnt_threshold', self.test_case, filepath,
+                 *self.args)
+
+
+class TEST0(Pmem2MovntThreshold):
+    """override the threshold of the mapping"""
+    test_case = "test_override"
+
+
+@t.require_architectures('x86_64')
+class TEST1(Pmem2MovntThreshold):
+    """calibrate the threshold of the mapping"""
+    test_case = "test_calibrate"
+
+
+# mappings with the byte granularity keep using the temporal stores
+@g.require_granularity(g.PAGE, g.CACHELINE)
+@t.require_architectures('x86_64')
+class TEST2(Pmem2MovntThreshold):
+    """the threshold forced by PMEM_MOVNT_THRESHOLD is not calibrated"""
+    test_case = "test_fixed"
+    args = ('1024',)
+    envs = {'PMEM_MOVNT_THRESHOLD': '1024'}
+
+
+@g.require_granularity(g.PAGE, g.CACHELINE)
+@t.require_architectures('x86_64')
+class TEST3(Pmem2MovntThreshold):
+    """the calibration disabled by PMEM_MOVNT_CALIBRATE"""
+    test_case = "test_fixed"
+    args = ('256',)
+    envs = {'PMEM_MOVNT_CALIBRATE': '0'}
+
+
+@t.require_architectures('x86_64')
+class TEST4(Pmem2MovntThreshold):
+    """calibrate a mapping created after deleting a cached one"""
+    test_case = "test_remap"
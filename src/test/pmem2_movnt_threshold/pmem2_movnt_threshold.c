@@ -0,0 +1,272 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2026, Intel Corporation */
+
+/*
+ * pmem2_movnt_threshold.c -- pmem2_map_[get|set]_movnt_threshold unittests
+ */
+
+#include <stdint.h>
+
+#include "map.h"
+#include "movnt_threshold.h"
+#include "unittest.h"
+#include "ut_pmem2.h"
+
+#define MAX_LEN (256 * 1024)
+/* more than the number of operations needed to calibrate the threshold */
+#define NOPS 1024
+
+/*
+ * map_file -- (internal) maps the file with the page granularity
+ */
+static struct pmem2_map *
+map_file(const char *path, int *fd)
+{
+	struct pmem2_config *cfg;
+	struct pmem2_source *src;
+	struct pmem2_map *map;
+
+	*fd = OPEN(path, O_RDWR);
+
+	PMEM2_CONFIG_NEW(&cfg);
+	PMEM2_SOURCE_FROM_FD(&src, *fd);
+	PMEM2_CONFIG_SET_GRANULARITY(cfg, PMEM2_GRANULARITY_PAGE);
+
+	int ret = pmem2_map_new(&map, cfg, src);
+	UT_PMEM2_EXPECT_RETURN(ret, 0);
+
+	PMEM2_CONFIG_DELETE(&cfg);
+	PMEM2_SOURCE_DELETE(&src);
+
+	return map;
+}
+
+/*
+ * unmap_file -- (internal) deletes the mapping and closes the file
+ */
+static void
+unmap_file(struct pmem2_map *map, int fd)
+{
+	int ret = pmem2_map_delete(&map);
+	UT_ASSERTeq(ret, 0);
+
+	CLOSE(fd);
+}
+
+/*
+ * do_ops -- (internal) performs nops memcpy and memset operations of
+ *	various lengths and verifies their results
+ */
+static void
+do_ops(struct pmem2_map *map, unsigned nops)
+{
+	char *dst = pmem2_map_get_address(map);
+	char *src = MALLOC(MAX_LEN);
+	memset(src, 0x88, MAX_LEN);
+
+	pmem2_memcpy_fn memcpy_fn = pmem2_get_memcpy_fn(map);
+	pmem2_memset_fn memset_fn = pmem2_get_memset_fn(map);
+
+	size_t len = 1;
+	for (unsigned i = 0; i < nops; ++i) {
+		memset_fn(dst, 0, len + 1, 0);
+		memcpy_fn(dst, src, len, 0);
+		UT_ASSERTeq(memcmp(dst, src, len), 0);
+		UT_ASSERTeq(dst[len], 0);
+
+		len = len * 2 + 3;
+		if (len > MAX_LEN)
+			len = 1;
+	}
+
+	FREE(src);
+}
+
+/*
+ * check_sampled -- (internal) checks that the operations of the given kind
+ *	were measured with both kinds of stores
+ */
+static void
+check_sampled(struct movnt_calibration *calib, enum movnt_op op)
+{
+	uint64_t nsamples[2] = {0, 0};
+
+	for (unsigned i = 0; i < MOVNT_NBUCKETS; ++i) {
+		nsamples[0] += calib->buckets[op][i].nsamples[0];
+		nsamples[1] += calib->buckets[op][i].nsamples[1];
+	}
+
+	UT_ASSERTne(nsamples[0], 0);
+	UT_ASSERTne(nsamples[1], 0);
+}
+
+/*
+ * test_override -- overrides the threshold of the mapping
+ */
+static int
+test_override(const struct test_case *tc, int argc, char *argv[])
+{
+	if (argc < 1)
+		UT_FATAL("usage: test_override file");
+
+	int fd;
+	struct pmem2_map *map = map_file(argv[0], &fd);
+
+	pmem2_map_set_movnt_threshold(map, 0);
+	UT_ASSERTeq(pmem2_map_get_movnt_threshold(map), 0);
+	do_ops(map, NOPS);
+	UT_ASSERTeq(pmem2_map_get_movnt_threshold(map), 0);
+
+	pmem2_map_set_movnt_threshold(map, SIZE_MAX);
+	UT_ASSERTeq(pmem2_map_get_movnt_threshold(map), SIZE_MAX);
+	do_ops(map, NOPS);
+	UT_ASSERTeq(pmem2_map_get_movnt_threshold(map), SIZE_MAX);
+
+	pmem2_map_set_movnt_threshold(map, 1000);
+	UT_ASSERTeq(pmem2_map_get_movnt_threshold(map), 1000);
+	do_ops(map, NOPS);
+	UT_ASSERTeq(pmem2_map_get_movnt_threshold(map), 1000);
+
+	unmap_file(map, fd);
+
+	return 1;
+}
+
+/*
+ * test_calibrate -- calibrates the threshold of the mapping
+ */
+static int
+test_calibrate(const struct test_case *tc, int argc, char *argv[])
+{
+	if (argc < 1)
+		UT_FATAL("usage: test_calibrate file");
+
+	int fd;
+	struct pmem2_map *map = map_file(argv[0], &fd);
+	struct movnt_calibration *calib = &map->movnt_calib;
+
+	UT_ASSERTeq(calib->state, MOVNT_CALIBRATING);
+	do_ops(map, NOPS);
+
+	/* the operations were measured and the calibration has finished */
+	UT_ASSERTeq(calib->state, MOVNT_CALIBRATED);
+	UT_ASSERT(calib->nsamples > 0);
+
+	/*
+	 * do_ops interleaves memset and memcpy of similar lengths, each of
+	 * them has to be measured with both kinds of stores
+	 */
+	check_sampled(calib, MOVNT_OP_MEMMOVE);
+	check_sampled(calib, MOVNT_OP_MEMSET);
+
+	/* calibrated thresholds are the bounds of power of two buckets */
+	size_t threshold = pmem2_map_get_movnt_threshold(map);
+	UT_ASSERT(threshold == SIZE_MAX || util_is_pow2(threshold) ||
+		threshold == 0);
+
+	/* the calibration is over */
+	uint64_t nsamples = calib->nsamples;
+	do_ops(map, NOPS);
+	UT_ASSERTeq(pmem2_map_get_movnt_threshold(map), threshold);
+	UT_ASSERTeq(calib->nsamples, nsamples);
+
+	/* the overridden threshold is not calibrated again */
+	pmem2_map_set_movnt_threshold(map, 4096);
+	UT_ASSERTeq(pmem2_map_get_movnt_threshold(map), 4096);
+	UT_ASSERTeq(calib->state, MOVNT_OVERRIDDEN);
+	do_ops(map, NOPS);
+	UT_ASSERTeq(pmem2_map_get_movnt_threshold(map), 4096);
+
+	unmap_file(map, fd);
+
+	return 1;
+}
+
+/*
+ * test_remap -- checks that a new mapping is calibrated after the mapping
+ *	previously written to, possibly at the same address, was deleted
+ */
+static int
+test_remap(const struct test_case *tc, int argc, char *argv[])
+{
+	if (argc < 1)
+		UT_FATAL("usage: test_remap file");
+
+	int fd_a;
+	int fd_b;
+	struct pmem2_map *map_a = map_file(argv[0], &fd_a);
+	struct pmem2_map *map_b = map_file(argv[0], &fd_b);
+
+	/* the final thresholds of both mappings get cached */
+	pmem2_map_set_movnt_threshold(map_a, 0);
+	pmem2_map_set_movnt_threshold(map_b, SIZE_MAX);
+	for (unsigned i = 0; i < 4; ++i) {
+		do_ops(map_a, 1);
+		do_ops(map_b, 1);
+	}
+
+	unmap_file(map_a, fd_a);
+
+	int fd_c;
+	struct pmem2_map *map_c = map_file(argv[0], &fd_c);
+	UT_ASSERTeq(map_c->movnt_calib.state, MOVNT_CALIBRATING);
+	do_ops(map_c, NOPS);
+	UT_ASSERTeq(map_c->movnt_calib.state, MOVNT_CALIBRATED);
+	check_sampled(&map_c->movnt_calib, MOVNT_OP_MEMMOVE);
+
+	/* the overridden threshold replaces the cached one */
+	pmem2_map_set_movnt_threshold(map_c, 4096);
+	do_ops(map_c, NOPS);
+	UT_ASSERTeq(pmem2_map_get_movnt_threshold(map_c), 4096);
+
+	do_ops(map_b, NOPS);
+	UT_ASSERTeq(pmem2_map_get_movnt_threshold(map_b), SIZE_MAX);
+
+	unmap_file(map_c, fd_c);
+	unmap_file(map_b, fd_b);
+
+	return 1;
+}
+
+/*
+ * test_fixed -- checks that the threshold is not calibrated
+ */
+static int
+test_fixed(const struct test_case *tc, int argc, char *argv[])
+{
+	if (argc < 2)
+		UT_FATAL("usage: test_fixed file threshold");
+
+	size_t expected = ATOUL(argv[1]);
+
+	int fd;
+	struct pmem2_map *map = map_file(argv[0], &fd);
+
+	UT_ASSERTeq(pmem2_map_get_movnt_threshold(map), expected);
+	do_ops(map, NOPS);
+	UT_ASSERTeq(pmem2_map_get_movnt_threshold(map), expected);
+
+	unmap_file(map, fd);
+
+	return 2;
+}
+
+/*
+ * test_cases -- available test cases
+ */
+static struct test_case test_cases[] = {
+	TEST_CASE(test_override),
+	TEST_CASE(test_calibrate),
+	TEST_CASE(test_remap),
+	TEST_CASE(test_fixed),
+};
+
+#define NTESTS (sizeof(test_cases) / sizeof(test_cases[0]))
+
+int
+main(int argc, char *argv[])
+{
+	START(argc, argv, "pmem2_movnt_threshold");
+	TEST_CASE_PROCESS(argc, argv, test_cases, NTESTS);
+	DONE(NULL);
+}
@@ -63,3 +63,7 @@ class TEST4(PmemMemcpy):
 @t.require_architectures('x86_64')
 class TEST5(PmemMemcpy):
     envs1 = ("PMEM_MOVDIR64B",)
+
+
+class TEST6(PmemMemcpy):
+    envs0 = ("PMEM_PARALLEL_THRESHOLD",)
@@ -0,0 +1,39 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2026, Intel Corporation */
+
+/*
+ * pmem_memcpyv.c -- unit test for doing a scatter-gather memcpy
+ *
+ * usage: pmem_memcpyv file
+ */
+
+#include "unittest.h"
+#include "memcpyv_common.h"
+
+int
+main(int argc, char *argv[])
+{
+	size_t mapped_len;
+
+	if (argc != 2)
+		UT_FATAL("usage: %s file", argv[0]);
+
+	const char *thr = os_getenv("PMEM_MOVNT_THRESHOLD");
+	const char *avx = os_getenv("PMEM_AVX");
+	const char *avx512f = os_getenv("PMEM_AVX512F");
+
+	START(argc, argv, "pmem_memcpyv %s %savx %savx512f",
+			thr ? thr : "default",
+			avx ? "" : "!",
+			avx512f ? "" : "!");
+
+	char *dest = pmem_map_file(argv[1], 0, 0, 0, &mapped_len, NULL);
+	if (dest == NULL)
+		UT_FATAL("!could not map file: %s", argv[1]);
+
+	do_memcpyv_variants(dest, mapped_len, pmem_memcpyv);
+
+	UT_ASSERTeq(pmem_unmap(dest, mapped_len), 0);
+
+	DONE(NULL);
+}
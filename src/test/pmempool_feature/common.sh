@@ -138,3 +138,16 @@ function pmempool_feature_test_CHECK_BAD_BLOCKS() {
 	pmempool_feature_enable "CHECK_BAD_BLOCKS"
 	pmempool_feature_disable "CHECK_BAD_BLOCKS"
 }
+
+# pmempool_feature_test_HUGE_ALIGN -- test HUGE_ALIGN
+function pmempool_feature_test_HUGE_ALIGN() {
+	# PMEMPOOL_FEAT_HUGE_ALIGN is disabled by default
+	pmempool_feature_query "HUGE_ALIGN"
+
+	pmempool_feature_enable "HUGE_ALIGN"
+
+	# the pool might already contain aligned huge objects
+	exit_func=expect_abnormal_exit
+	pmempool_feature_disable "HUGE_ALIGN" # UNSUPPORTED
+	exit_func=expect_normal_exit
+}